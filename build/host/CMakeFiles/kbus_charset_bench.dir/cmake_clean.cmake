@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/kbus_charset_bench.dir/kbus_charset_bench.c.o"
+  "CMakeFiles/kbus_charset_bench.dir/kbus_charset_bench.c.o.d"
+  "kbus_charset_bench"
+  "kbus_charset_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/kbus_charset_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
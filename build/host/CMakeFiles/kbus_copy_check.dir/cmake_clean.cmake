@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/kbus_copy_check.dir/kbus_copy_check.c.o"
+  "CMakeFiles/kbus_copy_check.dir/kbus_copy_check.c.o.d"
+  "kbus_copy_check"
+  "kbus_copy_check.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/kbus_copy_check.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/kbus_dispatch_bench.dir/kbus_dispatch_bench.c.o"
+  "CMakeFiles/kbus_dispatch_bench.dir/kbus_dispatch_bench.c.o.d"
+  "kbus_dispatch_bench"
+  "kbus_dispatch_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/kbus_dispatch_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/kbus_host.dir/kbus_host.c.o"
+  "CMakeFiles/kbus_host.dir/kbus_host.c.o.d"
+  "kbus_host"
+  "kbus_host.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/kbus_host.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,39 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/tools/host/esp_shim.c" "CMakeFiles/kbus_host_stack.dir/esp_shim.c.o" "gcc" "CMakeFiles/kbus_host_stack.dir/esp_shim.c.o.d"
+  "/root/repo/tools/host/freertos_shim.c" "CMakeFiles/kbus_host_stack.dir/freertos_shim.c.o" "gcc" "CMakeFiles/kbus_host_stack.dir/freertos_shim.c.o.d"
+  "/root/repo/components/cdc_emulator/cdc_emulator.c" "CMakeFiles/kbus_host_stack.dir/root/repo/components/cdc_emulator/cdc_emulator.c.o" "gcc" "CMakeFiles/kbus_host_stack.dir/root/repo/components/cdc_emulator/cdc_emulator.c.o.d"
+  "/root/repo/components/cdc_emulator/cdc_state.c" "CMakeFiles/kbus_host_stack.dir/root/repo/components/cdc_emulator/cdc_state.c.o" "gcc" "CMakeFiles/kbus_host_stack.dir/root/repo/components/cdc_emulator/cdc_state.c.o.d"
+  "/root/repo/components/kbus_service/kbus_charset.c" "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_charset.c.o" "gcc" "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_charset.c.o.d"
+  "/root/repo/components/kbus_service/kbus_filter.c" "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_filter.c.o" "gcc" "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_filter.c.o.d"
+  "/root/repo/components/kbus_service/kbus_mfl.c" "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_mfl.c.o" "gcc" "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_mfl.c.o.d"
+  "/root/repo/components/kbus_service/kbus_msg_pool.c" "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_msg_pool.c.o" "gcc" "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_msg_pool.c.o.d"
+  "/root/repo/components/kbus_service/kbus_pubsub.c" "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_pubsub.c.o" "gcc" "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_pubsub.c.o.d"
+  "/root/repo/components/kbus_service/kbus_ring.c" "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_ring.c.o" "gcc" "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_ring.c.o.d"
+  "/root/repo/components/kbus_service/kbus_scroll.c" "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_scroll.c.o" "gcc" "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_scroll.c.o.d"
+  "/root/repo/components/kbus_service/kbus_service.c" "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_service.c.o" "gcc" "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_service.c.o.d"
+  "/root/repo/components/kbus_service/kbus_tables.c" "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_tables.c.o" "gcc" "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_tables.c.o.d"
+  "/root/repo/components/kbus_service/kbus_tx_sched.c" "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_tx_sched.c.o" "gcc" "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_tx_sched.c.o.d"
+  "/root/repo/components/kbus_service/kbus_virtual_bus.c" "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_virtual_bus.c.o" "gcc" "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_virtual_bus.c.o.d"
+  "/root/repo/components/meta_arena/meta_arena.c" "CMakeFiles/kbus_host_stack.dir/root/repo/components/meta_arena/meta_arena.c.o" "gcc" "CMakeFiles/kbus_host_stack.dir/root/repo/components/meta_arena/meta_arena.c.o.d"
+  "/root/repo/components/sdrs_emulator/sdrs_display.c" "CMakeFiles/kbus_host_stack.dir/root/repo/components/sdrs_emulator/sdrs_display.c.o" "gcc" "CMakeFiles/kbus_host_stack.dir/root/repo/components/sdrs_emulator/sdrs_display.c.o.d"
+  "/root/repo/components/sdrs_emulator/sdrs_emulator.c" "CMakeFiles/kbus_host_stack.dir/root/repo/components/sdrs_emulator/sdrs_emulator.c.o" "gcc" "CMakeFiles/kbus_host_stack.dir/root/repo/components/sdrs_emulator/sdrs_emulator.c.o.d"
+  "/root/repo/components/sdrs_emulator/sdrs_sched.c" "CMakeFiles/kbus_host_stack.dir/root/repo/components/sdrs_emulator/sdrs_sched.c.o" "gcc" "CMakeFiles/kbus_host_stack.dir/root/repo/components/sdrs_emulator/sdrs_sched.c.o.d"
+  "/root/repo/components/sys_monitor/sys_monitor.c" "CMakeFiles/kbus_host_stack.dir/root/repo/components/sys_monitor/sys_monitor.c.o" "gcc" "CMakeFiles/kbus_host_stack.dir/root/repo/components/sys_monitor/sys_monitor.c.o.d"
+  "/root/repo/components/sys_monitor/sys_topology.c" "CMakeFiles/kbus_host_stack.dir/root/repo/components/sys_monitor/sys_topology.c.o" "gcc" "CMakeFiles/kbus_host_stack.dir/root/repo/components/sys_monitor/sys_topology.c.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
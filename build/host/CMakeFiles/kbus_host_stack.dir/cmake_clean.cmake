@@ -0,0 +1,51 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/kbus_host_stack.dir/esp_shim.c.o"
+  "CMakeFiles/kbus_host_stack.dir/esp_shim.c.o.d"
+  "CMakeFiles/kbus_host_stack.dir/freertos_shim.c.o"
+  "CMakeFiles/kbus_host_stack.dir/freertos_shim.c.o.d"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/cdc_emulator/cdc_emulator.c.o"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/cdc_emulator/cdc_emulator.c.o.d"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/cdc_emulator/cdc_state.c.o"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/cdc_emulator/cdc_state.c.o.d"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_charset.c.o"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_charset.c.o.d"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_filter.c.o"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_filter.c.o.d"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_mfl.c.o"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_mfl.c.o.d"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_msg_pool.c.o"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_msg_pool.c.o.d"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_pubsub.c.o"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_pubsub.c.o.d"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_ring.c.o"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_ring.c.o.d"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_scroll.c.o"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_scroll.c.o.d"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_service.c.o"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_service.c.o.d"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_tables.c.o"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_tables.c.o.d"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_tx_sched.c.o"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_tx_sched.c.o.d"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_virtual_bus.c.o"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/kbus_service/kbus_virtual_bus.c.o.d"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/meta_arena/meta_arena.c.o"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/meta_arena/meta_arena.c.o.d"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/sdrs_emulator/sdrs_display.c.o"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/sdrs_emulator/sdrs_display.c.o.d"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/sdrs_emulator/sdrs_emulator.c.o"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/sdrs_emulator/sdrs_emulator.c.o.d"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/sdrs_emulator/sdrs_sched.c.o"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/sdrs_emulator/sdrs_sched.c.o.d"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/sys_monitor/sys_monitor.c.o"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/sys_monitor/sys_monitor.c.o.d"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/sys_monitor/sys_topology.c.o"
+  "CMakeFiles/kbus_host_stack.dir/root/repo/components/sys_monitor/sys_topology.c.o.d"
+  "libkbus_host_stack.a"
+  "libkbus_host_stack.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/kbus_host_stack.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,3 @@
+file(REMOVE_RECURSE
+  "libkbus_host_stack.a"
+)
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/sdrs_display_stress.dir/sdrs_display_stress.c.o"
+  "CMakeFiles/sdrs_display_stress.dir/sdrs_display_stress.c.o.d"
+  "sdrs_display_stress"
+  "sdrs_display_stress.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/sdrs_display_stress.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
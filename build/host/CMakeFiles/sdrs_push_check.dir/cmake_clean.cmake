@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/sdrs_push_check.dir/sdrs_push_check.c.o"
+  "CMakeFiles/sdrs_push_check.dir/sdrs_push_check.c.o.d"
+  "sdrs_push_check"
+  "sdrs_push_check.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/sdrs_push_check.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/sdrs_reply_check.dir/sdrs_reply_check.c.o"
+  "CMakeFiles/sdrs_reply_check.dir/sdrs_reply_check.c.o.d"
+  "sdrs_reply_check"
+  "sdrs_reply_check.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/sdrs_reply_check.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,20 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/tools/host
+# Build directory: /root/repo/build/host
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(kbus_host "/root/repo/build/host/kbus_host" "-n" "200" "-f" "20000")
+set_tests_properties(kbus_host PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tools/host/CMakeLists.txt;71;add_test;/root/repo/tools/host/CMakeLists.txt;0;")
+add_test(kbus_dispatch_bench "/root/repo/build/host/kbus_dispatch_bench" "-n" "200000" "-r" "1")
+set_tests_properties(kbus_dispatch_bench PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tools/host/CMakeLists.txt;72;add_test;/root/repo/tools/host/CMakeLists.txt;0;")
+add_test(kbus_copy_check "/root/repo/build/host/kbus_copy_check" "-n" "50")
+set_tests_properties(kbus_copy_check PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tools/host/CMakeLists.txt;73;add_test;/root/repo/tools/host/CMakeLists.txt;0;")
+add_test(sdrs_reply_check "/root/repo/build/host/sdrs_reply_check" "-n" "1000")
+set_tests_properties(sdrs_reply_check PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tools/host/CMakeLists.txt;74;add_test;/root/repo/tools/host/CMakeLists.txt;0;")
+add_test(sdrs_push_check "/root/repo/build/host/sdrs_push_check" "-n" "5")
+set_tests_properties(sdrs_push_check PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tools/host/CMakeLists.txt;75;add_test;/root/repo/tools/host/CMakeLists.txt;0;")
+add_test(sdrs_display_stress "/root/repo/build/host/sdrs_display_stress" "-n" "50000")
+set_tests_properties(sdrs_display_stress PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tools/host/CMakeLists.txt;76;add_test;/root/repo/tools/host/CMakeLists.txt;0;")
+add_test(kbus_charset_bench "/root/repo/build/host/kbus_charset_bench" "-n" "200" "-r" "1" "/root/repo/tools/host/charset_corpus.txt")
+set_tests_properties(kbus_charset_bench PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tools/host/CMakeLists.txt;77;add_test;/root/repo/tools/host/CMakeLists.txt;0;")
@@ -47,6 +47,8 @@
 #include "btstack.h"
 
 #include "avrcp_control_driver.h"
+#define DLOG_LEVEL CONFIG_SYS_DLOG_LEVEL_BT
+#include "sys_dlog.h"
 
 static const char* TAG = "avrcp-ctl";
 
@@ -61,10 +63,10 @@ static uint16_t avrcp_cid = 0;
 static bool     avrcp_connected = false;
 static uint8_t  avrcp_subevent_value[100];
 
-// Now Playing Info
-static char track_str[256];
-static char artist_str[256];
-static char album_str[256];
+// Now Playing Info; interned, see meta_arena.h
+static meta_handle_t track_str = META_NONE;
+static meta_handle_t artist_str = META_NONE;
+static meta_handle_t album_str = META_NONE;
 static uint32_t track_len_ms = 0;
 static uint8_t track_no = 0;
 static uint8_t total_tracks = 0;
@@ -165,14 +167,14 @@ uint8_t avrcp_req_now_playing() {
     return avrcp_controller_get_now_playing_info(avrcp_cid);
 }
 
-char* avrcp_get_track_str() {
-    return track_str;
+meta_handle_t avrcp_get_track() {
+    return meta_load(&track_str);
 }
-char* avrcp_get_album_str() {
-    return album_str;
+meta_handle_t avrcp_get_album() {
+    return meta_load(&album_str);
 }
-char* avrcp_get_artist_str() {
-    return artist_str;
+meta_handle_t avrcp_get_artist() {
+    return meta_load(&artist_str);
 }
 
 uint16_t avrcp_get_track_info(){
@@ -251,7 +253,7 @@ static void avrcp_controller_packet_handler(uint8_t packet_type, uint16_t channe
             case AVRCP_SUBEVENT_NOTIFICATION_PLAYBACK_POS_CHANGED:{
                 uint32_t playback_position_ms = avrcp_subevent_notification_playback_pos_changed_get_playback_position_ms(packet);
                 if (playback_position_ms == AVRCP_NO_TRACK_SELECTED_PLAYBACK_POSITION_CHANGED){
-                    ESP_LOGD(TAG, "AVRCP Controller: playback position changed, no track is selected");
+                    DLOGD("AVRCP Controller: playback position changed, no track is selected");
                 }  
                 break;
             }
@@ -264,111 +266,106 @@ static void avrcp_controller_packet_handler(uint8_t packet_type, uint16_t channe
     memset(avrcp_subevent_value, 0, sizeof(avrcp_subevent_value));
     switch (packet[2]){
         case AVRCP_SUBEVENT_NOTIFICATION_PLAYBACK_POS_CHANGED:
-            ESP_LOGD(TAG, "AVRCP Controller: Playback position changed, position %d ms", (unsigned int) avrcp_subevent_notification_playback_pos_changed_get_playback_position_ms(packet));
+            DLOGD("AVRCP Controller: Playback position changed, position %d ms", (unsigned int) avrcp_subevent_notification_playback_pos_changed_get_playback_position_ms(packet));
             break;
         case AVRCP_SUBEVENT_NOTIFICATION_PLAYBACK_STATUS_CHANGED:
-            ESP_LOGD(TAG, "AVRCP Controller: Playback status changed %s", avrcp_play_status2str(avrcp_subevent_notification_playback_status_changed_get_play_status(packet)));
+            DLOGD("AVRCP Controller: Playback status changed %d", avrcp_subevent_notification_playback_status_changed_get_play_status(packet));
             return;
         case AVRCP_SUBEVENT_NOTIFICATION_NOW_PLAYING_CONTENT_CHANGED:
-            ESP_LOGD(TAG, "AVRCP Controller: Playing content changed");
+            DLOGD("AVRCP Controller: Playing content changed");
             avrcp_controller_get_now_playing_info(avrcp_cid);
             return;
         case AVRCP_SUBEVENT_NOTIFICATION_TRACK_CHANGED:
-            ESP_LOGD(TAG, "AVRCP Controller: Track changed");
-            ESP_LOGD(TAG, "packet_type: 0x%02x\t\tchannel: %d\tsize: %d\tpacket_addr: %x", packet_type, channel, size, (int)packet);
-            ESP_LOG_BUFFER_HEXDUMP(TAG, packet, 16, ESP_LOG_DEBUG);
+            DLOG_HEX(D, "AVRCP Controller: Track changed, packet_type: 0x%02x\tchannel: %d\tsize: %d", packet, 16, packet_type, channel, size);
             if(bt_service_task != NULL) xTaskNotify(bt_service_task, 0x04, eSetBits);
             return;
         case AVRCP_SUBEVENT_NOTIFICATION_VOLUME_CHANGED:
-            ESP_LOGD(TAG, "AVRCP Controller: Absolute volume changed %d", avrcp_subevent_notification_volume_changed_get_absolute_volume(packet));
+            DLOGD("AVRCP Controller: Absolute volume changed %d", avrcp_subevent_notification_volume_changed_get_absolute_volume(packet));
             return;
         case AVRCP_SUBEVENT_NOTIFICATION_AVAILABLE_PLAYERS_CHANGED:
-            ESP_LOGD(TAG, "AVRCP Controller: Changed");
+            DLOGD("AVRCP Controller: Changed");
             return; 
         case AVRCP_SUBEVENT_SHUFFLE_AND_REPEAT_MODE:{
             uint8_t shuffle_mode = avrcp_subevent_shuffle_and_repeat_mode_get_shuffle_mode(packet);
             uint8_t repeat_mode  = avrcp_subevent_shuffle_and_repeat_mode_get_repeat_mode(packet);
-            ESP_LOGD(TAG, "AVRCP Controller: %s, %s", avrcp_shuffle2str(shuffle_mode), avrcp_repeat2str(repeat_mode));
+            DLOGD("AVRCP Controller: shuffle %d, repeat %d", shuffle_mode, repeat_mode);
             break;
         }
         case AVRCP_SUBEVENT_NOW_PLAYING_TRACK_INFO:
             track_no = avrcp_subevent_now_playing_track_info_get_track(packet);
-            ESP_LOGD(TAG, "AVRCP Controller:     Track: %d", track_no);
+            DLOGD("AVRCP Controller:     Track: %d", track_no);
             break;
 
         case AVRCP_SUBEVENT_NOW_PLAYING_TOTAL_TRACKS_INFO:
             total_tracks = avrcp_subevent_now_playing_total_tracks_info_get_total_tracks(packet);
-            ESP_LOGD(TAG, "AVRCP Controller:     Total Tracks: %d", total_tracks);
+            DLOGD("AVRCP Controller:     Total Tracks: %d", total_tracks);
             break;
 
         case AVRCP_SUBEVENT_NOW_PLAYING_TITLE_INFO:
             if (avrcp_subevent_now_playing_title_info_get_value_len(packet) > 0){
-                bzero(track_str, sizeof(track_str));
-                memcpy(track_str, avrcp_subevent_now_playing_title_info_get_value(packet), avrcp_subevent_now_playing_title_info_get_value_len(packet));
-                ESP_LOGD(TAG, "AVRCP Controller:     Title: %s", track_str);
+                meta_assign(&track_str, meta_intern((const char*)avrcp_subevent_now_playing_title_info_get_value(packet), avrcp_subevent_now_playing_title_info_get_value_len(packet)));
+                DLOG_TEXT(D, "AVRCP Controller:     Title: %.*s", avrcp_subevent_now_playing_title_info_get_value(packet), avrcp_subevent_now_playing_title_info_get_value_len(packet));
             }  
             break;
 
         case AVRCP_SUBEVENT_NOW_PLAYING_ARTIST_INFO:
             if (avrcp_subevent_now_playing_artist_info_get_value_len(packet) > 0){
-                bzero(artist_str, sizeof(artist_str));
-                memcpy(artist_str, avrcp_subevent_now_playing_artist_info_get_value(packet), avrcp_subevent_now_playing_artist_info_get_value_len(packet));
-                ESP_LOGD(TAG, "AVRCP Controller:     Artist: %s", artist_str);
+                meta_assign(&artist_str, meta_intern((const char*)avrcp_subevent_now_playing_artist_info_get_value(packet), avrcp_subevent_now_playing_artist_info_get_value_len(packet)));
+                DLOG_TEXT(D, "AVRCP Controller:     Artist: %.*s", avrcp_subevent_now_playing_artist_info_get_value(packet), avrcp_subevent_now_playing_artist_info_get_value_len(packet));
             }  
             break;
         
         case AVRCP_SUBEVENT_NOW_PLAYING_ALBUM_INFO:
             if (avrcp_subevent_now_playing_album_info_get_value_len(packet) > 0){
-                bzero(album_str, sizeof(album_str));
-                memcpy(album_str, avrcp_subevent_now_playing_album_info_get_value(packet), avrcp_subevent_now_playing_album_info_get_value_len(packet));
-                ESP_LOGD(TAG, "AVRCP Controller:     Album: %s", album_str);
+                meta_assign(&album_str, meta_intern((const char*)avrcp_subevent_now_playing_album_info_get_value(packet), avrcp_subevent_now_playing_album_info_get_value_len(packet)));
+                DLOG_TEXT(D, "AVRCP Controller:     Album: %.*s", avrcp_subevent_now_playing_album_info_get_value(packet), avrcp_subevent_now_playing_album_info_get_value_len(packet));
             }  
             break;
         
         case AVRCP_SUBEVENT_NOW_PLAYING_GENRE_INFO:
             if (avrcp_subevent_now_playing_genre_info_get_value_len(packet) > 0){
                 memcpy(avrcp_subevent_value, avrcp_subevent_now_playing_genre_info_get_value(packet), avrcp_subevent_now_playing_genre_info_get_value_len(packet));
-                ESP_LOGD(TAG, "AVRCP Controller:     Genre: %s", avrcp_subevent_value);
+                DLOG_TEXT(D, "AVRCP Controller:     Genre: %.*s", avrcp_subevent_value, avrcp_subevent_now_playing_genre_info_get_value_len(packet));
             }  
             break;
 
         case AVRCP_SUBEVENT_NOW_PLAYING_SONG_LENGTH_MS_INFO:
             track_len_ms = avrcp_subevent_now_playing_song_length_ms_info_get_song_length(packet);
-            ESP_LOGD(TAG, "AVRCP Controller:     Length: %"PRIu32" ms", track_len_ms);
+            DLOGD("AVRCP Controller:     Length: %"PRIu32" ms", track_len_ms);
             // In testing, this is consistently the last packet of info parsed, so let's notify bt_task to pull new data.
             if(bt_service_task != NULL) xTaskNotify(bt_service_task, 0x08, eSetBits);
             break;
         
         case AVRCP_SUBEVENT_PLAY_STATUS:
             track_len_ms = avrcp_subevent_play_status_get_song_length(packet);
-            ESP_LOGD(TAG, "AVRCP Controller: Song length %"PRIu32" ms, Song position %"PRIu32" ms, Play status %s", 
-                track_len_ms, 
+            DLOGD("AVRCP Controller: Song length %"PRIu32" ms, Song position %"PRIu32" ms, Play status %d",
+                track_len_ms,
                 avrcp_subevent_play_status_get_song_position(packet),
-                avrcp_play_status2str(avrcp_subevent_play_status_get_play_status(packet)));
+                avrcp_subevent_play_status_get_play_status(packet));
             break;
         
         case AVRCP_SUBEVENT_OPERATION_COMPLETE:
-            ESP_LOGD(TAG, "AVRCP Controller: %s complete", avrcp_operation2str(avrcp_subevent_operation_complete_get_operation_id(packet)));
+            DLOGD("AVRCP Controller: operation 0x%02x complete", avrcp_subevent_operation_complete_get_operation_id(packet));
             break;
         
         case AVRCP_SUBEVENT_OPERATION_START:
-            ESP_LOGD(TAG, "AVRCP Controller: %s start", avrcp_operation2str(avrcp_subevent_operation_start_get_operation_id(packet)));
+            DLOGD("AVRCP Controller: operation 0x%02x start", avrcp_subevent_operation_start_get_operation_id(packet));
             break;
        
         case AVRCP_SUBEVENT_NOTIFICATION_EVENT_TRACK_REACHED_START:
-            ESP_LOGD(TAG, "AVRCP Controller: Track reached start");
+            DLOGD("AVRCP Controller: Track reached start");
             break;
 
         case AVRCP_SUBEVENT_NOTIFICATION_EVENT_TRACK_REACHED_END:
-            ESP_LOGD(TAG, "AVRCP Controller: Track reached end");
+            DLOGD("AVRCP Controller: Track reached end");
             break;
 
         case AVRCP_SUBEVENT_PLAYER_APPLICATION_VALUE_RESPONSE:
-            ESP_LOGD(TAG, "A2DP  Sink      : Set Player App Value %s", avrcp_ctype2str(avrcp_subevent_player_application_value_response_get_command_type(packet)));
+            DLOGD("A2DP  Sink      : Set Player App Value, ctype %d", avrcp_subevent_player_application_value_response_get_command_type(packet));
             break;
 
         default:
-            ESP_LOGD(TAG, "AVRCP Controller: Event 0x%02x is not parsed", packet[2]);
+            DLOGD("AVRCP Controller: Event 0x%02x is not parsed", packet[2]);
             break;
     }
 }
@@ -3,6 +3,7 @@
 
 #include <inttypes.h>
 #include <stdint.h>
+#include "meta_arena.h"
 
 /* Setup AVRCP service */
 int avrcp_setup(char* announce_str);
@@ -30,10 +31,10 @@ uint8_t avrcp_ctl_end_long_press();
 
 uint8_t avrcp_req_now_playing();
 
-// Returns pointer to current info strings
-char* avrcp_get_track_str();
-char* avrcp_get_album_str();
-char* avrcp_get_artist_str();
+// Returns current info strings; each call takes a reference, release it when done
+meta_handle_t avrcp_get_track();
+meta_handle_t avrcp_get_album();
+meta_handle_t avrcp_get_artist();
 
 // Returns current track in upper byte, total tracks in lower byte
 uint16_t avrcp_get_track_info();
@@ -15,11 +15,17 @@
 #include "avrcp_control_driver.h"
 
 #include "bt_common.h"
+#include "sys_monitor.h"
+#include "sys_topology.h"
+#include "sys_telemetry.h"
+#include "sys_trace.h"
+#include "sys_bench.h"
+#include "sys_power.h"
+#define DLOG_LEVEL CONFIG_SYS_DLOG_LEVEL_BT
+#include "sys_dlog.h"
 
 #define SECONDS(sec) ((sec*1000) / portTICK_RATE_MS)
 
-#define BT_TASK_PRIORITY    configMAX_PRIORITIES-8
-#define AUTOCON_TASK_PRIORITY BT_TASK_PRIORITY-10
 #define ANNOUNCE_STR        CONFIG_BT_ANNOUNCE_STR
 #define SHOULD_AUTOCONNECT  CONFIG_BT_AUTOCONNECT
 
@@ -31,6 +37,7 @@
 static const char* TAG = "bt-services";
 static QueueHandle_t bt_cmd_queue;
 static QueueHandle_t bt_info_queue;
+static sys_tlm_id_t bt_info_tlm = SYS_TLM_NONE;
 static TaskHandle_t avrcp_notification_task;
 
 static bt_now_playing_info_t cur_track_info;
@@ -69,6 +76,7 @@ int bluetooth_services_setup(QueueHandle_t command_queue, QueueHandle_t info_que
     setup_cmd_task();
 
     bt_info_queue = info_queue;
+    bt_info_tlm = sys_tlm_queue_register("bt_info");
 
     // Turn on bluetooth
     ESP_LOGI(TAG, "Bluetooth HCI on");
@@ -80,7 +88,7 @@ int bluetooth_services_setup(QueueHandle_t command_queue, QueueHandle_t info_que
 
 #if SHOULD_AUTOCONNECT
 static void setup_notify_task() {
-    int tsk_ret = xTaskCreatePinnedToCore(avrcp_notify_task, "bt_auto_con", 4096, NULL, AUTOCON_TASK_PRIORITY, &avrcp_notification_task, 0);
+    int tsk_ret = SYS_TASK_SPAWN(BT_AUTO_CON, avrcp_notify_task, &avrcp_notification_task);
     if(tsk_ret != pdPASS){ ESP_LOGE(TAG, "bt_auto_con creation failed with: %d", tsk_ret);}
 }
 
@@ -89,6 +97,8 @@ static void avrcp_notify_task() {
     uint32_t avrcp_status = 0;
     uint16_t retry_delay = 1;
     uint8_t cxn_attempt_count = 0;
+    char log_title[64], log_artist[64];
+    meta_arena_stats_t arena_stats;
 
     ESP_LOGD(TASK_TAG, "Autoconnect task started. Blocking while BT boots...");
     vTaskDelay(SECONDS(10)); // Block for 10 seconds while bt boots...
@@ -96,6 +106,7 @@ static void avrcp_notify_task() {
     while(1) {
         ESP_LOGD(TASK_TAG, "Waiting for AVRCP Notification...");
         xTaskNotifyWait(0x00000000, 0x0000000C, &avrcp_status, portMAX_DELAY); // CLear 0x04 && 0x08 Flags
+        sys_power_park();   // Car off: no reconnect attempts until it's back on
 
         ESP_LOGD(TASK_TAG, "Notification Receieved 0x%08x", avrcp_status);
 
@@ -127,9 +138,10 @@ static void avrcp_notify_task() {
             }
 
             if(avrcp_status & 0x08) {   // Track info updated, pull it
-                strcpy(cur_track_info.track_title, avrcp_get_track_str());
-                strcpy(cur_track_info.album_name, avrcp_get_album_str());
-                strcpy(cur_track_info.artist_name, avrcp_get_artist_str());
+                // Handles, not copies; the references travel with the message
+                cur_track_info.track_title = avrcp_get_track();
+                cur_track_info.album_name = avrcp_get_album();
+                cur_track_info.artist_name = avrcp_get_artist();
 
                 uint16_t cur_track_total_tracks = avrcp_get_track_info();
 
@@ -138,12 +150,22 @@ static void avrcp_notify_task() {
 
                 cur_track_info.track_len_ms = avrcp_get_track_len_ms();
 
-                ESP_LOGI(TASK_TAG, "Track Info: %s - %s - %s\t%d/%d",
-                                cur_track_info.track_title,
-                                cur_track_info.album_name,
-                                cur_track_info.artist_name,
+                meta_copy(cur_track_info.track_title, log_title, sizeof(log_title));
+                meta_copy(cur_track_info.artist_name, log_artist, sizeof(log_artist));
+                ESP_LOGI(TASK_TAG, "Track Info: %s - %s\t%d/%d",
+                                log_title,
+                                log_artist,
                                 cur_track_info.cur_track, cur_track_info.total_tracks);
-                xQueueSend(bt_info_queue, &cur_track_info, 100);
+                if(sys_tlm_queue_send(bt_info_tlm, bt_info_queue, &cur_track_info, 100) != pdTRUE) {
+                    meta_release(cur_track_info.track_title);
+                    meta_release(cur_track_info.album_name);
+                    meta_release(cur_track_info.artist_name);
+                }
+
+                meta_arena_get_stats(&arena_stats);
+                ESP_LOGD(TASK_TAG, "Metadata arena: %d strings, %d/%d bytes (peak %d), %"PRIu32" hits, %"PRIu32" failures",
+                                arena_stats.strings, arena_stats.bytes_used, META_ARENA_SIZE, arena_stats.bytes_peak,
+                                arena_stats.intern_hits, arena_stats.failures);
             }
         }
     }
@@ -151,92 +173,91 @@ static void avrcp_notify_task() {
 #endif
 
 static void setup_cmd_task() {
-    int tsk_ret = xTaskCreatePinnedToCore(bt_cmd_task, "bt_cmd", 2048, NULL, BT_TASK_PRIORITY, NULL, 0);
+    int tsk_ret = SYS_TASK_SPAWN(BT_CMD, bt_cmd_task, NULL);
     if(tsk_ret != pdPASS){ ESP_LOGE(TAG, "bt_cmd creation failed with: %d", tsk_ret);}
 }
 
 static void bt_cmd_task() {
-    bt_cmd_type_t command = BT_CMD_NOOP;
+    bt_cmd_t command;
+    uint8_t status;
+    const char* failed;     // What to call it if status says it failed
 
     while(1) {
-        command = BT_CMD_NOOP;
+        command.type = BT_CMD_NOOP;
 
         if(xQueueReceive(bt_cmd_queue, (void * )&command,  (portTickType)portMAX_DELAY)) {    
-            switch(command) {
+            sys_trace(SYS_TRACE_BT_DEQUEUE, command.trace_id, command.type);
+            status = ERROR_CODE_SUCCESS;
+            failed = NULL;
+            switch(command.type) {
                 case BT_CONNECT:
-                    ESP_LOGD(TAG, "BT Attempting Connect");
-                    if(avrcp_ctl_connect() != ERROR_CODE_SUCCESS) {
-                        ESP_LOGE(TAG, "AVRCP Connection error");
-                    }
+                    DLOGD("BT Attempting Connect");
+                    status = avrcp_ctl_connect();
+                    failed = "Connection";
                     break;
                 case BT_DISCONNECT:
-                    ESP_LOGD(TAG, "BT Attempting Disconnect");
-                    if(avrcp_ctl_disconnect() != ERROR_CODE_SUCCESS) {
-                        ESP_LOGE(TAG, "AVRCP Disconnect error");
-                    }
+                    DLOGD("BT Attempting Disconnect");
+                    status = avrcp_ctl_disconnect();
+                    failed = "Disconnect";
                     break;
                 case AVRCP_PLAY:
-                    ESP_LOGD(TAG, "BT Play Requested");
-                    if(avrcp_ctl_play()!= ERROR_CODE_SUCCESS) {
-                        ESP_LOGE(TAG, "AVRCP Play command error");
-                    }
+                    DLOGD("BT Play Requested");
+                    status = avrcp_ctl_play();
+                    failed = "Play command";
                     break;
                 case AVRCP_PAUSE:
-                    ESP_LOGD(TAG, "BT Pause Requested");
-                    if(avrcp_ctl_pause() != ERROR_CODE_SUCCESS) {
-                        ESP_LOGE(TAG, "AVRCP Pause command error");
-                    }
+                    DLOGD("BT Pause Requested");
+                    status = avrcp_ctl_pause();
+                    failed = "Pause command";
                     break;
                 case AVRCP_STOP:
-                    ESP_LOGD(TAG, "BT STOP Requested");
-                    if(avrcp_ctl_stop() != ERROR_CODE_SUCCESS) {
-                        ESP_LOGE(TAG, "AVRCP Stop command error");
-                    }
+                    DLOGD("BT STOP Requested");
+                    status = avrcp_ctl_stop();
+                    failed = "Stop command";
                     break;
                 case AVRCP_NEXT:
-                    ESP_LOGD(TAG, "BT Next Requested");
-                    if(avrcp_ctl_next() != ERROR_CODE_SUCCESS) {
-                        ESP_LOGE(TAG, "AVRCP Next command error");
-                    }
+                    DLOGD("BT Next Requested");
+                    status = avrcp_ctl_next();
+                    failed = "Next command";
                     break;
                 case AVRCP_PREV:
-                    ESP_LOGD(TAG, "BT Previous Requested");
-                    if(avrcp_ctl_prev() != ERROR_CODE_SUCCESS) {
-                        ESP_LOGE(TAG, "AVRCP Previous command error");
-                    }
+                    DLOGD("BT Previous Requested");
+                    status = avrcp_ctl_prev();
+                    failed = "Previous command";
                     break;
                 case AVRCP_FF_START:
-                    ESP_LOGD(TAG, "BT Fast Forward Requested");
-                    if(avrcp_ctl_start_ff() != ERROR_CODE_SUCCESS) {
-                        ESP_LOGE(TAG, "AVRCP FF command error");
-                    }
+                    DLOGD("BT Fast Forward Requested");
+                    status = avrcp_ctl_start_ff();
+                    failed = "FF command";
                     break;
                 case AVRCP_FF_STOP:
-                    ESP_LOGD(TAG, "BT Fast Forward Stop");
-                    if(avrcp_ctl_end_long_press() != ERROR_CODE_SUCCESS) {
-                        ESP_LOGE(TAG, "AVRCP FF Stop command error");
-                    }
+                    DLOGD("BT Fast Forward Stop");
+                    status = avrcp_ctl_end_long_press();
+                    failed = "FF Stop command";
                     break;
                 case AVRCP_RWD_START:
-                    ESP_LOGD(TAG, "BT Rewind Requested");
-                    if(avrcp_ctl_start_rwd() != ERROR_CODE_SUCCESS) {
-                        ESP_LOGE(TAG, "AVRCP RWD command error");
-                    }
+                    DLOGD("BT Rewind Requested");
+                    status = avrcp_ctl_start_rwd();
+                    failed = "RWD command";
                     break;
                 case AVRCP_RWD_STOP:
-                    ESP_LOGD(TAG, "BT Rewind Stop");
-                    if(avrcp_ctl_end_long_press() != ERROR_CODE_SUCCESS) {
-                        ESP_LOGE(TAG, "AVRCP RWD command error");
-                    }
+                    DLOGD("BT Rewind Stop");
+                    status = avrcp_ctl_end_long_press();
+                    failed = "RWD command";
                     break;
                 case AVRCP_GET_INFO:
-                ESP_LOGD(TAG, "AVRCP Requesting Track Info");
-                    if(avrcp_req_now_playing() != ERROR_CODE_SUCCESS) {
-                        ESP_LOGE(TAG, "AVRCP RWD command error");
-                    }
+                DLOGD("AVRCP Requesting Track Info");
+                    status = avrcp_req_now_playing();
+                    failed = "Track Info request";
                     break;
                 default:
-                    ESP_LOGD(TAG, "No action registered for command 0x%02x", command);
+                    DLOGD("No action registered for command 0x%02x", command.type);
+            }
+            sys_trace(SYS_TRACE_AVRCP_SENT, command.trace_id, command.type);
+            sys_bench_end();
+            // Logged after the send is timed; an unconnected bench setup fails every command
+            if(status != ERROR_CODE_SUCCESS) {
+                ESP_LOGE(TAG, "AVRCP %s error", failed);
             }
         } else {
             xQueueReset(bt_cmd_queue); // flush queue
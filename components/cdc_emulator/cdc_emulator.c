@@ -0,0 +1,94 @@
+// C stdlib includes
+#include <stddef.h>
+#include <string.h>
+
+// FreeRTOS includes
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// esp-idf includes
+#include "esp_log.h"
+#include "esp_timer.h"
+
+// component includes
+#include "kbus_uart_driver.h"
+#include "kbus_defines.h"
+#include "kbus_service.h"
+#include "kbus_pubsub.h"
+#include "kbus_tx_sched.h"
+#include "cdc_emulator.h"
+#include "cdc_state.h"
+#define DLOG_LEVEL CONFIG_SYS_DLOG_LEVEL_CDC
+#include "sys_dlog.h"
+
+static const char* TAG = "cdc_emu";
+static cdc_cmd_cb_t send_command = NULL;
+static cdc_state_t state;               // Only touched on kbus_dispatch_task
+static cdc_emu_stats_t stats;
+static portMUX_TYPE stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static const kbus_pattern_t cdc_patterns[] = {
+    {KBUS_ANY, CDC, DEV_STAT_REQ},
+    {KBUS_ANY, CDC, CD_CTRL_REQ},
+};
+
+static void cdc_rx_handler(kbus_message_t* rx_msg);
+
+void cdc_init_emulation(cdc_cmd_cb_t command_cb) {
+    send_command = command_cb;
+    cdc_state_init(&state);
+
+    if(kbus_subscribe("cdc", cdc_patterns, sizeof(cdc_patterns) / sizeof(cdc_patterns[0]), cdc_rx_handler) == KBUS_SUB_NONE) {
+        ESP_LOGE(TAG, "Out of subscriptions, CDC not emulated");
+        return;
+    }
+    send_dev_ready(CDC, LOC, true);
+}
+
+void cdc_get_stats(cdc_emu_stats_t* out) {
+    portENTER_CRITICAL(&stats_mux);
+    *out = stats;
+    portEXIT_CRITICAL(&stats_mux);
+}
+
+/**
+ ** Reply first, from the precomputed body, then the phone. A CD_CTRL_REQ without its
+ ** argument byte is taken as argument 0, as the radio's polls sometimes are.
+ */
+static void cdc_rx_handler(kbus_message_t* rx_msg) {
+    int64_t start_us = esp_timer_get_time();
+    kbus_message_t tx_msg = {
+        .src = CDC,
+        .dst = rx_msg->src,     // Address to sender of received msg
+        .body_len = CDC_STAT_BODY_LEN
+    };
+    cdc_action_t action;
+    uint32_t reply_us;
+
+    if(rx_msg->body[0] == DEV_STAT_REQ) {
+        send_dev_ready(CDC, rx_msg->src, false); // "Device Status Request" response "Device Status Ready"
+        DLOGD("CDC Queued: DEVICE STATUS READY");
+        return;
+    }
+    if(rx_msg->body_len < 2) return;
+
+    action = cdc_state_feed(&state, rx_msg->body[1], rx_msg->body_len > 2 ? rx_msg->body[2] : 0x00);
+    memcpy(tx_msg.body, action.reply, CDC_STAT_BODY_LEN);
+    // An unsent status is stale once there's a newer one
+    kbus_tx_submit(&tx_msg, KBUS_TX_REPLY, KBUS_TX_REPLY_DEADLINE_MS, KBUS_TX_KEY(CDC, CD_STAT_RPLY, 0));
+    reply_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+    for(uint8_t i = 0; i < action.ncommands && send_command != NULL; i++) send_command(action.commands[i]);
+
+    portENTER_CRITICAL(&stats_mux);
+    stats.play = state.play;
+    stats.disc = state.disc;
+    stats.track = state.track;
+    stats.requests++;
+    stats.commands += action.ncommands;
+    stats.reply_last_us = reply_us;
+    if(reply_us > stats.reply_max_us) stats.reply_max_us = reply_us;
+    portEXIT_CRITICAL(&stats_mux);
+
+    DLOGD("CDC 0x%02x: play state %d, disc %d track %d", rx_msg->body[1], state.play, state.disc, state.track);
+}
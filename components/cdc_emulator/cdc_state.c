@@ -0,0 +1,131 @@
+// C stdlib includes
+#include <stddef.h>
+#include <string.h>
+
+// component includes
+#include "kbus_defines.h"
+#include "cdc_state.h"
+
+static const char* play_names[CDC_STATES] = {"stopped", "paused", "playing", "scan fwd", "scan rev"};
+
+// Function byte per play state, before the mode bits
+static const uint8_t play_function[CDC_STATES] = {
+    [CDC_STOPPED]  = CDC_FUNC_STOPPED,
+    [CDC_PAUSED]   = CDC_FUNC_PAUSED,
+    [CDC_PLAYING]  = CDC_FUNC_PLAYING,
+    [CDC_SCAN_FWD] = CDC_FUNC_PLAYING,
+    [CDC_SCAN_REV] = CDC_FUNC_PLAYING,
+};
+
+static void encode_replies(cdc_state_t* state);
+static void end_scan(cdc_state_t* state, cdc_action_t* action);
+
+static inline void push(cdc_action_t* action, bt_cmd_type_t command) {
+    if(action->ncommands < CDC_MAX_COMMANDS) action->commands[action->ncommands++] = command;
+}
+
+static inline bool set_mode(cdc_state_t* state, uint8_t bit, bool on) {
+    uint8_t mode = on ? (state->mode | bit) : (state->mode & ~bit);
+    if(mode == state->mode) return false;
+    state->mode = mode;
+    return true;
+}
+
+void cdc_state_init(cdc_state_t* state) {
+    memset(state, 0, sizeof(*state));
+    state->play = CDC_STOPPED;
+    state->disc = 1;
+    state->track = 1;
+    encode_replies(state);
+}
+
+cdc_action_t cdc_state_feed(cdc_state_t* state, uint8_t req, uint8_t arg) {
+    cdc_action_t action = {.ncommands = 0};
+    cdc_play_t scan;
+    bool changed = false;
+
+    switch(req) {
+        case CDC_REQ_STOP:
+        case CDC_REQ_PAUSE:
+            // Pause for stop too; stopping the phone's player can end its AVRCP session
+            end_scan(state, &action);
+            if(state->play != CDC_STOPPED && state->play != CDC_PAUSED) push(&action, AVRCP_PAUSE);
+            state->play = (req == CDC_REQ_STOP) ? CDC_STOPPED : CDC_PAUSED;
+            break;
+
+        case CDC_REQ_PLAY:
+            // After a scan the phone is still playing; ending the scan is all it needs
+            if(state->play == CDC_SCAN_FWD || state->play == CDC_SCAN_REV) end_scan(state, &action);
+            else if(state->play != CDC_PLAYING) push(&action, AVRCP_PLAY);
+            state->play = CDC_PLAYING;
+            break;
+
+        case CDC_REQ_SCAN:
+            scan = arg ? CDC_SCAN_REV : CDC_SCAN_FWD;
+            if(state->play == scan) break;
+            end_scan(state, &action);
+            push(&action, arg ? AVRCP_RWD_START : AVRCP_FF_START);
+            state->play = scan;
+            break;
+
+        case CDC_REQ_SEEK:
+        case CDC_REQ_TRACK:
+            if(state->play == CDC_SCAN_FWD || state->play == CDC_SCAN_REV) {
+                end_scan(state, &action);
+                state->play = CDC_PLAYING;
+            }
+            if(arg) state->track = (state->track > 1) ? state->track - 1 : CDC_TRACK_MAX;
+            else state->track = (state->track < CDC_TRACK_MAX) ? state->track + 1 : 1;
+            push(&action, arg ? AVRCP_PREV : AVRCP_NEXT);
+            changed = true;
+            break;
+
+        // Nothing on the phone to change to; the radio just needs to see the disc it asked for
+        case CDC_REQ_DISC:
+            if(arg < 1 || arg > CDC_DISCS || arg == state->disc) break;
+            state->disc = arg;
+            state->track = 1;
+            changed = true;
+            break;
+
+        case CDC_REQ_INTRO:
+            changed = set_mode(state, CDC_MODE_INTRO, arg != 0);
+            break;
+
+        case CDC_REQ_RANDOM:
+            changed = set_mode(state, CDC_MODE_RANDOM, arg != 0);
+            break;
+
+        case CDC_REQ_STATUS:
+        default:
+            break;
+    }
+
+    if(changed) encode_replies(state);
+    action.reply = state->replies[state->play];
+    return action;
+}
+
+const char* cdc_play_name(cdc_play_t play) {
+    return play < CDC_STATES ? play_names[play] : "?";
+}
+
+// Every play state's reply for the current disc, track and mode
+static void encode_replies(cdc_state_t* state) {
+    for(int play = 0; play < CDC_STATES; play++) {
+        uint8_t* body = state->replies[play];
+        body[0] = CD_STAT_RPLY;
+        body[1] = play;                                 // Status
+        body[2] = play_function[play] | state->mode;    // Function
+        body[3] = 0x00;                                 // Errors; none
+        body[4] = CDC_DISCS_LOADED;
+        body[5] = 0x00;
+        body[6] = state->disc;
+        body[7] = state->track;
+    }
+}
+
+static void end_scan(cdc_state_t* state, cdc_action_t* action) {
+    if(state->play == CDC_SCAN_FWD) push(action, AVRCP_FF_STOP);
+    else if(state->play == CDC_SCAN_REV) push(action, AVRCP_RWD_STOP);
+}
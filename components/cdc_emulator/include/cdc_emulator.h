@@ -0,0 +1,37 @@
+#ifndef CDC_EMULATOR_H
+#define CDC_EMULATOR_H
+
+#include <stdint.h>
+#include "bt_common.h"
+#include "cdc_state.h"
+
+/**
+ ** CD changer emulator, CONFIG_CDC_EMULATOR; a lot of radios only offer an external source
+ ** once a CDC answers their polls. Runs as an inline subscriber on kbus_dispatch_task with
+ ** no task or queue of its own: each request goes through cdc_state.h, its precomputed
+ ** reply is queued as a KBUS_TX_REPLY, and only then is any AVRCP command handed to
+ ** command_cb, so a full bt_cmd queue can't hold the reply up.
+ **
+ ** Reply times in the stats run from handler entry to the reply being queued for tx; with
+ ** CONFIG_SYS_TRACE the whole rx to tx path is in the trace.
+ */
+typedef void (*cdc_cmd_cb_t)(bt_cmd_type_t command);
+
+typedef struct {
+    cdc_play_t play;
+    uint8_t disc;
+    uint8_t track;
+    uint32_t requests;          // CD_CTRL_REQ answered
+    uint32_t commands;          // Handed to command_cb
+    uint32_t reply_last_us;
+    uint32_t reply_max_us;
+} cdc_emu_stats_t;
+
+#ifdef CONFIG_CDC_EMULATOR
+void cdc_init_emulation(cdc_cmd_cb_t command_cb);
+void cdc_get_stats(cdc_emu_stats_t* stats);
+#else
+static inline void cdc_init_emulation(cdc_cmd_cb_t command_cb) {}
+#endif
+
+#endif //CDC_EMULATOR_H
@@ -0,0 +1,76 @@
+#ifndef CDC_STATE_H
+#define CDC_STATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "bt_common.h"
+
+/**
+ ** CD changer state machine; what the radio's CD_CTRL_REQ does to play state, disc and
+ ** track, and which AVRCP command that means for the phone. No FreeRTOS or esp-idf in it,
+ ** so tools/cdc_check.c runs the same code on the host.
+ **
+ ** CD_STAT_RPLY bodies are kept encoded, one per play state, and rebuilt only when disc,
+ ** track or mode change; answering a request is a switch and a pointer to one of them.
+ **
+ ** CD Changer messages from http://web.archive.org/web/20110320053244/http://ibus.stuge.se/CD_Changer
+ */
+
+// CD_CTRL_REQ subcommands, body[1]; body[2] is the argument
+#define CDC_REQ_STATUS      0x00    // Poll
+#define CDC_REQ_STOP        0x01    // Also sent when the radio switches away from CD
+#define CDC_REQ_PAUSE       0x02
+#define CDC_REQ_PLAY        0x03    // Also ends a scan when the button is released
+#define CDC_REQ_SCAN        0x04    // Held >>/<<; 0x00 forward, 0x01 back
+#define CDC_REQ_SEEK        0x05    // 0x00 next track, 0x01 previous
+#define CDC_REQ_DISC        0x06    // Disc number 1-6
+#define CDC_REQ_INTRO       0x07    // Scan (intro) mode; 0x00 off
+#define CDC_REQ_RANDOM      0x08    // Random mode; 0x00 off
+#define CDC_REQ_TRACK       0x0A    // 0x00 next track, 0x01 previous; newer radios' seek
+
+// CD_STAT_RPLY function byte, body[2]
+#define CDC_FUNC_STOPPED    0x02
+#define CDC_FUNC_PLAYING    0x09
+#define CDC_FUNC_PAUSED     0x0C
+#define CDC_MODE_INTRO      0x10    // Or'd into the function byte
+#define CDC_MODE_RANDOM     0x20
+
+#define CDC_STAT_BODY_LEN   8       // [39][status][function][errors][discs][00][disc][track]
+#define CDC_DISCS           6
+#define CDC_DISCS_LOADED    0x3F    // Bit per disc; all of them, so any disc button is accepted
+#define CDC_TRACK_MAX       99
+#define CDC_MAX_COMMANDS    2       // Ending a scan and pausing, for one request
+
+// Order is the CD_STAT_RPLY status byte
+typedef enum {
+    CDC_STOPPED = 0,
+    CDC_PAUSED,
+    CDC_PLAYING,
+    CDC_SCAN_FWD,
+    CDC_SCAN_REV,
+    CDC_STATES
+} cdc_play_t;
+
+typedef struct {
+    cdc_play_t play;
+    uint8_t disc;           // 1-CDC_DISCS
+    uint8_t track;          // 1-CDC_TRACK_MAX
+    uint8_t mode;           // CDC_MODE_* bits
+    uint8_t replies[CDC_STATES][CDC_STAT_BODY_LEN];
+} cdc_state_t;
+
+typedef struct {
+    const uint8_t* reply;                       // CD_STAT_RPLY body, CDC_STAT_BODY_LEN bytes
+    bt_cmd_type_t commands[CDC_MAX_COMMANDS];   // For the phone, in order
+    uint8_t ncommands;
+} cdc_action_t;
+
+// Stopped on disc 1 track 1
+void cdc_state_init(cdc_state_t* state);
+
+// One CD_CTRL_REQ; the reply is always set, the radio expects a status for every request
+cdc_action_t cdc_state_feed(cdc_state_t* state, uint8_t req, uint8_t arg);
+
+const char* cdc_play_name(cdc_play_t play);
+
+#endif //CDC_STATE_H
@@ -1,6 +1,8 @@
 #ifndef BT_COMMON_H
 #define BT_COMMON_H
 
+#include "meta_arena.h"
+
 typedef enum {
     BT_CMD_NOOP = 0x00,
     BT_CONNECT,
@@ -17,11 +19,17 @@ typedef enum {
     AVRCP_GET_INFO
 } bt_cmd_type_t;
 
+// bt_cmd_queue item; trace_id follows the K-bus frame that caused the command, see sys_trace.h
+typedef struct {
+    bt_cmd_type_t type;
+    uint16_t trace_id;
+} bt_cmd_t;
+
+// Strings are meta_arena handles; each holds a reference the receiver releases
 typedef struct {
-    char album_name[128];
-    char track_title[128];
-    char artist_name[64];
-    char playback_state[16];
+    meta_handle_t album_name;
+    meta_handle_t track_title;
+    meta_handle_t artist_name;
 
     uint32_t track_len_ms;
     uint8_t cur_track;
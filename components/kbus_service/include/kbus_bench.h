@@ -0,0 +1,24 @@
+#ifndef KBUS_BENCH_H
+#define KBUS_BENCH_H
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+/**
+ ** MFL -> AVRCP latency benchmark, enabled with CONFIG_KBUS_BENCH on the virtual bus.
+ ** Injects steering wheel hold/release frames (search up: AVRCP FF start/stop, so a
+ ** connected phone isn't skipped through its playlist) and times each one until bt_cmd_task
+ ** hands the command to btstack (sys_bench.h). Runs once idle, then again while background
+ ** bus traffic and now-playing updates run, and prints a BENCH line per phase.
+ **
+ ** Topology is a build option (sys_topology.h); build each one, run, and compare the logs
+ ** with `tools/sys_bench.py`.
+ */
+#ifdef CONFIG_KBUS_BENCH
+// bt_info_queue is where the BT load's now-playing updates go
+void kbus_bench_start(QueueHandle_t bt_info_queue);
+#else
+static inline void kbus_bench_start(QueueHandle_t bt_info_queue) {}
+#endif
+
+#endif //KBUS_BENCH_H
@@ -0,0 +1,62 @@
+#ifndef KBUS_CAPTURE_H
+#define KBUS_CAPTURE_H
+
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "kbus_uart_driver.h"
+
+/**
+ ** K-bus capture (.kbc), little endian:
+ **   header  "KBC1" [version][3 reserved]
+ **   record  [uint32 us since previous record][src][dst][body_len][body...]
+ ** First record's delta is from capture start. tools/kbus_capture.py reads, writes and imports these.
+ */
+#define KBUS_CAPTURE_MAGIC          "KBC1"
+#define KBUS_CAPTURE_VERSION        1
+#define KBUS_CAPTURE_HDR_LEN        8
+#define KBUS_CAPTURE_REC_HDR_LEN    7
+
+#define KBUS_REPLAY_MAX_SPEED       0   // speed argument; no pacing, back-pressure only
+
+typedef struct {
+    uint32_t min_us;
+    uint32_t avg_us;
+    uint32_t max_us;
+    uint32_t p50_us;    // Upper bound of the log2 bucket holding the percentile
+    uint32_t p99_us;
+    uint32_t samples;
+} kbus_latency_stats_t;
+
+typedef struct {
+    uint32_t frames;                // Frames injected
+    uint32_t elapsed_us;            // First inject to last frame dispatched
+    uint32_t frames_per_sec;
+    kbus_latency_stats_t frame;     // Inject -> all handlers returned
+    kbus_latency_stats_t output;    // Inject -> handler output (e.g. command on bt_cmd_queue)
+} kbus_replay_report_t;
+
+void kbus_capture_init(QueueHandle_t rx_queue);
+
+// Recording, fed by kbus_rx_task
+bool kbus_capture_start();
+void kbus_capture_stop();
+void kbus_capture_record(const kbus_message_t* message);
+size_t kbus_capture_get(const uint8_t** data);
+void kbus_capture_dump();   // Hex lines between KBC-BEGIN/KBC-END markers on the console
+
+/**
+ ** Replay a capture into the rx path. speed 1 is real time, N is N times faster,
+ ** KBUS_REPLAY_MAX_SPEED is as fast as the stack takes it. Latencies pair frames up in
+ ** FIFO order, so replay on a quiet (or virtual) bus.
+ */
+bool kbus_replay_start(const uint8_t* capture, size_t len, uint16_t speed);
+bool kbus_replay_running();
+void kbus_replay_get_report(kbus_replay_report_t* report);
+
+// Dispatch side hooks
+void kbus_replay_frame_begin();
+void kbus_replay_frame_done();
+void kbus_replay_note_output();
+
+#endif //KBUS_CAPTURE_H
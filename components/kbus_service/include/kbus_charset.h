@@ -0,0 +1,17 @@
+#ifndef KBUS_CHARSET_H
+#define KBUS_CHARSET_H
+
+#include <stddef.h>
+
+/**
+ ** UTF-8 to the character set the IKE/MID and radio display. Output is one byte per glyph,
+ ** so byte counts are display widths and any cut lands between glyphs. Characters the
+ ** display lacks are transliterated ("é" -> "e", "ß" -> "ss", "…" -> "..."); a
+ ** transliteration that doesn't fit at the end is dropped whole. Combining marks are dropped,
+ ** anything else unknown or malformed becomes '?'. Meant to run once per track, not per frame.
+ */
+
+// Returns bytes written to out, not counting the NUL; out always ends up NUL terminated
+size_t kbus_charset_from_utf8(const char* in, size_t in_len, char* out, size_t out_size);
+
+#endif //KBUS_CHARSET_H
@@ -1,5 +1,15 @@
 #ifndef KBUS_DEFINES_H
 #define KBUS_DEFINES_H
+// Generated by tools/kbus_spec.py from kbus_spec.json; edit the spec, not this file
+
+/**
+ ** kbus bus timing; 9600 baud, 8 data bits, even parity, 1 stop bit
+ ** Frame on the wire is [src][len][dst][body...][chk], len counting dst through chk
+ */
+#define KBUS_BAUD           9600
+#define KBUS_BITS_PER_BYTE  11
+#define KBUS_FRAME_OVERHEAD 4       // src, len, dst, checksum
+#define KBUS_WIRE_US(body_len) ((((body_len) + KBUS_FRAME_OVERHEAD) * KBUS_BITS_PER_BYTE * 1000000UL) / KBUS_BAUD)
 
 /**
  ** kbus device definitions from
@@ -54,7 +64,7 @@
 
 #define LCM     0xD0    //Light control module
 #define SM_1    0xDA    //Seat memory
-#define GTHL    0xDA    //unknown
+#define GTHL    SM_1    //Alias, same address
 
 #define IRIS    0xE0    //Integrated radio information system
 #define ANZV    0xE7    //Front display
@@ -65,11 +75,11 @@
 #define CSU     0xF5    //unknown
 #define LOC     0xFF    //Local
 
-/** 
- ** kbus command definitions from
- * http://web.archive.org/web/20110318185808/http://ibus.stuge.se/IBus_Messages
+/**
+ ** kbus command definitions, first body byte, from
+ ** http://web.archive.org/web/20110318185808/http://ibus.stuge.se/IBus_Messages
  ** AND
- * Testing w/NavCoder
+ ** Testing w/NavCoder
  */
 
 // General status && module coding
@@ -111,6 +121,7 @@
 #define TEL_STATUS          0x2C    //Telephone status
 
 // Media Status / Control
+#define VOLUME_CTRL         0x32    //Volume control
 #define DSP_EQ_BUTT         0x34    //DSP Equalizer Button
 #define CD_CTRL_REQ         0x38    //CD Control Message
 #define CD_STAT_RPLY        0x39    //CD Status Reply
@@ -128,12 +139,12 @@
 // Light module
 #define LAMP_STAT_REQ       0x5A    //Lamp state request
 #define LAMP_STAT_RPLY      0x5B    //Lamp state
+#define LAMP_STATUS         LAMP_STAT_RPLY    //Alias, same command
 #define VEHICLE_STAT_REQ    0x53    //Vehicle data request
 #define VEHICLE_STAT_RPLY   0x54    //Vehicle data status
-#define LAMP_STATUS         0x5B    //Lamp Status
 #define RIP_STAT_REQ        0x71    //Rain sensor status request
 
-// 
+// Diagnostics / Navigation
 #define DIAG_DATA           0xA0    //"DIAG data"
 #define NAV_CTL             0xAA    //Navigation Control
 
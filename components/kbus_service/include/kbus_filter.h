@@ -0,0 +1,72 @@
+#ifndef KBUS_FILTER_H
+#define KBUS_FILTER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "kbus_uart_driver.h"
+
+/**
+ ** Ingest filter, checked where a frame completes so frames nobody handles never reach
+ ** kbus_rx_queue or wake kbus_rx_task. A frame passes if its source is in src or its
+ ** destination is in dst, and its command (body[0]) is allowed by that address's command
+ ** mask, if it has one. Dropped frames are only counted, and still reported to the tx
+ ** pacing estimate since they used the bus.
+ **
+ ** Filters only ever widen: adding an address or command never takes another one out. So
+ ** the matcher reads without a lock from any task while handlers register; each update
+ ** sets the command mask before the address bit that makes it reachable.
+ */
+#define KBUS_FILTER_CMD_MASKS 8     // Addresses that can have their own command mask
+
+typedef struct {
+    uint32_t src[8];                // 256-bit address bitmaps
+    uint32_t dst[8];
+    uint8_t src_cmds[256];          // 0 for any command, else 1 + index into cmd_masks
+    uint8_t dst_cmds[256];
+    uint32_t cmd_masks[KBUS_FILTER_CMD_MASKS][8];
+    uint8_t cmd_masks_used;
+    bool pass_all;
+    volatile uint32_t passed;
+    volatile uint32_t dropped;
+    volatile uint32_t dropped_bytes; // Body bytes of dropped frames
+} kbus_filter_t;
+
+typedef struct {
+    uint32_t passed;
+    uint32_t dropped;
+    uint32_t dropped_bytes;
+} kbus_filter_stats_t;
+
+// pass_all lets everything through regardless of what's added, e.g. while capturing the bus
+void kbus_filter_init(kbus_filter_t* filter, bool pass_all);
+
+/**
+ ** Let frames from src / to dst through. With ncmds == 0 any command passes, for good;
+ ** otherwise cmds are added to the address's command mask. False if every command mask is
+ ** taken, in which case the address passes any command rather than losing frames.
+ */
+bool kbus_filter_add_src(kbus_filter_t* filter, uint8_t src, const uint8_t* cmds, uint8_t ncmds);
+bool kbus_filter_add_dst(kbus_filter_t* filter, uint8_t dst, const uint8_t* cmds, uint8_t ncmds);
+
+// For a subscriber that wants frames from anyone to anyone
+void kbus_filter_pass_all(kbus_filter_t* filter);
+
+// Match and count; call once per completed frame, before it's queued
+bool kbus_filter_admit(kbus_filter_t* filter, const kbus_message_t* message);
+void kbus_filter_get_stats(const kbus_filter_t* filter, kbus_filter_stats_t* stats);
+
+static inline bool kbus_filter_bit(const uint32_t* bitmap, uint8_t bit) {
+    return bitmap[bit >> 5] & (1UL << (bit & 0x1F));
+}
+
+static inline bool kbus_filter_cmd_ok(const kbus_filter_t* filter, uint8_t mask, uint8_t cmd) {
+    return mask == 0 || kbus_filter_bit(filter->cmd_masks[mask - 1], cmd);
+}
+
+static inline bool kbus_filter_match(const kbus_filter_t* filter, uint8_t src, uint8_t dst, uint8_t cmd) {
+    if(filter->pass_all) return true;
+    if(kbus_filter_bit(filter->src, src) && kbus_filter_cmd_ok(filter, filter->src_cmds[src], cmd)) return true;
+    return kbus_filter_bit(filter->dst, dst) && kbus_filter_cmd_ok(filter, filter->dst_cmds[dst], cmd);
+}
+
+#endif //KBUS_FILTER_H
@@ -0,0 +1,36 @@
+#ifndef KBUS_MFL_H
+#define KBUS_MFL_H
+
+#include "freertos/FreeRTOS.h"
+#include "kbus_uart_driver.h"
+#include "bt_common.h"
+
+/**
+ ** Steering wheel (MFL) button decoder. Every button runs the same constant transition
+ ** table; what each press means is looked up per button. No heap, all state is static.
+ ** Runs entirely on kbus_dispatch_task, so it takes no locks.
+ **
+ ** With CONFIG_KBUS_MFL_TIMING long presses are also detected from tick time (instead of
+ ** waiting for the MFL's own long-press frame) and double presses become available. The
+ ** caller must then run kbus_mfl_poll() whenever the returned wait has elapsed.
+ */
+typedef void (*kbus_mfl_cmd_cb_t)(bt_cmd_type_t command);
+
+typedef struct {
+    uint32_t events;        // Decoded press/long/release events
+    uint32_t commands;      // Commands handed to the callback
+    uint32_t ignored;       // MFL frames that aren't a known button
+    uint32_t synthesized;   // Long presses detected from tick time
+} kbus_mfl_stats_t;
+
+void kbus_mfl_init(kbus_mfl_cmd_cb_t command_cb);
+
+// Handler for frames from MFL
+void kbus_mfl_feed(const kbus_message_t* message);
+
+// Runs expired press timers; returns ticks until the next one, portMAX_DELAY if none is armed
+TickType_t kbus_mfl_poll();
+
+void kbus_mfl_get_stats(kbus_mfl_stats_t* stats);
+
+#endif //KBUS_MFL_H
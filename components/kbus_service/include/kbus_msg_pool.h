@@ -0,0 +1,36 @@
+#ifndef KBUS_MSG_POOL_H
+#define KBUS_MSG_POOL_H
+
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "kbus_uart_driver.h"
+
+/**
+ ** Fixed pool of refcounted kbus_message_t buffers.
+ ** Queues between kbus_dispatch_task and emulators carry kbus_message_t* handles from this pool
+ ** instead of the message itself; each consumer takes a reference and releases it when done.
+ ** Only messages obtained from kbus_msg_alloc() may be passed to retain/release.
+ */
+#define KBUS_MSG_POOL_SIZE  16
+
+typedef struct {
+    uint32_t frames_delivered;  // Frames handed to dispatch
+    uint32_t bytes_copied;      // Bytes moved by queue copies along the way
+    uint32_t alloc_failures;    // kbus_msg_alloc() timeouts
+    uint8_t in_use;             // Buffers currently referenced
+    uint8_t in_use_max;         // High-water mark of in_use
+} kbus_msg_pool_stats_t;
+
+void kbus_msg_pool_init();
+
+// Returns a buffer holding one reference, or NULL if none frees up within ticks_to_wait
+kbus_message_t* kbus_msg_alloc(TickType_t ticks_to_wait);
+kbus_message_t* kbus_msg_retain(kbus_message_t* message);
+void kbus_msg_release(kbus_message_t* message);
+
+// Copy accounting, called wherever a hop moves message bytes
+void kbus_msg_pool_count_copy(size_t bytes);
+void kbus_msg_pool_count_delivered();
+void kbus_msg_pool_get_stats(kbus_msg_pool_stats_t* stats);
+
+#endif //KBUS_MSG_POOL_H
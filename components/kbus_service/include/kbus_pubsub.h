@@ -0,0 +1,66 @@
+#ifndef KBUS_PUBSUB_H
+#define KBUS_PUBSUB_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "kbus_uart_driver.h"
+#include "kbus_filter.h"
+
+/**
+ ** Frame routing for kbus_dispatch_task. A subscriber gives (src, dst, cmd) patterns, any
+ ** field KBUS_ANY, and gets each frame that matches at least one of them exactly once.
+ ** Patterns compile into one 256-entry table of pattern bits per field, so matching a frame
+ ** is three lookups ANDed together however many subscribers there are.
+ **
+ ** Delivery is either inline, a handler run on kbus_dispatch_task, or queued: a reference to
+ ** the pooled message (kbus_msg_pool.h) goes to the subscriber's queue without waiting, the
+ ** frame itself is never copied, and the subscriber releases it when done. The subscriber
+ ** creates the queue, with kbus_message_t* items, so its length is the ring depth and its
+ ** memory is attributed to the subscriber. When it's full the frame is dropped for that
+ ** subscriber only and counted as an overflow; lag is how many frames were already waiting.
+ **
+ ** Subscribing opens the rx filter (kbus_filter.h) for the patterns. Subscriptions are never
+ ** removed, so dispatch matches without a lock while others subscribe.
+ */
+#define KBUS_ANY            0xFFFF
+#define KBUS_MAX_SUBS       16
+#define KBUS_MAX_PATTERNS   32      // Across all subscribers; one bit each in the match tables
+
+#define KBUS_PATTERN(src, dst, cmd) ((kbus_pattern_t){(src), (dst), (cmd)})
+
+// Called from kbus_dispatch_task for every matching frame; must not block for long.
+typedef void (*kbus_handler_t)(kbus_message_t* message);
+
+typedef struct {
+    uint16_t src;       // Address, or KBUS_ANY
+    uint16_t dst;
+    uint16_t cmd;       // First body byte
+} kbus_pattern_t;
+
+typedef int8_t kbus_sub_id_t;
+#define KBUS_SUB_NONE (-1)
+
+typedef struct {
+    const char* name;
+    bool queued;
+    uint32_t delivered;
+    uint32_t overflows;     // Queued only; frames dropped because the queue was full
+    uint8_t lag;            // Queued only; frames waiting when the last one was delivered
+    uint8_t lag_max;
+} kbus_sub_stats_t;
+
+void kbus_pubsub_init(kbus_filter_t* rx_filter);
+
+// name is copied, up to SYS_TLM_NAME_LEN, and names the subscriber's telemetry. KBUS_SUB_NONE when out of room.
+kbus_sub_id_t kbus_subscribe(const char* name, const kbus_pattern_t* patterns, uint8_t npatterns, kbus_handler_t handler);
+kbus_sub_id_t kbus_subscribe_queue(const char* name, const kbus_pattern_t* patterns, uint8_t npatterns, QueueHandle_t queue);
+
+// kbus_dispatch_task only; message must come from kbus_msg_alloc()
+void kbus_publish(kbus_message_t* message, uint16_t trace_id);
+
+uint8_t kbus_pubsub_count();
+bool kbus_pubsub_get_stats(kbus_sub_id_t id, kbus_sub_stats_t* stats);
+
+#endif //KBUS_PUBSUB_H
@@ -0,0 +1,54 @@
+#ifndef KBUS_RING_H
+#define KBUS_RING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ ** Lock-free single-producer/single-consumer byte ring of length-prefixed frames.
+ ** Sized in bytes, so short frames (2-3 byte polls) take 2 + len bytes, rounded up to even,
+ ** rather than a full kbus_message_t slot. One task may push and one (possibly on the other
+ ** core) may pop; head is only written by the producer and tail only by the consumer.
+ ** No FreeRTOS dependency, builds as plain C11 on the host.
+ **
+ ** Frames take an even number of bytes so a length prefix never straddles the end of the
+ ** buffer. A reservation has to be contiguous; one that doesn't fit before the end leaves a
+ ** KBUS_RING_PAD prefix there and starts over at the front, and pops skip it.
+ */
+#define KBUS_RING_HDR_LEN   2       // uint16_t little endian frame length
+#define KBUS_RING_PAD       0xFFFF  // Length prefix of the unused bytes up to the end of the buffer
+
+typedef struct {
+    uint8_t* buf;
+    uint32_t size;          // Power of two
+    uint32_t head;          // Free running write index, producer owned
+    uint32_t tail;          // Free running read index, consumer owned
+    uint32_t dropped;       // Frames rejected by push for lack of space, producer owned
+} kbus_ring_t;
+
+// size must be a power of two; storage must outlive the ring
+bool kbus_ring_init(kbus_ring_t* ring, uint8_t* storage, uint32_t size);
+
+// Producer side; returns false (and counts a drop) if the frame doesn't fit
+bool kbus_ring_push(kbus_ring_t* ring, const uint8_t* frame, uint16_t len);
+// Same, but the frame is gathered from a header and body without staging it first
+bool kbus_ring_push2(kbus_ring_t* ring, const uint8_t* hdr, uint16_t hdr_len, const uint8_t* body, uint16_t body_len);
+/**
+ ** Same, but filled in place: max_len contiguous bytes to write the frame into, NULL if they
+ ** don't fit right now (not counted as a drop). The ring has to be at least twice max_len
+ ** plus the prefix, or this always fails. Nothing is visible to the consumer until
+ ** kbus_ring_commit() publishes the first len <= max_len of them; not committing abandons it.
+ */
+uint8_t* kbus_ring_reserve(kbus_ring_t* ring, uint16_t max_len);
+void kbus_ring_commit(kbus_ring_t* ring, uint16_t len);
+
+// Consumer side; returns frame length, 0 if empty. Frames longer than max_len are dropped.
+uint16_t kbus_ring_pop(kbus_ring_t* ring, uint8_t* out, uint16_t max_len);
+// Same, but scattered straight into a header and body; frames shorter than hdr_len or with more
+// than body_max left after it are dropped. Returns hdr_len + body length.
+uint16_t kbus_ring_pop2(kbus_ring_t* ring, uint8_t* hdr, uint16_t hdr_len, uint8_t* body, uint16_t body_max);
+
+uint32_t kbus_ring_used(const kbus_ring_t* ring);
+uint32_t kbus_ring_free(const kbus_ring_t* ring);
+
+#endif //KBUS_RING_H
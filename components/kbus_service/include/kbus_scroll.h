@@ -0,0 +1,48 @@
+#ifndef KBUS_SCROLL_H
+#define KBUS_SCROLL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ ** Scroll frame renderer for fixed width displays. Text is split into frames once when it
+ ** changes; each frame starts on a word boundary and the sequence is cached as offsets into
+ ** the stored text. Stepping hands out the next frame only if it differs from the last one
+ ** handed out, so a static or single frame text is sent once instead of on every tick.
+ */
+#define KBUS_SCROLL_TEXT_MAX    256
+#define KBUS_SCROLL_WIDTH_MAX   32
+#define KBUS_SCROLL_MAX_FRAMES  48
+
+// Display widths, in characters
+#define KBUS_SCROLL_WIDTH_MID   11  // MID / TEL field
+#define KBUS_SCROLL_WIDTH_IKE   20  // IKE cluster text
+#define KBUS_SCROLL_WIDTH_SDRS  11  // Radio's SDRS text fields
+
+typedef struct {
+    char text[KBUS_SCROLL_TEXT_MAX];
+    char last[KBUS_SCROLL_WIDTH_MAX + 1];   // Last frame handed out, "" if none
+    uint16_t frame_off[KBUS_SCROLL_MAX_FRAMES];
+    uint8_t frame_len[KBUS_SCROLL_MAX_FRAMES];
+    uint8_t frame_count;
+    uint8_t next;
+    uint8_t width;
+} kbus_scroll_t;
+
+void kbus_scroll_init(kbus_scroll_t* scroll, uint8_t width);
+
+// Re-renders only if text differs from the current text; returns true if it did
+bool kbus_scroll_set_text(kbus_scroll_t* scroll, const char* text);
+
+// Advances to the next frame; copies it NUL terminated to out (width + 1 bytes) and returns
+// true only if it differs from the previous frame. Wraps around after the last frame.
+bool kbus_scroll_step(kbus_scroll_t* scroll, char* out);
+
+// Forget the last frame so the next step sends even if unchanged, e.g. after something else drew over the display
+void kbus_scroll_invalidate(kbus_scroll_t* scroll);
+
+static inline bool kbus_scroll_scrolls(const kbus_scroll_t* scroll) {
+    return scroll->frame_count > 1;
+}
+
+#endif //KBUS_SCROLL_H
@@ -1,5 +1,28 @@
 #ifndef KBUS_SERVICE_H
 #define KBUS_SERVICE_H
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "kbus_uart_driver.h"
+#include "kbus_filter.h"
+#include "kbus_pubsub.h"
+
 void init_kbus_service(QueueHandle_t bt_command_q, QueueHandle_t bt_track_info_q);
 void send_dev_ready(uint8_t source, uint8_t dest, bool startup);
+
+/**
+ ** Register a handler for every frame sent by / addressed to a device; shorthand for an inline
+ ** kbus_subscribe() with one pattern. Returns false when out of subscriptions.
+ ** Registering also opens the rx filter for the address; until something does, its frames are
+ ** dropped at ingest.
+ */
+bool kbus_register_src_handler(uint8_t src, kbus_handler_t handler);
+bool kbus_register_dst_handler(uint8_t dst, kbus_handler_t handler);
+
+// Same, but only frames carrying one of these commands; one pattern each
+bool kbus_register_dst_cmd_handler(uint8_t dst, const uint8_t* cmds, uint8_t ncmds, kbus_handler_t handler);
+void kbus_rx_filter_get_stats(kbus_filter_stats_t* stats);
+
+// Trace id of the frame being dispatched when called from a handler, SYS_TRACE_NO_ID anywhere else
+uint16_t kbus_trace_id();
 #endif //KBUS_SERVICE_H
@@ -0,0 +1,59 @@
+#ifndef KBUS_TABLES_H
+#define KBUS_TABLES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ ** Name, expected length and body layout lookups, generated with kbus_defines.h from
+ ** kbus_spec.json by `tools/kbus_spec.py gen`. Plain C with no esp-idf dependencies, so
+ ** tools/kbus_decode.c builds against the same tables on the host.
+ */
+typedef enum {
+    KBUS_FIELD_U8,
+    KBUS_FIELD_S8,
+    KBUS_FIELD_U16,     // Big-endian, as sent on the bus
+    KBUS_FIELD_TEXT,    // Rest of the body
+    KBUS_FIELD_HEX      // Rest of the body
+} kbus_field_type_t;
+
+typedef struct {
+    const char* name;
+    uint8_t type;       // kbus_field_type_t
+} kbus_field_t;
+
+typedef struct {
+    const char* name;           // NULL for commands missing from the spec
+    uint8_t min_len;            // Body length including the command byte
+    uint8_t max_len;            // 0xFF when open ended
+    uint8_t n_fields;
+    const kbus_field_t* fields; // In order after the command byte
+} kbus_cmd_info_t;
+
+extern const char* const kbus_dev_names[256];
+extern const kbus_cmd_info_t kbus_cmds[256];
+
+/**
+ ** NULL for an address the spec doesn't name
+ */
+static inline const char* kbus_dev_name(uint8_t addr) {
+    return kbus_dev_names[addr];
+}
+
+/**
+ ** NULL for a command the spec doesn't name
+ */
+static inline const char* kbus_cmd_name(uint8_t cmd) {
+    return kbus_cmds[cmd].name;
+}
+
+/**
+ ** False only for known commands whose body is outside the spec'd length
+ */
+static inline bool kbus_body_len_ok(const uint8_t* body, uint8_t body_len) {
+    if(body_len == 0) return false;
+    const kbus_cmd_info_t* info = &kbus_cmds[body[0]];
+    return info->name == NULL || (body_len >= info->min_len && body_len <= info->max_len);
+}
+
+#endif //KBUS_TABLES_H
@@ -0,0 +1,61 @@
+#ifndef KBUS_TX_SCHED_H
+#define KBUS_TX_SCHED_H
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "kbus_uart_driver.h"
+
+/**
+ ** K-bus TX scheduler. Producers submit without blocking; a single pump task hands the
+ ** most urgent frame to the driver whenever it can take one. Within a class frames go out
+ ** in submit order.
+ **
+ ** KBUS_TX_DISPLAY frames are also paced by a token bucket (CONFIG_KBUS_TX_DISPLAY_BUDGET
+ ** bytes/s) whose refill rate shrinks as the bus fills, going to zero at
+ ** CONFIG_KBUS_TX_PACE_UTIL_MAX percent. Utilization is estimated from the rx frames
+ ** reported through kbus_tx_note_rx().
+ */
+typedef enum {
+    KBUS_TX_REPLY = 0,  // Protocol replies to a poll/request
+    KBUS_TX_STATUS,     // Unsolicited status, device announcements
+    KBUS_TX_DISPLAY,    // Display/text updates
+    KBUS_TX_CLASSES
+} kbus_tx_class_t;
+
+#define KBUS_TX_SLOTS           16
+#define KBUS_TX_NO_DEADLINE     0
+#define KBUS_TX_NO_KEY          0
+
+// Default deadlines; a reply the poller has given up on, or stale text, is just bus load
+#define KBUS_TX_REPLY_DEADLINE_MS   500
+#define KBUS_TX_DISPLAY_DEADLINE_MS 2000
+
+// Supersede key; a newer unsent frame with the same key replaces the older one in place
+#define KBUS_TX_KEY(src, cmd, sub)  (0x01000000UL | ((uint32_t)(src) << 16) | ((uint32_t)(cmd) << 8) | (uint8_t)(sub))
+
+typedef struct {
+    uint32_t submitted;
+    uint32_t sent;
+    uint32_t superseded;        // Unsent frames replaced by a newer one with the same key
+    uint32_t dropped_expired;   // Deadline passed before the bus was free
+    uint32_t dropped_full;      // No slot, and nothing less urgent to evict
+    uint32_t evicted;           // Less urgent frames pushed out by a more urgent one
+    uint32_t deferred;          // Display frames held back at least once for lack of budget
+    uint8_t pending;
+    uint8_t pending_max;
+    uint8_t bus_util;           // Smoothed bus utilization, percent
+    uint8_t display_rate;       // Current display budget, bytes/s
+} kbus_tx_stats_t;
+
+void kbus_tx_sched_init(QueueHandle_t driver_tx_queue);
+
+// deadline_ms counts from submit; KBUS_TX_NO_DEADLINE keeps the frame until sent. A frame still
+// pending under the same supersede_key is replaced in place, keeping its place in line and the more
+// urgent of the two classes and deadlines
+bool kbus_tx_submit(const kbus_message_t* message, kbus_tx_class_t tx_class, uint32_t deadline_ms, uint32_t supersede_key);
+void kbus_tx_get_stats(kbus_tx_stats_t* stats);
+
+// Feed the utilization estimate; call for every frame seen on the bus
+void kbus_tx_note_rx(uint8_t body_len);
+
+#endif //KBUS_TX_SCHED_H
@@ -0,0 +1,34 @@
+#ifndef KBUS_VIRTUAL_BUS_H
+#define KBUS_VIRTUAL_BUS_H
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "kbus_uart_driver.h"
+#include "kbus_filter.h"
+
+/**
+ ** In-memory stand in for kbus_uart_driver, enabled with CONFIG_KBUS_VIRTUAL_BUS.
+ ** Same queue contract as init_kbus_uart_driver(): frames are pushed to rx_queue as they
+ ** "arrive" and pulled from tx_queue to be "sent". Injected frames rx_filter turns away
+ ** never reach rx_queue, same as on the wire.
+ */
+typedef void (*kbus_vbus_tx_hook_t)(const kbus_message_t* message);
+
+typedef struct {
+    uint32_t rx_frames;     // Injected frames accepted into rx_queue
+    uint32_t rx_filtered;   // Injected frames rx_filter dropped before rx_queue
+    uint32_t rx_dropped;    // Injected frames rejected, rx_queue full
+    uint32_t tx_frames;     // Frames taken off tx_queue
+    uint32_t tx_bytes;      // Wire bytes those frames would have used
+} kbus_vbus_stats_t;
+
+void init_kbus_virtual_bus(QueueHandle_t rx_queue, QueueHandle_t tx_queue, kbus_filter_t* rx_filter);
+
+// Put a frame on the virtual wire as if another module sent it
+bool kbus_virtual_bus_inject(const kbus_message_t* message, TickType_t ticks_to_wait);
+
+// Called from the virtual bus tx task for every frame the stack sends; NULL to clear
+void kbus_virtual_bus_set_tx_hook(kbus_vbus_tx_hook_t hook);
+void kbus_virtual_bus_get_stats(kbus_vbus_stats_t* stats);
+
+#endif //KBUS_VIRTUAL_BUS_H
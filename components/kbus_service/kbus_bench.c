@@ -0,0 +1,145 @@
+// C stdlib includes
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+// FreeRTOS includes
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+// esp-idf includes
+#include "esp_log.h"
+#include "esp_system.h"
+
+// component includes
+#include "kbus_bench.h"
+#include "kbus_defines.h"
+#include "kbus_virtual_bus.h"
+#include "bt_common.h"
+#include "sdrs_emulator.h"
+#include "sys_bench.h"
+#include "sys_monitor.h"
+#include "sys_topology.h"
+
+#define SECONDS(sec) ((sec*1000) / portTICK_RATE_MS)
+#define BENCH_SETTLE_SEC    5       // Let emus_init and the startup announcements finish first
+#define BENCH_TIMEOUT_MS    500     // A press not sent by then counts as lost
+#define BENCH_GAP_MIN_MS    20      // Random gap between frames, so they don't lock step with the load
+#define BENCH_GAP_SPAN_MS   50
+#define BENCH_TITLES        8       // Rotating now-playing titles; well under META_ARENA_ENTRIES
+
+// MFL_BUTTON codes for search up; see kbus_mfl.c
+#define MFL_UP_LONG         0x11
+#define MFL_UP_RELEASE      0x21
+
+static const char* TAG = "kbus_bench";
+static QueueHandle_t info_queue;
+static volatile bool loading = false;
+
+// Background bus traffic: a radio polling SDRS, handled but idle ignition status, and a
+// speed broadcast nobody subscribes to, which the rx filter drops
+static const kbus_message_t bus_load[] = {
+    {.src = RAD, .dst = SDRS, .body = {SDRS_CTRL_REQ, SDRS_HEARTBEAT, 0x00}, .body_len = 3},
+    {.src = IKE, .dst = GLO,  .body = {IGN_STAT_RPLY, 0x01}, .body_len = 2},
+    {.src = IKE, .dst = GLO,  .body = {SPEED_RPM_REQ, 0x20, 0x1E}, .body_len = 3},
+};
+
+static void bench_task();
+static void run_phase(const char* phase);
+static void press(uint8_t code);
+static void bus_load_task();
+static void bt_load_task();
+
+void kbus_bench_start(QueueHandle_t bt_info_queue) {
+    info_queue = bt_info_queue;
+
+    int tsk_ret = SYS_TASK_SPAWN(BENCH, bench_task, NULL);
+    if(tsk_ret != pdPASS){ ESP_LOGE(TAG, "kbus_bench creation failed with: %d", tsk_ret);}
+}
+
+static void bench_task() {
+    vTaskDelay(SECONDS(BENCH_SETTLE_SEC));
+    ESP_LOGI(TAG, "Topology %s, %d presses per phase", sys_topology_name(), CONFIG_KBUS_BENCH_PRESSES);
+
+    run_phase("idle");
+
+    loading = true;
+    int tsk_ret = SYS_TASK_SPAWN(BENCH_BUS, bus_load_task, NULL);
+    if(tsk_ret != pdPASS){ ESP_LOGE(TAG, "bench_bus creation failed with: %d", tsk_ret);}
+    tsk_ret = SYS_TASK_SPAWN(BENCH_BT, bt_load_task, NULL);
+    if(tsk_ret != pdPASS){ ESP_LOGE(TAG, "bench_bt creation failed with: %d", tsk_ret);}
+    vTaskDelay(SECONDS(1));     // Let the load reach steady state
+
+    run_phase("loaded");
+    loading = false;
+
+    ESP_LOGI(TAG, "Done");
+    sys_monitor_task_exit();
+}
+
+// Each press is two samples: hold (FF start) and release (FF stop)
+static void run_phase(const char* phase) {
+    sys_bench_reset();
+    for(int i = 0; i < CONFIG_KBUS_BENCH_PRESSES; i++) {
+        press(MFL_UP_LONG);
+        press(MFL_UP_RELEASE);
+    }
+    sys_bench_report(phase);
+}
+
+static void press(uint8_t code) {
+    kbus_message_t frame = {
+        .src = MFL,
+        .dst = RAD,
+        .body = {MFL_BUTTON, code},
+        .body_len = 2
+    };
+
+    vTaskDelay((BENCH_GAP_MIN_MS + esp_random() % BENCH_GAP_SPAN_MS) / portTICK_PERIOD_MS);
+    sys_bench_begin();
+    kbus_virtual_bus_inject(&frame, 0);    // Not queued is the same as lost
+    sys_bench_wait(BENCH_TIMEOUT_MS / portTICK_PERIOD_MS);
+}
+
+// Paced by tick; owed frames accumulate so rates above the tick rate come out as bursts
+static void bus_load_task() {
+    TickType_t last_wake = xTaskGetTickCount();
+    uint32_t owed = 0;
+    uint8_t next = 0;
+
+    while(loading) {
+        vTaskDelayUntil(&last_wake, 1);
+        owed += CONFIG_KBUS_BENCH_BUS_LOAD;
+        while(owed >= configTICK_RATE_HZ) {
+            owed -= configTICK_RATE_HZ;
+            kbus_virtual_bus_inject(&bus_load[next], 0);
+            next = (next + 1) % (sizeof(bus_load) / sizeof(bus_load[0]));
+        }
+    }
+    sys_monitor_task_exit();
+}
+
+// Now-playing churn like a phone skipping tracks: interning, transcoding, display publishing
+static void bt_load_task() {
+    bt_now_playing_info_t info;
+    char title[48];
+    uint32_t n = 0;
+    int len;
+
+    while(loading) {
+        vTaskDelay(SECONDS(1) / CONFIG_KBUS_BENCH_BT_LOAD);
+        len = snprintf(title, sizeof(title), "Benchmark Track %u - Extended Mix", (unsigned)(n++ % BENCH_TITLES));
+
+        memset(&info, 0, sizeof(info));
+        info.track_title = meta_intern(title, len);
+        info.artist_name = meta_intern("Benchmark Artist", strlen("Benchmark Artist"));
+        info.total_tracks = BENCH_TITLES;
+        info.cur_track = n % BENCH_TITLES;
+        if(xQueueSend(info_queue, &info, 0) != pdTRUE) {
+            meta_release(info.track_title);
+            meta_release(info.artist_name);
+        }
+    }
+    sys_monitor_task_exit();
+}
@@ -0,0 +1,296 @@
+// C stdlib includes
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+// FreeRTOS includes
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+// esp-idf includes
+#include "esp_log.h"
+#include "esp_timer.h"
+
+// component includes
+#include "kbus_capture.h"
+#include "kbus_ring.h"
+#include "sys_topology.h"
+
+#define SECONDS(sec) ((sec*1000) / portTICK_RATE_MS)
+#define INFLIGHT_RING_SIZE 512  // Inject timestamps waiting on dispatch, 10 bytes each
+#define LAT_BUCKETS 20          // log2 buckets, 1us .. ~0.5s
+
+typedef struct {
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint32_t samples;
+    uint32_t buckets[LAT_BUCKETS];
+} latency_acc_t;
+
+static const char* TAG = "kbus_capture";
+static QueueHandle_t kbus_rx_queue;
+
+// Recording
+static uint8_t capture_buf[CONFIG_KBUS_CAPTURE_BUF_SIZE];
+static size_t capture_len = 0;
+static int64_t capture_last_us = 0;
+static bool capturing = false;
+static portMUX_TYPE capture_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// Replay
+static const uint8_t* replay_data;
+static size_t replay_len;
+static uint16_t replay_speed;
+static volatile bool replaying = false;
+static uint32_t replay_frames;
+static int64_t replay_first_us, replay_last_done_us;
+static uint8_t inflight_storage[INFLIGHT_RING_SIZE];
+static kbus_ring_t inflight;    // replay task -> dispatch task
+static int64_t cur_inject_us = -1;
+static bool cur_output_seen;
+static latency_acc_t frame_lat, output_lat;
+
+static void replay_task();
+#if CONFIG_KBUS_CAPTURE_DUMP_SEC > 0
+static void dump_task();
+#endif
+
+static inline uint32_t rd32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+static inline void wr32(uint8_t* p, uint32_t v) { p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24; }
+
+void kbus_capture_init(QueueHandle_t rx_queue) {
+    kbus_rx_queue = rx_queue;
+    kbus_ring_init(&inflight, inflight_storage, sizeof(inflight_storage));
+
+#if CONFIG_KBUS_CAPTURE_DUMP_SEC > 0
+    kbus_capture_start();
+    int tsk_ret = SYS_TASK_SPAWN(KBUS_CAPTURE, dump_task, NULL);
+    if(tsk_ret != pdPASS){ ESP_LOGE(TAG, "kbus_capture creation failed with: %d", tsk_ret);}
+#endif
+}
+
+bool kbus_capture_start() {
+    portENTER_CRITICAL(&capture_mux);
+    memcpy(capture_buf, KBUS_CAPTURE_MAGIC, 4);
+    capture_buf[4] = KBUS_CAPTURE_VERSION;
+    capture_buf[5] = capture_buf[6] = capture_buf[7] = 0;
+    capture_len = KBUS_CAPTURE_HDR_LEN;
+    capture_last_us = esp_timer_get_time();
+    capturing = true;
+    portEXIT_CRITICAL(&capture_mux);
+
+    ESP_LOGI(TAG, "Capture started, %d bytes available", CONFIG_KBUS_CAPTURE_BUF_SIZE);
+    return true;
+}
+
+void kbus_capture_stop() {
+    capturing = false;
+    ESP_LOGI(TAG, "Capture stopped, %d bytes", (int)capture_len);
+}
+
+void kbus_capture_record(const kbus_message_t* message) {
+    int64_t now;
+    uint8_t* rec;
+
+    if(!capturing) return;
+
+    now = esp_timer_get_time();
+    portENTER_CRITICAL(&capture_mux);
+    if(capture_len + KBUS_CAPTURE_REC_HDR_LEN + message->body_len > sizeof(capture_buf)) {
+        capturing = false;  // Full; keep what we have rather than wrap
+        portEXIT_CRITICAL(&capture_mux);
+        ESP_LOGW(TAG, "Capture buffer full, stopped");
+        return;
+    }
+    rec = &capture_buf[capture_len];
+    wr32(rec, (uint32_t)(now - capture_last_us));
+    rec[4] = message->src;
+    rec[5] = message->dst;
+    rec[6] = message->body_len;
+    memcpy(&rec[KBUS_CAPTURE_REC_HDR_LEN], message->body, message->body_len);
+    capture_len += KBUS_CAPTURE_REC_HDR_LEN + message->body_len;
+    capture_last_us = now;
+    portEXIT_CRITICAL(&capture_mux);
+}
+
+size_t kbus_capture_get(const uint8_t** data) {
+    *data = capture_buf;
+    return capture_len;
+}
+
+void kbus_capture_dump() {
+    size_t len;
+
+    // Records only ever go past the end, so everything up to here holds still while it prints
+    portENTER_CRITICAL(&capture_mux);
+    len = capture_len;
+    portEXIT_CRITICAL(&capture_mux);
+
+    printf("KBC-BEGIN %d\n", (int)len);
+    for(size_t i = 0; i < len; i++) {
+        printf("%02x%s", capture_buf[i], ((i % 32) == 31 || i == len - 1) ? "\n" : "");
+    }
+    printf("KBC-END\n");
+}
+
+#if CONFIG_KBUS_CAPTURE_DUMP_SEC > 0
+static void dump_task() {
+    while(1) {
+        vTaskDelay(SECONDS(CONFIG_KBUS_CAPTURE_DUMP_SEC));
+        kbus_capture_dump();
+        if(!capturing) kbus_capture_start();   // Full, so that was its last block
+    }
+    vTaskDelete(NULL); // In case we leave the loop, to avoid a panic
+}
+#endif
+
+static void latency_add(latency_acc_t* acc, uint32_t us) {
+    uint8_t bucket = 0;
+
+    if(acc->samples == 0 || us < acc->min_us) acc->min_us = us;
+    if(us > acc->max_us) acc->max_us = us;
+    acc->sum_us += us;
+    acc->samples++;
+
+    while(bucket < LAT_BUCKETS - 1 && us >= (2UL << bucket)) bucket++;
+    acc->buckets[bucket]++;
+}
+
+static uint32_t latency_percentile(const latency_acc_t* acc, uint8_t pct) {
+    uint32_t target = (acc->samples * pct + 99) / 100;
+    uint32_t seen = 0;
+
+    for(uint8_t i = 0; i < LAT_BUCKETS; i++) {
+        seen += acc->buckets[i];
+        if(seen >= target) return (2UL << i) - 1;
+    }
+    return acc->max_us;
+}
+
+static void latency_report(const latency_acc_t* acc, kbus_latency_stats_t* stats) {
+    stats->samples = acc->samples;
+    stats->min_us = acc->min_us;
+    stats->max_us = acc->max_us;
+    stats->avg_us = acc->samples ? (uint32_t)(acc->sum_us / acc->samples) : 0;
+    stats->p50_us = acc->samples ? latency_percentile(acc, 50) : 0;
+    stats->p99_us = acc->samples ? latency_percentile(acc, 99) : 0;
+}
+
+bool kbus_replay_start(const uint8_t* capture, size_t len, uint16_t speed) {
+    if(replaying) return false;
+    if(len < KBUS_CAPTURE_HDR_LEN || memcmp(capture, KBUS_CAPTURE_MAGIC, 4) != 0 || capture[4] != KBUS_CAPTURE_VERSION) {
+        ESP_LOGE(TAG, "Not a v%d capture", KBUS_CAPTURE_VERSION);
+        return false;
+    }
+
+    replay_data = capture;
+    replay_len = len;
+    replay_speed = speed;
+    replay_frames = 0;
+    replay_last_done_us = 0;
+    memset(&frame_lat, 0, sizeof(frame_lat));
+    memset(&output_lat, 0, sizeof(output_lat));
+    replaying = true;
+
+    // Heap backed, not SYS_TASK_SPAWN; a replay task is created again for every replay
+    int tsk_ret = xTaskCreatePinnedToCore(replay_task, sys_topology[SYS_TASK_KBUS_REPLAY].name, SYS_TASK_STACK_KBUS_REPLAY,
+                                          NULL, SYS_TASK_PRIO_KBUS_REPLAY, NULL, SYS_TASK_CORE_KBUS_REPLAY);
+    if(tsk_ret != pdPASS){
+        ESP_LOGE(TAG, "kbus_replay creation failed with: %d", tsk_ret);
+        replaying = false;
+        return false;
+    }
+    return true;
+}
+
+bool kbus_replay_running() {
+    return replaying;
+}
+
+static void replay_task() {
+    size_t pos = KBUS_CAPTURE_HDR_LEN;
+    uint64_t capture_t_us = 0;
+    int64_t start_us, now_us, due_us;
+    kbus_message_t message;
+    kbus_replay_report_t report;
+
+    start_us = replay_first_us = esp_timer_get_time();
+
+    while(pos + KBUS_CAPTURE_REC_HDR_LEN <= replay_len) {
+        const uint8_t* rec = &replay_data[pos];
+
+        capture_t_us += rd32(rec);
+        message.src = rec[4];
+        message.dst = rec[5];
+        message.body_len = rec[6];
+        if(message.body_len > sizeof(message.body) || pos + KBUS_CAPTURE_REC_HDR_LEN + message.body_len > replay_len) {
+            ESP_LOGE(TAG, "Truncated or oversized record at offset %d", (int)pos);
+            break;
+        }
+        memcpy(message.body, &rec[KBUS_CAPTURE_REC_HDR_LEN], message.body_len);
+        pos += KBUS_CAPTURE_REC_HDR_LEN + message.body_len;
+
+        if(replay_speed != KBUS_REPLAY_MAX_SPEED) {
+            due_us = start_us + (int64_t)(capture_t_us / replay_speed);
+            now_us = esp_timer_get_time();
+            if(due_us - now_us >= 1000) vTaskDelay((due_us - now_us) / 1000 / portTICK_PERIOD_MS);
+        }
+
+        // Stamp before the send so the queue wait counts toward latency
+        now_us = esp_timer_get_time();
+        while(!kbus_ring_push(&inflight, (const uint8_t*)&now_us, sizeof(now_us))) vTaskDelay(1);
+        xQueueSend(kbus_rx_queue, &message, (portTickType)portMAX_DELAY);
+        replay_frames++;
+    }
+
+    // Let dispatch drain what's in flight
+    while(kbus_ring_used(&inflight)) vTaskDelay(1);
+    replaying = false;
+
+    kbus_replay_get_report(&report);
+    ESP_LOGI(TAG, "Replay done: %"PRIu32" frames in %"PRIu32" us, %"PRIu32" frames/s",
+                report.frames, report.elapsed_us, report.frames_per_sec);
+    ESP_LOGI(TAG, "Frame latency us: min %"PRIu32" avg %"PRIu32" p50 %"PRIu32" p99 %"PRIu32" max %"PRIu32,
+                report.frame.min_us, report.frame.avg_us, report.frame.p50_us, report.frame.p99_us, report.frame.max_us);
+    ESP_LOGI(TAG, "Output latency us (%"PRIu32" outputs): min %"PRIu32" avg %"PRIu32" p50 %"PRIu32" p99 %"PRIu32" max %"PRIu32,
+                report.output.samples, report.output.min_us, report.output.avg_us, report.output.p50_us, report.output.p99_us, report.output.max_us);
+
+    vTaskDelete(NULL);
+}
+
+void kbus_replay_get_report(kbus_replay_report_t* report) {
+    report->frames = replay_frames;
+    report->elapsed_us = (replay_last_done_us > replay_first_us) ? (uint32_t)(replay_last_done_us - replay_first_us) : 0;
+    report->frames_per_sec = report->elapsed_us ? (uint32_t)((uint64_t)replay_frames * 1000000 / report->elapsed_us) : 0;
+    latency_report(&frame_lat, &report->frame);
+    latency_report(&output_lat, &report->output);
+}
+
+void kbus_replay_frame_begin() {
+    int64_t inject_us;
+
+    cur_inject_us = -1;
+    if(kbus_ring_pop(&inflight, (uint8_t*)&inject_us, sizeof(inject_us)) == sizeof(inject_us)) {
+        cur_inject_us = inject_us;
+        cur_output_seen = false;
+    }
+}
+
+void kbus_replay_frame_done() {
+    if(cur_inject_us < 0) return;
+
+    replay_last_done_us = esp_timer_get_time();
+    latency_add(&frame_lat, (uint32_t)(replay_last_done_us - cur_inject_us));
+    cur_inject_us = -1;
+}
+
+void kbus_replay_note_output() {
+    // First output per frame only; that's the one a user would notice
+    if(cur_inject_us < 0 || cur_output_seen) return;
+
+    cur_output_seen = true;
+    latency_add(&output_lat, (uint32_t)(esp_timer_get_time() - cur_inject_us));
+}
@@ -0,0 +1,153 @@
+// C stdlib includes
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// component includes
+#include "kbus_charset.h"
+
+#define LATIN_FIRST 0x00A0
+#define LATIN_LAST  0x017F
+
+// U+00A0..U+017F, Latin-1 Supplement && Latin Extended-A
+static const char* const latin_translit[LATIN_LAST - LATIN_FIRST + 1] = {
+    /* U+00A0 */ " ", "!", "c", "L", "?", "Y", "|", "S",
+    /* U+00A8 */ "\"", "(C)", "a", "<<", "-", "-", "(R)", "-",
+    /* U+00B0 */ "o", "+-", "2", "3", "'", "u", "P", ".",
+    /* U+00B8 */ ",", "1", "o", ">>", "1/4", "1/2", "3/4", "?",
+    /* U+00C0 */ "A", "A", "A", "A", "Ae", "A", "AE", "C",
+    /* U+00C8 */ "E", "E", "E", "E", "I", "I", "I", "I",
+    /* U+00D0 */ "D", "N", "O", "O", "O", "O", "Oe", "x",
+    /* U+00D8 */ "O", "U", "U", "U", "Ue", "Y", "Th", "ss",
+    /* U+00E0 */ "a", "a", "a", "a", "ae", "a", "ae", "c",
+    /* U+00E8 */ "e", "e", "e", "e", "i", "i", "i", "i",
+    /* U+00F0 */ "d", "n", "o", "o", "o", "o", "oe", "/",
+    /* U+00F8 */ "o", "u", "u", "u", "ue", "y", "th", "y",
+    /* U+0100 */ "A", "a", "A", "a", "A", "a", "C", "c",
+    /* U+0108 */ "C", "c", "C", "c", "C", "c", "D", "d",
+    /* U+0110 */ "D", "d", "E", "e", "E", "e", "E", "e",
+    /* U+0118 */ "E", "e", "E", "e", "G", "g", "G", "g",
+    /* U+0120 */ "G", "g", "G", "g", "H", "h", "H", "h",
+    /* U+0128 */ "I", "i", "I", "i", "I", "i", "I", "i",
+    /* U+0130 */ "I", "i", "IJ", "ij", "J", "j", "K", "k",
+    /* U+0138 */ "k", "L", "l", "L", "l", "L", "l", "L",
+    /* U+0140 */ "l", "L", "l", "N", "n", "N", "n", "N",
+    /* U+0148 */ "n", "n", "N", "n", "O", "o", "O", "o",
+    /* U+0150 */ "O", "o", "OE", "oe", "R", "r", "R", "r",
+    /* U+0158 */ "R", "r", "S", "s", "S", "s", "S", "s",
+    /* U+0160 */ "S", "s", "T", "t", "T", "t", "T", "t",
+    /* U+0168 */ "U", "u", "U", "u", "U", "u", "U", "u",
+    /* U+0170 */ "U", "u", "U", "u", "W", "w", "Y", "y",
+    /* U+0178 */ "Y", "Z", "z", "Z", "z", "Z", "z", "s",
+};
+
+#ifdef CONFIG_KBUS_CHARSET_UMLAUTS
+// Shown natively at their ISO 8859-1 positions
+static const uint8_t native_glyphs[] = {0xB0, 0xC4, 0xD6, 0xDC, 0xDF, 0xE4, 0xF6, 0xFC};
+#endif
+
+// Typographic punctuation phones like to send; sorted for bsearch
+static const struct {
+    uint16_t cp;
+    const char* text;
+} punct_translit[] = {
+    {0x2010, "-"}, {0x2011, "-"}, {0x2012, "-"}, {0x2013, "-"}, {0x2014, "-"}, {0x2015, "-"},
+    {0x2018, "'"}, {0x2019, "'"}, {0x201A, ","}, {0x201B, "'"},
+    {0x201C, "\""}, {0x201D, "\""}, {0x201E, "\""}, {0x201F, "\""},
+    {0x2022, "*"}, {0x2026, "..."}, {0x2032, "'"}, {0x2033, "\""}, {0x2039, "<"}, {0x203A, ">"},
+    {0x20AC, "EUR"}, {0x2122, "TM"}, {0x2212, "-"},
+};
+#define PUNCT_COUNT (sizeof(punct_translit) / sizeof(punct_translit[0]))
+
+static const char* lookup(uint32_t cp, char* single) {
+    (void)single;   // Only for native glyphs
+    if(cp >= LATIN_FIRST && cp <= LATIN_LAST) {
+#ifdef CONFIG_KBUS_CHARSET_UMLAUTS
+        for(size_t i = 0; i < sizeof(native_glyphs); i++) {
+            if(native_glyphs[i] == cp) {
+                single[0] = (char)cp;
+                return single;
+            }
+        }
+#endif
+        return latin_translit[cp - LATIN_FIRST];
+    }
+    if(cp >= 0x0300 && cp <= 0x036F) return "";    // Combining marks; base letter was already sent
+
+    for(size_t lo = 0, hi = PUNCT_COUNT; lo < hi;) {
+        size_t mid = (lo + hi) / 2;
+        if(punct_translit[mid].cp == cp) return punct_translit[mid].text;
+        if(punct_translit[mid].cp < cp) lo = mid + 1;
+        else hi = mid;
+    }
+    return "?";
+}
+
+// Decodes one code point; returns bytes consumed, 0 if malformed
+static size_t decode(const uint8_t* in, size_t len, uint32_t* cp) {
+    size_t need;
+    uint32_t min;
+
+    if(in[0] < 0xC2) return 0;  // Stray continuation byte or overlong 2 byte lead
+    if(in[0] < 0xE0)      { need = 2; min = 0x80;    *cp = in[0] & 0x1F; }
+    else if(in[0] < 0xF0) { need = 3; min = 0x800;   *cp = in[0] & 0x0F; }
+    else if(in[0] < 0xF5) { need = 4; min = 0x10000; *cp = in[0] & 0x07; }
+    else return 0;
+
+    if(need > len) return 0;
+    for(size_t i = 1; i < need; i++) {
+        if((in[i] & 0xC0) != 0x80) return 0;
+        *cp = (*cp << 6) | (in[i] & 0x3F);
+    }
+    if(*cp < min || *cp > 0x10FFFF || (*cp >= 0xD800 && *cp <= 0xDFFF)) return 0;
+    return need;
+}
+
+size_t kbus_charset_from_utf8(const char* in, size_t in_len, char* out, size_t out_size) {
+    const uint8_t* src = (const uint8_t*)in;
+    size_t pos = 0, used = 0, step;
+    uint32_t word, cp;
+    const char* text;
+    char single[2] = {0, 0};
+
+    if(out_size == 0) return 0;
+    out_size--;     // Room for the NUL
+
+    while(pos < in_len && used < out_size) {
+        // Fast path, four plain ASCII bytes at a time; most titles never leave it
+        if(in_len - pos >= 4 && out_size - used >= 4) {
+            memcpy(&word, &src[pos], 4);
+            // No byte with the top bit set, and no byte below 0x20 (control characters)
+            if(!(word & 0x80808080UL) && !((word - 0x20202020UL) & ~word & 0x80808080UL)) {
+                memcpy(&out[used], &src[pos], 4);
+                pos += 4;
+                used += 4;
+                continue;
+            }
+        }
+
+        if(src[pos] < 0x80) {
+            out[used++] = src[pos] < 0x20 ? ' ' : (char)src[pos];
+            pos++;
+            continue;
+        }
+
+        step = decode(&src[pos], in_len - pos, &cp);
+        if(step == 0) {
+            text = "?";
+            step = 1;
+        } else {
+            text = lookup(cp, single);
+        }
+
+        // Whole transliterations only; stop rather than show half of one
+        size_t text_len = strlen(text);
+        if(used + text_len > out_size) break;
+        memcpy(&out[used], text, text_len);
+        used += text_len;
+        pos += step;
+    }
+
+    out[used] = '\0';
+    return used;
+}
@@ -0,0 +1,86 @@
+// C stdlib includes
+#include <stddef.h>
+#include <string.h>
+
+// FreeRTOS includes
+#include "freertos/FreeRTOS.h"
+
+// esp-idf includes
+#include "esp_log.h"
+
+// component includes
+#include "kbus_filter.h"
+#include "kbus_tx_sched.h"
+
+static const char* TAG = "kbus_filter";
+static portMUX_TYPE filter_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static bool add_addr(kbus_filter_t* filter, uint32_t* bitmap, uint8_t* addr_cmds, uint8_t addr,
+                     const uint8_t* cmds, uint8_t ncmds);
+
+void kbus_filter_init(kbus_filter_t* filter, bool pass_all) {
+    memset(filter, 0, sizeof(kbus_filter_t));
+    filter->pass_all = pass_all;
+}
+
+bool kbus_filter_add_src(kbus_filter_t* filter, uint8_t src, const uint8_t* cmds, uint8_t ncmds) {
+    return add_addr(filter, filter->src, filter->src_cmds, src, cmds, ncmds);
+}
+
+bool kbus_filter_add_dst(kbus_filter_t* filter, uint8_t dst, const uint8_t* cmds, uint8_t ncmds) {
+    return add_addr(filter, filter->dst, filter->dst_cmds, dst, cmds, ncmds);
+}
+
+void kbus_filter_pass_all(kbus_filter_t* filter) {
+    filter->pass_all = true;
+}
+
+static bool add_addr(kbus_filter_t* filter, uint32_t* bitmap, uint8_t* addr_cmds, uint8_t addr,
+                     const uint8_t* cmds, uint8_t ncmds) {
+    bool ok = true;
+    uint8_t mask;
+
+    portENTER_CRITICAL(&filter_mux);
+    mask = addr_cmds[addr];
+    if(ncmds == 0) {
+        addr_cmds[addr] = 0;
+    } else if(mask != 0 || !kbus_filter_bit(bitmap, addr)) {   // Listed with any command stays that way
+        if(mask == 0 && filter->cmd_masks_used < KBUS_FILTER_CMD_MASKS) {
+            mask = ++filter->cmd_masks_used;
+        }
+        if(mask != 0) {
+            for(uint8_t i = 0; i < ncmds; i++) {
+                filter->cmd_masks[mask - 1][cmds[i] >> 5] |= 1UL << (cmds[i] & 0x1F);
+            }
+        } else {
+            ok = false;
+        }
+        addr_cmds[addr] = mask;
+    }
+    // Mask first; the address bit is what makes it reachable for the lock free matcher
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    bitmap[addr >> 5] |= 1UL << (addr & 0x1F);
+    portEXIT_CRITICAL(&filter_mux);
+
+    if(!ok) ESP_LOGW(TAG, "Out of command masks, 0x%02x passes any command", addr);
+    return ok;
+}
+
+bool kbus_filter_admit(kbus_filter_t* filter, const kbus_message_t* message) {
+    uint8_t cmd = message->body_len ? message->body[0] : 0;
+
+    if(kbus_filter_match(filter, message->src, message->dst, cmd)) {
+        __atomic_fetch_add(&filter->passed, 1, __ATOMIC_RELAXED);
+        return true;
+    }
+    __atomic_fetch_add(&filter->dropped, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&filter->dropped_bytes, message->body_len, __ATOMIC_RELAXED);
+    kbus_tx_note_rx(message->body_len);     // Never gets to kbus_rx_task, but it did load the bus
+    return false;
+}
+
+void kbus_filter_get_stats(const kbus_filter_t* filter, kbus_filter_stats_t* stats) {
+    stats->passed = filter->passed;
+    stats->dropped = filter->dropped;
+    stats->dropped_bytes = filter->dropped_bytes;
+}
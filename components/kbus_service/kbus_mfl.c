@@ -0,0 +1,245 @@
+// C stdlib includes
+#include <stddef.h>
+#include <string.h>
+
+// FreeRTOS includes
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// esp-idf includes
+#include "esp_log.h"
+
+// component includes
+#include "kbus_mfl.h"
+#include "kbus_defines.h"
+#define DLOG_LEVEL CONFIG_SYS_DLOG_LEVEL_KBUS
+#include "sys_dlog.h"
+
+/**
+ ** MFL_BUTTON (0x3B) frames carry the button in the low/high bits and the phase in bits 4-5:
+ ** 0x01 search up, 0x08 search down, 0x40 R/T, 0x80 Send/End (voice)
+ ** +0x00 pressed, +0x10 pressed long (repeats while held), +0x20 released
+ ** VOLUME_CTRL (0x32) frames are single clicks: 0x10 down, 0x11 up
+ */
+#define MFL_PHASE_MASK      0x30
+#define MFL_PHASE_PRESS     0x00
+#define MFL_PHASE_LONG      0x10
+#define MFL_PHASE_RELEASE   0x20
+
+typedef enum {
+    MFL_BTN_UP = 0,
+    MFL_BTN_DOWN,
+    MFL_BTN_RT,
+    MFL_BTN_VOICE,
+    MFL_BTN_VOL_UP,
+    MFL_BTN_VOL_DN,
+    MFL_BTN_COUNT
+} mfl_button_t;
+
+typedef enum {
+    MFL_EV_PRESS = 0,
+    MFL_EV_LONG,
+    MFL_EV_RELEASE,
+    MFL_EV_TIMEOUT,
+    MFL_EV_COUNT
+} mfl_event_t;
+
+typedef enum {
+    MFL_ST_IDLE = 0,
+    MFL_ST_PRESSED,
+    MFL_ST_HELD,
+    MFL_ST_TAP_WAIT,        // Released once, waiting to see if a second press follows
+    MFL_ST_PRESSED_AGAIN,
+    MFL_ST_COUNT
+} mfl_state_t;
+
+typedef enum {
+    MFL_ACT_NONE = 0,
+    MFL_ACT_TAP,            // Short press completed; deferred to TAP_WAIT if the button has a double action
+    MFL_ACT_TAP_NOW,        // Short press, no more waiting
+    MFL_ACT_HOLD_START,
+    MFL_ACT_HOLD_END,
+    MFL_ACT_DOUBLE
+} mfl_action_t;
+
+typedef struct {
+    uint8_t next;
+    uint8_t action;
+} mfl_transition_t;
+
+#define T(st, act) {MFL_ST_##st, MFL_ACT_##act}
+static const mfl_transition_t transitions[MFL_ST_COUNT][MFL_EV_COUNT] = {
+    //                       PRESS                   LONG                        RELEASE                 TIMEOUT
+    [MFL_ST_IDLE]          = {T(PRESSED, NONE),       T(HELD, HOLD_START),        T(IDLE, NONE),          T(IDLE, NONE)},
+    [MFL_ST_PRESSED]       = {T(PRESSED, NONE),       T(HELD, HOLD_START),        T(TAP_WAIT, TAP),       T(HELD, HOLD_START)},
+    [MFL_ST_HELD]          = {T(HELD, NONE),          T(HELD, NONE),              T(IDLE, HOLD_END),      T(HELD, NONE)},
+    [MFL_ST_TAP_WAIT]      = {T(PRESSED_AGAIN, NONE), T(HELD, HOLD_START),        T(TAP_WAIT, NONE),      T(IDLE, TAP_NOW)},
+    [MFL_ST_PRESSED_AGAIN] = {T(PRESSED_AGAIN, NONE), T(HELD, HOLD_START),        T(IDLE, DOUBLE),        T(HELD, HOLD_START)},
+};
+#undef T
+
+// What each button does; BT_CMD_NOOP leaves the action unmapped
+typedef struct {
+    uint8_t tap;
+    uint8_t hold_start;
+    uint8_t hold_end;
+    uint8_t double_tap;
+} mfl_button_map_t;
+
+static const mfl_button_map_t button_map[MFL_BTN_COUNT] = {
+    [MFL_BTN_UP]     = {AVRCP_NEXT, AVRCP_FF_START,  AVRCP_FF_STOP,  BT_CMD_NOOP},
+    [MFL_BTN_DOWN]   = {AVRCP_PREV, AVRCP_RWD_START, AVRCP_RWD_STOP, BT_CMD_NOOP},
+    [MFL_BTN_RT]     = {BT_CMD_NOOP, BT_CMD_NOOP,    BT_CMD_NOOP,    BT_CMD_NOOP},
+    [MFL_BTN_VOICE]  = {AVRCP_STOP, AVRCP_PLAY,      BT_CMD_NOOP,    AVRCP_PAUSE},
+    [MFL_BTN_VOL_UP] = {BT_CMD_NOOP, BT_CMD_NOOP,    BT_CMD_NOOP,    BT_CMD_NOOP},   // Radio handles volume
+    [MFL_BTN_VOL_DN] = {BT_CMD_NOOP, BT_CMD_NOOP,    BT_CMD_NOOP,    BT_CMD_NOOP},
+};
+
+#ifdef CONFIG_KBUS_MFL_TIMING
+#define LONG_PRESS_TICKS    (CONFIG_KBUS_MFL_LONG_PRESS_MS / portTICK_PERIOD_MS)
+#define DOUBLE_PRESS_TICKS  (CONFIG_KBUS_MFL_DOUBLE_PRESS_MS / portTICK_PERIOD_MS)
+#else
+#define LONG_PRESS_TICKS    0
+#define DOUBLE_PRESS_TICKS  0
+#endif
+
+static const char* TAG = "kbus_mfl";
+static kbus_mfl_cmd_cb_t cmd_cb = NULL;
+static uint8_t state[MFL_BTN_COUNT];
+static TickType_t deadline[MFL_BTN_COUNT];  // 0 if no timer armed
+static kbus_mfl_stats_t mfl_stats;
+
+static void run_event(mfl_button_t button, mfl_event_t event);
+
+void kbus_mfl_init(kbus_mfl_cmd_cb_t command_cb) {
+    cmd_cb = command_cb;
+    memset(state, MFL_ST_IDLE, sizeof(state));
+    memset(deadline, 0, sizeof(deadline));
+}
+
+void kbus_mfl_feed(const kbus_message_t* message) {
+    uint8_t code;
+
+    if(message->body_len < 2) return;
+    code = message->body[1];
+
+    switch(message->body[0]) {
+        case MFL_BUTTON: {
+            mfl_button_t button;
+            mfl_event_t event;
+
+            switch(code & ~MFL_PHASE_MASK) {
+                case 0x01: button = MFL_BTN_UP;    break;
+                case 0x08: button = MFL_BTN_DOWN;  break;
+                case 0x40: button = MFL_BTN_RT;    break;
+                case 0x80: button = MFL_BTN_VOICE; break;
+                default:
+                    DLOGD("Other MFL -> RAD/TEL Button Event: 0x%02x", code);
+                    mfl_stats.ignored++;
+                    return;
+            }
+            switch(code & MFL_PHASE_MASK) {
+                case MFL_PHASE_PRESS:   event = MFL_EV_PRESS;   break;
+                case MFL_PHASE_LONG:    event = MFL_EV_LONG;    break;
+                case MFL_PHASE_RELEASE: event = MFL_EV_RELEASE; break;
+                default:
+                    mfl_stats.ignored++;
+                    return;
+            }
+            run_event(button, event);
+            break;
+        }
+
+        case VOLUME_CTRL:
+            if((code & 0xFE) != 0x10) {
+                mfl_stats.ignored++;
+                return;
+            }
+            // Volume only ever sends one frame per click
+            run_event((code & 0x01) ? MFL_BTN_VOL_UP : MFL_BTN_VOL_DN, MFL_EV_PRESS);
+            run_event((code & 0x01) ? MFL_BTN_VOL_UP : MFL_BTN_VOL_DN, MFL_EV_RELEASE);
+            break;
+
+        default:
+            DLOGD("Other MFL Button Event: 0x%02x 0x%02x", message->body[0], code);
+            mfl_stats.ignored++;
+            break;
+    }
+}
+
+TickType_t kbus_mfl_poll() {
+    TickType_t now = xTaskGetTickCount();
+    TickType_t wait = portMAX_DELAY;
+    int32_t left;
+
+    for(int i = 0; i < MFL_BTN_COUNT; i++) {
+        if(deadline[i] == 0) continue;
+
+        left = (int32_t)(deadline[i] - now);
+        if(left <= 0) {
+            run_event(i, MFL_EV_TIMEOUT);
+            if(deadline[i] == 0) continue;
+            left = (int32_t)(deadline[i] - now);
+            if(left < 0) left = 0;
+        }
+        if((TickType_t)left < wait) wait = left;
+    }
+    return wait;
+}
+
+void kbus_mfl_get_stats(kbus_mfl_stats_t* stats) {
+    *stats = mfl_stats;
+}
+
+static inline void emit(uint8_t command) {
+    if(command == BT_CMD_NOOP || cmd_cb == NULL) return;
+    mfl_stats.commands++;
+    cmd_cb(command);
+}
+
+static inline void arm(mfl_button_t button, TickType_t ticks) {
+    deadline[button] = ticks ? (xTaskGetTickCount() + ticks) | 1 : 0;     // | 1 keeps 0 meaning "unarmed"
+}
+
+static void run_event(mfl_button_t button, mfl_event_t event) {
+    const mfl_button_map_t* map = &button_map[button];
+    mfl_state_t prev = state[button];
+    mfl_transition_t t = transitions[prev][event];
+
+    if(event != MFL_EV_TIMEOUT) mfl_stats.events++;
+    else if(t.action == MFL_ACT_HOLD_START) mfl_stats.synthesized++;
+
+    // Without a double action there's nothing to wait for; taps go out on release
+    if(t.action == MFL_ACT_TAP && (DOUBLE_PRESS_TICKS == 0 || map->double_tap == BT_CMD_NOOP)) {
+        t.next = MFL_ST_IDLE;
+        t.action = MFL_ACT_TAP_NOW;
+    }
+
+    DLOGD("button %d: state %d -ev %d-> %d", button, prev, event, t.next);
+    if(t.action != MFL_ACT_NONE) DLOGD("button %d: action %d", button, t.action);
+    state[button] = t.next;
+
+    // Timers belong to the state; only (re)armed on entry so repeat frames don't extend them
+    if(t.next != prev) {
+        switch(t.next) {
+            case MFL_ST_PRESSED:
+            case MFL_ST_PRESSED_AGAIN:
+                arm(button, LONG_PRESS_TICKS);
+                break;
+            case MFL_ST_TAP_WAIT:
+                arm(button, DOUBLE_PRESS_TICKS);
+                break;
+            default:
+                arm(button, 0);
+                break;
+        }
+    }
+
+    switch(t.action) {
+        case MFL_ACT_TAP_NOW:    emit(map->tap);        break;
+        case MFL_ACT_HOLD_START: emit(map->hold_start); break;
+        case MFL_ACT_HOLD_END:   emit(map->hold_end);   break;
+        case MFL_ACT_DOUBLE:     emit(map->double_tap); break;
+        default: break;
+    }
+}
@@ -0,0 +1,100 @@
+// C stdlib includes
+#include <stddef.h>
+#include <string.h>
+
+// FreeRTOS includes
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+// esp-idf includes
+#include "esp_log.h"
+
+// component includes
+#include "kbus_msg_pool.h"
+#include "sys_monitor.h"
+
+typedef struct {
+    kbus_message_t msg;     // Must stay first; handles are &buf->msg
+    uint8_t refs;
+} kbus_msg_buf_t;
+
+#define BUF_FROM_MSG(m) ((kbus_msg_buf_t*)((uint8_t*)(m) - offsetof(kbus_msg_buf_t, msg)))
+
+static const char* TAG = "kbus_msg_pool";
+
+static kbus_msg_buf_t pool[KBUS_MSG_POOL_SIZE];
+static QueueHandle_t free_list = NULL;   // Holds kbus_msg_buf_t* of unreferenced buffers
+static portMUX_TYPE pool_mux = portMUX_INITIALIZER_UNLOCKED;
+static kbus_msg_pool_stats_t pool_stats;
+
+void kbus_msg_pool_init() {
+    if(free_list != NULL) return;
+
+    free_list = SYS_QUEUE_CREATE("msg_pool", KBUS_MSG_POOL_SIZE, sizeof(kbus_msg_buf_t*));
+    for(int i = 0; i < KBUS_MSG_POOL_SIZE; i++) {
+        kbus_msg_buf_t* buf = &pool[i];
+        buf->refs = 0;
+        xQueueSend(free_list, &buf, 0);
+    }
+}
+
+kbus_message_t* kbus_msg_alloc(TickType_t ticks_to_wait) {
+    kbus_msg_buf_t* buf = NULL;
+
+    if(xQueueReceive(free_list, &buf, ticks_to_wait) != pdTRUE) {
+        portENTER_CRITICAL(&pool_mux);
+        pool_stats.alloc_failures++;
+        portEXIT_CRITICAL(&pool_mux);
+        ESP_LOGW(TAG, "No free message buffers");
+        return NULL;
+    }
+
+    portENTER_CRITICAL(&pool_mux);
+    buf->refs = 1;
+    pool_stats.in_use++;
+    if(pool_stats.in_use > pool_stats.in_use_max) pool_stats.in_use_max = pool_stats.in_use;
+    portEXIT_CRITICAL(&pool_mux);
+
+    return &buf->msg;
+}
+
+kbus_message_t* kbus_msg_retain(kbus_message_t* message) {
+    kbus_msg_buf_t* buf = BUF_FROM_MSG(message);
+
+    portENTER_CRITICAL(&pool_mux);
+    buf->refs++;
+    portEXIT_CRITICAL(&pool_mux);
+
+    return message;
+}
+
+void kbus_msg_release(kbus_message_t* message) {
+    kbus_msg_buf_t* buf = BUF_FROM_MSG(message);
+    uint8_t refs;
+
+    portENTER_CRITICAL(&pool_mux);
+    refs = --buf->refs;
+    if(refs == 0) pool_stats.in_use--;
+    portEXIT_CRITICAL(&pool_mux);
+
+    // Last reference gone, hand it back
+    if(refs == 0) xQueueSend(free_list, &buf, 0);
+}
+
+void kbus_msg_pool_count_copy(size_t bytes) {
+    portENTER_CRITICAL(&pool_mux);
+    pool_stats.bytes_copied += bytes;
+    portEXIT_CRITICAL(&pool_mux);
+}
+
+void kbus_msg_pool_count_delivered() {
+    portENTER_CRITICAL(&pool_mux);
+    pool_stats.frames_delivered++;
+    portEXIT_CRITICAL(&pool_mux);
+}
+
+void kbus_msg_pool_get_stats(kbus_msg_pool_stats_t* stats) {
+    portENTER_CRITICAL(&pool_mux);
+    memcpy(stats, &pool_stats, sizeof(kbus_msg_pool_stats_t));
+    portEXIT_CRITICAL(&pool_mux);
+}
@@ -0,0 +1,207 @@
+// C stdlib includes
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+// FreeRTOS includes
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+// esp-idf includes
+#include "esp_log.h"
+
+// component includes
+#include "kbus_pubsub.h"
+#include "kbus_msg_pool.h"
+#include "sys_telemetry.h"
+#include "sys_trace.h"
+
+_Static_assert(KBUS_MAX_PATTERNS <= 32, "pattern bits must fit the uint32_t match tables");
+_Static_assert(KBUS_MAX_SUBS <= 32, "subscriber bits must fit a uint32_t");
+
+typedef struct {
+    char name[SYS_TLM_NAME_LEN];
+    kbus_handler_t handler;     // NULL for queued subscribers
+    QueueHandle_t queue;
+    sys_tlm_id_t tlm;           // Execution time for inline subscribers, queue stats for queued ones
+    uint32_t delivered;
+    uint32_t overflows;
+    uint8_t lag;
+    uint8_t lag_max;
+} kbus_sub_t;
+
+// Pattern bit -> what delivering needs, so a match reaches its handler in one load
+typedef struct {
+    kbus_handler_t handler;     // Copy of the subscriber's, NULL for queued
+    kbus_sub_t* sub;
+    uint32_t sub_bits;          // All of the subscriber's pattern bits, contiguous
+    kbus_sub_id_t id;
+} kbus_route_t;
+
+static const char* TAG = "kbus_pubsub";
+static kbus_sub_t subs[KBUS_MAX_SUBS];
+static uint8_t subs_used = 0;
+static uint8_t patterns_used = 0;
+static kbus_route_t routes[KBUS_MAX_PATTERNS];   // Pattern bit -> route
+
+// Compiled index; bit n set in [x] if pattern n matches field value x, KBUS_ANY sets it in all 256
+static uint32_t src_index[256];
+static uint32_t dst_index[256];
+static uint32_t cmd_index[256];
+static uint32_t cmd_any;        // Patterns that take any command, the only ones an empty body can match
+
+static kbus_filter_t* filter = NULL;
+static portMUX_TYPE pubsub_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static kbus_sub_id_t add_sub(const char* name, const kbus_pattern_t* patterns, uint8_t npatterns,
+                             kbus_handler_t handler, QueueHandle_t queue);
+static void index_field(uint32_t* index, uint16_t value, uint32_t bit);
+static void open_filter(const kbus_pattern_t* pattern);
+static inline void deliver(const kbus_route_t* route, kbus_message_t* message, uint16_t trace_id);
+static void deliver_queued(kbus_sub_t* sub, kbus_message_t* message);
+
+void kbus_pubsub_init(kbus_filter_t* rx_filter) {
+    filter = rx_filter;
+}
+
+kbus_sub_id_t kbus_subscribe(const char* name, const kbus_pattern_t* patterns, uint8_t npatterns, kbus_handler_t handler) {
+    if(handler == NULL) return KBUS_SUB_NONE;
+    return add_sub(name, patterns, npatterns, handler, NULL);
+}
+
+kbus_sub_id_t kbus_subscribe_queue(const char* name, const kbus_pattern_t* patterns, uint8_t npatterns, QueueHandle_t queue) {
+    if(queue == NULL) return KBUS_SUB_NONE;
+    return add_sub(name, patterns, npatterns, NULL, queue);
+}
+
+static kbus_sub_id_t add_sub(const char* name, const kbus_pattern_t* patterns, uint8_t npatterns,
+                             kbus_handler_t handler, QueueHandle_t queue) {
+    kbus_sub_id_t id;
+    kbus_sub_t* sub;
+    uint32_t first_bit;
+    sys_tlm_id_t tlm;
+
+    if(npatterns == 0) return KBUS_SUB_NONE;
+    // Registered up front; telemetry has its own lock and may log
+    tlm = handler != NULL ? sys_tlm_timer_register(name) : sys_tlm_queue_register(name);
+
+    portENTER_CRITICAL(&pubsub_mux);
+    if(subs_used >= KBUS_MAX_SUBS || patterns_used + npatterns > KBUS_MAX_PATTERNS) {
+        portEXIT_CRITICAL(&pubsub_mux);
+        ESP_LOGE(TAG, "Out of subscriptions, can't subscribe %s", name);
+        return KBUS_SUB_NONE;
+    }
+    id = subs_used;
+    sub = &subs[id];
+    snprintf(sub->name, sizeof(sub->name), "%s", name);
+    sub->handler = handler;
+    sub->queue = queue;
+    sub->tlm = tlm;
+
+    first_bit = patterns_used;
+    for(uint8_t i = 0; i < npatterns; i++) {
+        routes[first_bit + i] = (kbus_route_t){handler, sub, (uint32_t)(((1ULL << npatterns) - 1) << first_bit), id};
+    }
+    patterns_used += npatterns;
+    subs_used++;
+
+    // Subscriber is complete before any of its pattern bits can match
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    for(uint8_t i = 0; i < npatterns; i++) {
+        uint32_t bit = 1UL << (first_bit + i);
+        index_field(src_index, patterns[i].src, bit);
+        index_field(dst_index, patterns[i].dst, bit);
+        index_field(cmd_index, patterns[i].cmd, bit);
+        if(patterns[i].cmd == KBUS_ANY) cmd_any |= bit;
+    }
+    portEXIT_CRITICAL(&pubsub_mux);
+
+    // After the bits; a frame let in a moment early just matches nobody
+    for(uint8_t i = 0; i < npatterns; i++) open_filter(&patterns[i]);
+    return id;
+}
+
+static void index_field(uint32_t* index, uint16_t value, uint32_t bit) {
+    if(value == KBUS_ANY) {
+        for(int i = 0; i < 256; i++) index[i] |= bit;
+    } else {
+        index[value & 0xFF] |= bit;
+    }
+}
+
+static void open_filter(const kbus_pattern_t* pattern) {
+    uint8_t cmd = pattern->cmd;
+    uint8_t ncmds = pattern->cmd == KBUS_ANY ? 0 : 1;
+
+    if(filter == NULL) return;
+    if(pattern->dst != KBUS_ANY) {
+        kbus_filter_add_dst(filter, pattern->dst, &cmd, ncmds);     // Wider than src && dst, never narrower
+    } else if(pattern->src != KBUS_ANY) {
+        kbus_filter_add_src(filter, pattern->src, &cmd, ncmds);
+    } else {
+        kbus_filter_pass_all(filter);
+    }
+}
+
+/**
+ ** One match per frame. A subscriber's pattern bits are contiguous and follow the ones of
+ ** everyone subscribed before it, so taking the lowest hit and clearing all of its
+ ** subscriber's bits delivers once per subscriber, in subscription order.
+ */
+void kbus_publish(kbus_message_t* message, uint16_t trace_id) {
+    uint32_t cmds = message->body_len ? cmd_index[message->body[0]] : cmd_any;
+    uint32_t hits = src_index[message->src] & dst_index[message->dst] & cmds;
+
+    while(hits) {
+        const kbus_route_t* route = &routes[__builtin_ctz(hits)];
+        deliver(route, message, trace_id);
+        hits &= ~route->sub_bits;
+    }
+}
+
+static inline void deliver(const kbus_route_t* route, kbus_message_t* message, uint16_t trace_id) {
+    if(route->handler != NULL) {
+        uint32_t start = sys_tlm_now_us();
+        sys_trace(SYS_TRACE_HANDLER_BEGIN, trace_id, route->id);
+        route->handler(message);
+        sys_trace(SYS_TRACE_HANDLER_END, trace_id, route->id);
+        sys_tlm_timer_record(route->sub->tlm, start);
+        route->sub->delivered++;
+    } else {
+        deliver_queued(route->sub, message);
+    }
+}
+
+// Out of line so the inline handler path in kbus_publish() stays in registers
+static __attribute__((noinline)) void deliver_queued(kbus_sub_t* sub, kbus_message_t* message) {
+    sub->lag = uxQueueMessagesWaiting(sub->queue);
+    if(sub->lag > sub->lag_max) sub->lag_max = sub->lag;
+
+    // A reference, not a copy; never waits, a slow subscriber only loses its own frames
+    kbus_msg_retain(message);
+    if(sys_tlm_queue_send(sub->tlm, sub->queue, &message, 0) != pdTRUE) {
+        kbus_msg_release(message);
+        sub->overflows++;
+        return;
+    }
+    kbus_msg_pool_count_copy(sizeof(kbus_message_t*));
+    sub->delivered++;
+}
+
+uint8_t kbus_pubsub_count() {
+    return subs_used;
+}
+
+bool kbus_pubsub_get_stats(kbus_sub_id_t id, kbus_sub_stats_t* stats) {
+    const kbus_sub_t* sub;
+
+    if(id < 0 || id >= subs_used) return false;
+    sub = &subs[id];
+    stats->name = sub->name;
+    stats->queued = sub->handler == NULL;
+    stats->delivered = sub->delivered;
+    stats->overflows = sub->overflows;
+    stats->lag = sub->lag;
+    stats->lag_max = sub->lag_max;
+    return true;
+}
@@ -0,0 +1,147 @@
+// C stdlib includes
+#include <stddef.h>
+#include <string.h>
+
+// component includes
+#include "kbus_ring.h"
+
+// Acquire/release pairs order the payload bytes against the index that publishes them.
+#define LOAD_ACQ(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE_REL(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define LOAD_RLX(p)     __atomic_load_n((p), __ATOMIC_RELAXED)
+
+// Bytes a frame of len takes in the ring, prefix included; even, see kbus_ring.h
+#define SPAN(len)       ((KBUS_RING_HDR_LEN + (uint32_t)(len) + 1) & ~1UL)
+
+static inline void copy_in(kbus_ring_t* ring, uint32_t pos, const uint8_t* src, uint32_t len) {
+    uint32_t off = pos & (ring->size - 1);
+    uint32_t first = ring->size - off;
+
+    if(first >= len) {
+        memcpy(&ring->buf[off], src, len);
+    } else { // Wraps past the end
+        memcpy(&ring->buf[off], src, first);
+        memcpy(ring->buf, src + first, len - first);
+    }
+}
+
+static inline void copy_out(const kbus_ring_t* ring, uint32_t pos, uint8_t* dst, uint32_t len) {
+    uint32_t off = pos & (ring->size - 1);
+    uint32_t first = ring->size - off;
+
+    if(first >= len) {
+        memcpy(dst, &ring->buf[off], len);
+    } else {
+        memcpy(dst, &ring->buf[off], first);
+        memcpy(dst + first, ring->buf, len - first);
+    }
+}
+
+bool kbus_ring_init(kbus_ring_t* ring, uint8_t* storage, uint32_t size) {
+    if(ring == NULL || storage == NULL || size < 4 || (size & (size - 1)) != 0) return false;
+
+    ring->buf = storage;
+    ring->size = size;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->dropped = 0;
+    return true;
+}
+
+bool kbus_ring_push(kbus_ring_t* ring, const uint8_t* frame, uint16_t len) {
+    return kbus_ring_push2(ring, frame, len, NULL, 0);
+}
+
+bool kbus_ring_push2(kbus_ring_t* ring, const uint8_t* hdr, uint16_t hdr_len, const uint8_t* body, uint16_t body_len) {
+    uint32_t len = (uint32_t)hdr_len + body_len;
+    uint32_t head = LOAD_RLX(&ring->head);
+    uint32_t tail = LOAD_ACQ(&ring->tail);
+    uint8_t prefix[KBUS_RING_HDR_LEN];
+
+    if(len >= KBUS_RING_PAD || ring->size - (head - tail) < SPAN(len)) {
+        ring->dropped++;
+        return false;
+    }
+
+    prefix[0] = len & 0xFF;
+    prefix[1] = len >> 8;
+    copy_in(ring, head, prefix, KBUS_RING_HDR_LEN);
+    if(hdr_len) copy_in(ring, head + KBUS_RING_HDR_LEN, hdr, hdr_len);
+    if(body_len) copy_in(ring, head + KBUS_RING_HDR_LEN + hdr_len, body, body_len);
+
+    // Publish; consumer sees the frame only once every byte is in place
+    STORE_REL(&ring->head, head + SPAN(len));
+    return true;
+}
+
+uint8_t* kbus_ring_reserve(kbus_ring_t* ring, uint16_t max_len) {
+    uint32_t head = LOAD_RLX(&ring->head);
+    uint32_t tail = LOAD_ACQ(&ring->tail);
+    uint32_t off = head & (ring->size - 1);
+    uint32_t to_end = ring->size - off;
+    uint32_t pad = KBUS_RING_HDR_LEN + (uint32_t)max_len > to_end ? to_end : 0;
+
+    // Padding is less than a reservation, so twice one always fits an empty ring
+    if(max_len >= KBUS_RING_PAD || 2 * SPAN(max_len) > ring->size || ring->size - (head - tail) < pad + SPAN(max_len)) {
+        return NULL;
+    }
+    if(pad) {
+        // Skip the tail end of the buffer; fine to publish alone, a reservation may be abandoned anyway
+        ring->buf[off] = KBUS_RING_PAD & 0xFF;
+        ring->buf[off + 1] = KBUS_RING_PAD >> 8;
+        STORE_REL(&ring->head, head + pad);
+        off = 0;
+    }
+    return &ring->buf[off + KBUS_RING_HDR_LEN];
+}
+
+void kbus_ring_commit(kbus_ring_t* ring, uint16_t len) {
+    uint32_t head = LOAD_RLX(&ring->head);
+    uint32_t off = head & (ring->size - 1);
+
+    ring->buf[off] = len & 0xFF;
+    ring->buf[off + 1] = len >> 8;
+    STORE_REL(&ring->head, head + SPAN(len));
+}
+
+uint16_t kbus_ring_pop(kbus_ring_t* ring, uint8_t* out, uint16_t max_len) {
+    return kbus_ring_pop2(ring, NULL, 0, out, max_len);
+}
+
+uint16_t kbus_ring_pop2(kbus_ring_t* ring, uint8_t* hdr, uint16_t hdr_len, uint8_t* body, uint16_t body_max) {
+    uint32_t tail = LOAD_RLX(&ring->tail);
+    uint32_t head = LOAD_ACQ(&ring->head);
+    uint8_t prefix[KBUS_RING_HDR_LEN];
+    uint16_t len;
+
+    if(head == tail) return 0;
+
+    copy_out(ring, tail, prefix, KBUS_RING_HDR_LEN);
+    len = prefix[0] | (prefix[1] << 8);
+    if(len == KBUS_RING_PAD) {
+        tail += ring->size - (tail & (ring->size - 1));
+        STORE_REL(&ring->tail, tail);
+        if(head == tail) return 0;
+        copy_out(ring, tail, prefix, KBUS_RING_HDR_LEN);
+        len = prefix[0] | (prefix[1] << 8);
+    }
+
+    if(len >= hdr_len && len - hdr_len <= body_max) {
+        if(hdr_len) copy_out(ring, tail + KBUS_RING_HDR_LEN, hdr, hdr_len);
+        if(len > hdr_len) copy_out(ring, tail + KBUS_RING_HDR_LEN + hdr_len, body, len - hdr_len);
+    } else {
+        len = 0;    // Doesn't fit the caller's buffers, skip it
+    }
+
+    // Release the space back to the producer after we're done reading it
+    STORE_REL(&ring->tail, tail + SPAN(prefix[0] | (prefix[1] << 8)));
+    return len;
+}
+
+uint32_t kbus_ring_used(const kbus_ring_t* ring) {
+    return LOAD_ACQ(&ring->head) - LOAD_ACQ(&ring->tail);
+}
+
+uint32_t kbus_ring_free(const kbus_ring_t* ring) {
+    return ring->size - kbus_ring_used(ring);
+}
@@ -0,0 +1,90 @@
+// C stdlib includes
+#include <stddef.h>
+#include <string.h>
+
+// esp-idf includes
+#include "esp_log.h"
+
+// component includes
+#include "kbus_scroll.h"
+
+static const char* TAG = "kbus_scroll";
+
+static void render(kbus_scroll_t* scroll);
+
+void kbus_scroll_init(kbus_scroll_t* scroll, uint8_t width) {
+    memset(scroll, 0, sizeof(kbus_scroll_t));
+    scroll->width = width > KBUS_SCROLL_WIDTH_MAX ? KBUS_SCROLL_WIDTH_MAX : width;
+}
+
+bool kbus_scroll_set_text(kbus_scroll_t* scroll, const char* text) {
+    if(!strncmp(scroll->text, text, sizeof(scroll->text) - 1)) return false;
+
+    strncpy(scroll->text, text, sizeof(scroll->text) - 1);
+    scroll->text[sizeof(scroll->text) - 1] = '\0';
+    render(scroll);
+    return true;
+}
+
+bool kbus_scroll_step(kbus_scroll_t* scroll, char* out) {
+    uint8_t len;
+
+    if(scroll->frame_count == 0) return false;
+    if(scroll->next >= scroll->frame_count) scroll->next = 0;
+
+    len = scroll->frame_len[scroll->next];
+    memcpy(out, &scroll->text[scroll->frame_off[scroll->next]], len);
+    out[len] = '\0';
+    scroll->next++;
+
+    if(!strcmp(out, scroll->last)) return false;
+    memcpy(scroll->last, out, len + 1);
+    return true;
+}
+
+void kbus_scroll_invalidate(kbus_scroll_t* scroll) {
+    scroll->last[0] = '\0';
+}
+
+/**
+ ** Next frame starts at the last word start inside the current window, so a word cut at the
+ ** right edge is shown whole in the following frame. A word that ends exactly at the edge
+ ** isn't cut and stays in its frame. A word longer than the window is cut.
+ */
+static void render(kbus_scroll_t* scroll) {
+    uint16_t text_len = strlen(scroll->text);
+    uint16_t start = 0, end, next;
+
+    scroll->frame_count = 0;
+    scroll->next = 0;
+
+    while(start < text_len && scroll->text[start] == ' ') start++;
+
+    while(start < text_len && scroll->frame_count < KBUS_SCROLL_MAX_FRAMES) {
+        end = start + scroll->width;
+        if(end > text_len) end = text_len;
+
+        scroll->frame_off[scroll->frame_count] = start;
+        scroll->frame_len[scroll->frame_count] = end - start;
+        while(scroll->frame_len[scroll->frame_count] > 1 && scroll->text[start + scroll->frame_len[scroll->frame_count] - 1] == ' ') {
+            scroll->frame_len[scroll->frame_count]--;
+        }
+        scroll->frame_count++;
+
+        if(end == text_len) break;
+
+        // A window ending right before a space cut no word; otherwise back up to the cut word's start
+        next = end;
+        if(scroll->text[end] != ' ') {
+            for(; next > start + 1 && scroll->text[next - 1] != ' '; next--);
+            if(next <= start + 1) next = end;
+        }
+        while(next < text_len && scroll->text[next] == ' ') next++;
+        start = next;
+    }
+
+    if(start < text_len && scroll->frame_count == KBUS_SCROLL_MAX_FRAMES) {
+        ESP_LOGW(TAG, "Text needs more than %d frames, tail dropped", KBUS_SCROLL_MAX_FRAMES);
+    }
+    ESP_LOGD(TAG, "Rendered %d frames at width %d", scroll->frame_count, scroll->width);
+}
@@ -1,4 +1,5 @@
 // C stdlib includes
+#include <inttypes.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <string.h>
@@ -15,35 +16,82 @@
 // component includes
 #include "kbus_uart_driver.h"
 #include "kbus_service.h"
+#include "kbus_msg_pool.h"
+#include "kbus_ring.h"
+#include "kbus_virtual_bus.h"
+#include "kbus_filter.h"
+#include "kbus_pubsub.h"
+#include "kbus_tx_sched.h"
+#include "kbus_mfl.h"
+#include "kbus_scroll.h"
+#include "kbus_charset.h"
+#ifdef CONFIG_KBUS_CAPTURE
+#include "kbus_capture.h"
+#endif
+#include "kbus_bench.h"
 #include "kbus_defines.h"
+#include "kbus_tables.h"
 #include "bt_common.h"
 #include "sdrs_emulator.h"
+#include "cdc_emulator.h"
+#include "sys_monitor.h"
+#include "sys_topology.h"
+#include "sys_telemetry.h"
+#include "sys_trace.h"
+#include "sys_power.h"
+#define DLOG_LEVEL CONFIG_SYS_DLOG_LEVEL_KBUS
+#include "sys_dlog.h"
 
 // ! Debug Flags
 // #define QUEUE_DEBUG
 
 #define HERTZ(hz) ((1000/hz)/portTICK_RATE_MS)
 #define SECONDS(sec) ((sec*1000) / portTICK_RATE_MS)
-#define KBUS_TASK_PRIORITY configMAX_PRIORITIES-5
+#define KBUS_RX_RING_SIZE 1024  // Bytes; each frame costs 6 + body_len, rounded up to even. Power of two.
+#define KBUS_RX_TRACE_LEN 2     // [trace id lo][trace id hi] ahead of the frame in rx_ring
+#define KBUS_RX_HDR_LEN 4       // Trace id, src, dst; then the body
+#define KBUS_BODY_MAX sizeof(((kbus_message_t*)0)->body)
+#if defined(CONFIG_KBUS_DISPLAY_MID) || defined(CONFIG_KBUS_DISPLAY_IKE)
+#define TEL_DISPLAY             // tel_display_task only runs with a display to drive
+#endif
+#define IGN_STAT_ON_MASK 0x07     // IGN_STAT_RPLY state bits Pos1_Acc, Pos2_On, Pos3_Start
 
 static const char* TAG = "kbus_service";
 static QueueHandle_t bt_cmd_queue;
 static QueueHandle_t bt_info_queue;
-static QueueHandle_t kbus_rx_queue; //TODO: Message Buffer instead of Queue... lol, not available on esp-idf 4.0.2; will be on 4.3
-static QueueHandle_t kbus_tx_queue; //TODO: See https://github.com/espressif/esp-idf/issues/4945 for details
+static QueueHandle_t kbus_rx_queue; // Driver facing, kept shallow; drained into rx_ring right away
+static QueueHandle_t kbus_tx_queue; // Driver facing, fed only by kbus_tx_sched; everyone else calls kbus_tx_submit()
+
+static sys_tlm_id_t kbus_rx_tlm = SYS_TLM_NONE, bt_cmd_tlm = SYS_TLM_NONE;
 
 static TaskHandle_t tel_display_tsk = NULL;
+static TaskHandle_t kbus_dispatch_tsk = NULL;
+static uint16_t dispatch_trace_id = SYS_TRACE_NO_ID;   // Only touched by kbus_dispatch_task
 
-static sdrs_display_buf_t* sdrs_display_buf = NULL;
+// Variable length frames [trace id][src][dst][body...] between kbus_rx_task (producer) and kbus_dispatch_task (consumer)
+static uint8_t rx_ring_storage[KBUS_RX_RING_SIZE];
+static kbus_ring_t rx_ring;
+
+// Opened by subscriptions; see kbus_filter.h && kbus_pubsub.h
+static kbus_filter_t rx_filter;
 
 static void init_emulated_devs();
 static void kbus_rx_task();
-static void cdc_emulator(kbus_message_t rx_msg);
-static void tel_emulator(kbus_message_t rx_msg);
-static void mfl_handler(uint8_t mfl_cmd[2]);
-static void display_tel_msg(uint8_t cmd, uint8_t layout, uint8_t flags, char* text);
+static void kbus_dispatch_task();
+static bool register_handler(const char* dir, uint8_t addr, const kbus_pattern_t* patterns, uint8_t npatterns,
+                             kbus_handler_t handler);
+static void ignition_handler(kbus_message_t* message);
+static void tel_emulator(kbus_message_t* rx_msg);
+static void mfl_rx_handler(kbus_message_t* message);
+static void send_bt_cmd(bt_cmd_type_t bt_command);
+#ifdef TEL_DISPLAY
+static void display_tel_msg(uint8_t dst, uint8_t cmd, uint8_t layout, uint8_t flags, const char* text);
+#endif
 static void bt_info_task();
+static void display_changed(uint32_t version);
+#ifdef TEL_DISPLAY
 static void tel_display_task();
+#endif
 
 #ifdef QUEUE_DEBUG
 static void create_kbus_queue_watcher();
@@ -52,54 +100,107 @@ static void create_kbus_queue_watcher();
 void init_kbus_service(QueueHandle_t bt_command_q, QueueHandle_t bt_track_info_q) {
     bt_cmd_queue = bt_command_q;
     bt_info_queue = bt_track_info_q;
-    kbus_rx_queue = xQueueCreate(8, sizeof(kbus_message_t));
-    kbus_tx_queue = xQueueCreate(4, sizeof(kbus_message_t));
+    kbus_rx_queue = SYS_QUEUE_CREATE("kbus_rx", 2, sizeof(kbus_message_t));
+    kbus_tx_queue = SYS_QUEUE_CREATE("kbus_tx", 1, sizeof(kbus_message_t));
+    kbus_msg_pool_init();
+    kbus_tx_sched_init(kbus_tx_queue);
+    kbus_ring_init(&rx_ring, rx_ring_storage, sizeof(rx_ring_storage));
+#ifdef CONFIG_KBUS_CAPTURE
+    kbus_filter_init(&rx_filter, true);     // A capture wants the whole bus
+#else
+    kbus_filter_init(&rx_filter, false);
+#endif
+    kbus_pubsub_init(&rx_filter);
+    kbus_rx_tlm = sys_tlm_queue_register("kbus_rx");
+    bt_cmd_tlm = sys_tlm_queue_register("bt_cmd");
+#ifdef CONFIG_KBUS_CAPTURE
+    kbus_capture_init(kbus_rx_queue);
+#endif
+
+    // Service-local handlers; emulators register their own during init
+    kbus_mfl_init(send_bt_cmd);
+    kbus_register_src_handler(MFL, mfl_rx_handler);
+    kbus_register_dst_cmd_handler(GLO, (const uint8_t[]){IGN_STAT_RPLY}, 1, ignition_handler);
+    kbus_register_dst_handler(TEL, tel_emulator);
 
-    int tsk_ret = xTaskCreatePinnedToCore(kbus_rx_task, "kbus_rx", 4096, NULL, KBUS_TASK_PRIORITY, NULL, 1);
+    int tsk_ret = SYS_TASK_SPAWN(KBUS_DISP, kbus_dispatch_task, &kbus_dispatch_tsk);
+    if(tsk_ret != pdPASS){ ESP_LOGE(TAG, "kbus_disp creation failed with: %d", tsk_ret);}
+
+    tsk_ret = SYS_TASK_SPAWN(KBUS_RX, kbus_rx_task, NULL);
     if(tsk_ret != pdPASS){ ESP_LOGE(TAG, "kbus_rx creation failed with: %d", tsk_ret);}
+#ifdef CONFIG_KBUS_VIRTUAL_BUS
+    init_kbus_virtual_bus(kbus_rx_queue, kbus_tx_queue, &rx_filter);
+#else
     init_kbus_uart_driver(kbus_rx_queue, kbus_tx_queue);
+#endif
 
-    tsk_ret = xTaskCreate(init_emulated_devs, "emus_init", 4096, NULL, KBUS_TASK_PRIORITY+1, NULL);
+    tsk_ret = SYS_TASK_SPAWN(EMUS_INIT, init_emulated_devs, NULL);
     if(tsk_ret != pdPASS){ ESP_LOGE(TAG, "emus_init creation failed with: %d", tsk_ret);}
 
-    tsk_ret = xTaskCreate(bt_info_task, "bt_trk_info", 4096, NULL, KBUS_TASK_PRIORITY-2, NULL);
+    sdrs_display_subscribe(display_changed);
+    tsk_ret = SYS_TASK_SPAWN(BT_TRK_INFO, bt_info_task, NULL);
     if(tsk_ret != pdPASS){ ESP_LOGE(TAG, "bt_trk_info creation failed with: %d", tsk_ret);}
 
-    tsk_ret = xTaskCreate(tel_display_task, "tel_dis_tsk", 4096, NULL, KBUS_TASK_PRIORITY-2, &tel_display_tsk);
+#ifdef TEL_DISPLAY
+    tsk_ret = SYS_TASK_SPAWN(TEL_DISPLAY, tel_display_task, &tel_display_tsk);
     if(tsk_ret != pdPASS){ ESP_LOGE(TAG, "tel_dis_tsk creation failed with: %d", tsk_ret);}
+#endif
 
 #ifdef QUEUE_DEBUG
     create_kbus_queue_watcher();
 #endif
+    kbus_bench_start(bt_info_queue);
 }
 
 static void init_emulated_devs() {
     vTaskDelay(SECONDS(1));
 
-    sdrs_display_buf = (sdrs_display_buf_t*) malloc(sizeof(sdrs_display_buf_t));
-    sdrs_init_emulation(kbus_tx_queue, sdrs_display_buf);
+    sdrs_init_emulation();
 
     vTaskDelay(50);
     send_dev_ready(TEL, LOC, true);
 
-    // vTaskDelay(50);
-    // send_dev_ready(CDC, LOC, true);
+    vTaskDelay(50);
+    cdc_init_emulation(send_bt_cmd);
+
+    sys_monitor_task_exit();
+}
 
-    vTaskDelete(NULL);
+static void display_changed(uint32_t version) {
+    if(tel_display_tsk != NULL) xTaskNotify(tel_display_tsk, 0x01, eSetBits);
 }
 
 static void bt_info_task() {
     bt_now_playing_info_t info;
+    static sdrs_display_buf_t display;  // Only writer, so our last publish is the current state
+    meta_handle_t shown_title = META_NONE, shown_artist = META_NONE;
+    char utf8[META_STR_MAX + 1];
+    size_t utf8_len;
+
+    sdrs_display_read(&display);
     while(1) {
+        sys_power_park();   // Updates wait in bt_info_queue while the car is off
         if(xQueueReceive(bt_info_queue, (void *)&info, (portTickType)portMAX_DELAY)) {
-            strcpy(sdrs_display_buf->chan_disp, "Spotify");
-            strcpy(sdrs_display_buf->artist_disp, info.artist_name);
-            strcpy(sdrs_display_buf->song_disp, info.track_title);
+            meta_release(info.album_name);
 
-            // If incoming string is new, update MID
-            if(!strcmp(sdrs_display_buf->song_disp, info.track_title)){
-                if(tel_display_tsk != NULL) xTaskNotify(tel_display_tsk, 0x01, eSetBits);
+            // Interned, so same handles means same text; nothing to publish
+            if(info.track_title == shown_title && info.artist_name == shown_artist) {
+                meta_release(info.track_title);
+                meta_release(info.artist_name);
+                continue;
             }
+
+            snprintf(display.chan_disp, sizeof(display.chan_disp), "Spotify");
+            // Transcoded once here; everything downstream works in display bytes, one per glyph
+            utf8_len = meta_copy(info.artist_name, utf8, sizeof(utf8));
+            kbus_charset_from_utf8(utf8, utf8_len, display.artist_disp, sizeof(display.artist_disp));
+            utf8_len = meta_copy(info.track_title, utf8, sizeof(utf8));
+            kbus_charset_from_utf8(utf8, utf8_len, display.song_disp, sizeof(display.song_disp));
+            sdrs_display_publish(&display);     // Subscribers (MID, SDRS) pick it up from here
+
+            // Keep what's shown alive for the comparison above; hands over the message's references
+            meta_assign(&shown_title, info.track_title);
+            meta_assign(&shown_artist, info.artist_name);
         }
         vTaskDelay(HERTZ(1)); // Rate limit updates to 1Hz
     }
@@ -117,71 +218,106 @@ void send_dev_ready(uint8_t source, uint8_t dest, bool startup) {
 
     // If startup, update message to
     //"Device Status Ready After Reset"
+    // Startup is an announcement, otherwise it's the reply to a "Device Status Request" poll
     if(startup) {
         message.body[1] = 0x01;
-        ESP_LOGD(TAG, "Queueing 0x%02x -> 0x%02x DEVICE READY AFTER RESET", source, dest);
+        DLOGD("Queueing 0x%02x -> 0x%02x DEVICE READY AFTER RESET", source, dest);
+        kbus_tx_submit(&message, KBUS_TX_STATUS, KBUS_TX_NO_DEADLINE, KBUS_TX_NO_KEY);
     } else {
-        ESP_LOGD(TAG, "Queueing 0x%02x -> 0x%02x DEVICE READY", source, dest);
+        DLOGD("Queueing 0x%02x -> 0x%02x DEVICE READY", source, dest);
+        kbus_tx_submit(&message, KBUS_TX_REPLY, KBUS_TX_REPLY_DEADLINE_MS, KBUS_TX_NO_KEY);
     }
-    xQueueSend(kbus_tx_queue, &message, (portTickType)portMAX_DELAY);
 }
 
+bool kbus_register_src_handler(uint8_t src, kbus_handler_t handler) {
+    return register_handler("src", src, &KBUS_PATTERN(src, KBUS_ANY, KBUS_ANY), 1, handler);
+}
+
+bool kbus_register_dst_handler(uint8_t dst, kbus_handler_t handler) {
+    return register_handler("dst", dst, &KBUS_PATTERN(KBUS_ANY, dst, KBUS_ANY), 1, handler);
+}
+
+bool kbus_register_dst_cmd_handler(uint8_t dst, const uint8_t* cmds, uint8_t ncmds, kbus_handler_t handler) {
+    kbus_pattern_t patterns[KBUS_MAX_PATTERNS];
+
+    if(ncmds == 0 || ncmds > KBUS_MAX_PATTERNS) return false;
+    for(uint8_t i = 0; i < ncmds; i++) patterns[i] = KBUS_PATTERN(KBUS_ANY, dst, cmds[i]);
+    return register_handler("dst", dst, patterns, ncmds, handler);
+}
+
+void kbus_rx_filter_get_stats(kbus_filter_stats_t* stats) {
+    kbus_filter_get_stats(&rx_filter, stats);
+}
+
+// Address handlers are inline subscribers, named after the address like before
+static bool register_handler(const char* dir, uint8_t addr, const kbus_pattern_t* patterns, uint8_t npatterns,
+                             kbus_handler_t handler) {
+    char name[SYS_TLM_NAME_LEN];
+    const char* dev_name = kbus_dev_name(addr);
+
+    if(dev_name != NULL) {
+        snprintf(name, sizeof(name), "%s %s", dir, dev_name);
+    } else {
+        snprintf(name, sizeof(name), "%s 0x%02x", dir, addr);
+    }
+    return kbus_subscribe(name, patterns, npatterns, handler) != KBUS_SUB_NONE;
+}
+
+uint16_t kbus_trace_id() {
+    if(xTaskGetCurrentTaskHandle() != kbus_dispatch_tsk) return SYS_TRACE_NO_ID;
+    return dispatch_trace_id;
+}
+
+// The driver's frame is received straight into rx_ring, src, dst and body already in ring order
+_Static_assert(offsetof(kbus_message_t, body) == 2, "kbus_message_t must start src, dst, body");
+
+/**
+ ** Ingest; only job is to get frames out of the driver's queue and into rx_ring so the
+ ** driver never waits on handlers. The driver's queue receive lands in a reservation of
+ ** rx_ring and only src, dst and the used part of body are committed, so the frame isn't
+ ** copied again on the way in. With the ring too full to reserve, it's received aside and
+ ** pushed, or dropped, once it arrives.
+ */
 static void kbus_rx_task() {
-    kbus_message_t message;
+    kbus_message_t spill;
+    kbus_message_t* message;
+    uint8_t* slot;
+    uint16_t trace_id;
+
     while(1) {
-        if(xQueueReceive(kbus_rx_queue, (void * )&message,  (portTickType)portMAX_DELAY)) {
-            ESP_LOGD(TAG, "data from driver:");
-            ESP_LOGD(TAG, "KBUS\t0x%02x -> 0x%02x", message.src, message.dst);
-            ESP_LOG_BUFFER_HEXDUMP(TAG, message.body, message.body_len, ESP_LOG_DEBUG);
-
-            switch(message.src) {
-                case MFL:
-                    ESP_LOGD(TAG, "MFL -> 0x%02x Message Received", message.dst);
-                    mfl_handler((uint8_t[2]){message.body[0], message.body[1]});
-                    break;
-
-                default:
-                    break;
-            }
+        slot = kbus_ring_reserve(&rx_ring, KBUS_RX_TRACE_LEN + sizeof(kbus_message_t));
+        message = slot != NULL ? (kbus_message_t*)&slot[KBUS_RX_TRACE_LEN] : &spill;
+
+        if(xQueueReceive(kbus_rx_queue, (void * )message,  (portTickType)portMAX_DELAY)) {
+            // Driver side send isn't ours to wrap; depth as found, counting the one just taken
+            sys_tlm_queue_depth(kbus_rx_tlm, uxQueueMessagesWaiting(kbus_rx_queue) + 1);
+            kbus_msg_pool_count_copy(sizeof(kbus_message_t));
+            // Before the filter; a bus busy with frames nobody here wants is still a car that's on
+            sys_power_note_activity();
+            if(message->dst == SDRS || message->dst == TEL || message->dst == CDC) sys_power_note_request();
+#ifndef CONFIG_KBUS_VIRTUAL_BUS
+            // kbus_uart_driver doesn't take the filter, so this is the earliest it can drop
+            if(!kbus_filter_admit(&rx_filter, message)) continue;  // Reservation left uncommitted
+#endif
+            trace_id = sys_trace_new_id();
+            sys_trace(SYS_TRACE_RX_DEQUEUE, trace_id, message->src << 8 | message->dst);
+            kbus_tx_note_rx(message->body_len);
+#ifdef CONFIG_KBUS_CAPTURE
+            kbus_capture_record(message);
+#endif
 
-            switch(message.dst) {
-
-                case LOC:
-                    // Noop right away on LOCAL broadcast messages. short circuit -> save some cycles
-                    break;
-
-                case GLO:
-                    // If ignition is set to Pos1_ACC, send device startup packet
-                    if(message.body_len == 2 && message.body[0] == IGN_STAT_RPLY && message.body[1] == 0x03) {
-                        ESP_LOGI(TAG, "Ignition On...");
-                        // TODO: Need to guarantee it's only emitted once before requesting media begin playing
-                    //     // Send AVRCP_PLAY command when ignition_status bits set to: Pos1_Acc Pos2_On
-                    //     bt_cmd_type_t bt_command = AVRCP_PLAY;
-                    //     xQueueSend(bt_cmd_queue, &bt_command, (portTickType)portMAX_DELAY);
-                    }
-                    // Only care for this one particular GLOBAL message right now
-                    break;
-
-                case SDRS:
-                    ESP_LOGD(TAG, "Message for Sat Radio Received");
-                    ESP_LOG_BUFFER_HEXDUMP(TAG, message.body, message.body_len, ESP_LOG_DEBUG);
-                    sdrs_enqueue_msg(&message, 50);
-                    break;
-
-                // case CDC:
-                //     ESP_LOGD(TAG, "Message for CD Changer Received");
-                //     ESP_LOG_BUFFER_HEXDUMP(TAG, message.body, message.body_len, ESP_LOG_DEBUG);
-                //     cdc_emulator(message);
-                //     break;
-
-                case TEL:
-                    ESP_LOGD(TAG, "Message for TEL module Received");
-                    ESP_LOG_BUFFER_HEXDUMP(TAG, message.body, message.body_len, ESP_LOG_DEBUG);
-                    tel_emulator(message);
-                    break;
-
-                default:
-                    break;
+            if(slot != NULL) {
+                slot[0] = trace_id & 0xFF;
+                slot[1] = trace_id >> 8;
+                kbus_ring_commit(&rx_ring, KBUS_RX_HDR_LEN + message->body_len);
+                xTaskNotifyGive(kbus_dispatch_tsk);
+            } else if(kbus_ring_push2(&rx_ring, (uint8_t[KBUS_RX_HDR_LEN]){trace_id & 0xFF, trace_id >> 8, spill.src, spill.dst},
+                                      KBUS_RX_HDR_LEN, spill.body, spill.body_len)) {
+                kbus_msg_pool_count_copy(KBUS_RX_HDR_LEN + spill.body_len);
+                xTaskNotifyGive(kbus_dispatch_tsk);
+            } else {
+                sys_tlm_queue_drop(kbus_rx_tlm);
+                DLOGW("rx ring full, dropped 0x%02x -> 0x%02x", spill.src, spill.dst);
             }
         } else {
             xQueueReset(kbus_rx_queue); // flush queue
@@ -190,259 +326,205 @@ static void kbus_rx_task() {
     vTaskDelete(NULL); // In case we leave the loop, to avoid a panic
 }
 
-static void cdc_emulator(kbus_message_t rx_msg) {   //? Own component like SDRS?...
-    //* CD Changer Messages from http://web.archive.org/web/20110320053244/http://ibus.stuge.se/CD_Changer
-    kbus_message_t tx_msg = {   // CDC -> SORUCE
-        .src = CDC,
-        .dst = rx_msg.src,      // Address to sender of received msg
-    };
+static void kbus_dispatch_task() {
+    uint8_t frame[KBUS_RX_HDR_LEN];   // Trace id, src, dst; the body goes straight to the pooled buffer
+    uint16_t frame_len;
+    kbus_message_t* message;
 
-    switch(rx_msg.body[0]) {
-        case DEV_STAT_REQ:
-            ESP_LOGD(TAG, "CDC Received: DEVICE STATUS REQUEST");
-            send_dev_ready(CDC, rx_msg.src, false); // "Device Status Request" response "Device Status Ready"
-            ESP_LOGD(TAG, "CDC Queued: DEVICE STATUS READY");
-            return;
+    while(1) {
+        // Also wakes for MFL press timers; portMAX_DELAY unless CONFIG_KBUS_MFL_TIMING armed one
+        ulTaskNotifyTake(pdTRUE, kbus_mfl_poll());
+
+        while(kbus_ring_used(&rx_ring)) {
+            // Pooled buffer first, so the body comes out of the ring straight into it;
+            // handlers that keep the frame take a reference instead of a copy
+            message = kbus_msg_alloc((portTickType)portMAX_DELAY);
+            if(message == NULL) continue;
+
+            frame_len = kbus_ring_pop2(&rx_ring, frame, KBUS_RX_HDR_LEN, message->body, sizeof(message->body));
+            if(frame_len == 0) {
+                kbus_msg_release(message);
+                continue;
+            }
+            kbus_msg_pool_count_copy(frame_len);
+
+            dispatch_trace_id = frame[0] | (frame[1] << 8);
+            message->src = frame[2];
+            message->dst = frame[3];
+            message->body_len = frame_len - KBUS_RX_HDR_LEN;
+            sys_trace(SYS_TRACE_DISPATCH, dispatch_trace_id, message->src << 8 | message->dst);
+            kbus_msg_pool_count_delivered();
+
+            DLOG_HEX(D, "KBUS\t0x%02x -> 0x%02x", message->body, message->body_len, message->src, message->dst);
+            if(!kbus_body_len_ok(message->body, message->body_len)) {
+                DLOGW("0x%02x -> 0x%02x cmd 0x%02x: %d byte body outside spec",
+                      message->src, message->dst, message->body[0], message->body_len);
+            }
 
-        case CD_CTRL_REQ: // TODO: React to different requests and reply appropriately
-            ESP_LOGD(TAG, "CDC Received: CD CONTROL REQUEST");
-            tx_msg.body[0] = CD_STAT_RPLY;
-            tx_msg.body[1] = 0x00;  // STOP
-            tx_msg.body[2] = 0x00;  // PAUSE requested on 0x02
-            tx_msg.body[3] = 0x00;  // ERRORS byte, can || multiple flags
-            tx_msg.body[4] = 0x21;  // DISCS loaded; each bit is a CD. 0x21 --> Discs 1 & 6
-            tx_msg.body[5] = 0x00;  // ¯\_(ツ)_/¯ Padding?...
-            tx_msg.body[6] = 0x01;  // DISC number in reader. 0x01 --> Disc 1
-            tx_msg.body[7] = 0x01;  // TRACK number.
-            tx_msg.body_len = 8;
-            xQueueSend(kbus_tx_queue, &tx_msg, (portTickType)portMAX_DELAY);
-            ESP_LOGD(TAG, "CDC Queued: CD STATUS REPLY");
-            return;
+#ifdef CONFIG_KBUS_CAPTURE
+            kbus_replay_frame_begin();
+#endif
+            // Inline subscribers run here; queued ones get a reference and release it themselves
+            kbus_publish(message, dispatch_trace_id);
+#ifdef CONFIG_KBUS_CAPTURE
+            kbus_replay_frame_done();
+#endif
 
-        default:
-            ESP_LOGD(TAG, "CDC Received Other Command:");
-            ESP_LOG_BUFFER_HEXDUMP(TAG, rx_msg.body, rx_msg.body_len, ESP_LOG_DEBUG);
-            break;
+            kbus_msg_release(message);
+            dispatch_trace_id = SYS_TRACE_NO_ID;   // MFL timer commands between frames get their own
+        }
     }
+    vTaskDelete(NULL); // In case we leave the loop, to avoid a panic
 }
 
-static void tel_emulator(kbus_message_t rx_msg) {
-    switch(rx_msg.body[0]) {
-        case DEV_STAT_REQ:
-            ESP_LOGD(TAG, "TEL Received: DEVICE STATUS REQUEST");
-            send_dev_ready(TEL, rx_msg.src, false);
-            ESP_LOGD(TAG, "TEL Queued: DEVICE STATUS READY");
-            return;
-
-        default:
-            ESP_LOGD(TAG, "TEL Received Other Command:");
-            ESP_LOG_BUFFER_HEXDUMP(TAG, rx_msg.body, rx_msg.body_len, ESP_LOG_DEBUG);
-            break;
+static void ignition_handler(kbus_message_t* message) {
+    if(message->body_len != 2 || message->body[0] != IGN_STAT_RPLY) return;
+    sys_power_note_ignition((message->body[1] & IGN_STAT_ON_MASK) != 0);
+
+    // If ignition is set to Pos1_ACC, send device startup packet
+    if(message->body[1] == 0x03) {
+        ESP_LOGI(TAG, "Ignition On...");
+        // TODO: Need to guarantee it's only emitted once before requesting media begin playing
+    //     // Send AVRCP_PLAY command when ignition_status bits set to: Pos1_Acc Pos2_On
+    //     bt_cmd_type_t bt_command = AVRCP_PLAY;
+    //     xQueueSend(bt_cmd_queue, &bt_command, (portTickType)portMAX_DELAY);
     }
 }
 
-static void mfl_handler(uint8_t mfl_cmd[2]) {
-    //? Queue might be overkill for keeping last command
-    static uint8_t *last_mfl_cmd = NULL;
-    bt_cmd_type_t bt_command = BT_CMD_NOOP;
-
-    inline void malloc_last_mfl() {
-        if(last_mfl_cmd == NULL) {
-            ESP_LOGD(TAG, "allocating last_mfl_cmd...");
-            last_mfl_cmd = (uint8_t*) malloc(2 * sizeof(uint8_t));
-        }
-    }
+static void mfl_rx_handler(kbus_message_t* message) {
+    DLOGD("MFL -> 0x%02x Message Received", message->dst);
+    kbus_mfl_feed(message);
+}
 
-    inline void free_last_mfl() {
-        if(last_mfl_cmd) {
-            ESP_LOGD(TAG, "freeing last_mfl_cmd...");
-            free(last_mfl_cmd);
-            last_mfl_cmd = NULL;
-        }   
-    }
+static void tel_emulator(kbus_message_t* rx_msg) {
+    DLOGD("Message for TEL module Received");
+    switch(rx_msg->body[0]) {
+        case DEV_STAT_REQ:
+            DLOGD("TEL Received: DEVICE STATUS REQUEST");
+            send_dev_ready(TEL, rx_msg->src, false);
+            DLOGD("TEL Queued: DEVICE STATUS READY");
+            return;
 
-// TODO: Addresses lend themselves to bit twiddling stuff instead of this. Look into it in a revision ☜(ﾟヮﾟ☜)
-    switch(mfl_cmd[0]) { //? State machine?...
-        case 0x3B:
-            ESP_LOGD(TAG, "MFL -> RAD/TEL Button Event");
-            
-            if(last_mfl_cmd){
-                ESP_LOGD(TAG, "last_mfl_cmd: 0x%02x 0x%02x", last_mfl_cmd[0], last_mfl_cmd[1]);
-            } else {
-                ESP_LOGD(TAG, "last_mfl_cmd: NULL");
-            }
-            malloc_last_mfl();
-
-            switch(mfl_cmd[1]) {
-                //* A button down event received, let's store it.
-                case 0x01:      // "search up pressed"
-                case 0x08:      // "search down pressed"
-                case 0x80: {    // "Send/End pressed"
-                    ESP_LOGD(TAG, "MFL short press");
-                    last_mfl_cmd[0] = mfl_cmd[0];
-                    last_mfl_cmd[1] = mfl_cmd[1];
-                    return; // Return, don't need to take any further action other than storing opening event.
-                }
-
-                //* A long press event
-                case 0x11: // "search up pressed long"
-                    ESP_LOGD(TAG, "MFL Up long press");
-                    if(last_mfl_cmd[1] == mfl_cmd[1]){
-                        return; // Return, this is a repeat long press event.
-                    }
-                    last_mfl_cmd[0] = mfl_cmd[0];
-                    last_mfl_cmd[1] = mfl_cmd[1];
-                    bt_command = AVRCP_FF_START;
-                    break;
-                case 0x18: // "search down pressed long"
-                    ESP_LOGD(TAG, "MFL Down long press");
-                    if(last_mfl_cmd[1] == mfl_cmd[1]){
-                        return; // Return, this is a repeat long press event.
-                    }
-                    last_mfl_cmd[0] = mfl_cmd[0];
-                    last_mfl_cmd[1] = mfl_cmd[1];
-                    bt_command = AVRCP_RWD_START;
-                    break;
-                case 0x90: // "SEND/END pressed long"
-                    ESP_LOGD(TAG, "MFL R/T long press");
-                    if(last_mfl_cmd[1] == mfl_cmd[1]){
-                        return; // Return, this is a repeat long press event.
-                    }
-                    last_mfl_cmd[0] = mfl_cmd[0];
-                    last_mfl_cmd[1] = mfl_cmd[1];
-                    bt_command = AVRCP_PLAY;
-                    break;
-
-                //* A button up event, let's check previous state.
-                case 0x21: // "search up released"
-                case 0x28: // "search down released"
-                case 0xA0: // "SEND/END released"
-                    ESP_LOGD(TAG, "MFL arrow button released");
-                    if(last_mfl_cmd[0] == mfl_cmd[0]){
-                        ESP_LOGD(TAG, "Last BT command matches");
-                        switch(last_mfl_cmd[1]) {
-                            case 0x01:
-                                bt_command = AVRCP_NEXT;
-                                break;
-                            case 0x11:
-                                bt_command = AVRCP_FF_STOP;
-                                break;
-                            case 0x80:
-                                bt_command = AVRCP_STOP;
-                                break;
-                            case 0x90:
-                                // NOOP: Long press AVRCP_PLAY handled during previous event
-                                break;
-                            case 0x08:
-                                bt_command = AVRCP_PREV;
-                                break;
-                            case 0x18:
-                                bt_command = AVRCP_RWD_STOP;
-                                break;
-                            default:
-                                ESP_LOGW(TAG, "Mismatched previous event! Expected 0x%02x, got 0x%02x", last_mfl_cmd[1], mfl_cmd[1]);
-                                free_last_mfl();
-                                break;
-                        }
-                    }
-                    free_last_mfl(); // Button was released, free last_mfl_cmd
-                    break;
-                
-                default:
-                    ESP_LOGD(TAG, "Other MFL -> RAD/TEL Button Event: 0x%02x", mfl_cmd[1]);
-                    // free_last_mfl(); // Command we don't care about, free last_mfl_cmd
-                    break;
-            }
-            break;
         default:
-            ESP_LOGD(TAG, "Other MFL Button Event: 0x%02x 0x%02x", mfl_cmd[0], mfl_cmd[1]);
-            // free_last_mfl(); // last_mfl_cmd should't have been allocated, but try to free anyway
+            DLOG_HEX(D, "TEL Received Other Command:", rx_msg->body, rx_msg->body_len);
             break;
     }
+}
 
-    if(bt_command != BT_CMD_NOOP) { // Only put command on queue if it's a valid one
-        ESP_LOGD(TAG, "Sending BT Command 0x%02x", bt_command);
-        xQueueSend(bt_cmd_queue, &bt_command, (portTickType)portMAX_DELAY);
-    }
+static void send_bt_cmd(bt_cmd_type_t bt_command) {
+    bt_cmd_t command = {
+        .type = bt_command,
+        .trace_id = dispatch_trace_id != SYS_TRACE_NO_ID ? dispatch_trace_id : sys_trace_new_id()
+    };
+
+    DLOGD("Sending BT Command 0x%02x", bt_command);
+    sys_trace(SYS_TRACE_BT_ENQUEUE, command.trace_id, bt_command);
+    sys_tlm_queue_send(bt_cmd_tlm, bt_cmd_queue, &command, (portTickType)portMAX_DELAY);
+#ifdef CONFIG_KBUS_CAPTURE
+    kbus_replay_note_output();
+#endif
 }
 
+#ifdef TEL_DISPLAY
+/**
+ ** Text targets driven by tel_display_task. Each keeps its own rendered frame sequence for its
+ ** width; frames are rendered once per track and only changed frames reach the bus.
+ */
+typedef struct {
+    uint8_t dst;
+    uint8_t cmd;
+    uint8_t layout;
+    uint8_t flags;
+    uint8_t width;
+    kbus_scroll_t scroll;
+} tel_display_target_t;
+
+// The radio's SDRS song and artist fields stay with the SDRS emulator, which owns them
+static tel_display_target_t display_targets[] = {
+#ifdef CONFIG_KBUS_DISPLAY_MID
+    {.dst = IKE, .cmd = UPDATE_MID, .layout = 0x42, .flags = 0x32, .width = KBUS_SCROLL_WIDTH_MID},
+#endif
+#ifdef CONFIG_KBUS_DISPLAY_IKE
+    {.dst = IKE, .cmd = UPDATE_MID, .layout = 0x62, .flags = 0x30, .width = KBUS_SCROLL_WIDTH_IKE},
+#endif
+};
+#define DISPLAY_TARGETS (sizeof(display_targets) / sizeof(display_targets[0]))
+
 static void tel_display_task() {
-    char msg_buf[256];
-    char mid_buf[12];
-    
-    static uint32_t notification;
-    static const uint8_t text_limit = 11;
-    static const uint8_t step_size = 8;
-    
-    uint16_t seconds = 0;
-    uint8_t msg_len = 0;
-    uint8_t msg_pos = 0;
-
-    bool should_scroll = false;
-    bool should_update = false;
-    bool should_display = false;
+    char msg_buf[KBUS_SCROLL_TEXT_MAX];
+    char frame[KBUS_SCROLL_WIDTH_MAX + 1];
+    static sdrs_display_buf_t display;
+    uint32_t display_version = 0;
+    TickType_t wait;
+    bool scrolling, notified = true;   // Show what's already published before the first wait
+
+    for(size_t i = 0; i < DISPLAY_TARGETS; i++) {
+        kbus_scroll_init(&display_targets[i].scroll, display_targets[i].width);
+    }
 
     while(1){
-        xTaskNotifyWait(0x00000000, 0x00000001, &notification, SECONDS(1)); // CLear 0x01 on exit and continue
-        if(notification == 0x01) {
-            should_display = true;
-            should_scroll = false;
-            seconds = 0;
-            msg_pos = 0;
-            bzero(mid_buf, sizeof(mid_buf));
-            bzero(msg_buf, sizeof(msg_buf));
-
-            sprintf(msg_buf, "%s<>%s", sdrs_display_buf->song_disp, sdrs_display_buf->artist_disp);
-            msg_len = strlen(msg_buf);
-
+        sys_power_park();   // No scrolling with nobody to see it
+        if(notified && sdrs_display_version() != display_version) {
+            display_version = sdrs_display_read(&display);
+            snprintf(msg_buf, sizeof(msg_buf), "%s<>%s", display.song_disp, display.artist_disp);
             ESP_LOGI(TAG, "%s", msg_buf);
 
-            if(msg_len > text_limit){
-                should_scroll = true;
+            for(size_t i = 0; i < DISPLAY_TARGETS; i++) {
+                kbus_scroll_set_text(&display_targets[i].scroll, msg_buf);
             }
         }
-        
-        should_update = !(seconds % 15);
-        seconds++;
-
-        if(should_display && should_update){
 
-            if(should_scroll) {
-                if(msg_pos + step_size > msg_len) msg_pos = 0; //Reset to start of buffer
-                strncpy(mid_buf, msg_buf + msg_pos, text_limit); //strncpy pads with 0 if we go beyond \0 delimeter
-                msg_pos+=step_size;
-            
-                ESP_LOGI(TAG, "Scrolling|| %s ||", mid_buf);
-                display_tel_msg(UPDATE_MID, 0x42, 0x32, mid_buf);
+        scrolling = false;
+        for(size_t i = 0; i < DISPLAY_TARGETS; i++) {
+            tel_display_target_t* target = &display_targets[i];
 
-            } else {
-                ESP_LOGI(TAG, "Static|| %s ||", msg_buf);
-                display_tel_msg(UPDATE_MID, 0x42, 0x32, msg_buf);
+            if(kbus_scroll_step(&target->scroll, frame)) {
+                ESP_LOGI(TAG, "%s|| %s ||", kbus_scroll_scrolls(&target->scroll) ? "Scrolling" : "Static", frame);
+                display_tel_msg(target->dst, target->cmd, target->layout, target->flags, frame);
             }
+            scrolling |= kbus_scroll_scrolls(&target->scroll);
         }
+
+        // New track notifications re-render; otherwise wake once per scroll step, or never for static text
+        wait = scrolling ? CONFIG_KBUS_SCROLL_STEP_MS / portTICK_PERIOD_MS : portMAX_DELAY;
+        notified = xTaskNotifyWait(0x00000000, 0x00000001, NULL, wait) == pdTRUE;
     }
+    vTaskDelete(NULL); // In case we leave the loop, to avoid a panic
 }
 
-static void display_tel_msg(uint8_t cmd, uint8_t layout, uint8_t flags, char* text) {
-    uint8_t text_len = strlen(text);
+static void display_tel_msg(uint8_t dst, uint8_t cmd, uint8_t layout, uint8_t flags, const char* text) {
+    uint8_t text_len = strnlen(text, KBUS_BODY_MAX - 3);
 
     kbus_message_t message = {
         .src = TEL,
-        .dst = IKE,
+        .dst = dst,
         .body = {cmd, layout, flags},
         .body_len = 3 + text_len
     };
 
-    message.body_len = 3 + text_len;
-        memcpy(&message.body[3], text, message.body_len - 1);
-        xQueueSend(kbus_tx_queue, &message, (portTickType)portMAX_DELAY);
+    memcpy(&message.body[3], text, text_len);
+    // Newer text replaces whatever hasn't made it onto the bus yet; keyed per field, as IKE has two
+    kbus_tx_submit(&message, KBUS_TX_DISPLAY, KBUS_TX_DISPLAY_DEADLINE_MS, KBUS_TX_KEY(dst, cmd, layout));
 }
+#endif
 
 #ifdef QUEUE_DEBUG
 static void kbus_queue_watcher(){
     #define WATCHER_DELAY 10
 
     uint8_t kb_rx = 0, kb_tx = 0, bt_tx = 0;
+    kbus_msg_pool_stats_t pool_stats;
+    kbus_tx_stats_t tx_stats;
+    kbus_filter_stats_t filter_stats;
+    kbus_sub_stats_t sub_stats;
+    kbus_mfl_stats_t mfl_stats;
+    meta_arena_stats_t arena_stats;
+#ifdef CONFIG_SYS_POWER
+    sys_power_stats_t power_stats;
+#endif
+#ifdef CONFIG_CDC_EMULATOR
+    cdc_emu_stats_t cdc_stats;
+#endif
     vTaskDelay(SECONDS(WATCHER_DELAY));
 
     while(1){
@@ -454,13 +536,59 @@ static void kbus_queue_watcher(){
         printf("kbus-rx\t%d\n", kb_rx);
         printf("kbus-tx\t%d\n", kb_tx);
         printf("bt-tx\t%d\n", bt_tx);
+        kbus_tx_get_stats(&tx_stats);
+        printf("tx-sched\t%d pending (max %d), %"PRIu32" sent, %"PRIu32" superseded, %"PRIu32" expired, %"PRIu32" evicted, %"PRIu32" full\n",
+                tx_stats.pending, tx_stats.pending_max, tx_stats.sent, tx_stats.superseded,
+                tx_stats.dropped_expired, tx_stats.evicted, tx_stats.dropped_full);
+        printf("bus-util\t%d%%, display budget %d B/s, %"PRIu32" display frames deferred\n",
+                tx_stats.bus_util, tx_stats.display_rate, tx_stats.deferred);
+        printf("rx-ring\t%"PRIu32"/%d bytes, %"PRIu32" dropped\n", kbus_ring_used(&rx_ring), KBUS_RX_RING_SIZE, rx_ring.dropped);
+        kbus_rx_filter_get_stats(&filter_stats);
+        printf("rx-filter\t%"PRIu32" passed, %"PRIu32" dropped (%"PRIu32" body bytes)\n",
+                filter_stats.passed, filter_stats.dropped, filter_stats.dropped_bytes);
+        for(kbus_sub_id_t id = 0; kbus_pubsub_get_stats(id, &sub_stats); id++) {
+            if(sub_stats.queued) {
+                printf("sub %-11s	%"PRIu32" queued, %"PRIu32" overflows, lag %d (max %d)\n",
+                        sub_stats.name, sub_stats.delivered, sub_stats.overflows, sub_stats.lag, sub_stats.lag_max);
+            } else {
+                printf("sub %-11s	%"PRIu32" handled\n", sub_stats.name, sub_stats.delivered);
+            }
+        }
+
+        kbus_mfl_get_stats(&mfl_stats);
+        printf("mfl\t%"PRIu32" events, %"PRIu32" commands, %"PRIu32" ignored, %"PRIu32" timed long presses\n",
+                mfl_stats.events, mfl_stats.commands, mfl_stats.ignored, mfl_stats.synthesized);
+
+        meta_arena_get_stats(&arena_stats);
+        printf("meta-arena\t%d strings (max %d), %d/%d bytes (max %d), %d bytes static, %"PRIu32" hits, %"PRIu32" misses, %"PRIu32" failures\n",
+                arena_stats.strings, arena_stats.strings_peak, arena_stats.bytes_used, META_ARENA_SIZE, arena_stats.bytes_peak,
+                arena_stats.arena_bytes, arena_stats.intern_hits, arena_stats.intern_misses, arena_stats.failures);
+
+        kbus_msg_pool_get_stats(&pool_stats);
+        printf("msg-pool\t%d/%d in use (max %d), %"PRIu32" alloc failures\n",
+                pool_stats.in_use, KBUS_MSG_POOL_SIZE, pool_stats.in_use_max, pool_stats.alloc_failures);
+        if(pool_stats.frames_delivered) {
+            printf("bytes-copied/frame\t%"PRIu32"\n", pool_stats.bytes_copied / pool_stats.frames_delivered);
+        }
+#ifdef CONFIG_SYS_POWER
+        sys_power_get_stats(&power_stats);
+        printf("power\t%s, %"PRIu32" sleeps, %"PRIu32" wakes, wake to reply %"PRIu32" us last, %"PRIu32" us max, %"PRIu32" us mean\n",
+                sys_power_state_name(power_stats.state), power_stats.sleeps, power_stats.wakes, power_stats.reply_last_us,
+                power_stats.reply_max_us, power_stats.reply_samples ? power_stats.reply_total_us / power_stats.reply_samples : 0);
+#endif
+#ifdef CONFIG_CDC_EMULATOR
+        cdc_get_stats(&cdc_stats);
+        printf("cdc\t%s disc %d track %d, %"PRIu32" requests, %"PRIu32" commands, reply %"PRIu32" us last, %"PRIu32" us max\n",
+                cdc_play_name(cdc_stats.play), cdc_stats.disc, cdc_stats.track, cdc_stats.requests, cdc_stats.commands,
+                cdc_stats.reply_last_us, cdc_stats.reply_max_us);
+#endif
 
         vTaskDelay(SECONDS(WATCHER_DELAY));
     }
 }
 
 static void create_kbus_queue_watcher(){
-    int task_ret = xTaskCreate(kbus_queue_watcher, "kbus_queue_watcher", 4096, NULL, 5, NULL);
+    int task_ret = SYS_TASK_SPAWN(KBUS_WATCHER, kbus_queue_watcher, NULL);
     if(task_ret != pdPASS){ESP_LOGE(TAG, "kbus_queue_watcher creation failed with: %d", task_ret);}
 }
 #endif
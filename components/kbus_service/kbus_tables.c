@@ -0,0 +1,127 @@
+// Generated by tools/kbus_spec.py from kbus_spec.json; edit the spec, not this file
+#include <stddef.h>
+#include "kbus_tables.h"
+
+static const kbus_field_t dev_stat_rdy_fields[] = {{"after_reset", KBUS_FIELD_U8}};
+static const kbus_field_t vehicle_ctrl_fields[] = {{"job", KBUS_FIELD_HEX}};
+static const kbus_field_t ign_stat_rply_fields[] = {{"state", KBUS_FIELD_U8}};
+static const kbus_field_t ike_sens_stat_rply_fields[] = {{"sensors", KBUS_FIELD_HEX}};
+static const kbus_field_t odmtr_stat_rply_fields[] = {{"km", KBUS_FIELD_HEX}};
+static const kbus_field_t speed_rpm_req_fields[] = {{"half_kmh", KBUS_FIELD_U8}, {"rpm_100", KBUS_FIELD_U8}};
+static const kbus_field_t temp_fields[] = {{"outside_c", KBUS_FIELD_S8}, {"coolant_c", KBUS_FIELD_S8}};
+static const kbus_field_t ike_txt_gong_fields[] = {{"mode", KBUS_FIELD_U8}, {"gong", KBUS_FIELD_U8}, {"text", KBUS_FIELD_TEXT}};
+static const kbus_field_t menu_txt_fields[] = {{"layout", KBUS_FIELD_U8}, {"flags", KBUS_FIELD_U8}, {"index", KBUS_FIELD_U8}, {"text", KBUS_FIELD_TEXT}};
+static const kbus_field_t update_mid_fields[] = {{"layout", KBUS_FIELD_U8}, {"flags", KBUS_FIELD_U8}, {"text", KBUS_FIELD_TEXT}};
+static const kbus_field_t update_anzv_fields[] = {{"field", KBUS_FIELD_U8}, {"flags", KBUS_FIELD_U8}, {"text", KBUS_FIELD_TEXT}};
+static const kbus_field_t tel_leds_fields[] = {{"leds", KBUS_FIELD_U8}};
+static const kbus_field_t tel_status_fields[] = {{"status", KBUS_FIELD_U8}};
+static const kbus_field_t volume_ctrl_fields[] = {{"step", KBUS_FIELD_U8}};
+static const kbus_field_t cd_ctrl_req_fields[] = {{"request", KBUS_FIELD_U8}, {"param", KBUS_FIELD_U8}};
+static const kbus_field_t cd_stat_rply_fields[] = {{"state", KBUS_FIELD_U8}, {"pause", KBUS_FIELD_U8}, {"errors", KBUS_FIELD_U8}, {"discs", KBUS_FIELD_U8}, {"pad", KBUS_FIELD_U8}, {"disc", KBUS_FIELD_U8}, {"track", KBUS_FIELD_U8}};
+static const kbus_field_t mfl_button_fields[] = {{"button", KBUS_FIELD_U8}};
+static const kbus_field_t sdrs_ctrl_req_fields[] = {{"request", KBUS_FIELD_U8}, {"param", KBUS_FIELD_U8}};
+static const kbus_field_t sdrs_stat_rply_fields[] = {{"reply", KBUS_FIELD_U8}, {"data", KBUS_FIELD_HEX}};
+static const kbus_field_t bmbt_butt_1_fields[] = {{"button", KBUS_FIELD_U8}};
+static const kbus_field_t bmbt_butt_2_fields[] = {{"knob", KBUS_FIELD_U8}};
+static const kbus_field_t lamp_stat_rply_fields[] = {{"lamps", KBUS_FIELD_U8}, {"faults_1", KBUS_FIELD_U8}, {"faults_2", KBUS_FIELD_U8}, {"rest", KBUS_FIELD_HEX}};
+
+const char* const kbus_dev_names[256] = {
+    [0x00] = "GM",
+    [0x18] = "CDC",
+    [0x28] = "FUH",
+    [0x30] = "CCM",
+    [0x3B] = "GT",
+    [0x3F] = "DIA",
+    [0x40] = "FBZV",
+    [0x43] = "GTF",
+    [0x44] = "EWS",
+    [0x46] = "CID",
+    [0x50] = "MFL",
+    [0x51] = "MM_0",
+    [0x5B] = "IHK",
+    [0x60] = "PDC",
+    [0x67] = "ONL",
+    [0x68] = "RAD",
+    [0x6A] = "DSP",
+    [0x70] = "RDC",
+    [0x72] = "SM_0",
+    [0x73] = "SDRS",
+    [0x74] = "SOR",
+    [0x76] = "CDCD",
+    [0x7F] = "NAVE",
+    [0x80] = "IKE",
+    [0x9B] = "MM_1",
+    [0x9C] = "MM_2",
+    [0xA0] = "FMID",
+    [0xA4] = "ABM",
+    [0xA8] = "KAM",
+    [0xAC] = "ASP",
+    [0xB0] = "SES",
+    [0xBB] = "NAVJ",
+    [0xBF] = "GLO",
+    [0xC0] = "MID",
+    [0xC8] = "TEL",
+    [0xD0] = "LCM",
+    [0xDA] = "SM_1",
+    [0xE0] = "IRIS",
+    [0xE7] = "ANZV",
+    [0xE8] = "RLS",
+    [0xED] = "TV",
+    [0xF0] = "BMBT",
+    [0xF5] = "CSU",
+    [0xFF] = "LOC",
+};
+
+const kbus_cmd_info_t kbus_cmds[256] = {
+    [0x01] = {"DEV_STAT_REQ", 1, 1, 0, NULL},
+    [0x02] = {"DEV_STAT_RDY", 2, 2, 1, dev_stat_rdy_fields},
+    [0x03] = {"BUS_STAT_REQ", 1, 255, 0, NULL},
+    [0x04] = {"BUS_STAT_RPLY", 1, 255, 0, NULL},
+    [0x06] = {"DIAG_READ_MEM", 1, 255, 0, NULL},
+    [0x07] = {"DIAG_WRTE_MEM_1", 1, 255, 0, NULL},
+    [0x08] = {"DIAG_READ_CODING", 1, 255, 0, NULL},
+    [0x09] = {"DIAG_WRTE_MEM_2", 1, 255, 0, NULL},
+    [0x0C] = {"VEHICLE_CTRL", 2, 255, 1, vehicle_ctrl_fields},
+    [0x10] = {"IGN_STAT_REQ", 1, 1, 0, NULL},
+    [0x11] = {"IGN_STAT_RPLY", 2, 2, 1, ign_stat_rply_fields},
+    [0x12] = {"IKE_SENS_STAT_REQ", 1, 1, 0, NULL},
+    [0x13] = {"IKE_SENS_STAT_RPLY", 2, 255, 1, ike_sens_stat_rply_fields},
+    [0x14] = {"CTRY_CODE_STAT_REQ", 1, 1, 0, NULL},
+    [0x15] = {"CTRY_CODE_STAT_RPLY", 1, 255, 0, NULL},
+    [0x16] = {"ODMTR_STAT_REQ", 1, 1, 0, NULL},
+    [0x17] = {"ODMTR_STAT_RPLY", 4, 255, 1, odmtr_stat_rply_fields},
+    [0x18] = {"SPEED_RPM_REQ", 3, 3, 2, speed_rpm_req_fields},
+    [0x19] = {"TEMP", 3, 4, 2, temp_fields},
+    [0x1A] = {"IKE_TXT_GONG", 3, 255, 3, ike_txt_gong_fields},
+    [0x1B] = {"IKE_TXT_STAT", 1, 255, 0, NULL},
+    [0x1C] = {"GONG", 1, 255, 0, NULL},
+    [0x1D] = {"TEMP_REQ", 1, 255, 0, NULL},
+    [0x1F] = {"UTC_DATE_TIME", 1, 255, 0, NULL},
+    [0x20] = {"DISPLAY_STATUS", 1, 255, 0, NULL},
+    [0x21] = {"MENU_TXT", 4, 255, 4, menu_txt_fields},
+    [0x22] = {"TXT_DISPLAY_CONF", 1, 255, 0, NULL},
+    [0x23] = {"UPDATE_MID", 3, 255, 3, update_mid_fields},
+    [0x24] = {"UPDATE_ANZV", 3, 255, 3, update_anzv_fields},
+    [0x2A] = {"OBC_UPDATE", 1, 255, 0, NULL},
+    [0x2B] = {"TEL_LEDS", 2, 2, 1, tel_leds_fields},
+    [0x2C] = {"TEL_STATUS", 2, 2, 1, tel_status_fields},
+    [0x32] = {"VOLUME_CTRL", 2, 2, 1, volume_ctrl_fields},
+    [0x34] = {"DSP_EQ_BUTT", 1, 255, 0, NULL},
+    [0x38] = {"CD_CTRL_REQ", 3, 3, 2, cd_ctrl_req_fields},
+    [0x39] = {"CD_STAT_RPLY", 8, 8, 7, cd_stat_rply_fields},
+    [0x3B] = {"MFL_BUTTON", 2, 2, 1, mfl_button_fields},
+    [0x3D] = {"SDRS_CTRL_REQ", 2, 255, 2, sdrs_ctrl_req_fields},
+    [0x3E] = {"SDRS_STAT_RPLY", 2, 255, 2, sdrs_stat_rply_fields},
+    [0x40] = {"OBC_SET_DATA", 1, 255, 0, NULL},
+    [0x41] = {"OBC_DATA_REQ", 1, 255, 0, NULL},
+    [0x48] = {"BMBT_BUTT_1", 2, 2, 1, bmbt_butt_1_fields},
+    [0x49] = {"BMBT_BUTT_2", 2, 2, 1, bmbt_butt_2_fields},
+    [0x4F] = {"TV_RGB_CTL", 1, 255, 0, NULL},
+    [0x53] = {"VEHICLE_STAT_REQ", 1, 1, 0, NULL},
+    [0x54] = {"VEHICLE_STAT_RPLY", 1, 255, 0, NULL},
+    [0x5A] = {"LAMP_STAT_REQ", 1, 1, 0, NULL},
+    [0x5B] = {"LAMP_STAT_RPLY", 4, 255, 4, lamp_stat_rply_fields},
+    [0x71] = {"RIP_STAT_REQ", 1, 255, 0, NULL},
+    [0xA0] = {"DIAG_DATA", 1, 255, 0, NULL},
+    [0xAA] = {"NAV_CTL", 1, 255, 0, NULL},
+};
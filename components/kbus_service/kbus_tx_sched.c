@@ -0,0 +1,275 @@
+// C stdlib includes
+#include <stddef.h>
+#include <string.h>
+
+// FreeRTOS includes
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+// esp-idf includes
+#include "esp_log.h"
+
+// component includes
+#include "kbus_tx_sched.h"
+#include "kbus_defines.h"
+#include "sys_monitor.h"
+#include "sys_topology.h"
+#include "sys_telemetry.h"
+#include "sys_trace.h"
+#include "sys_power.h"
+#include "kbus_service.h"
+
+#define UTIL_WINDOW_MS 100      // Utilization is measured per window, then smoothed
+#define KBUS_WIRE_BYTES(body_len) ((body_len) + KBUS_FRAME_OVERHEAD)
+
+typedef struct {
+    kbus_message_t msg;
+    uint32_t key;
+    uint32_t seq;           // Submit order, oldest goes first within a class
+    TickType_t expires;     // 0 if none
+    uint16_t trace_id;
+    uint8_t tx_class;
+    bool used;
+    bool deferred;
+} tx_slot_t;
+
+static const char* TAG = "kbus_tx";
+static QueueHandle_t driver_queue;
+static sys_tlm_id_t driver_tlm = SYS_TLM_NONE;
+static TaskHandle_t tx_pump_tsk = NULL;
+
+static tx_slot_t slots[KBUS_TX_SLOTS];
+static uint32_t next_seq = 0;
+static kbus_tx_stats_t tx_stats;
+static portMUX_TYPE tx_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// Utilization estimate && display token bucket, all under tx_mux
+static TickType_t util_window_start = 0;
+static uint32_t util_window_busy_us = 0;
+static uint32_t display_tokens = CONFIG_KBUS_TX_DISPLAY_BURST * 1000UL;   // milli-bytes
+static TickType_t display_refilled = 0;
+
+static void tx_pump_task();
+
+static inline bool expired(const tx_slot_t* slot, TickType_t now) {
+    return slot->expires != 0 && (int32_t)(now - slot->expires) >= 0;
+}
+
+// Lower class wins, then lower seq. Returns true if a is more urgent than b.
+static inline bool more_urgent(const tx_slot_t* a, const tx_slot_t* b) {
+    if(a->tx_class != b->tx_class) return a->tx_class < b->tx_class;
+    return (int32_t)(a->seq - b->seq) < 0;
+}
+
+// Close finished windows into the smoothed estimate; windows with no rx at all count as idle
+static void roll_util_window(TickType_t now) {
+    uint32_t elapsed_ms = (now - util_window_start) * portTICK_PERIOD_MS;
+    uint32_t util;
+
+    if(elapsed_ms < UTIL_WINDOW_MS) return;
+
+    util = util_window_busy_us / (elapsed_ms * 10);    // busy_us * 100 / (elapsed_ms * 1000)
+    if(util > 100) util = 100;
+    tx_stats.bus_util = (tx_stats.bus_util * 3 + util) / 4;
+
+    for(uint32_t idle = elapsed_ms / UTIL_WINDOW_MS; idle > 1 && tx_stats.bus_util; idle--) {
+        tx_stats.bus_util = tx_stats.bus_util * 3 / 4;
+    }
+
+    util_window_start = now;
+    util_window_busy_us = 0;
+}
+
+// Display budget scales down linearly with utilization, hitting zero at CONFIG_KBUS_TX_PACE_UTIL_MAX
+static uint32_t display_rate() {
+    if(tx_stats.bus_util >= CONFIG_KBUS_TX_PACE_UTIL_MAX) return 0;
+    return CONFIG_KBUS_TX_DISPLAY_BUDGET * (CONFIG_KBUS_TX_PACE_UTIL_MAX - tx_stats.bus_util) / CONFIG_KBUS_TX_PACE_UTIL_MAX;
+}
+
+// Spend budget for a display frame. If there isn't enough, *wait is how long until there will be
+static bool display_take(uint8_t body_len, TickType_t now, TickType_t* wait) {
+    uint32_t cost = KBUS_WIRE_BYTES(body_len) * 1000UL;
+    uint32_t rate = display_rate();
+    uint32_t elapsed_ms = (now - display_refilled) * portTICK_PERIOD_MS;
+
+    if(CONFIG_KBUS_TX_DISPLAY_BUDGET == 0) return true;    // Pacing off
+
+    if(elapsed_ms > 60000) elapsed_ms = 60000;   // Bucket is long full by then; keeps the product in range
+    display_tokens += elapsed_ms * rate;         // bytes/s == milli-bytes/ms
+    if(display_tokens > CONFIG_KBUS_TX_DISPLAY_BURST * 1000UL) display_tokens = CONFIG_KBUS_TX_DISPLAY_BURST * 1000UL;
+    display_refilled = now;
+    tx_stats.display_rate = rate > 255 ? 255 : rate;
+
+    // Frames bigger than the bucket go out once it's full
+    if(cost > CONFIG_KBUS_TX_DISPLAY_BURST * 1000UL) cost = CONFIG_KBUS_TX_DISPLAY_BURST * 1000UL;
+    if(display_tokens >= cost) {
+        display_tokens -= cost;
+        return true;
+    }
+
+    *wait = rate ? pdMS_TO_TICKS((cost - display_tokens) / rate + 1) : pdMS_TO_TICKS(UTIL_WINDOW_MS);
+    return false;
+}
+
+void kbus_tx_sched_init(QueueHandle_t driver_tx_queue) {
+    driver_queue = driver_tx_queue;
+    driver_tlm = sys_tlm_queue_register("kbus_tx");
+
+    int tsk_ret = SYS_TASK_SPAWN(KBUS_TX, tx_pump_task, &tx_pump_tsk);
+    if(tsk_ret != pdPASS){ ESP_LOGE(TAG, "kbus_tx creation failed with: %d", tsk_ret);}
+}
+
+bool kbus_tx_submit(const kbus_message_t* message, kbus_tx_class_t tx_class, uint32_t deadline_ms, uint32_t supersede_key) {
+    TickType_t now = xTaskGetTickCount();
+    tx_slot_t* slot = NULL;
+    tx_slot_t* victim = NULL;
+    bool superseded = false;
+    TickType_t expires;
+    uint16_t trace_id = kbus_trace_id();
+
+    if(tx_class >= KBUS_TX_CLASSES) tx_class = KBUS_TX_DISPLAY;
+    // Replies carry the request's id; anything else starts its own trace here
+    if(trace_id == SYS_TRACE_NO_ID) trace_id = sys_trace_new_id();
+    sys_trace(SYS_TRACE_TX_SUBMIT, trace_id, message->dst << 8 | message->body[0]);
+
+    portENTER_CRITICAL(&tx_mux);
+    tx_stats.submitted++;
+
+    for(int i = 0; i < KBUS_TX_SLOTS; i++) {
+        tx_slot_t* s = &slots[i];
+        if(!s->used) {
+            if(slot == NULL) slot = s;
+            continue;
+        }
+        if(supersede_key != KBUS_TX_NO_KEY && s->key == supersede_key) {
+            slot = s;
+            superseded = true;
+            break;
+        }
+        // Track the least urgent pending frame in case we need to evict
+        if(victim == NULL || more_urgent(victim, s)) victim = s;
+    }
+
+    if(slot == NULL) {
+        if(victim != NULL && victim->tx_class > tx_class) {
+            slot = victim;
+            tx_stats.evicted++;
+        } else {
+            tx_stats.dropped_full++;
+            portEXIT_CRITICAL(&tx_mux);
+            ESP_LOGW(TAG, "TX full, dropped 0x%02x -> 0x%02x", message->src, message->dst);
+            return false;
+        }
+    } else if(superseded) {
+        tx_stats.superseded++;
+    } else {
+        tx_stats.pending++;
+        if(tx_stats.pending > tx_stats.pending_max) tx_stats.pending_max = tx_stats.pending;
+    }
+
+    expires = deadline_ms ? now + pdMS_TO_TICKS(deadline_ms) : 0;
+    if(expires == 0 && deadline_ms) expires = 1; // 0 is reserved for "no deadline"
+    if(superseded) {
+        // New content, but no later or less urgent than the frame it replaces was due
+        if(slot->tx_class < tx_class) tx_class = slot->tx_class;
+        if(slot->expires != 0 && (expires == 0 || (int32_t)(slot->expires - expires) < 0)) expires = slot->expires;
+    }
+
+    memcpy(&slot->msg, message, sizeof(kbus_message_t));
+    slot->key = supersede_key;
+    slot->trace_id = trace_id;
+    slot->tx_class = tx_class;
+    slot->expires = expires;
+    if(!superseded) {
+        slot->seq = next_seq++;     // A superseding frame keeps its place in line
+        slot->deferred = false;
+    }
+    slot->used = true;
+    portEXIT_CRITICAL(&tx_mux);
+
+    xTaskNotifyGive(tx_pump_tsk);
+    return true;
+}
+
+void kbus_tx_note_rx(uint8_t body_len) {
+    TickType_t now = xTaskGetTickCount();
+
+    portENTER_CRITICAL(&tx_mux);
+    roll_util_window(now);
+    util_window_busy_us += KBUS_WIRE_US(body_len);
+    portEXIT_CRITICAL(&tx_mux);
+}
+
+void kbus_tx_get_stats(kbus_tx_stats_t* stats) {
+    portENTER_CRITICAL(&tx_mux);
+    roll_util_window(xTaskGetTickCount());
+    memcpy(stats, &tx_stats, sizeof(kbus_tx_stats_t));
+    portEXIT_CRITICAL(&tx_mux);
+}
+
+/**
+ ** Pull the most urgent live frame out of the table; false if nothing is pending or the
+ ** most urgent frame is display traffic that's over budget. *wait is how long the pump
+ ** may sleep before something could become sendable without a new submit.
+ */
+static bool take_next(kbus_message_t* out, uint16_t* trace_id, TickType_t* wait) {
+    TickType_t now = xTaskGetTickCount();
+    tx_slot_t* best = NULL;
+
+    *wait = portMAX_DELAY;
+
+    portENTER_CRITICAL(&tx_mux);
+    roll_util_window(now);
+    for(int i = 0; i < KBUS_TX_SLOTS; i++) {
+        tx_slot_t* s = &slots[i];
+        if(!s->used) continue;
+
+        if(expired(s, now)) {
+            s->used = false;
+            tx_stats.pending--;
+            tx_stats.dropped_expired++;
+            continue;
+        }
+        if(best == NULL || more_urgent(s, best)) best = s;
+    }
+
+    // Only display frames are paced, and they're the least urgent, so nothing else is waiting behind this one
+    if(best != NULL && best->tx_class == KBUS_TX_DISPLAY && !display_take(best->msg.body_len, now, wait)) {
+        if(!best->deferred) tx_stats.deferred++;
+        best->deferred = true;
+        best = NULL;
+    }
+
+    if(best != NULL) {
+        memcpy(out, &best->msg, sizeof(kbus_message_t));
+        *trace_id = best->trace_id;
+        best->used = false;
+        tx_stats.pending--;
+    }
+    portEXIT_CRITICAL(&tx_mux);
+
+    return best != NULL;
+}
+
+static void tx_pump_task() {
+    kbus_message_t message;
+    uint16_t trace_id;
+    TickType_t wait = portMAX_DELAY;
+
+    while(1) {
+        ulTaskNotifyTake(pdTRUE, wait);
+
+        // Driver queue is kept shallow, so the choice of what goes next is made here, as late as possible
+        while(take_next(&message, &trace_id, &wait)) {
+            sys_tlm_queue_send(driver_tlm, driver_queue, &message, (portTickType)portMAX_DELAY);
+            sys_trace(SYS_TRACE_TX_HANDOFF, trace_id, message.dst << 8 | message.body[0]);
+            sys_power_note_tx();
+
+            portENTER_CRITICAL(&tx_mux);
+            tx_stats.sent++;
+            portEXIT_CRITICAL(&tx_mux);
+        }
+    }
+    vTaskDelete(NULL); // In case we leave the loop, to avoid a panic
+}
@@ -0,0 +1,83 @@
+// C stdlib includes
+#include <stddef.h>
+#include <string.h>
+
+// FreeRTOS includes
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+// esp-idf includes
+#include "esp_log.h"
+
+// component includes
+#include "kbus_defines.h"
+#include "kbus_virtual_bus.h"
+#include "sys_monitor.h"
+#include "sys_topology.h"
+
+static const char* TAG = "kbus_vbus";
+static QueueHandle_t vbus_rx_queue;
+static QueueHandle_t vbus_tx_queue;
+static kbus_filter_t* vbus_rx_filter;
+static kbus_vbus_tx_hook_t tx_hook = NULL;
+static kbus_vbus_stats_t vbus_stats;
+
+static void vbus_tx_task();
+
+void init_kbus_virtual_bus(QueueHandle_t rx_queue, QueueHandle_t tx_queue, kbus_filter_t* rx_filter) {
+    vbus_rx_queue = rx_queue;
+    vbus_tx_queue = tx_queue;
+    vbus_rx_filter = rx_filter;
+
+    int tsk_ret = SYS_TASK_SPAWN(KBUS_VBUS_TX, vbus_tx_task, NULL);
+    if(tsk_ret != pdPASS){ ESP_LOGE(TAG, "kbus_vbus_tx creation failed with: %d", tsk_ret);}
+
+    ESP_LOGW(TAG, "Virtual K-bus enabled, UART driver not started");
+}
+
+bool kbus_virtual_bus_inject(const kbus_message_t* message, TickType_t ticks_to_wait) {
+    // "On the wire" either way, so it counts as accepted
+    if(vbus_rx_filter != NULL && !kbus_filter_admit(vbus_rx_filter, message)) {
+        vbus_stats.rx_filtered++;
+        return true;
+    }
+    if(xQueueSend(vbus_rx_queue, message, ticks_to_wait) != pdTRUE) {
+        vbus_stats.rx_dropped++;
+        return false;
+    }
+    vbus_stats.rx_frames++;
+    return true;
+}
+
+void kbus_virtual_bus_set_tx_hook(kbus_vbus_tx_hook_t hook) {
+    tx_hook = hook;
+}
+
+void kbus_virtual_bus_get_stats(kbus_vbus_stats_t* stats) {
+    memcpy(stats, &vbus_stats, sizeof(kbus_vbus_stats_t));
+}
+
+static void vbus_tx_task() {
+    kbus_message_t message;
+    kbus_vbus_tx_hook_t hook;
+
+    while(1) {
+        if(xQueueReceive(vbus_tx_queue, (void * )&message, (portTickType)portMAX_DELAY)) {
+#ifdef CONFIG_KBUS_VIRTUAL_BUS_WIRE_TIME
+            // Round up to whole ticks; close enough at 1kHz for a ~1ms/byte bus
+            vTaskDelay((KBUS_WIRE_US(message.body_len) / 1000 / portTICK_PERIOD_MS) + 1);
+#endif
+            vbus_stats.tx_frames++;
+            vbus_stats.tx_bytes += message.body_len + KBUS_FRAME_OVERHEAD;
+
+            hook = tx_hook;
+            if(hook != NULL) hook(&message);
+
+#ifdef CONFIG_KBUS_VIRTUAL_BUS_ECHO
+            kbus_virtual_bus_inject(&message, 0);
+#endif
+        }
+    }
+    vTaskDelete(NULL); // In case we leave the loop, to avoid a panic
+}
@@ -0,0 +1,53 @@
+#ifndef META_ARENA_H
+#define META_ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ ** Interned string arena for now-playing metadata (title, artist, album).
+ ** Each distinct string is stored once, with its length and hash, and passed around as a
+ ** one byte handle. Equal strings get the same handle, so comparing metadata is comparing
+ ** handles. Handles are refcounted; whoever holds one owns a reference and releases it.
+ ** Strings move when the arena compacts, so text is only reached by copying it out.
+ ** All calls are safe from any task.
+ */
+#define META_ARENA_SIZE     768     // Bytes of string storage; two tracks' worth of max length strings
+#define META_ARENA_ENTRIES  16      // Distinct strings alive at once
+#define META_STR_MAX        127     // Longer strings are cut, on a UTF-8 character boundary
+
+typedef uint8_t meta_handle_t;
+#define META_NONE 0
+
+typedef struct {
+    uint16_t bytes_used;        // Live string bytes
+    uint16_t bytes_peak;
+    uint16_t arena_bytes;       // Static footprint: storage plus entry table
+    uint8_t strings;            // Live strings
+    uint8_t strings_peak;
+    uint32_t intern_hits;       // Interned strings that were already stored
+    uint32_t intern_misses;
+    uint32_t compactions;
+    uint32_t failures;          // Interns refused for lack of space or entries
+} meta_arena_stats_t;
+
+// Returns a handle holding one reference, META_NONE if empty or out of space
+meta_handle_t meta_intern(const char* str, size_t len);
+
+meta_handle_t meta_retain(meta_handle_t handle);
+void meta_release(meta_handle_t handle);
+
+// For handles shared through a variable: swap in a new handle (taking over its reference)
+// and release the old one, or read the variable and take a reference, in one step
+void meta_assign(meta_handle_t* slot, meta_handle_t handle);
+meta_handle_t meta_load(meta_handle_t* slot);
+
+// Copies the string NUL terminated, cut to out_size; returns the length copied
+size_t meta_copy(meta_handle_t handle, char* out, size_t out_size);
+uint8_t meta_len(meta_handle_t handle);
+uint32_t meta_hash(meta_handle_t handle);
+
+void meta_arena_get_stats(meta_arena_stats_t* stats);
+
+#endif //META_ARENA_H
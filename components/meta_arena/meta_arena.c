@@ -0,0 +1,206 @@
+// C stdlib includes
+#include <stddef.h>
+#include <string.h>
+
+// FreeRTOS includes
+#include "freertos/FreeRTOS.h"
+
+// esp-idf includes
+#include "esp_log.h"
+
+// component includes
+#include "meta_arena.h"
+
+typedef struct {
+    uint32_t hash;
+    uint16_t off;
+    uint8_t len;
+    uint8_t refs;       // 0 if the entry is free
+} meta_entry_t;
+
+static const char* TAG = "meta_arena";
+
+// Strings are packed from the bottom; space of released strings is reclaimed by compacting
+static char arena[META_ARENA_SIZE];
+static uint16_t arena_top = 0;
+static meta_entry_t entries[META_ARENA_ENTRIES];
+static meta_arena_stats_t arena_stats;
+static portMUX_TYPE arena_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static inline meta_entry_t* entry(meta_handle_t handle) {
+    if(handle == META_NONE || handle > META_ARENA_ENTRIES || entries[handle - 1].refs == 0) return NULL;
+    return &entries[handle - 1];
+}
+
+// FNV-1a
+static uint32_t hash_str(const char* str, size_t len) {
+    uint32_t hash = 2166136261UL;
+    for(size_t i = 0; i < len; i++) {
+        hash = (hash ^ (uint8_t)str[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+// Slide live strings down over released ones, keeping their order
+static void compact() {
+    uint16_t top = 0, floor = 0;
+    meta_entry_t* next;
+
+    while(1) {
+        next = NULL;
+        for(int i = 0; i < META_ARENA_ENTRIES; i++) {
+            if(entries[i].refs && entries[i].off >= floor && (next == NULL || entries[i].off < next->off)) next = &entries[i];
+        }
+        if(next == NULL) break;
+
+        floor = next->off + 1;
+        if(next->off != top) memmove(&arena[top], &arena[next->off], next->len);
+        next->off = top;
+        top += next->len;
+    }
+    arena_top = top;
+    arena_stats.compactions++;
+}
+
+static void release_locked(meta_handle_t handle) {
+    meta_entry_t* e = entry(handle);
+
+    if(e == NULL) return;
+    if(--e->refs == 0) {
+        arena_stats.bytes_used -= e->len;
+        arena_stats.strings--;
+    }
+}
+
+meta_handle_t meta_intern(const char* str, size_t len) {
+    uint32_t hash;
+    meta_entry_t* free_entry = NULL;
+    meta_handle_t handle = META_NONE;
+
+    if(str == NULL || len == 0) return META_NONE;
+    if(len > META_STR_MAX) {
+        len = META_STR_MAX;
+        while(len && ((uint8_t)str[len] & 0xC0) == 0x80) len--;    // Don't split a UTF-8 sequence
+    }
+    hash = hash_str(str, len);
+
+    portENTER_CRITICAL(&arena_mux);
+    for(int i = 0; i < META_ARENA_ENTRIES; i++) {
+        meta_entry_t* e = &entries[i];
+        if(e->refs == 0) {
+            if(free_entry == NULL) free_entry = e;
+            continue;
+        }
+        if(e->hash == hash && e->len == len && !memcmp(&arena[e->off], str, len)) {
+            e->refs++;
+            arena_stats.intern_hits++;
+            handle = i + 1;
+            break;
+        }
+    }
+
+    if(handle == META_NONE) {
+        arena_stats.intern_misses++;
+        if(free_entry != NULL && arena_top + len > META_ARENA_SIZE) compact();
+
+        if(free_entry == NULL || arena_top + len > META_ARENA_SIZE) {
+            arena_stats.failures++;
+        } else {
+            memcpy(&arena[arena_top], str, len);
+            free_entry->off = arena_top;
+            free_entry->len = len;
+            free_entry->hash = hash;
+            free_entry->refs = 1;
+            arena_top += len;
+            handle = (free_entry - entries) + 1;
+
+            arena_stats.bytes_used += len;
+            arena_stats.strings++;
+            if(arena_stats.bytes_used > arena_stats.bytes_peak) arena_stats.bytes_peak = arena_stats.bytes_used;
+            if(arena_stats.strings > arena_stats.strings_peak) arena_stats.strings_peak = arena_stats.strings;
+        }
+    }
+    portEXIT_CRITICAL(&arena_mux);
+
+    if(handle == META_NONE) ESP_LOGW(TAG, "Arena full, dropped %d byte string", (int)len);
+    return handle;
+}
+
+meta_handle_t meta_retain(meta_handle_t handle) {
+    meta_entry_t* e;
+
+    portENTER_CRITICAL(&arena_mux);
+    e = entry(handle);
+    if(e != NULL) e->refs++;
+    portEXIT_CRITICAL(&arena_mux);
+
+    return e != NULL ? handle : META_NONE;
+}
+
+void meta_release(meta_handle_t handle) {
+    portENTER_CRITICAL(&arena_mux);
+    release_locked(handle);
+    portEXIT_CRITICAL(&arena_mux);
+}
+
+void meta_assign(meta_handle_t* slot, meta_handle_t handle) {
+    meta_handle_t old;
+
+    portENTER_CRITICAL(&arena_mux);
+    old = *slot;
+    *slot = handle;
+    release_locked(old);
+    portEXIT_CRITICAL(&arena_mux);
+}
+
+meta_handle_t meta_load(meta_handle_t* slot) {
+    meta_handle_t handle;
+    meta_entry_t* e;
+
+    portENTER_CRITICAL(&arena_mux);
+    handle = *slot;
+    e = entry(handle);
+    if(e != NULL) e->refs++;
+    portEXIT_CRITICAL(&arena_mux);
+
+    return e != NULL ? handle : META_NONE;
+}
+
+size_t meta_copy(meta_handle_t handle, char* out, size_t out_size) {
+    meta_entry_t* e;
+    size_t len = 0;
+
+    if(out_size == 0) return 0;
+
+    portENTER_CRITICAL(&arena_mux);
+    e = entry(handle);
+    if(e != NULL) {
+        len = e->len;
+        if(len > out_size - 1) {
+            len = out_size - 1;
+            while(len && ((uint8_t)arena[e->off + len] & 0xC0) == 0x80) len--;
+        }
+        memcpy(out, &arena[e->off], len);
+    }
+    portEXIT_CRITICAL(&arena_mux);
+
+    out[len] = '\0';
+    return len;
+}
+
+uint8_t meta_len(meta_handle_t handle) {
+    meta_entry_t* e = entry(handle);
+    return e != NULL ? e->len : 0;
+}
+
+uint32_t meta_hash(meta_handle_t handle) {
+    meta_entry_t* e = entry(handle);
+    return e != NULL ? e->hash : 0;
+}
+
+void meta_arena_get_stats(meta_arena_stats_t* stats) {
+    portENTER_CRITICAL(&arena_mux);
+    memcpy(stats, &arena_stats, sizeof(meta_arena_stats_t));
+    portEXIT_CRITICAL(&arena_mux);
+    stats->arena_bytes = sizeof(arena) + sizeof(entries);
+}
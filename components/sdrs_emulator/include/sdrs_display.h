@@ -0,0 +1,39 @@
+#ifndef SDRS_DISPLAY_H
+#define SDRS_DISPLAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    char chan_disp[128];
+    char song_disp[128];
+    char artist_disp[64];
+    char esn_disp[32];
+} sdrs_display_buf_t;
+
+/**
+ ** Now playing / display text shared between bt_info_task (the only writer) and the display
+ ** readers (tel_display_task, the SDRS emulator). Triple buffered: a publish fills a spare
+ ** buffer and swaps it in, readers copy out whichever buffer is current when they start, so a
+ ** snapshot never mixes fields from two tracks. Readers are wait-free, two atomic adds around
+ ** the copy and never a retry; the writer waits only for a reader still copying out of the
+ ** buffer it's about to reuse. tools/host/sdrs_display_stress checks it for torn reads.
+ */
+
+// Single writer only; may block for a reader preempted mid-copy
+void sdrs_display_publish(const sdrs_display_buf_t* next);
+
+// Copies a consistent snapshot to out; returns its version. Wait-free
+uint32_t sdrs_display_read(sdrs_display_buf_t* out);
+
+// Called from the writer's task right after each publish; keep it short, e.g. notify a task
+typedef void (*sdrs_display_cb_t)(uint32_t version);
+#define SDRS_DISPLAY_MAX_SUBSCRIBERS 4
+
+// Subscribers are never removed; registering while the writer runs is fine
+bool sdrs_display_subscribe(sdrs_display_cb_t callback);
+
+// Version of the latest publish; compare to the version of a previous read to skip unchanged work
+uint32_t sdrs_display_version();
+
+#endif //SDRS_DISPLAY_H
@@ -1,6 +1,8 @@
 #ifndef SDRS_EMULATOR_H
 #define SDRS_EMULATOR_H
 
+#include "sdrs_display.h"
+
 // SDRS Common Subcommands
 #define SDRS_POWER_MODE     0x00
 #define SDRS_HEARTBEAT      0x02
@@ -21,13 +23,5 @@
 #define SDRS_UPDATE_TXT     0x01
 #define SDRS_CHAN_DN_ACK    0x03
 
-typedef struct {
-    char chan_disp[128];
-    char song_disp[128];
-    char artist_disp[64];
-    char esn_disp[32];
-} sdrs_display_buf_t;
-
-void sdrs_init_emulation(QueueHandle_t kbus_tx_queue, sdrs_display_buf_t* display_buffer);
-uint8_t sdrs_enqueue_msg(void* message, TickType_t ticksToWait);
+void sdrs_init_emulation();
 #endif //SDRS_EMULATOR_H
@@ -0,0 +1,77 @@
+#ifndef SDRS_SCHED_H
+#define SDRS_SCHED_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ ** SDRS emulator deadlines: the channel text that follows a status or channel reply, and
+ ** track text pushed while SAT is the radio's source. emu_task sleeps on sdrs_sched_wait()
+ ** and sends whatever sdrs_sched_service() says is due. Times are ticks from the caller's
+ ** clock, compared wrap-safe; no FreeRTOS or esp-idf in it, so tools/sdrs_sched_check.c runs
+ ** the same code on a simulated clock.
+ */
+#define SDRS_TEXT_FOLLOWUP_MS   1000    // Channel text goes out this long after a status/channel change reply
+#define SDRS_ACTIVE_TIMEOUT_MS  10000   // SAT counts as the radio's source while it keeps polling at least this often
+#define SDRS_PUSH_MIN_MS        1000    // Pushed track text goes out at most this often
+
+#define SDRS_SCHED_FOREVER      UINT32_MAX  // Nothing pending; portMAX_DELAY on the target
+
+typedef struct {
+    uint32_t followup_ticks;
+    uint32_t active_ticks;
+    uint32_t push_min_ticks;
+
+    // Deferred channel text follow-up
+    struct {
+        bool pending;
+        uint8_t dst;
+        uint32_t due;
+    } chan_text;
+
+    // Radio currently polling us; SAT is its active source
+    struct {
+        bool active;
+        uint8_t dst;
+        uint32_t last_poll;
+    } source;
+
+    // Track text pushed on now-playing changes, instead of waiting for the radio to ask
+    struct {
+        bool pending;
+        uint32_t due;
+        uint32_t changed_at;
+        uint32_t last_push;
+        uint32_t pushed_version;
+    } text_push;
+} sdrs_sched_t;
+
+// What sdrs_sched_service() found due
+typedef struct {
+    bool chan_text;         // Channel text to chan_dst
+    bool track_text;        // Song and artist to track_dst; confirm with sdrs_sched_pushed()
+    uint8_t chan_dst;
+    uint8_t track_dst;
+} sdrs_due_t;
+
+// The three intervals in the caller's ticks; the first track text may be pushed right away
+void sdrs_sched_init(sdrs_sched_t* sched, uint32_t followup_ticks, uint32_t active_ticks, uint32_t push_min_ticks, uint32_t now);
+
+// Every SDRS_CTRL_REQ; active is false for the radio's sleep request
+void sdrs_sched_poll(sdrs_sched_t* sched, uint8_t src, bool active, uint32_t now);
+// Channel text to dst followup_ticks from now; an already pending one keeps its due time
+void sdrs_sched_chan_text(sdrs_sched_t* sched, uint8_t dst, uint32_t now);
+// Now-playing text changed; rate limited, a change inside the window goes out when it ends
+void sdrs_sched_track_changed(sdrs_sched_t* sched, uint32_t now);
+
+// SAT is the radio's source: its last poll wasn't a sleep request and is recent enough
+bool sdrs_sched_active(const sdrs_sched_t* sched, uint32_t now);
+
+// Ticks until the next deadline, 0 if one is already due, SDRS_SCHED_FOREVER if none
+uint32_t sdrs_sched_wait(const sdrs_sched_t* sched, uint32_t now);
+// Clears what's due; display_version is sdrs_display_version(), track text it was already pushed is skipped
+sdrs_due_t sdrs_sched_service(sdrs_sched_t* sched, uint32_t display_version, uint32_t now);
+// Track text for display_version went out
+void sdrs_sched_pushed(sdrs_sched_t* sched, uint32_t display_version, uint32_t now);
+
+#endif //SDRS_SCHED_H
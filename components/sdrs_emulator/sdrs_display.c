@@ -0,0 +1,93 @@
+// C stdlib includes
+#include <stddef.h>
+#include <string.h>
+
+// FreeRTOS includes
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// component includes
+#include "sdrs_display.h"
+
+/**
+ ** Three buffers: the current one, readers may still be copying out of the previous one, and
+ ** the writer fills the third. state holds the current index in its top bits and the number of
+ ** readers that entered it in the rest; a reader enters with a single fetch_add, so it always
+ ** counts against the buffer it then copies. A publish swaps in the new index with the count
+ ** cleared and adds the old count to that buffer's entered; readers bump exited when done.
+ ** A buffer is free again once the two match. Readers copy when the version changed, so the
+ ** count never gets near 2^30 between two publishes and carries into the index.
+ */
+#define SLOTS           3
+#define SLOT_SHIFT      30
+#define READERS_MASK    ((1UL << SLOT_SHIFT) - 1)
+
+typedef struct {
+    sdrs_display_buf_t buf;
+    uint32_t version;
+} display_slot_t;
+
+static display_slot_t slots[SLOTS] = {
+    {.buf = {
+        .chan_disp = "No Channel Info",
+        .song_disp = "No Song Info",
+        .artist_disp = "No Artist Info",
+        .esn_disp = "1123580130",
+    }, .version = 1},
+};
+static uint32_t state = 0;              // Slot 0, no readers
+static uint32_t entered[SLOTS];         // Writer only
+static uint32_t exited[SLOTS];
+static uint32_t version = 1;
+
+static sdrs_display_cb_t subscribers[SDRS_DISPLAY_MAX_SUBSCRIBERS];
+static uint8_t subscriber_count = 0;
+static portMUX_TYPE subscribe_mux = portMUX_INITIALIZER_UNLOCKED;
+
+void sdrs_display_publish(const sdrs_display_buf_t* next) {
+    uint32_t cur = __atomic_load_n(&state, __ATOMIC_RELAXED) >> SLOT_SHIFT;
+    uint32_t slot = (cur + 1) % SLOTS;
+    uint32_t old;
+
+    // Retired two publishes ago; a reader is only still in it if it was preempted mid-copy since
+    while(__atomic_load_n(&exited[slot], __ATOMIC_ACQUIRE) != entered[slot]) vTaskDelay(1);
+
+    memcpy(&slots[slot].buf, next, sizeof(sdrs_display_buf_t));
+    slots[slot].version = version + 1;
+
+    old = __atomic_exchange_n(&state, slot << SLOT_SHIFT, __ATOMIC_ACQ_REL);
+    entered[cur] += old & READERS_MASK;
+    __atomic_store_n(&version, version + 1, __ATOMIC_RELEASE);
+
+    for(uint8_t i = 0, n = __atomic_load_n(&subscriber_count, __ATOMIC_ACQUIRE); i < n; i++) {
+        subscribers[i](version);
+    }
+}
+
+bool sdrs_display_subscribe(sdrs_display_cb_t callback) {
+    bool ok = false;
+
+    portENTER_CRITICAL(&subscribe_mux);
+    if(callback != NULL && subscriber_count < SDRS_DISPLAY_MAX_SUBSCRIBERS) {
+        subscribers[subscriber_count] = callback;
+        __atomic_store_n(&subscriber_count, subscriber_count + 1, __ATOMIC_RELEASE);  // Slot is filled before it's counted
+        ok = true;
+    }
+    portEXIT_CRITICAL(&subscribe_mux);
+
+    return ok;
+}
+
+uint32_t sdrs_display_read(sdrs_display_buf_t* out) {
+    uint32_t slot = __atomic_fetch_add(&state, 1, __ATOMIC_ACQUIRE) >> SLOT_SHIFT;
+    uint32_t read_version;
+
+    memcpy(out, &slots[slot].buf, sizeof(sdrs_display_buf_t));
+    read_version = slots[slot].version;
+    __atomic_fetch_add(&exited[slot], 1, __ATOMIC_RELEASE);     // Copy completes before the writer may reuse it
+    return read_version;
+}
+
+uint32_t sdrs_display_version() {
+    return __atomic_load_n(&version, __ATOMIC_ACQUIRE);
+}
@@ -16,211 +16,271 @@
 #include "kbus_uart_driver.h"
 #include "kbus_defines.h"
 #include "kbus_service.h"
+#include "kbus_msg_pool.h"
+#include "kbus_pubsub.h"
+#include "kbus_tx_sched.h"
 #include "sdrs_emulator.h"
+#include "sdrs_sched.h"
+#include "sys_monitor.h"
+#include "sys_topology.h"
+#include "sys_power.h"
+#define DLOG_LEVEL CONFIG_SYS_DLOG_LEVEL_SDRS
+#include "sys_dlog.h"
 
 #define HERTZ(hz) ((1000/hz)/portTICK_RATE_MS)
 #define SECONDS(sec) ((sec*1000) / portTICK_RATE_MS)
-#define EMU_TASK_PRIORITY configMAX_PRIORITIES-5
 
 static const char* TAG = "sdrs_emu";
 static QueueHandle_t rx_queue;
-static QueueHandle_t tx_queue;
 
 static uint8_t cur_channel = 0xaf, cur_bank = 0x00, cur_preset = 0x00;
 
-static sdrs_display_buf_t* display_buf = NULL;
+static sdrs_display_buf_t display_buf;   // Snapshot the reply cache was last built from
+
+/**
+ ** Fully encoded replies, rebuilt together when tuning (state_version) or display text
+ ** (sdrs_display_version()) changed since the last build. Answering a poll is one slot copy.
+ */
+typedef enum {
+    SDRS_REPLY_SLEEP = 0,
+    SDRS_REPLY_STATUS,          // Heartbeat
+    SDRS_REPLY_STATUS_TEXT,     // Heartbeat w/channel text; preset recall, bank up
+    SDRS_REPLY_CHAN_DN,
+    SDRS_REPLY_CHAN_TEXT,
+    SDRS_REPLY_ARTIST,
+    SDRS_REPLY_SONG,
+    SDRS_REPLY_ESN,
+    SDRS_REPLY_COUNT
+} sdrs_reply_t;
+
+static kbus_message_t reply_cache[SDRS_REPLY_COUNT];
+static uint32_t state_version = 1;
+static uint32_t built_state_version = 0, built_display_version = 0;
+
+static sdrs_sched_t sched;     // Channel text follow-up and track text push deadlines
+static bool text_dirty = false; // Set by display_changed(), taken by emu_task
 
 static inline uint8_t bank_preset_byte() { return (cur_bank << 4) | cur_preset; }
 
+// Text updates for the same field supersede each other while unsent; the radio only needs the latest
+static inline void sdrs_send(kbus_message_t* msg, kbus_tx_class_t tx_class) {
+    uint32_t key = (msg->body[1] == SDRS_UPDATE_TXT) ? KBUS_TX_KEY(SDRS, SDRS_UPDATE_TXT, msg->body[2]) : KBUS_TX_NO_KEY;
+    uint32_t deadline = (tx_class == KBUS_TX_DISPLAY) ? KBUS_TX_DISPLAY_DEADLINE_MS : KBUS_TX_REPLY_DEADLINE_MS;
+    kbus_tx_submit(msg, tx_class, deadline, key);
+}
+
 static void emu_task();
+static void handle_request(kbus_message_t* rx_msg);
+static TickType_t deferred_wait();
+static void display_changed(uint32_t version);
+static void service_deferred();
+static void set_tuning(uint8_t channel, uint8_t bank, uint8_t preset);
+static void build_reply(sdrs_reply_t reply, uint8_t cmd, uint8_t flags, uint8_t channel, uint8_t presets, uint8_t magic, const char* text);
+static void rebuild_reply_cache();
+static void send_reply(sdrs_reply_t reply, uint8_t dst, kbus_tx_class_t tx_class);
+
+void sdrs_init_emulation(){
+    // Own queue for SDRS messages, don't want to have multiple readers on the main kbus rx queue.
+    // Carries pooled message handles, not copies; kbus_pubsub fills it without waiting on us
+    rx_queue = SYS_QUEUE_CREATE("sdrs_rx", 8, sizeof(kbus_message_t*));
+    sdrs_sched_init(&sched, pdMS_TO_TICKS(SDRS_TEXT_FOLLOWUP_MS), pdMS_TO_TICKS(SDRS_ACTIVE_TIMEOUT_MS),
+                    pdMS_TO_TICKS(SDRS_PUSH_MIN_MS), xTaskGetTickCount());
+
+    int tsk_ret = SYS_TASK_SPAWN(SDRS_EMU, emu_task, NULL);
+    if(tsk_ret != pdPASS){ ESP_LOGE(TAG, "sdrs_emu creation failed with: %d", tsk_ret);}
 
-void sdrs_init_emulation(QueueHandle_t kbus_tx_queue, sdrs_display_buf_t* display_buffer){
-    // Own queue for SDRS messages, don't want to have multiple readers on the main kbus rx queue
-    rx_queue = xQueueCreate(4, sizeof(kbus_message_t));
-    tx_queue = kbus_tx_queue;
-    display_buf = display_buffer;
+    kbus_subscribe_queue("sdrs_rx", &KBUS_PATTERN(KBUS_ANY, SDRS, KBUS_ANY), 1, rx_queue);
+    sdrs_display_subscribe(display_changed);
+    send_dev_ready(SDRS, LOC, true);
+}
 
-    sprintf(display_buf->chan_disp, "No Channel Info");
-    sprintf(display_buf->artist_disp, "No Artist Info");
-    sprintf(display_buf->song_disp, "No Song Info");
-    sprintf(display_buf->esn_disp, "1123580130");
+/**
+ ** Event loop; never sleeps while there's work. Requests are answered as they arrive and
+ ** follow-ups are kept as deadlines, so the wait on rx_queue doubles as the timer.
+ ** A NULL handle on rx_queue only wakes the task; text_dirty says the now-playing text changed.
+ */
+static void emu_task() {
+    kbus_message_t* rx_msg;
 
-    int tsk_ret = xTaskCreatePinnedToCore(emu_task, "sdrs_emu", 4096, NULL, EMU_TASK_PRIORITY, NULL, 1);
-    if(tsk_ret != pdPASS){ ESP_LOGE(TAG, "sdrs_emu creation failed with: %d", tsk_ret);}
+    while(1) {
+        // A request wakes the system before it's dispatched, so nothing here waits behind this
+        sys_power_park();
+        if(xQueueReceive(rx_queue, (void * )&rx_msg, deferred_wait())) {
+            kbus_msg_pool_count_copy(sizeof(kbus_message_t*));
+            if(rx_msg != NULL) {
+                handle_request(rx_msg);
+                kbus_msg_release(rx_msg);
+            }
+        }
+        // Checked on every wake, not just a NULL one; the wakeup itself may have been dropped
+        if(__atomic_exchange_n(&text_dirty, false, __ATOMIC_ACQUIRE)) {
+            sdrs_sched_track_changed(&sched, xTaskGetTickCount());
+        }
+        service_deferred();
+    }
+}
 
-    send_dev_ready(SDRS, LOC, true);
+/**
+ ** Runs on the publisher's task; flag the change, then wake emu_task. The wakeup is dropped
+ ** if rx_queue is full, but then emu_task has requests to wake for and sees the flag after them.
+ */
+static void display_changed(uint32_t version) {
+    kbus_message_t* wakeup = NULL;
+
+    __atomic_store_n(&text_dirty, true, __ATOMIC_RELEASE);
+    xQueueSend(rx_queue, &wakeup, 0);
 }
 
-uint8_t sdrs_enqueue_msg(void* message, TickType_t ticks_to_wait) {
-    return xQueueSend(rx_queue, message, ticks_to_wait);
+static TickType_t deferred_wait() {
+    uint32_t wait = sdrs_sched_wait(&sched, xTaskGetTickCount());
+    return wait == SDRS_SCHED_FOREVER ? (portTickType)portMAX_DELAY : wait;
 }
 
-static void emu_task() {
-    kbus_message_t rx_msg;
-    kbus_message_t tx_msg = {   
-        .src = SDRS
-    };
+static void service_deferred() {
+    TickType_t now = xTaskGetTickCount();
+    sdrs_due_t due = sdrs_sched_service(&sched, sdrs_display_version(), now);
 
-    while(1) {
-        if(xQueueReceive(rx_queue, (void * )&rx_msg, (portTickType)portMAX_DELAY)) {
-            tx_msg.dst = rx_msg.src;      // SDRS -> SOURCE
+    if(due.chan_text) send_reply(SDRS_REPLY_CHAN_TEXT, due.chan_dst, KBUS_TX_DISPLAY);
+
+    if(due.track_text) {
+        send_reply(SDRS_REPLY_SONG, due.track_dst, KBUS_TX_DISPLAY);
+        send_reply(SDRS_REPLY_ARTIST, due.track_dst, KBUS_TX_DISPLAY);
+        sdrs_sched_pushed(&sched, built_display_version, now);
+        DLOGD("Pushed track text v%d, %d ms after change", built_display_version,
+              (now - sched.text_push.changed_at) * portTICK_PERIOD_MS);
+    }
+}
+
+static void set_tuning(uint8_t channel, uint8_t bank, uint8_t preset) {
+    if(channel == cur_channel && bank == cur_bank && preset == cur_preset) return;
+
+    cur_channel = channel;
+    cur_bank = bank;
+    cur_preset = preset;
+    state_version++;
+}
 
-            switch(rx_msg.body[0]) {
+static void build_reply(sdrs_reply_t reply, uint8_t cmd, uint8_t flags, uint8_t channel, uint8_t presets, uint8_t magic, const char* text) {
+    kbus_message_t* msg = &reply_cache[reply];
+    size_t text_len = text ? strnlen(text, sizeof(msg->body) - 6) : 0;    // Clip to what fits in a frame
+
+    msg->src = SDRS;
+    msg->body[0] = SDRS_STAT_RPLY;
+    msg->body[1] = cmd;
+    msg->body[2] = flags;       // Padding or flags?
+    msg->body[3] = channel;     // Current Channel
+    msg->body[4] = presets;     // Preset Bank && Preset number (each gets a nibble)
+    msg->body[5] = magic;       // ¯\_(ツ)_/¯
+    memcpy(&msg->body[6], text, text_len);
+    msg->body_len = 6 + text_len;
+}
+
+// Re-encode every reply; only runs when tuning or display text changed since the last build
+static void rebuild_reply_cache() {
+    uint8_t presets = bank_preset_byte();
+
+    built_state_version = state_version;
+    built_display_version = sdrs_display_read(&display_buf);
+
+    build_reply(SDRS_REPLY_SLEEP,       SDRS_POWER_MODE,  0x00, cur_channel, presets, 0x04, NULL);
+    build_reply(SDRS_REPLY_STATUS,      SDRS_HEARTBEAT,   0x00, cur_channel, presets, 0x04, NULL);
+    build_reply(SDRS_REPLY_STATUS_TEXT, SDRS_HEARTBEAT,   0x00, cur_channel, presets, 0x04, display_buf.chan_disp);
+    build_reply(SDRS_REPLY_CHAN_DN,     SDRS_CHAN_DN_ACK, 0x00, cur_channel, presets, 0x04, NULL);
+    build_reply(SDRS_REPLY_CHAN_TEXT,   SDRS_UPDATE_TXT,  0x00, cur_channel, presets, 0x04, display_buf.chan_disp);
+    // Artist/Song text: flags 0x06/0x07 mark the field, Bank 0 && Preset 1, bit 0 flag set
+    build_reply(SDRS_REPLY_ARTIST,      SDRS_UPDATE_TXT,  0x06, cur_channel, 0x01, 0x01, display_buf.artist_disp);
+    build_reply(SDRS_REPLY_SONG,        SDRS_UPDATE_TXT,  0x07, cur_channel, 0x01, 0x01, display_buf.song_disp);
+    // ESN: channel, presets and flag bytes are all 0x30
+    build_reply(SDRS_REPLY_ESN,         SDRS_UPDATE_TXT,  0x0c, 0x30, 0x30, 0x30, display_buf.esn_disp);
+
+    DLOGD("Reply cache rebuilt, state v%d display v%d", built_state_version, built_display_version);
+}
+
+static void send_reply(sdrs_reply_t reply, uint8_t dst, kbus_tx_class_t tx_class) {
+    if(built_state_version != state_version || built_display_version != sdrs_display_version()) {
+        rebuild_reply_cache();
+    }
+
+    reply_cache[reply].dst = dst;   // SDRS -> SOURCE
+    sdrs_send(&reply_cache[reply], tx_class);
+}
+
+static void handle_request(kbus_message_t* rx_msg) {
+    switch(rx_msg->body[0]) {
+
+        case DEV_STAT_REQ:
+            DLOGD("SDRS Received: DEVICE STATUS REQUEST");
+            send_dev_ready(SDRS, rx_msg->src, false); // "Device Status Request" response "Device Status Ready"
+            DLOGD("SDRS Queued: DEVICE STATUS READY");
+            break;
+        
+        case SDRS_CTRL_REQ: {
+            sdrs_sched_poll(&sched, rx_msg->src, rx_msg->body[1] != SDRS_REQ_SLEEP, xTaskGetTickCount());
+            switch(rx_msg->body[1]) {
+                case SDRS_POWER_MODE:  //? Bootup command?
+                    DLOGI("SRDS Power On command received");
+                    break;
+                /**
+                 * ? Might indeed be a power/mode update command like documented at:
+                 * ? https://github.com/blalor/iPod_IBus_adapter/blob/f828d9327810512daa1dab1f9b7bb13dd9f80c21/doc/logs/log_analysis.txt#L9
+                 * 
+                 * ? Looks like it either confirms the SAT tuning on deactivatiohn, or this might be a
+                 * ? brief status update after SAT is no longer the source. Analyzing the logs, the two different
+                 * ? <3D 01 00> command messages recieved have matching channel && preset values as the regular
+                 * ? status update messages that immediately preceeded.
+                 * 
+                 * ? Type              Status Update            Sleep Status
+                 * ? Command             <3D 02 00>      <=>     <3D 01 00>
+                 * ? Response Body   3E 02 00 95 20 04   <=>   3E 00 00 95 20 04
+                 * !                          95 20 04                  95 20 04
+                 * !                     channel 149, preset bank 2, preset num 0
+                 * ?
+                 */
+                case SDRS_REQ_SLEEP:
+                    send_reply(SDRS_REPLY_SLEEP, rx_msg->src, KBUS_TX_REPLY);
+                    break;
+
+                case SDRS_REQ_CHAN_UP:  // Channel up
+                    set_tuning(cur_channel + 1, cur_bank, cur_preset);
+                    //! Fall through - to send packet
+                case SDRS_HEARTBEAT:  // Status Update Req. ("NOW" message)
+                    send_reply(SDRS_REPLY_STATUS, rx_msg->src, KBUS_TX_REPLY);
+                    sdrs_sched_chan_text(&sched, rx_msg->src, xTaskGetTickCount());  // Text follows a second later, without blocking
+                    break;
 
-                case DEV_STAT_REQ:
-                    ESP_LOGD(TAG, "SDRS Received: DEVICE STATUS REQUEST");
-                    send_dev_ready(SDRS, rx_msg.src, false); // "Device Status Request" response "Device Status Ready"
-                    ESP_LOGD(TAG, "SDRS Queued: DEVICE STATUS READY");
+                case SDRS_REQ_CHAN_DN:  // Channel down
+                    set_tuning(cur_channel - 1, cur_bank, cur_preset);
+                    send_reply(SDRS_REPLY_CHAN_DN, rx_msg->src, KBUS_TX_REPLY);
+                    sdrs_sched_chan_text(&sched, rx_msg->src, xTaskGetTickCount());  // Text follows a second later, without blocking
                     break;
-                
-                case SDRS_CTRL_REQ: {
-                    tx_msg.body[0] = SDRS_STAT_RPLY;
-
-                    switch(rx_msg.body[1]) {
-                        case SDRS_POWER_MODE:  //? Bootup command?
-                            ESP_LOGI(TAG, "SRDS Power On command received");
-                            break;
-                        /**
-                         * ? Might indeed be a power/mode update command like documented at:
-                         * ? https://github.com/blalor/iPod_IBus_adapter/blob/f828d9327810512daa1dab1f9b7bb13dd9f80c21/doc/logs/log_analysis.txt#L9
-                         * 
-                         * ? Looks like it either confirms the SAT tuning on deactivatiohn, or this might be a
-                         * ? brief status update after SAT is no longer the source. Analyzing the logs, the two different
-                         * ? <3D 01 00> command messages recieved have matching channel && preset values as the regular
-                         * ? status update messages that immediately preceeded.
-                         * 
-                         * ? Type              Status Update            Sleep Status
-                         * ? Command             <3D 02 00>      <=>     <3D 01 00>
-                         * ? Response Body   3E 02 00 95 20 04   <=>   3E 00 00 95 20 04
-                         * !                          95 20 04                  95 20 04
-                         * !                     channel 149, preset bank 2, preset num 0
-                         * ?
-                         */
-                        case SDRS_REQ_SLEEP:
-                            tx_msg.body[1] = SDRS_POWER_MODE;  // Command 0x00
-                            tx_msg.body[2] = 0x00;  // Padding or flags?
-                            tx_msg.body[3] = cur_channel;  // Current Channel
-                            tx_msg.body[4] = bank_preset_byte();  // Preset Bank && Preset number (each gets a nibble)
-                            tx_msg.body[5] = 0x04;  // ¯\_(ツ)_/¯   Some flag set on bit 2
-                            tx_msg.body_len = 6;
-                            xQueueSend(tx_queue, &tx_msg, (portTickType)portMAX_DELAY);
-                            break;
-
-                        case SDRS_REQ_CHAN_UP:  // Channel up
-                            cur_channel++;
-                            //! Fall through to send packet
-                        case SDRS_HEARTBEAT:  // Status Update Req. ("NOW" message)
-                            tx_msg.body[1] = SDRS_HEARTBEAT;        // Status Update
-                            tx_msg.body[2] = 0x00;                  // Padding or flags?
-                            tx_msg.body[3] = cur_channel;           // Current Channel
-                            tx_msg.body[4] = bank_preset_byte();    // Preset Bank && Preset number (each gets a nibble)
-                            tx_msg.body[5] = 0x04;                  // ¯\_(ツ)_/¯   Some flag set on bit 2
-                            tx_msg.body_len = 6;
-                            xQueueSend(tx_queue, &tx_msg, (portTickType)portMAX_DELAY);
-
-                            vTaskDelay(SECONDS(1));
-                            tx_msg.body[1] = SDRS_UPDATE_TXT;       // Text Update
-                            tx_msg.body[2] = 0x00;                  // Padding or flags?
-                            tx_msg.body[3] = cur_channel;           // Current Channel
-                            tx_msg.body[4] = bank_preset_byte();    // Preset Bank && Preset number (each gets a nibble)
-                            tx_msg.body[5] = 0x04;                  // ¯\_(ツ)_/¯   Some flag set on bit 2
-                            tx_msg.body_len = 6 + strlen(display_buf->chan_disp);
-
-                            memcpy(&tx_msg.body[6], display_buf->chan_disp, strlen(display_buf->chan_disp)); // Channel Name Text
-                            xQueueSend(tx_queue, &tx_msg, (portTickType)portMAX_DELAY);
-                            break;
-
-                        case SDRS_REQ_CHAN_DN:  // Channel down
-                            cur_channel--;
-                            tx_msg.body[1] = SDRS_CHAN_DN_ACK;      // Down ACK
-                            tx_msg.body[2] = 0x00;                  // Padding or flags?
-                            tx_msg.body[3] = cur_channel;           // Current Channel
-                            tx_msg.body[4] = bank_preset_byte();    // Preset Bank && Preset number (each gets a nibble)
-                            tx_msg.body[5] = 0x04;                  // ¯\_(ツ)_/¯   Some flag set on bit 2
-                            tx_msg.body_len = 6;
-                            xQueueSend(tx_queue, &tx_msg, (portTickType)portMAX_DELAY);
-
-                            vTaskDelay(SECONDS(1));
-                            tx_msg.body[1] = SDRS_UPDATE_TXT;       // Text Update
-                            tx_msg.body[2] = 0x00;                  // Padding or flags?
-                            tx_msg.body[3] = cur_channel;           // Current Channel
-                            tx_msg.body[4] = bank_preset_byte();    // Preset Bank && Preset number (each gets a nibble)
-                            tx_msg.body[5] = 0x04;                  // ¯\_(ツ)_/¯   Some flag set on bit 2
-                            tx_msg.body_len = 6 + strlen(display_buf->chan_disp);
-
-                            memcpy(&tx_msg.body[6], display_buf->chan_disp, strlen(display_buf->chan_disp)); // Channel Name Text
-                            xQueueSend(tx_queue, &tx_msg, (portTickType)portMAX_DELAY);
-                            break;
-
-                        case SDRS_REQ_PRESET:  // Preset recall to preset in rx_msg.body[2]
-                            cur_preset = rx_msg.body[2];            // Let's just agree with the RAD
-                            tx_msg.body[1] = SDRS_HEARTBEAT;        // Status Update
-                            tx_msg.body[2] = 0x00;                  // Padding or flags?
-                            tx_msg.body[3] = cur_channel;           // Current Channel
-                            tx_msg.body[4] = bank_preset_byte();    // Preset Bank && Preset number (each gets a nibble)
-                            tx_msg.body[5] = 0x04;                  // ¯\_(ツ)_/¯   Some flag set on bit 2
-                            tx_msg.body_len = 6 + strlen(display_buf->chan_disp);
-
-                            memcpy(&tx_msg.body[6], display_buf->chan_disp, strlen(display_buf->chan_disp)); // Channel Name Text
-                            xQueueSend(tx_queue, &tx_msg, (portTickType)portMAX_DELAY);
-                            break;
-
-                        case SDRS_REQ_ESN:  // SAT long press, show ESN
-                            tx_msg.body[1] = SDRS_UPDATE_TXT;       // Status Update
-                            tx_msg.body[2] = 0x0c;                  // Padding or flags?
-                            tx_msg.body[3] = 0x30;                  // Current Channel set to 48 (0x30)
-                            tx_msg.body[4] = 0x30;                  // Presets byte is set to 0x30 for ESN
-                            tx_msg.body[5] = 0x30;                  // ¯\_(ツ)_/¯ 
-                            tx_msg.body_len = 6 + strlen(display_buf->esn_disp);
-
-                            memcpy(&tx_msg.body[6], display_buf->esn_disp, strlen(display_buf->esn_disp)); // Channel Name Text
-                            xQueueSend(tx_queue, &tx_msg, (portTickType)portMAX_DELAY);
-                            break;
-
-                        case SDRS_REQ_BANK_UP:  // SAT pushed, change preset bank
-                            cur_bank++;
-                            tx_msg.body[1] = SDRS_HEARTBEAT;        // Status Update
-                            tx_msg.body[2] = 0x00;                  // Padding or flags?
-                            tx_msg.body[3] = cur_channel;           // Current Channel
-                            tx_msg.body[4] = bank_preset_byte();    // Preset Bank && Preset number (each gets a nibble)
-                            tx_msg.body[5] = 0x04;                  // ¯\_(ツ)_/¯   Some flag set on bit 2
-                            tx_msg.body_len = 6 + strlen(display_buf->chan_disp);
-
-                            memcpy(&tx_msg.body[6], display_buf->chan_disp, strlen(display_buf->chan_disp)); // Channel Name Text
-                            xQueueSend(tx_queue, &tx_msg, (portTickType)portMAX_DELAY);
-                            break;
-
-                        case SDRS_REQ_ARTIST:  // Artist Text Req.
-                            tx_msg.body[1] = SDRS_UPDATE_TXT;       // Text Update
-                            tx_msg.body[2] = 0x06;                  // Padding or flags? Artist flag?
-                            tx_msg.body[3] = cur_channel;           // Current Channel
-                            tx_msg.body[4] = 0x01;                  // Bank 0 && Preset 1 for Artist Text
-                            tx_msg.body[5] = 0x01;                  // ¯\_(ツ)_/¯   Some flag set on bit 0
-                            tx_msg.body_len = 6 + strlen(display_buf->artist_disp);
-
-                            memcpy(&tx_msg.body[6], display_buf->artist_disp, strlen(display_buf->artist_disp)); // Artist Name Text
-                            xQueueSend(tx_queue, &tx_msg, (portTickType)portMAX_DELAY);
-                            break;
-
-                        case SDRS_REQ_SONG:  // Song Text Req.
-                            tx_msg.body[1] = SDRS_UPDATE_TXT;       // Text Update
-                            tx_msg.body[2] = 0x07;                  // Padding or flags? Song flag?
-                            tx_msg.body[3] = cur_channel;           // Channel
-                            tx_msg.body[4] = 0x01;                  // Bank 0 && Preset 1 for Song Text
-                            tx_msg.body[5] = 0x01;                  // ¯\_(ツ)_/¯   Some flag set on bit 0
-                            tx_msg.body_len = 6 + strlen(display_buf->song_disp);
-
-                            memcpy(&tx_msg.body[6], display_buf->song_disp, strlen(display_buf->song_disp)); // Song Name Text
-                            xQueueSend(tx_queue, &tx_msg, (portTickType)portMAX_DELAY);
-                            break;
-
-                        default:
-                            break;
-                    }
-                }
+
+                case SDRS_REQ_PRESET:  // Preset recall to preset in rx_msg.body[2]
+                    set_tuning(cur_channel, cur_bank, rx_msg->body[2]);     // Let's just agree with the RAD
+                    send_reply(SDRS_REPLY_STATUS_TEXT, rx_msg->src, KBUS_TX_REPLY);
+                    break;
+
+                case SDRS_REQ_ESN:  // SAT long press, show ESN
+                    send_reply(SDRS_REPLY_ESN, rx_msg->src, KBUS_TX_REPLY);
+                    break;
+
+                case SDRS_REQ_BANK_UP:  // SAT pushed, change preset bank
+                    set_tuning(cur_channel, cur_bank + 1, cur_preset);
+                    send_reply(SDRS_REPLY_STATUS_TEXT, rx_msg->src, KBUS_TX_REPLY);
+                    break;
+
+                case SDRS_REQ_ARTIST:  // Artist Text Req.
+                    send_reply(SDRS_REPLY_ARTIST, rx_msg->src, KBUS_TX_REPLY);
+                    break;
+
+                case SDRS_REQ_SONG:  // Song Text Req.
+                    send_reply(SDRS_REPLY_SONG, rx_msg->src, KBUS_TX_REPLY);
+                    break;
+
                 default:
                     break;
             }
         }
+        default:
+            break;
     }
 }
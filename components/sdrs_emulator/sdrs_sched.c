@@ -0,0 +1,84 @@
+// C stdlib includes
+#include <stddef.h>
+#include <string.h>
+
+// component includes
+#include "sdrs_sched.h"
+
+static inline bool reached(uint32_t due, uint32_t now) {
+    return (int32_t)(due - now) <= 0;
+}
+
+static inline uint32_t wait_until(bool pending, uint32_t due, uint32_t now, uint32_t wait) {
+    if(!pending) return wait;
+    if(reached(due, now)) return 0;
+    return (due - now) < wait ? due - now : wait;
+}
+
+void sdrs_sched_init(sdrs_sched_t* sched, uint32_t followup_ticks, uint32_t active_ticks, uint32_t push_min_ticks, uint32_t now) {
+    memset(sched, 0, sizeof(sdrs_sched_t));
+    sched->followup_ticks = followup_ticks;
+    sched->active_ticks = active_ticks;
+    sched->push_min_ticks = push_min_ticks;
+    sched->text_push.last_push = now - push_min_ticks;
+}
+
+void sdrs_sched_poll(sdrs_sched_t* sched, uint8_t src, bool active, uint32_t now) {
+    sched->source.active = active;
+    sched->source.dst = src;
+    sched->source.last_poll = now;
+}
+
+void sdrs_sched_chan_text(sdrs_sched_t* sched, uint8_t dst, uint32_t now) {
+    // Keep an already pending follow-up's due time; repeated polls mustn't keep pushing it out
+    if(sched->chan_text.pending) return;
+
+    sched->chan_text.pending = true;
+    sched->chan_text.dst = dst;
+    sched->chan_text.due = now + sched->followup_ticks;
+}
+
+void sdrs_sched_track_changed(sdrs_sched_t* sched, uint32_t now) {
+    if(!sched->text_push.pending) sched->text_push.changed_at = now;
+    sched->text_push.pending = true;
+    sched->text_push.due = sched->text_push.last_push + sched->push_min_ticks;
+    if((int32_t)(sched->text_push.due - now) < 0) sched->text_push.due = now;
+}
+
+bool sdrs_sched_active(const sdrs_sched_t* sched, uint32_t now) {
+    return sched->source.active && (now - sched->source.last_poll) <= sched->active_ticks;
+}
+
+uint32_t sdrs_sched_wait(const sdrs_sched_t* sched, uint32_t now) {
+    uint32_t wait = SDRS_SCHED_FOREVER;
+
+    wait = wait_until(sched->chan_text.pending, sched->chan_text.due, now, wait);
+    wait = wait_until(sched->text_push.pending, sched->text_push.due, now, wait);
+    return wait;
+}
+
+sdrs_due_t sdrs_sched_service(sdrs_sched_t* sched, uint32_t display_version, uint32_t now) {
+    sdrs_due_t due = {0};
+
+    if(sched->chan_text.pending && reached(sched->chan_text.due, now)) {
+        sched->chan_text.pending = false;
+        due.chan_text = true;
+        due.chan_dst = sched->chan_text.dst;
+    }
+
+    if(sched->text_push.pending && reached(sched->text_push.due, now)) {
+        sched->text_push.pending = false;
+        // Only while the radio is showing SAT, and only text it hasn't been pushed yet
+        if(!sdrs_sched_active(sched, now)) return due;
+        if(display_version == sched->text_push.pushed_version) return due;
+
+        due.track_text = true;
+        due.track_dst = sched->source.dst;
+    }
+    return due;
+}
+
+void sdrs_sched_pushed(sdrs_sched_t* sched, uint32_t display_version, uint32_t now) {
+    sched->text_push.pushed_version = display_version;
+    sched->text_push.last_push = now;
+}
@@ -0,0 +1,33 @@
+#ifndef SYS_BENCH_H
+#define SYS_BENCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+
+/**
+ ** Latency probe for on-target benchmarks. A benchmark driver starts a sample, sets off the
+ ** path under test and waits; whoever ends the path calls sys_bench_end(), which is a single
+ ** atomic exchange when nothing is being measured. One sample is in flight at a time.
+ **
+ ** sys_bench_report() prints a BENCH line of percentiles tagged with the task topology
+ ** (sys_topology.h); `tools/sys_bench.py` tabulates them across logs from several builds.
+ */
+#define SYS_BENCH_MAX_SAMPLES 1024
+
+#ifdef CONFIG_SYS_BENCH
+void sys_bench_reset();
+void sys_bench_begin();
+void sys_bench_end();
+// True once the sample ended; false after ticks, and the sample counts as lost
+bool sys_bench_wait(TickType_t ticks);
+void sys_bench_report(const char* phase);
+#else
+static inline void sys_bench_reset() {}
+static inline void sys_bench_begin() {}
+static inline void sys_bench_end() {}
+static inline bool sys_bench_wait(TickType_t ticks) { return false; }
+static inline void sys_bench_report(const char* phase) {}
+#endif
+
+#endif //SYS_BENCH_H
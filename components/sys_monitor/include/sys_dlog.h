@@ -0,0 +1,81 @@
+#ifndef SYS_DLOG_H
+#define SYS_DLOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_log.h"
+
+/**
+ ** Deferred binary logging for hot paths. A call site stores its site id, up to four integer
+ ** arguments and optionally one buffer into a lock-free RAM ring; nothing is formatted on
+ ** the device. A lowest priority task drains the ring to the console as "DL <hex>" lines.
+ **
+ ** Site strings (level, file:line, format) go to .dlog_sites, an INFO section that's kept in
+ ** the ELF but never loaded, so formats cost no flash. A site's id is its offset in there;
+ ** the build writes the id table next to the ELF and `tools/sys_dlog.py decode` turns a
+ ** monitor log back into text with it.
+ **
+ ** Levels are per file at compile time: define DLOG_LEVEL (an esp_log_level_t value, usually
+ ** one of the CONFIG_SYS_DLOG_LEVEL_* options) before including this header. Sites above it
+ ** compile to nothing. Without CONFIG_SYS_DLOG every macro is the matching ESP_LOG call.
+ **
+ **   DLOGD("SDRS chan %d", chan);                          // D, I, W, E, V; integer args only
+ **   DLOG_HEX(D, "0x%02x -> 0x%02x", body, len, src, dst); // Buffer shown as a hexdump
+ **   DLOG_TEXT(I, "Title: %.*s", title, len);              // Buffer as text; %.*s must come first
+ **
+ ** Buffers past SYS_DLOG_BUF_MAX bytes are cut; the decoder notes how much was.
+ */
+#define SYS_DLOG_BUF_MAX 36
+#define SYS_DLOG_MAX_ARGS 4
+#define SYS_DLOG_SITE_LOST 0xFFFF   // Marker record, first arg is the number of records lost
+
+#define DLOG_LVL_E ESP_LOG_ERROR
+#define DLOG_LVL_W ESP_LOG_WARN
+#define DLOG_LVL_I ESP_LOG_INFO
+#define DLOG_LVL_D ESP_LOG_DEBUG
+#define DLOG_LVL_V ESP_LOG_VERBOSE
+
+#ifdef CONFIG_SYS_DLOG
+#ifndef DLOG_LEVEL
+#define DLOG_LEVEL CONFIG_LOG_DEFAULT_LEVEL
+#endif
+
+void sys_dlog_init();
+void sys_dlog_write(uint16_t site, const void* buf, size_t len, const uint32_t* args, uint8_t nargs);
+
+#define DLOG_STR_(x) #x
+#define DLOG_STR(x) DLOG_STR_(x)
+#define DLOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, n, ...) n
+#define DLOG_NARGS(...) DLOG_NARGS_(_0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+
+#define DLOG_SITE(lvl, buf, len, fmt, ...) do { \
+    _Static_assert(DLOG_NARGS(__VA_ARGS__) <= SYS_DLOG_MAX_ARGS, "at most 4 dlog arguments"); \
+    if(DLOG_LVL_##lvl <= DLOG_LEVEL) { \
+        static const char _dlog_site[] __attribute__((section(".dlog_sites"))) = \
+            #lvl "\x1f" __FILE__ ":" DLOG_STR(__LINE__) "\x1f" fmt; \
+        sys_dlog_write((uint16_t)(uintptr_t)_dlog_site, (buf), (len), \
+                       (const uint32_t[]){0, ##__VA_ARGS__} + 1, DLOG_NARGS(__VA_ARGS__)); \
+    } \
+} while(0)
+
+#define DLOG(lvl, fmt, ...)                 DLOG_SITE(lvl, NULL, 0, fmt, ##__VA_ARGS__)
+#define DLOG_HEX(lvl, fmt, buf, len, ...)   DLOG_SITE(lvl, (buf), (len), fmt, ##__VA_ARGS__)
+#define DLOG_TEXT(lvl, fmt, text, len, ...) DLOG_SITE(lvl, (text), (len), fmt, ##__VA_ARGS__)
+#else
+static inline void sys_dlog_init() {}
+
+#define DLOG(lvl, fmt, ...) ESP_LOG_LEVEL_LOCAL(DLOG_LVL_##lvl, TAG, fmt, ##__VA_ARGS__)
+#define DLOG_HEX(lvl, fmt, buf, len, ...) do { \
+    ESP_LOG_LEVEL_LOCAL(DLOG_LVL_##lvl, TAG, fmt, ##__VA_ARGS__); \
+    ESP_LOG_BUFFER_HEXDUMP(TAG, (buf), (len), DLOG_LVL_##lvl); \
+} while(0)
+#define DLOG_TEXT(lvl, fmt, text, len, ...) ESP_LOG_LEVEL_LOCAL(DLOG_LVL_##lvl, TAG, fmt, (int)(len), (const char*)(text), ##__VA_ARGS__)
+#endif
+
+#define DLOGE(fmt, ...) DLOG(E, fmt, ##__VA_ARGS__)
+#define DLOGW(fmt, ...) DLOG(W, fmt, ##__VA_ARGS__)
+#define DLOGI(fmt, ...) DLOG(I, fmt, ##__VA_ARGS__)
+#define DLOGD(fmt, ...) DLOG(D, fmt, ##__VA_ARGS__)
+#define DLOGV(fmt, ...) DLOG(V, fmt, ##__VA_ARGS__)
+
+#endif //SYS_DLOG_H
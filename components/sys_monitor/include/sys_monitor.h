@@ -0,0 +1,66 @@
+#ifndef SYS_MONITOR_H
+#define SYS_MONITOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+/**
+ ** Task/queue creation that's static or heap backed depending on CONFIG_SYS_STATIC_ALLOCATION,
+ ** plus a registry of what was created so sys_monitor_report() can print a memory map per
+ ** owner and each task's stack high-water mark.
+ **
+ ** The macros attribute everything to the calling file's TAG and need compile time sizes.
+ ** SYS_TASK_CREATE evaluates to pdPASS on success, like xTaskCreate. Static storage belongs to
+ ** the call site, so a call site may only create its task once.
+ */
+#define SYS_MONITOR_MAX_TASKS   24
+#define SYS_MONITOR_MAX_QUEUES  16
+
+void sys_monitor_init();
+
+void sys_monitor_add_task(TaskHandle_t task, const char* owner, uint32_t stack_bytes, bool is_static);
+void sys_monitor_add_queue(QueueHandle_t queue, const char* owner, const char* name, uint32_t bytes, bool is_static);
+
+// For tasks that end; drops the calling task from the registry, then deletes it
+void sys_monitor_task_exit();
+
+void sys_monitor_report();
+
+static inline BaseType_t sys_task_created(TaskHandle_t task, TaskHandle_t* handle_out, const char* owner, uint32_t stack_bytes, bool is_static) {
+    if(handle_out != NULL) *handle_out = task;
+    if(task == NULL) return errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;
+    sys_monitor_add_task(task, owner, stack_bytes, is_static);
+    return pdPASS;
+}
+
+static inline QueueHandle_t sys_queue_created(QueueHandle_t queue, const char* owner, const char* name, uint32_t bytes, bool is_static) {
+    if(queue != NULL) sys_monitor_add_queue(queue, owner, name, bytes, is_static);
+    return queue;
+}
+
+// core is tskNO_AFFINITY for unpinned tasks; handle_out may be NULL
+#ifdef CONFIG_SYS_STATIC_ALLOCATION
+#define SYS_TASK_CREATE(fn, name, stack_bytes, prio, handle_out, core) __extension__({ \
+    static StackType_t _sys_stack[(stack_bytes) / sizeof(StackType_t)]; \
+    static StaticTask_t _sys_tcb; \
+    sys_task_created(xTaskCreateStaticPinnedToCore((fn), (name), (stack_bytes), NULL, (prio), _sys_stack, &_sys_tcb, (core)), \
+                     (handle_out), TAG, (stack_bytes), true); })
+
+#define SYS_QUEUE_CREATE(name, length, item_size) __extension__({ \
+    static uint8_t _sys_storage[(length) * (item_size)]; \
+    static StaticQueue_t _sys_queue; \
+    sys_queue_created(xQueueCreateStatic((length), (item_size), _sys_storage, &_sys_queue), TAG, (name), (length) * (item_size), true); })
+#else
+#define SYS_TASK_CREATE(fn, name, stack_bytes, prio, handle_out, core) __extension__({ \
+    TaskHandle_t _sys_task = NULL; \
+    BaseType_t _sys_ret = xTaskCreatePinnedToCore((fn), (name), (stack_bytes), NULL, (prio), &_sys_task, (core)); \
+    _sys_ret == pdPASS ? sys_task_created(_sys_task, (handle_out), TAG, (stack_bytes), false) : _sys_ret; })
+
+#define SYS_QUEUE_CREATE(name, length, item_size) \
+    sys_queue_created(xQueueCreate((length), (item_size)), TAG, (name), (length) * (item_size), false)
+#endif
+
+#endif //SYS_MONITOR_H
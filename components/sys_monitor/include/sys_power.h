@@ -0,0 +1,55 @@
+#ifndef SYS_POWER_H
+#define SYS_POWER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sys_power_fsm.h"
+
+/**
+ ** Ignition power management, CONFIG_SYS_POWER; runs sys_power_fsm.h on the tick clock.
+ **
+ ** ON and LINGER hold PM locks for full CPU speed and no light sleep. OFF releases them, so
+ ** the CPU drops to CONFIG_SYS_POWER_MIN_MHZ and tickless idle light sleeps until the K-bus
+ ** UART sees traffic. Workers that poll or retry call sys_power_park() at the top of their
+ ** loop and block there while OFF, instead of being suspended wherever they happen to be.
+ **
+ ** Ignition and requests are applied on the caller's task, so a wake takes the locks before
+ ** the frame that caused it is dispatched. Timeouts are a low priority task's job. Time from
+ ** a wake to the first frame handed to the driver is kept in the stats.
+ */
+typedef struct {
+    sys_power_state_t state;
+    uint32_t sleeps;
+    uint32_t wakes;
+    uint32_t reply_samples;     // Wakes followed by a tx
+    uint32_t reply_last_us;     // Wake to first tx handoff
+    uint32_t reply_max_us;
+    uint32_t reply_total_us;
+} sys_power_stats_t;
+
+#ifdef CONFIG_SYS_POWER
+void sys_power_init();
+
+// Ignition status from IGN_STAT_RPLY
+void sys_power_note_ignition(bool on);
+// A frame for an emulated device; wakes from OFF
+void sys_power_note_request();
+// Any frame; only a timestamp, cheap enough for every frame
+void sys_power_note_activity();
+// A frame handed to the driver; ends a wake to reply measurement
+void sys_power_note_tx();
+
+// Blocks while OFF
+void sys_power_park();
+
+void sys_power_get_stats(sys_power_stats_t* stats);
+#else
+static inline void sys_power_init() {}
+static inline void sys_power_note_ignition(bool on) {}
+static inline void sys_power_note_request() {}
+static inline void sys_power_note_activity() {}
+static inline void sys_power_note_tx() {}
+static inline void sys_power_park() {}
+#endif
+
+#endif //SYS_POWER_H
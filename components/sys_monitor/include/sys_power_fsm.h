@@ -0,0 +1,59 @@
+#ifndef SYS_POWER_FSM_H
+#define SYS_POWER_FSM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ ** Ignition power state machine, no FreeRTOS or esp-idf in it so it builds on the host
+ ** (tools/power_sim.c) and runs on whatever clock the caller passes in, in ms.
+ **
+ **   ON      ignition on, or the bus asked an emulated device for something
+ **   LINGER  ignition went off; keep answering while the car winds down (doors, radio on
+ **           without key) until the bus goes quiet or linger_ms is up
+ **   OFF     workers parked, CPU at minimum, light sleep; woken by ignition or a request
+ **
+ ** Any frame counts as bus activity. ON also drops to OFF after silence_ms of no activity,
+ ** for ignition off frames that were missed. The caller applies what entering a state means.
+ */
+typedef enum {
+    SYS_POWER_ON = 0,
+    SYS_POWER_LINGER,
+    SYS_POWER_OFF,
+    SYS_POWER_STATES
+} sys_power_state_t;
+
+typedef enum {
+    SYS_POWER_EV_IGN_ON = 0,    // IGN_STAT_RPLY with any of Pos1_Acc, Pos2_On, Pos3_Start
+    SYS_POWER_EV_IGN_OFF,       // IGN_STAT_RPLY with none
+    SYS_POWER_EV_REQUEST,       // Frame addressed to an emulated device
+    SYS_POWER_EV_ACTIVITY,      // Any other frame
+    SYS_POWER_EV_TICK,          // Time passed; checks the timeouts
+    SYS_POWER_EVENTS
+} sys_power_event_t;
+
+typedef struct {
+    uint32_t silence_ms;        // No bus activity this long, ON or LINGER -> OFF
+    uint32_t linger_ms;         // LINGER this long -> OFF even on a busy bus
+} sys_power_cfg_t;
+
+typedef struct {
+    sys_power_cfg_t cfg;
+    sys_power_state_t state;
+    uint32_t entered_ms;        // When state was entered
+    uint32_t activity_ms;       // Last event other than a tick
+} sys_power_fsm_t;
+
+// Starts ON, as if the bus had just been active
+void sys_power_fsm_init(sys_power_fsm_t* fsm, const sys_power_cfg_t* cfg, uint32_t now_ms);
+
+// Returns the state after the event; compare with the state before to see a transition
+sys_power_state_t sys_power_fsm_event(sys_power_fsm_t* fsm, sys_power_event_t event, uint32_t now_ms);
+
+// ms from now_ms until a tick could change state; UINT32_MAX when only an event can
+uint32_t sys_power_fsm_next_ms(const sys_power_fsm_t* fsm, uint32_t now_ms);
+
+const char* sys_power_state_name(sys_power_state_t state);
+const char* sys_power_event_name(sys_power_event_t event);
+
+#endif //SYS_POWER_FSM_H
@@ -0,0 +1,97 @@
+#ifndef SYS_TELEMETRY_H
+#define SYS_TELEMETRY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+/**
+ ** Always-on counters for the spikes the periodic watchers miss: per queue depth histogram,
+ ** timeouts and drops; per timer (dispatch handlers) execution time histogram from esp_timer;
+ ** per task CPU share when FreeRTOS run time stats are enabled.
+ **
+ ** Producers only touch their own core's counters with relaxed atomic adds, no locks; cores
+ ** are summed when a snapshot is taken. Snapshots are a little-endian binary blob, printed
+ ** as a TLM-BEGIN/TLM-END hex block by sys_tlm_dump(); `tools/sys_telemetry.py` decodes it.
+ **
+ ** With CONFIG_SYS_TELEMETRY unset everything below compiles away, and sys_tlm_queue_send()
+ ** is a plain xQueueSend().
+ */
+#define SYS_TLM_MAX_QUEUES  12
+#define SYS_TLM_MAX_TIMERS  20
+#define SYS_TLM_NAME_LEN    12          // Including NUL; longer names are cut
+#define SYS_TLM_TASK_NAME_LEN   16      // Same, for task names
+#define SYS_TLM_DEPTH_BUCKETS   8       // Depth 0..6, last is 7+
+#define SYS_TLM_TIME_BUCKETS    12      // <2us, <4us ... <2048us, last is the rest
+#define SYS_TLM_NONE        0xFF
+
+// Blob layout; all fields little-endian
+#define SYS_TLM_MAGIC       "TLM1"
+#define SYS_TLM_HDR_LEN     12  // magic, uint32 uptime ms, uint8 queues, uint8 timers, uint8 tasks, uint8 reserved
+#define SYS_TLM_QUEUE_LEN   (SYS_TLM_NAME_LEN + 12 + 4 * SYS_TLM_DEPTH_BUCKETS)    // name, sends, timeouts, drops, histogram
+#define SYS_TLM_TIMER_LEN   (SYS_TLM_NAME_LEN + 8 + 4 * SYS_TLM_TIME_BUCKETS)      // name, count, total us, histogram
+#define SYS_TLM_TASK_LEN    (SYS_TLM_TASK_NAME_LEN + 4)                             // name, uint16 CPU share per mille of a core, reserved
+
+typedef uint8_t sys_tlm_id_t;
+
+#ifdef CONFIG_SYS_TELEMETRY
+#include "esp_timer.h"
+
+void sys_tlm_init();
+
+// Return SYS_TLM_NONE once full; recording against SYS_TLM_NONE is a no-op
+sys_tlm_id_t sys_tlm_queue_register(const char* name);
+sys_tlm_id_t sys_tlm_timer_register(const char* name);
+
+void sys_tlm_queue_depth(sys_tlm_id_t id, uint32_t depth);
+void sys_tlm_queue_timeout(sys_tlm_id_t id);
+void sys_tlm_queue_drop(sys_tlm_id_t id);
+/**
+ ** start is a sys_tlm_now_us() value. esp_timer rather than the CPU cycle counter, which is
+ ** per core and scaled by a clock CONFIG_SYS_POWER lowers, so the task being timed needn't be
+ ** pinned and may run across a frequency change. Costs a little more to read than CCOUNT.
+ */
+void sys_tlm_timer_record(sys_tlm_id_t id, uint32_t start);
+
+// Fills out with the layout above; returns bytes written, 0 if size is too small. One caller
+// at a time, task CPU shares are relative to the previous snapshot.
+size_t sys_tlm_snapshot(uint8_t* out, size_t size);
+void sys_tlm_dump();
+
+static inline uint32_t sys_tlm_now_us() {
+    return (uint32_t)esp_timer_get_time();
+}
+
+// xQueueSend that records depth after a send, or a drop (no wait) / timeout (waited) on failure
+static inline BaseType_t sys_tlm_queue_send(sys_tlm_id_t id, QueueHandle_t queue, const void* item, TickType_t ticks_to_wait) {
+    BaseType_t ret = xQueueSend(queue, item, ticks_to_wait);
+
+    if(ret == pdTRUE) {
+        sys_tlm_queue_depth(id, uxQueueMessagesWaiting(queue));
+    } else if(ticks_to_wait == 0) {
+        sys_tlm_queue_drop(id);
+    } else {
+        sys_tlm_queue_timeout(id);
+    }
+    return ret;
+}
+#else
+static inline void sys_tlm_init() {}
+static inline sys_tlm_id_t sys_tlm_queue_register(const char* name) { return SYS_TLM_NONE; }
+static inline sys_tlm_id_t sys_tlm_timer_register(const char* name) { return SYS_TLM_NONE; }
+static inline void sys_tlm_queue_depth(sys_tlm_id_t id, uint32_t depth) {}
+static inline void sys_tlm_queue_timeout(sys_tlm_id_t id) {}
+static inline void sys_tlm_queue_drop(sys_tlm_id_t id) {}
+static inline void sys_tlm_timer_record(sys_tlm_id_t id, uint32_t start) {}
+static inline size_t sys_tlm_snapshot(uint8_t* out, size_t size) { return 0; }
+static inline void sys_tlm_dump() {}
+static inline uint32_t sys_tlm_now_us() { return 0; }
+
+static inline BaseType_t sys_tlm_queue_send(sys_tlm_id_t id, QueueHandle_t queue, const void* item, TickType_t ticks_to_wait) {
+    return xQueueSend(queue, item, ticks_to_wait);
+}
+#endif
+
+#endif //SYS_TELEMETRY_H
@@ -0,0 +1,95 @@
+#ifndef SYS_TOPOLOGY_H
+#define SYS_TOPOLOGY_H
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_task.h"
+#include "sys_monitor.h"
+
+/**
+ ** Where every task runs: stack, priority and core, for the whole firmware in one table.
+ ** Tasks are created with SYS_TASK_SPAWN(ID, fn, handle_out) and take their placement from
+ ** here, so moving a task is a one line change and the whole layout can be read at once.
+ **
+ ** The table has a column per topology, picked with CONFIG_SYS_TOPOLOGY_*, so placements
+ ** can be compared with the MFL -> AVRCP benchmark (CONFIG_KBUS_BENCH) instead of guessed:
+ **   split       K-bus on core 1, Bluetooth on core 0, display/UI tasks float
+ **   press path  bt_cmd next to kbus_disp on core 1, just under kbus_rx, display/UI on core 0
+ **   float       nothing pinned, the scheduler places everything
+ **
+ ** The btstack run loop is app_main itself (running it as its own task didn't work), so its
+ ** stack and core come from the main task; sys_topology_adopt() only applies its priority.
+ */
+#define SYS_PRIO_KBUS   (configMAX_PRIORITIES-5)
+#define SYS_PRIO_BT     (configMAX_PRIORITIES-8)
+#define SYS_CORE_ANY    tskNO_AFFINITY
+
+#if defined(CONFIG_SYS_TOPOLOGY_PRESS_PATH)
+#define SYS_TOPO(split, press_path, floating) (press_path)
+#elif defined(CONFIG_SYS_TOPOLOGY_FLOAT)
+#define SYS_TOPO(split, press_path, floating) (floating)
+#else
+#define SYS_TOPO(split, press_path, floating) (split)
+#endif
+
+// X(id, name, stack bytes, priority, core); SYS_TOPO(split, press path, float) where they differ
+#define SYS_TOPOLOGY_TASKS(X) \
+    X(KBUS_RX,      "kbus_rx",              2048, SYS_PRIO_KBUS,                            SYS_TOPO(1, 1, SYS_CORE_ANY)) \
+    X(KBUS_DISP,    "kbus_disp",            4096, SYS_PRIO_KBUS-1,                          SYS_TOPO(1, 1, SYS_CORE_ANY)) \
+    X(KBUS_TX,      "kbus_tx",              2048, SYS_PRIO_KBUS-1,                          SYS_TOPO(1, 1, SYS_CORE_ANY)) \
+    X(KBUS_VBUS_TX, "kbus_vbus_tx",         2048, SYS_PRIO_KBUS,                            SYS_TOPO(1, 1, SYS_CORE_ANY)) \
+    X(KBUS_REPLAY,  "kbus_replay",          3072, SYS_PRIO_KBUS-1,                          SYS_CORE_ANY) \
+    X(KBUS_CAPTURE, "kbus_capture",         3072, 1,                                        SYS_CORE_ANY) \
+    X(SDRS_EMU,     "sdrs_emu",             4096, SYS_PRIO_KBUS,                            SYS_TOPO(1, 1, SYS_CORE_ANY)) \
+    X(EMUS_INIT,    "emus_init",            4096, SYS_PRIO_KBUS+1,                          SYS_CORE_ANY) \
+    X(BT_TRK_INFO,  "bt_trk_info",          4096, SYS_PRIO_KBUS-2,                          SYS_TOPO(SYS_CORE_ANY, 0, SYS_CORE_ANY)) \
+    X(TEL_DISPLAY,  "tel_dis_tsk",          4096, SYS_PRIO_KBUS-2,                          SYS_TOPO(SYS_CORE_ANY, 0, SYS_CORE_ANY)) \
+    X(BT_CMD,       "bt_cmd",               2048, SYS_TOPO(SYS_PRIO_BT, SYS_PRIO_KBUS-1, SYS_PRIO_BT), SYS_TOPO(0, 1, SYS_CORE_ANY)) \
+    X(BT_AUTO_CON,  "bt_auto_con",          4096, SYS_PRIO_BT-10,                           SYS_TOPO(0, 0, SYS_CORE_ANY)) \
+    X(BT_RUNLOOP,   "main",                 ESP_TASK_MAIN_STACK, ESP_TASK_MAIN_PRIO,        0) \
+    X(SYS_REPORT,   "sys_report",           3072, 1,                                        SYS_CORE_ANY) \
+    X(SYS_TLM,      "sys_tlm",              3072, 1,                                        SYS_CORE_ANY) \
+    X(SYS_TRACE,    "sys_trace",            3072, 1,                                        SYS_CORE_ANY) \
+    X(SYS_DLOG,     "sys_dlog",             2560, tskIDLE_PRIORITY+1,                       SYS_CORE_ANY) \
+    X(SYS_POWER,    "sys_power",            2560, 2,                                        SYS_CORE_ANY) \
+    X(KBUS_WATCHER, "kbus_queue_watcher",   4096, 5,                                        SYS_CORE_ANY) \
+    X(TASK_WATCHER, "task_watcher",         4096, 5,                                        SYS_CORE_ANY) \
+    X(BENCH,        "kbus_bench",           3072, SYS_PRIO_KBUS+1,                          SYS_CORE_ANY) \
+    X(BENCH_BUS,    "bench_bus",            2048, SYS_PRIO_KBUS+1,                          SYS_CORE_ANY) \
+    X(BENCH_BT,     "bench_bt",             2560, SYS_PRIO_BT-10,                           SYS_TOPO(0, 0, SYS_CORE_ANY))
+
+#define SYS_TOPOLOGY_ID(id, name, stack, prio, core) SYS_TASK_##id,
+typedef enum {
+    SYS_TOPOLOGY_TASKS(SYS_TOPOLOGY_ID)
+    SYS_TASK_COUNT
+} sys_task_id_t;
+#undef SYS_TOPOLOGY_ID
+
+// Compile time constants, SYS_TASK_STACK_<id> etc., since static allocation sizes stacks at compile time
+#define SYS_TOPOLOGY_CONST(id, name, stack, prio, core) \
+    SYS_TASK_STACK_##id = (stack), SYS_TASK_PRIO_##id = (prio), SYS_TASK_CORE_##id = (core),
+enum {
+    SYS_TOPOLOGY_TASKS(SYS_TOPOLOGY_CONST)
+};
+#undef SYS_TOPOLOGY_CONST
+
+typedef struct {
+    const char* name;
+    uint32_t stack_bytes;
+    UBaseType_t priority;
+    BaseType_t core;
+} sys_task_spec_t;
+
+extern const sys_task_spec_t sys_topology[SYS_TASK_COUNT];
+
+// SYS_TASK_CREATE with the table's placement; same one-task-per-call-site rule
+#define SYS_TASK_SPAWN(id, fn, handle_out) \
+    SYS_TASK_CREATE((fn), sys_topology[SYS_TASK_##id].name, SYS_TASK_STACK_##id, SYS_TASK_PRIO_##id, (handle_out), SYS_TASK_CORE_##id)
+
+const char* sys_topology_name();
+
+// For a task the table describes but didn't create; applies its priority, warns if it's on another core
+void sys_topology_adopt(sys_task_id_t id);
+
+#endif //SYS_TOPOLOGY_H
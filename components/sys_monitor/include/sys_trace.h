@@ -0,0 +1,50 @@
+#ifndef SYS_TRACE_H
+#define SYS_TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ ** Per-frame latency tracing. A K-bus frame gets a trace id when kbus_rx_task takes it off
+ ** the driver queue; the id rides along through dispatch, handlers, bt_cmd_queue and the tx
+ ** scheduler, and each stage drops a timestamped record into a RAM ring. Frames that start
+ ** locally (replies, MFL hold timers) get a fresh id at their first stage.
+ **
+ ** Writers claim a slot with an atomic add and publish it with a sequence number, so any
+ ** task on either core can record without a lock; the oldest records get overwritten.
+ ** sys_trace_dump() prints the ring as a TRC-BEGIN/TRC-END hex block, and
+ ** `tools/sys_trace.py` turns that into Chrome/Perfetto trace JSON plus per-stage percentiles.
+ */
+typedef enum {
+    SYS_TRACE_RX_DEQUEUE = 1,   // arg: src << 8 | dst; earliest point we own, driver rx is before this
+    SYS_TRACE_DISPATCH,         // arg: src << 8 | dst
+    SYS_TRACE_HANDLER_BEGIN,    // arg: inline subscriber id (kbus_pubsub.h)
+    SYS_TRACE_HANDLER_END,      // arg: as HANDLER_BEGIN
+    SYS_TRACE_BT_ENQUEUE,       // arg: bt_cmd_type_t
+    SYS_TRACE_BT_DEQUEUE,       // arg: bt_cmd_type_t
+    SYS_TRACE_AVRCP_SENT,       // arg: bt_cmd_type_t; handed to btstack
+    SYS_TRACE_TX_SUBMIT,        // arg: dst << 8 | first body byte
+    SYS_TRACE_TX_HANDOFF,       // arg: as TX_SUBMIT; in the driver's queue, wire time is up to the driver
+    SYS_TRACE_STAGES
+} sys_trace_stage_t;
+
+#define SYS_TRACE_NO_ID 0
+
+// Dump layout, little-endian: magic, uint32 record count, uint32 now us; then records oldest first
+#define SYS_TRACE_MAGIC     "TRC1"
+#define SYS_TRACE_HDR_LEN   12
+#define SYS_TRACE_REC_LEN   12  // uint32 us, uint16 id, uint16 arg, uint8 stage, uint8 core, 2 reserved
+
+#ifdef CONFIG_SYS_TRACE
+void sys_trace_init();
+uint16_t sys_trace_new_id();
+void sys_trace(sys_trace_stage_t stage, uint16_t id, uint16_t arg);
+void sys_trace_dump();
+#else
+static inline void sys_trace_init() {}
+static inline uint16_t sys_trace_new_id() { return SYS_TRACE_NO_ID; }
+static inline void sys_trace(sys_trace_stage_t stage, uint16_t id, uint16_t arg) {}
+static inline void sys_trace_dump() {}
+#endif
+
+#endif //SYS_TRACE_H
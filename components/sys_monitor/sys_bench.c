@@ -0,0 +1,84 @@
+// C stdlib includes
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// FreeRTOS includes
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// esp-idf includes
+#include "esp_timer.h"
+
+// component includes
+#include "sys_bench.h"
+#include "sys_topology.h"
+
+static uint32_t samples[SYS_BENCH_MAX_SAMPLES];    // us
+static uint16_t sample_count = 0;
+static uint16_t lost = 0;
+static uint32_t started_us;
+static bool armed = false;
+static TaskHandle_t waiter = NULL;
+
+static int cmp_u32(const void* a, const void* b);
+static uint32_t percentile(uint8_t pct);
+
+void sys_bench_reset() {
+    sample_count = 0;
+    lost = 0;
+}
+
+void sys_bench_begin() {
+    waiter = xTaskGetCurrentTaskHandle();
+    started_us = (uint32_t)esp_timer_get_time();
+    // Start time is in place before sys_bench_end() can see the sample
+    __atomic_store_n(&armed, true, __ATOMIC_RELEASE);
+}
+
+void sys_bench_end() {
+    uint32_t now_us = (uint32_t)esp_timer_get_time();
+
+    if(!__atomic_exchange_n(&armed, false, __ATOMIC_ACQ_REL)) return;
+    if(sample_count < SYS_BENCH_MAX_SAMPLES) samples[sample_count++] = now_us - started_us;
+    xTaskNotifyGive(waiter);
+}
+
+bool sys_bench_wait(TickType_t ticks) {
+    if(ulTaskNotifyTake(pdTRUE, ticks)) return true;
+    if(__atomic_exchange_n(&armed, false, __ATOMIC_ACQ_REL)) {
+        lost++;
+        return false;
+    }
+    // Ended between the timeout and the exchange; its notification is on the way
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    return true;
+}
+
+void sys_bench_report(const char* phase) {
+    uint64_t total = 0;
+
+    qsort(samples, sample_count, sizeof(samples[0]), cmp_u32);
+    for(uint16_t i = 0; i < sample_count; i++) total += samples[i];
+
+    printf("BENCH topology=%s phase=%s n=%u lost=%u mean=%u min=%u p50=%u p90=%u p99=%u max=%u\n",
+           sys_topology_name(), phase, sample_count, lost,
+           sample_count ? (unsigned)(total / sample_count) : 0,
+           sample_count ? (unsigned)samples[0] : 0,
+           (unsigned)percentile(50), (unsigned)percentile(90), (unsigned)percentile(99),
+           sample_count ? (unsigned)samples[sample_count - 1] : 0);
+}
+
+static int cmp_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest rank, samples sorted
+static uint32_t percentile(uint8_t pct) {
+    uint32_t rank;
+
+    if(sample_count == 0) return 0;
+    rank = ((uint32_t)sample_count * pct + 99) / 100;
+    return samples[rank ? rank - 1 : 0];
+}
@@ -0,0 +1,151 @@
+// C stdlib includes
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+// FreeRTOS includes
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// esp-idf includes
+#include "esp_log.h"
+#include "esp_timer.h"
+
+// component includes
+#include "sys_dlog.h"
+#include "sys_monitor.h"
+#include "sys_topology.h"
+
+#define RING_RECORDS CONFIG_SYS_DLOG_RECORDS
+#define RING_MASK (RING_RECORDS - 1)
+#define DRAIN_IDLE_MS 50
+#define REC_HDR_LEN 8   // us, site, buffer length, flags; what's printed ahead of args and buffer
+
+_Static_assert((RING_RECORDS & RING_MASK) == 0, "CONFIG_SYS_DLOG_RECORDS must be a power of two");
+
+/**
+ ** Fixed size so any task on either core can claim one with a single atomic add; seq
+ ** publishes it. Printed as: uint32 us, uint16 site, uint8 buffer length before the cut,
+ ** uint8 flags (bits 0-2 arg count, bit 7 core), args, then the stored buffer bytes.
+ */
+typedef struct {
+    uint32_t seq;       // Claim count + 1 once complete, 0 while it's being written
+    uint32_t us;
+    uint16_t site;
+    uint8_t buf_len;
+    uint8_t flags;
+    uint32_t args[SYS_DLOG_MAX_ARGS];
+    uint8_t buf[SYS_DLOG_BUF_MAX];
+} dlog_rec_t;
+
+static const char* TAG = "sys_dlog";
+static const char hex_digits[] = "0123456789abcdef";
+static dlog_rec_t ring[RING_RECORDS];
+static uint32_t claimed = 0;
+
+static void drain_task();
+
+void sys_dlog_init() {
+    int tsk_ret = SYS_TASK_SPAWN(SYS_DLOG, drain_task, NULL);
+    if(tsk_ret != pdPASS){ ESP_LOGE(TAG, "sys_dlog creation failed with: %d", tsk_ret);}
+}
+
+void sys_dlog_write(uint16_t site, const void* buf, size_t len, const uint32_t* args, uint8_t nargs) {
+    uint32_t n = __atomic_fetch_add(&claimed, 1, __ATOMIC_RELAXED);
+    dlog_rec_t* rec = &ring[n & RING_MASK];
+    size_t stored = len < SYS_DLOG_BUF_MAX ? len : SYS_DLOG_BUF_MAX;
+
+    __atomic_store_n(&rec->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    rec->us = (uint32_t)esp_timer_get_time();
+    rec->site = site;
+    rec->buf_len = len < 255 ? len : 255;
+    rec->flags = nargs | (xPortGetCoreID() << 7);
+    memcpy(rec->args, args, nargs * sizeof(uint32_t));
+    if(stored) memcpy(rec->buf, buf, stored);
+    __atomic_store_n(&rec->seq, n + 1, __ATOMIC_RELEASE);
+}
+
+static void print_rec(const dlog_rec_t* rec) {
+    char line[3 + 2 * (REC_HDR_LEN + sizeof(rec->args) + SYS_DLOG_BUF_MAX) + 2];
+    uint8_t bytes[REC_HDR_LEN + sizeof(rec->args) + SYS_DLOG_BUF_MAX];
+    uint8_t nargs = rec->flags & 0x07;
+    size_t stored = rec->buf_len < SYS_DLOG_BUF_MAX ? rec->buf_len : SYS_DLOG_BUF_MAX;
+    size_t len = REC_HDR_LEN;
+    char* p = line;
+
+    memcpy(bytes, &rec->us, REC_HDR_LEN);   // Little-endian, same as the wire order
+    memcpy(&bytes[len], rec->args, nargs * sizeof(uint32_t));
+    len += nargs * sizeof(uint32_t);
+    memcpy(&bytes[len], rec->buf, stored);
+    len += stored;
+
+    *p++ = 'D';
+    *p++ = 'L';
+    *p++ = ' ';
+    for(size_t i = 0; i < len; i++) {
+        *p++ = hex_digits[bytes[i] >> 4];
+        *p++ = hex_digits[bytes[i] & 0x0F];
+    }
+    *p++ = '\n';
+    fwrite(line, 1, p - line, stdout);
+}
+
+static void print_lost(uint32_t lost) {
+    dlog_rec_t marker = {
+        .us = (uint32_t)esp_timer_get_time(),
+        .site = SYS_DLOG_SITE_LOST,
+        .flags = 1,
+        .args = {lost}
+    };
+    print_rec(&marker);
+}
+
+/**
+ ** Prints records in claim order. One that's still being written stops the drain until the
+ ** next pass; ones overwritten before we got to them are reported as lost.
+ */
+static void drain_task() {
+    uint32_t drained = 0;
+    dlog_rec_t copy;
+
+    while(1) {
+        uint32_t end = __atomic_load_n(&claimed, __ATOMIC_ACQUIRE);
+        uint32_t lost = 0;
+
+        if(end - drained > RING_RECORDS) {
+            lost = end - drained - RING_RECORDS;
+            drained = end - RING_RECORDS;
+        }
+
+        while(drained != end) {
+            const dlog_rec_t* rec = &ring[drained & RING_MASK];
+            uint32_t seq = __atomic_load_n(&rec->seq, __ATOMIC_ACQUIRE);
+
+            if(seq != drained + 1) {
+                if(seq != 0 && (int32_t)(seq - (drained + 1)) > 0) {   // Lapped
+                    lost++;
+                    drained++;
+                    continue;
+                }
+                break;  // Writer hasn't finished it yet
+            }
+
+            memcpy(&copy, rec, sizeof(copy));
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if(__atomic_load_n(&rec->seq, __ATOMIC_RELAXED) != seq) {
+                lost++;     // Overwritten mid-copy
+            } else {
+                if(lost) print_lost(lost);
+                lost = 0;
+                print_rec(&copy);
+            }
+            drained++;
+        }
+        if(lost) print_lost(lost);
+
+        fflush(stdout);
+        vTaskDelay(pdMS_TO_TICKS(DRAIN_IDLE_MS));
+    }
+    vTaskDelete(NULL); // In case we leave the loop, to avoid a panic
+}
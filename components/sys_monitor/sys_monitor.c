@@ -0,0 +1,172 @@
+// C stdlib includes
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+// FreeRTOS includes
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+// esp-idf includes
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+
+// component includes
+#include "sys_monitor.h"
+#include "sys_topology.h"
+#include "sys_telemetry.h"
+#include "sys_dlog.h"
+#include "sys_trace.h"
+
+#define SECONDS(sec) ((sec*1000) / portTICK_RATE_MS)
+#define MAX_OWNERS (SYS_MONITOR_MAX_TASKS + SYS_MONITOR_MAX_QUEUES)
+
+typedef struct {
+    TaskHandle_t task;
+    const char* owner;
+    uint32_t stack_bytes;
+    bool is_static;
+} task_entry_t;
+
+typedef struct {
+    QueueHandle_t queue;
+    const char* owner;
+    const char* name;
+    uint32_t bytes;
+    bool is_static;
+} queue_entry_t;
+
+static const char* TAG = "sys_monitor";
+static task_entry_t tasks[SYS_MONITOR_MAX_TASKS];
+static queue_entry_t queues[SYS_MONITOR_MAX_QUEUES];
+static portMUX_TYPE registry_mux = portMUX_INITIALIZER_UNLOCKED;
+
+#if CONFIG_SYS_MONITOR_REPORT_SEC > 0
+static void report_task() {
+    while(1) {
+        vTaskDelay(SECONDS(CONFIG_SYS_MONITOR_REPORT_SEC));
+        sys_monitor_report();
+    }
+    vTaskDelete(NULL); // In case we leave the loop, to avoid a panic
+}
+#endif
+
+void sys_monitor_init() {
+    sys_tlm_init();
+    sys_dlog_init();
+    sys_trace_init();
+#if CONFIG_SYS_MONITOR_REPORT_SEC > 0
+    int tsk_ret = SYS_TASK_SPAWN(SYS_REPORT, report_task, NULL);
+    if(tsk_ret != pdPASS){ ESP_LOGE(TAG, "sys_report creation failed with: %d", tsk_ret);}
+#endif
+}
+
+void sys_monitor_add_task(TaskHandle_t task, const char* owner, uint32_t stack_bytes, bool is_static) {
+    portENTER_CRITICAL(&registry_mux);
+    for(int i = 0; i < SYS_MONITOR_MAX_TASKS; i++) {
+        if(tasks[i].task == NULL) {
+            tasks[i] = (task_entry_t){task, owner, stack_bytes, is_static};
+            portEXIT_CRITICAL(&registry_mux);
+            return;
+        }
+    }
+    portEXIT_CRITICAL(&registry_mux);
+    ESP_LOGW(TAG, "Task registry full, %s not tracked", pcTaskGetTaskName(task));
+}
+
+void sys_monitor_add_queue(QueueHandle_t queue, const char* owner, const char* name, uint32_t bytes, bool is_static) {
+    portENTER_CRITICAL(&registry_mux);
+    for(int i = 0; i < SYS_MONITOR_MAX_QUEUES; i++) {
+        if(queues[i].queue == NULL) {
+            queues[i] = (queue_entry_t){queue, owner, name, bytes, is_static};
+            portEXIT_CRITICAL(&registry_mux);
+            return;
+        }
+    }
+    portEXIT_CRITICAL(&registry_mux);
+    ESP_LOGW(TAG, "Queue registry full, %s not tracked", name);
+}
+
+void sys_monitor_task_exit() {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+
+    portENTER_CRITICAL(&registry_mux);
+    for(int i = 0; i < SYS_MONITOR_MAX_TASKS; i++) {
+        if(tasks[i].task == self) tasks[i].task = NULL;
+    }
+    portEXIT_CRITICAL(&registry_mux);
+
+    vTaskDelete(NULL);
+}
+
+void sys_monitor_report() {
+    static task_entry_t task_copy[SYS_MONITOR_MAX_TASKS];
+    static queue_entry_t queue_copy[SYS_MONITOR_MAX_QUEUES];
+    static struct {
+        const char* owner;
+        uint32_t stack_bytes;
+        uint32_t queue_bytes;
+        uint8_t tasks;
+        uint8_t queues;
+    } owners[MAX_OWNERS];
+    int owner_count = 0;
+
+    // Snapshot so printing happens outside the critical section
+    portENTER_CRITICAL(&registry_mux);
+    memcpy(task_copy, tasks, sizeof(tasks));
+    memcpy(queue_copy, queues, sizeof(queues));
+    portEXIT_CRITICAL(&registry_mux);
+
+    memset(owners, 0, sizeof(owners));
+    for(int i = 0; i < SYS_MONITOR_MAX_TASKS + SYS_MONITOR_MAX_QUEUES; i++) {
+        bool is_task = i < SYS_MONITOR_MAX_TASKS;
+        const char* owner;
+        int o;
+
+        if(is_task && task_copy[i].task == NULL) continue;
+        if(!is_task && queue_copy[i - SYS_MONITOR_MAX_TASKS].queue == NULL) continue;
+        owner = is_task ? task_copy[i].owner : queue_copy[i - SYS_MONITOR_MAX_TASKS].owner;
+
+        for(o = 0; o < owner_count && strcmp(owners[o].owner, owner); o++);
+        if(o == owner_count) owners[owner_count++].owner = owner;
+
+        if(is_task) {
+            owners[o].tasks++;
+            owners[o].stack_bytes += task_copy[i].stack_bytes;
+        } else {
+            owners[o].queues++;
+            owners[o].queue_bytes += queue_copy[i - SYS_MONITOR_MAX_TASKS].bytes;
+        }
+    }
+
+    printf("\n%sMemory map (%s)%s\n", "\033[1m\033[4m\033[44;1m\033[K",
+#ifdef CONFIG_SYS_STATIC_ALLOCATION
+            "static",
+#else
+            "heap",
+#endif
+            LOG_RESET_COLOR);
+    printf("Owner\t\tTasks\tStack B\tQueues\tQueue B\n");
+    for(int o = 0; o < owner_count; o++) {
+        printf("%-15s\t%d\t%"PRIu32"\t%d\t%"PRIu32"\n", owners[o].owner, owners[o].tasks, owners[o].stack_bytes,
+                owners[o].queues, owners[o].queue_bytes);
+    }
+
+    printf("%sTask\t\tOwner\t\tStack B\tMin free B\tPeak use%%%s\n", "\033[1m\033[4m\033[42m\033[K", LOG_RESET_COLOR);
+    for(int i = 0; i < SYS_MONITOR_MAX_TASKS; i++) {
+        uint32_t free_bytes;
+
+        if(task_copy[i].task == NULL) continue;
+        // ESP-IDF counts stacks in bytes
+        free_bytes = uxTaskGetStackHighWaterMark(task_copy[i].task);
+        printf("%-15s\t%-15s\t%"PRIu32"\t%"PRIu32"\t\t%"PRIu32"\n", pcTaskGetTaskName(task_copy[i].task), task_copy[i].owner,
+                task_copy[i].stack_bytes, free_bytes, 100 - (free_bytes * 100 / task_copy[i].stack_bytes));
+    }
+
+    printf("Heap: %d free, %d min free, %d largest block\n",
+            (int)heap_caps_get_free_size(MALLOC_CAP_8BIT),
+            (int)heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT),
+            (int)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+}
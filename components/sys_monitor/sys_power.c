@@ -0,0 +1,194 @@
+// C stdlib includes
+#include <stddef.h>
+
+// FreeRTOS includes
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+
+// esp-idf includes
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "driver/uart.h"
+
+// component includes
+#include "sys_power.h"
+#include "sys_topology.h"
+
+#if CONFIG_SYS_POWER_MIN_MHZ < 80 && !defined(CONFIG_SYS_POWER_UART_REF_TICK)
+#error "SYS_POWER_MIN_MHZ below 80 drops APB under an APB clocked K-bus UART; set SYS_POWER_UART_REF_TICK"
+#endif
+
+#define POWER_RUN_BIT       0x01    // Set unless OFF; parked workers wait on it
+#define POWER_WAKE_EDGES    3       // RX edges that wake from light sleep; the waking byte is lost
+
+static const char* TAG = "sys_power";
+static sys_power_fsm_t fsm;
+static SemaphoreHandle_t fsm_lock = NULL;
+static EventGroupHandle_t power_events = NULL;
+static TaskHandle_t power_tsk = NULL;
+static esp_pm_lock_handle_t cpu_lock, sleep_lock;
+static uint32_t activity_ms;        // Last sys_power_note_activity(), ahead of what fsm has seen
+static int64_t wake_us;
+static bool awaiting_reply = false;
+static sys_power_stats_t stats;
+static portMUX_TYPE stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static void power_task();
+static void feed(sys_power_event_t event, int64_t now_us);
+static void apply(sys_power_state_t from, sys_power_state_t to, sys_power_event_t event, int64_t now_us);
+static void configure_sleep();
+
+static inline uint32_t to_ms(int64_t us) {
+    return (uint32_t)(us / 1000);
+}
+
+void sys_power_init() {
+    sys_power_cfg_t cfg = {
+        .silence_ms = CONFIG_SYS_POWER_SILENCE_SEC * 1000,
+        .linger_ms = CONFIG_SYS_POWER_LINGER_SEC * 1000,
+    };
+    int64_t now_us = esp_timer_get_time();
+
+    esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "sys_power", &cpu_lock);
+    esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "sys_power", &sleep_lock);
+    // Starts ON; locks are taken before power management is allowed to do anything
+    esp_pm_lock_acquire(cpu_lock);
+    esp_pm_lock_acquire(sleep_lock);
+    configure_sleep();
+
+    sys_power_fsm_init(&fsm, &cfg, to_ms(now_us));
+    activity_ms = to_ms(now_us);
+    power_events = xEventGroupCreate();
+    xEventGroupSetBits(power_events, POWER_RUN_BIT);
+    fsm_lock = xSemaphoreCreateMutex();
+
+    int tsk_ret = SYS_TASK_SPAWN(SYS_POWER, power_task, &power_tsk);
+    if(tsk_ret != pdPASS){ ESP_LOGE(TAG, "sys_power creation failed with: %d", tsk_ret);}
+}
+
+void sys_power_note_ignition(bool on) {
+    feed(on ? SYS_POWER_EV_IGN_ON : SYS_POWER_EV_IGN_OFF, esp_timer_get_time());
+}
+
+void sys_power_note_request() {
+    // Only a wake changes anything; otherwise the activity timestamp covers it
+    if(fsm.state == SYS_POWER_OFF) feed(SYS_POWER_EV_REQUEST, esp_timer_get_time());
+}
+
+void sys_power_note_activity() {
+    __atomic_store_n(&activity_ms, to_ms(esp_timer_get_time()), __ATOMIC_RELAXED);
+}
+
+void sys_power_note_tx() {
+    int64_t now_us;
+    uint32_t sample;
+
+    if(!__atomic_exchange_n(&awaiting_reply, false, __ATOMIC_ACQ_REL)) return;
+    now_us = esp_timer_get_time();
+    sample = (uint32_t)(now_us - wake_us);
+
+    portENTER_CRITICAL(&stats_mux);
+    stats.reply_samples++;
+    stats.reply_last_us = sample;
+    stats.reply_total_us += sample;
+    if(sample > stats.reply_max_us) stats.reply_max_us = sample;
+    portEXIT_CRITICAL(&stats_mux);
+    ESP_LOGI(TAG, "Wake to first reply %u us", sample);
+}
+
+void sys_power_park() {
+    if(power_events == NULL) return;
+    xEventGroupWaitBits(power_events, POWER_RUN_BIT, pdFALSE, pdTRUE, portMAX_DELAY);
+}
+
+void sys_power_get_stats(sys_power_stats_t* out) {
+    portENTER_CRITICAL(&stats_mux);
+    *out = stats;
+    portEXIT_CRITICAL(&stats_mux);
+    out->state = fsm.state;
+}
+
+/**
+ ** Timeouts only; sleeps until the next one could fire, or indefinitely while OFF so the
+ ** core can stay in light sleep. Activity only moves deadlines out, so waking early to
+ ** recompute is all it costs; transitions notify the task since they can bring one in.
+ */
+static void power_task() {
+    uint32_t wait_ms;
+
+    while(1) {
+        xSemaphoreTake(fsm_lock, portMAX_DELAY);
+        wait_ms = sys_power_fsm_next_ms(&fsm, to_ms(esp_timer_get_time()));
+        xSemaphoreGive(fsm_lock);
+
+        ulTaskNotifyTake(pdTRUE, wait_ms == UINT32_MAX ? portMAX_DELAY : wait_ms / portTICK_PERIOD_MS + 1);
+        feed(SYS_POWER_EV_TICK, esp_timer_get_time());
+    }
+    vTaskDelete(NULL); // In case we leave the loop, to avoid a panic
+}
+
+static void feed(sys_power_event_t event, int64_t now_us) {
+    sys_power_state_t from, to;
+    uint32_t seen_ms;
+
+    if(fsm_lock == NULL) return;
+    xSemaphoreTake(fsm_lock, portMAX_DELAY);
+    from = fsm.state;
+    // Frames since the last event first, so the silence timeout sees them
+    seen_ms = __atomic_load_n(&activity_ms, __ATOMIC_RELAXED);
+    if((int32_t)(seen_ms - fsm.activity_ms) > 0) sys_power_fsm_event(&fsm, SYS_POWER_EV_ACTIVITY, seen_ms);
+    to = sys_power_fsm_event(&fsm, event, to_ms(now_us));
+    if(to != from) apply(from, to, event, now_us);
+    xSemaphoreGive(fsm_lock);
+}
+
+// fsm_lock held; only OFF differs from the others in what's running
+static void apply(sys_power_state_t from, sys_power_state_t to, sys_power_event_t event, int64_t now_us) {
+    ESP_LOGI(TAG, "%s -> %s on %s", sys_power_state_name(from), sys_power_state_name(to), sys_power_event_name(event));
+
+    if(from == SYS_POWER_OFF) {
+        esp_pm_lock_acquire(cpu_lock);
+        esp_pm_lock_acquire(sleep_lock);
+        wake_us = now_us;
+        __atomic_store_n(&awaiting_reply, true, __ATOMIC_RELEASE);
+        xEventGroupSetBits(power_events, POWER_RUN_BIT);
+        portENTER_CRITICAL(&stats_mux);
+        stats.wakes++;
+        portEXIT_CRITICAL(&stats_mux);
+    } else if(to == SYS_POWER_OFF) {
+        xEventGroupClearBits(power_events, POWER_RUN_BIT);
+        __atomic_store_n(&awaiting_reply, false, __ATOMIC_RELEASE);
+        esp_pm_lock_release(sleep_lock);
+        esp_pm_lock_release(cpu_lock);
+        portENTER_CRITICAL(&stats_mux);
+        stats.sleeps++;
+        portEXIT_CRITICAL(&stats_mux);
+    }
+    // New deadlines; the power task may be waiting on the old ones
+    if(power_tsk != NULL && xTaskGetCurrentTaskHandle() != power_tsk) xTaskNotifyGive(power_tsk);
+}
+
+/**
+ ** Minimum speed whenever nothing holds the locks, and tickless idle light sleep woken by
+ ** K-bus RX edges. APB stays at 80 MHz unless the K-bus UART runs from REF_TICK, so its baud
+ ** rate holds while off. The Bluetooth controller keeps its own lock unless modem sleep is set up.
+ */
+static void configure_sleep() {
+    esp_pm_config_esp32_t pm_config = {
+        .max_freq_mhz = CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = CONFIG_SYS_POWER_MIN_MHZ,
+        .light_sleep_enable = true
+    };
+    esp_err_t err;
+
+    err = esp_pm_configure(&pm_config);
+    if(err != ESP_OK) ESP_LOGE(TAG, "esp_pm_configure failed with: %d", err);
+
+    uart_set_wakeup_threshold(CONFIG_SYS_POWER_WAKE_UART, POWER_WAKE_EDGES);
+    err = esp_sleep_enable_uart_wakeup(CONFIG_SYS_POWER_WAKE_UART);
+    if(err != ESP_OK) ESP_LOGE(TAG, "UART%d wakeup failed with: %d", CONFIG_SYS_POWER_WAKE_UART, err);
+}
@@ -0,0 +1,75 @@
+// C stdlib includes
+#include <stddef.h>
+
+// component includes
+#include "sys_power_fsm.h"
+
+static const char* state_names[SYS_POWER_STATES] = {"on", "linger", "off"};
+static const char* event_names[SYS_POWER_EVENTS] = {"ignition on", "ignition off", "request", "activity", "tick"};
+
+static uint32_t remaining(uint32_t since_ms, uint32_t timeout_ms, uint32_t now_ms);
+
+void sys_power_fsm_init(sys_power_fsm_t* fsm, const sys_power_cfg_t* cfg, uint32_t now_ms) {
+    fsm->cfg = *cfg;
+    fsm->state = SYS_POWER_ON;
+    fsm->entered_ms = now_ms;
+    fsm->activity_ms = now_ms;
+}
+
+sys_power_state_t sys_power_fsm_event(sys_power_fsm_t* fsm, sys_power_event_t event, uint32_t now_ms) {
+    sys_power_state_t next = fsm->state;
+
+    if(event != SYS_POWER_EV_TICK) fsm->activity_ms = now_ms;
+
+    switch(fsm->state) {
+        case SYS_POWER_ON:
+            if(event == SYS_POWER_EV_IGN_OFF) next = SYS_POWER_LINGER;
+            break;
+        case SYS_POWER_LINGER:
+            if(event == SYS_POWER_EV_IGN_ON) next = SYS_POWER_ON;
+            else if(remaining(fsm->entered_ms, fsm->cfg.linger_ms, now_ms) == 0) next = SYS_POWER_OFF;
+            break;
+        case SYS_POWER_OFF:
+            // A request with the key out is the radio on by itself; ON, and silence ends it
+            if(event == SYS_POWER_EV_IGN_ON || event == SYS_POWER_EV_REQUEST) next = SYS_POWER_ON;
+            break;
+        default:
+            break;
+    }
+    if(next != SYS_POWER_OFF && remaining(fsm->activity_ms, fsm->cfg.silence_ms, now_ms) == 0) next = SYS_POWER_OFF;
+
+    if(next != fsm->state) {
+        fsm->state = next;
+        fsm->entered_ms = now_ms;
+    }
+    return next;
+}
+
+uint32_t sys_power_fsm_next_ms(const sys_power_fsm_t* fsm, uint32_t now_ms) {
+    uint32_t silence = remaining(fsm->activity_ms, fsm->cfg.silence_ms, now_ms);
+    uint32_t linger;
+
+    switch(fsm->state) {
+        case SYS_POWER_ON:
+            return silence;
+        case SYS_POWER_LINGER:
+            linger = remaining(fsm->entered_ms, fsm->cfg.linger_ms, now_ms);
+            return linger < silence ? linger : silence;
+        default:
+            return UINT32_MAX;
+    }
+}
+
+const char* sys_power_state_name(sys_power_state_t state) {
+    return state < SYS_POWER_STATES ? state_names[state] : "?";
+}
+
+const char* sys_power_event_name(sys_power_event_t event) {
+    return event < SYS_POWER_EVENTS ? event_names[event] : "?";
+}
+
+// Wrap safe; 0 once timeout_ms has passed since since_ms
+static uint32_t remaining(uint32_t since_ms, uint32_t timeout_ms, uint32_t now_ms) {
+    uint32_t elapsed = now_ms - since_ms;
+    return elapsed >= timeout_ms ? 0 : timeout_ms - elapsed;
+}
@@ -0,0 +1,258 @@
+// C stdlib includes
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+// FreeRTOS includes
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// esp-idf includes
+#include "esp_log.h"
+#include "esp_timer.h"
+
+// component includes
+#include "sys_telemetry.h"
+#include "sys_monitor.h"
+#include "sys_topology.h"
+
+#define SECONDS(sec) ((sec*1000) / portTICK_RATE_MS)
+#define MAX_TASKS 32    // Ours plus esp-idf's and btstack's
+#define DUMP_MAX (SYS_TLM_HDR_LEN + SYS_TLM_MAX_QUEUES * SYS_TLM_QUEUE_LEN + SYS_TLM_MAX_TIMERS * SYS_TLM_TIMER_LEN + MAX_TASKS * SYS_TLM_TASK_LEN)
+
+#define ADD_RLX(p, v) __atomic_fetch_add((p), (v), __ATOMIC_RELAXED)
+#define LOAD_RLX(p)   __atomic_load_n((p), __ATOMIC_RELAXED)
+
+typedef struct {
+    uint32_t sends;
+    uint32_t timeouts;
+    uint32_t drops;
+    uint32_t depth[SYS_TLM_DEPTH_BUCKETS];
+} queue_counters_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t total_us;
+    uint32_t hist[SYS_TLM_TIME_BUCKETS];
+} timer_counters_t;
+
+// One per core; a core only ever adds to its own, so the adds never contend
+typedef struct {
+    queue_counters_t queues[SYS_TLM_MAX_QUEUES];
+    timer_counters_t timers[SYS_TLM_MAX_TIMERS];
+} core_counters_t;
+
+static const char* TAG = "sys_tlm";
+static core_counters_t cores[portNUM_PROCESSORS];
+static char queue_names[SYS_TLM_MAX_QUEUES][SYS_TLM_NAME_LEN];
+static char timer_names[SYS_TLM_MAX_TIMERS][SYS_TLM_NAME_LEN];
+static uint8_t queue_count = 0, timer_count = 0;
+static portMUX_TYPE register_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static sys_tlm_id_t register_name(char names[][SYS_TLM_NAME_LEN], uint8_t* count, uint8_t max, const char* name);
+static uint8_t put_tasks(uint8_t* out, size_t size);
+
+static inline void put_u32(uint8_t* out, uint32_t val) {
+    out[0] = val & 0xFF;
+    out[1] = (val >> 8) & 0xFF;
+    out[2] = (val >> 16) & 0xFF;
+    out[3] = val >> 24;
+}
+
+#if CONFIG_SYS_TELEMETRY_DUMP_SEC > 0
+static void dump_task() {
+    while(1) {
+        vTaskDelay(SECONDS(CONFIG_SYS_TELEMETRY_DUMP_SEC));
+        sys_tlm_dump();
+    }
+    vTaskDelete(NULL); // In case we leave the loop, to avoid a panic
+}
+#endif
+
+void sys_tlm_init() {
+#if CONFIG_SYS_TELEMETRY_DUMP_SEC > 0
+    int tsk_ret = SYS_TASK_SPAWN(SYS_TLM, dump_task, NULL);
+    if(tsk_ret != pdPASS){ ESP_LOGE(TAG, "sys_tlm creation failed with: %d", tsk_ret);}
+#endif
+}
+
+sys_tlm_id_t sys_tlm_queue_register(const char* name) {
+    return register_name(queue_names, &queue_count, SYS_TLM_MAX_QUEUES, name);
+}
+
+sys_tlm_id_t sys_tlm_timer_register(const char* name) {
+    return register_name(timer_names, &timer_count, SYS_TLM_MAX_TIMERS, name);
+}
+
+static sys_tlm_id_t register_name(char names[][SYS_TLM_NAME_LEN], uint8_t* count, uint8_t max, const char* name) {
+    sys_tlm_id_t id;
+
+    portENTER_CRITICAL(&register_mux);
+    id = *count;
+    if(id < max) {
+        strncpy(names[id], name, SYS_TLM_NAME_LEN - 1);
+        // Name is in place before the snapshot side can see the new count
+        __atomic_store_n(count, id + 1, __ATOMIC_RELEASE);
+    }
+    portEXIT_CRITICAL(&register_mux);
+
+    if(id >= max) {
+        ESP_LOGW(TAG, "No room to track %s", name);
+        return SYS_TLM_NONE;
+    }
+    return id;
+}
+
+void sys_tlm_queue_depth(sys_tlm_id_t id, uint32_t depth) {
+    queue_counters_t* q;
+
+    if(id >= SYS_TLM_MAX_QUEUES) return;
+    q = &cores[xPortGetCoreID()].queues[id];
+
+    ADD_RLX(&q->sends, 1);
+    ADD_RLX(&q->depth[depth < SYS_TLM_DEPTH_BUCKETS ? depth : SYS_TLM_DEPTH_BUCKETS - 1], 1);
+}
+
+void sys_tlm_queue_timeout(sys_tlm_id_t id) {
+    if(id >= SYS_TLM_MAX_QUEUES) return;
+    ADD_RLX(&cores[xPortGetCoreID()].queues[id].timeouts, 1);
+}
+
+void sys_tlm_queue_drop(sys_tlm_id_t id) {
+    if(id >= SYS_TLM_MAX_QUEUES) return;
+    ADD_RLX(&cores[xPortGetCoreID()].queues[id].drops, 1);
+}
+
+void sys_tlm_timer_record(sys_tlm_id_t id, uint32_t start) {
+    timer_counters_t* t;
+    uint32_t us;
+    uint8_t bucket;
+
+    if(id >= SYS_TLM_MAX_TIMERS) return;
+    us = sys_tlm_now_us() - start;
+    // log2 buckets; 0 and 1us share the first
+    bucket = us < 2 ? 0 : 31 - __builtin_clz(us);
+    if(bucket >= SYS_TLM_TIME_BUCKETS) bucket = SYS_TLM_TIME_BUCKETS - 1;
+
+    t = &cores[xPortGetCoreID()].timers[id];
+    ADD_RLX(&t->count, 1);
+    ADD_RLX(&t->total_us, us);
+    ADD_RLX(&t->hist[bucket], 1);
+}
+
+size_t sys_tlm_snapshot(uint8_t* out, size_t size) {
+    uint8_t queues = __atomic_load_n(&queue_count, __ATOMIC_ACQUIRE);
+    uint8_t timers = __atomic_load_n(&timer_count, __ATOMIC_ACQUIRE);
+    uint8_t* p = out + SYS_TLM_HDR_LEN;
+    uint8_t tasks;
+
+    if(size < (size_t)(SYS_TLM_HDR_LEN + queues * SYS_TLM_QUEUE_LEN + timers * SYS_TLM_TIMER_LEN)) return 0;
+
+    // Sum the cores field by field; counters keep moving, each one is exact on its own
+    for(uint8_t i = 0; i < queues; i++, p += SYS_TLM_QUEUE_LEN) {
+        queue_counters_t sum = {0};
+
+        for(int c = 0; c < portNUM_PROCESSORS; c++) {
+            const queue_counters_t* q = &cores[c].queues[i];
+            sum.sends += LOAD_RLX(&q->sends);
+            sum.timeouts += LOAD_RLX(&q->timeouts);
+            sum.drops += LOAD_RLX(&q->drops);
+            for(int b = 0; b < SYS_TLM_DEPTH_BUCKETS; b++) sum.depth[b] += LOAD_RLX(&q->depth[b]);
+        }
+
+        memcpy(p, queue_names[i], SYS_TLM_NAME_LEN);
+        put_u32(p + SYS_TLM_NAME_LEN, sum.sends);
+        put_u32(p + SYS_TLM_NAME_LEN + 4, sum.timeouts);
+        put_u32(p + SYS_TLM_NAME_LEN + 8, sum.drops);
+        for(int b = 0; b < SYS_TLM_DEPTH_BUCKETS; b++) put_u32(p + SYS_TLM_NAME_LEN + 12 + 4 * b, sum.depth[b]);
+    }
+
+    for(uint8_t i = 0; i < timers; i++, p += SYS_TLM_TIMER_LEN) {
+        timer_counters_t sum = {0};
+
+        for(int c = 0; c < portNUM_PROCESSORS; c++) {
+            const timer_counters_t* t = &cores[c].timers[i];
+            sum.count += LOAD_RLX(&t->count);
+            sum.total_us += LOAD_RLX(&t->total_us);
+            for(int b = 0; b < SYS_TLM_TIME_BUCKETS; b++) sum.hist[b] += LOAD_RLX(&t->hist[b]);
+        }
+
+        memcpy(p, timer_names[i], SYS_TLM_NAME_LEN);
+        put_u32(p + SYS_TLM_NAME_LEN, sum.count);
+        put_u32(p + SYS_TLM_NAME_LEN + 4, sum.total_us);
+        for(int b = 0; b < SYS_TLM_TIME_BUCKETS; b++) put_u32(p + SYS_TLM_NAME_LEN + 8 + 4 * b, sum.hist[b]);
+    }
+
+    tasks = put_tasks(p, size - (p - out));
+    p += tasks * SYS_TLM_TASK_LEN;
+
+    memcpy(out, SYS_TLM_MAGIC, 4);
+    put_u32(out + 4, (uint32_t)(esp_timer_get_time() / 1000));
+    out[8] = queues;
+    out[9] = timers;
+    out[10] = tasks;
+    out[11] = 0;
+
+    return p - out;
+}
+
+/**
+ ** CPU share per task since the previous snapshot, in per mille of one core. Needs
+ ** CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS; without it no task records are written.
+ */
+static uint8_t put_tasks(uint8_t* out, size_t size) {
+#ifdef CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    static TaskStatus_t status[MAX_TASKS];
+    static TaskHandle_t prev_task[MAX_TASKS];
+    static uint32_t prev_runtime[MAX_TASKS];
+    static uint32_t prev_total = 0;
+    uint32_t total, elapsed;
+    UBaseType_t count;
+    uint8_t written = 0;
+
+    count = uxTaskGetSystemState(status, MAX_TASKS, &total);
+    elapsed = total - prev_total;
+    prev_total = total;
+
+    for(UBaseType_t i = 0; i < count && size >= SYS_TLM_TASK_LEN; i++) {
+        uint32_t ran = status[i].ulRunTimeCounter;
+        uint16_t share;
+
+        // Tasks are listed in no fixed order; match against last time by handle
+        for(int j = 0; j < MAX_TASKS; j++) {
+            if(prev_task[j] == status[i].xHandle) {
+                ran -= prev_runtime[j];
+                break;
+            }
+        }
+        share = elapsed ? (uint16_t)(((uint64_t)ran * 1000) / elapsed) : 0;
+
+        memset(out, 0, SYS_TLM_TASK_LEN);
+        strncpy((char*)out, status[i].pcTaskName, SYS_TLM_TASK_NAME_LEN - 1);
+        out[SYS_TLM_TASK_NAME_LEN] = share & 0xFF;
+        out[SYS_TLM_TASK_NAME_LEN + 1] = share >> 8;
+        out += SYS_TLM_TASK_LEN;
+        size -= SYS_TLM_TASK_LEN;
+        written++;
+    }
+
+    for(UBaseType_t j = 0; j < MAX_TASKS; j++) {
+        prev_task[j] = j < count ? status[j].xHandle : NULL;
+        prev_runtime[j] = j < count ? status[j].ulRunTimeCounter : 0;
+    }
+    return written;
+#else
+    return 0;
+#endif
+}
+
+void sys_tlm_dump() {
+    static uint8_t blob[DUMP_MAX];
+    size_t len = sys_tlm_snapshot(blob, sizeof(blob));
+
+    printf("TLM-BEGIN %d\n", (int)len);
+    for(size_t i = 0; i < len; i++) {
+        printf("%02x%s", blob[i], ((i % 32) == 31 || i == len - 1) ? "\n" : "");
+    }
+    printf("TLM-END\n");
+}
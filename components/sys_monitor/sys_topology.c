@@ -0,0 +1,40 @@
+// C stdlib includes
+#include <stddef.h>
+
+// FreeRTOS includes
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// esp-idf includes
+#include "esp_log.h"
+
+// component includes
+#include "sys_topology.h"
+
+static const char* TAG = "sys_topology";
+
+#define SYS_TOPOLOGY_SPEC(id, name, stack, prio, core) [SYS_TASK_##id] = {(name), (stack), (prio), (core)},
+const sys_task_spec_t sys_topology[SYS_TASK_COUNT] = {
+    SYS_TOPOLOGY_TASKS(SYS_TOPOLOGY_SPEC)
+};
+#undef SYS_TOPOLOGY_SPEC
+
+const char* sys_topology_name() {
+#if defined(CONFIG_SYS_TOPOLOGY_PRESS_PATH)
+    return "press_path";
+#elif defined(CONFIG_SYS_TOPOLOGY_FLOAT)
+    return "float";
+#else
+    return "split";
+#endif
+}
+
+void sys_topology_adopt(sys_task_id_t id) {
+    const sys_task_spec_t* spec = &sys_topology[id];
+
+    vTaskPrioritySet(NULL, spec->priority);
+    if(spec->core != SYS_CORE_ANY && spec->core != xPortGetCoreID()) {
+        ESP_LOGW(TAG, "%s runs on core %d, topology %s wants core %d", spec->name, xPortGetCoreID(),
+                 sys_topology_name(), spec->core);
+    }
+}
@@ -0,0 +1,137 @@
+// C stdlib includes
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+// FreeRTOS includes
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// esp-idf includes
+#include "esp_log.h"
+#include "esp_timer.h"
+
+// component includes
+#include "sys_trace.h"
+#include "sys_topology.h"
+
+#define SECONDS(sec) ((sec*1000) / portTICK_RATE_MS)
+#define RING_RECORDS CONFIG_SYS_TRACE_RECORDS
+#define RING_MASK (RING_RECORDS - 1)
+
+_Static_assert((RING_RECORDS & RING_MASK) == 0, "CONFIG_SYS_TRACE_RECORDS must be a power of two");
+
+typedef struct {
+    uint32_t seq;       // Claim count + 1 once the record is complete, 0 while it's being written
+    uint32_t us;
+    uint16_t id;
+    uint16_t arg;
+    uint8_t stage;
+    uint8_t core;
+} trace_rec_t;
+
+#if CONFIG_SYS_TRACE_DUMP_SEC > 0
+static const char* TAG = "sys_trace";
+#endif
+static trace_rec_t ring[RING_RECORDS];
+static uint32_t claimed = 0;
+static uint16_t last_id = 0;
+
+static inline void put_u32(uint8_t* out, uint32_t val) {
+    out[0] = val & 0xFF;
+    out[1] = (val >> 8) & 0xFF;
+    out[2] = (val >> 16) & 0xFF;
+    out[3] = val >> 24;
+}
+
+#if CONFIG_SYS_TRACE_DUMP_SEC > 0
+static void dump_task() {
+    while(1) {
+        vTaskDelay(SECONDS(CONFIG_SYS_TRACE_DUMP_SEC));
+        sys_trace_dump();
+    }
+    vTaskDelete(NULL); // In case we leave the loop, to avoid a panic
+}
+#endif
+
+void sys_trace_init() {
+#if CONFIG_SYS_TRACE_DUMP_SEC > 0
+    int tsk_ret = SYS_TASK_SPAWN(SYS_TRACE, dump_task, NULL);
+    if(tsk_ret != pdPASS){ ESP_LOGE(TAG, "sys_trace creation failed with: %d", tsk_ret);}
+#endif
+}
+
+uint16_t sys_trace_new_id() {
+    uint16_t id;
+
+    do {
+        id = __atomic_add_fetch(&last_id, 1, __ATOMIC_RELAXED);
+    } while(id == SYS_TRACE_NO_ID);     // Skipped on wrap
+    return id;
+}
+
+void sys_trace(sys_trace_stage_t stage, uint16_t id, uint16_t arg) {
+    uint32_t n = __atomic_fetch_add(&claimed, 1, __ATOMIC_RELAXED);
+    trace_rec_t* rec = &ring[n & RING_MASK];
+
+    __atomic_store_n(&rec->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    rec->us = (uint32_t)esp_timer_get_time();
+    rec->id = id;
+    rec->arg = arg;
+    rec->stage = stage;
+    rec->core = xPortGetCoreID();
+    __atomic_store_n(&rec->seq, n + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ ** Records are copied out one at a time and kept only if their sequence number is the same
+ ** before and after the copy, so tracing never has to stop. Anything overwritten or still
+ ** being written mid-dump is left out.
+ */
+void sys_trace_dump() {
+    uint32_t end = __atomic_load_n(&claimed, __ATOMIC_ACQUIRE);
+    uint32_t start = end > RING_RECORDS ? end - RING_RECORDS : 0;
+    uint32_t count = 0;
+    uint8_t out[SYS_TRACE_REC_LEN];
+
+    // Count first so the header is right; a record lost between passes is written as a gap
+    for(uint32_t n = start; n < end; n++) {
+        if(__atomic_load_n(&ring[n & RING_MASK].seq, __ATOMIC_ACQUIRE) == n + 1) count++;
+    }
+
+    printf("TRC-BEGIN %d\n", (int)(SYS_TRACE_HDR_LEN + count * SYS_TRACE_REC_LEN));
+    memcpy(out, SYS_TRACE_MAGIC, 4);
+    put_u32(out + 4, count);
+    put_u32(out + 8, (uint32_t)esp_timer_get_time());
+    for(int i = 0; i < SYS_TRACE_HDR_LEN; i++) printf("%02x", out[i]);
+    printf("\n");
+
+    for(uint32_t n = start; n < end && count; n++) {
+        const trace_rec_t* rec = &ring[n & RING_MASK];
+        trace_rec_t copy;
+
+        if(__atomic_load_n(&rec->seq, __ATOMIC_ACQUIRE) != n + 1) continue;
+        memcpy(&copy, rec, sizeof(copy));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if(__atomic_load_n(&rec->seq, __ATOMIC_RELAXED) != n + 1) {
+            memset(&copy, 0, sizeof(copy));     // Overwritten while copying; stage 0 is skipped by the tool
+        }
+
+        put_u32(out, copy.us);
+        out[4] = copy.id & 0xFF;
+        out[5] = copy.id >> 8;
+        out[6] = copy.arg & 0xFF;
+        out[7] = copy.arg >> 8;
+        out[8] = copy.stage;
+        out[9] = copy.core;
+        out[10] = 0;
+        out[11] = 0;
+        for(int i = 0; i < SYS_TRACE_REC_LEN; i++) printf("%02x", out[i]);
+        printf("\n");
+        count--;
+    }
+    // Keep the length in the header honest if records were lost after counting
+    for(; count; count--) printf("000000000000000000000000\n");
+    printf("TRC-END\n");
+}
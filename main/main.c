@@ -23,6 +23,9 @@
 #include "wifi_service.h"
 #include "kbus_service.h"
 #include "bt_common.h"
+#include "sys_monitor.h"
+#include "sys_topology.h"
+#include "sys_power.h"
 
 #define SECONDS(sec) ((sec*1000) / portTICK_RATE_MS)
 
@@ -58,12 +61,13 @@ static void watcher_task(){
         printf("%s", task_list_buffer);
 
         free(task_list_buffer);
+        sys_monitor_report();
         vTaskDelay(SECONDS(120));
     }
 }
 
 static void create_watcher_task(){
-    int task_ret = xTaskCreate(watcher_task, "task_watcher", 4096, NULL, 5, NULL);
+    int task_ret = SYS_TASK_SPAWN(TASK_WATCHER, watcher_task, NULL);
     if(task_ret != pdPASS){ESP_LOGE(TAG, "task_watcher creation failed with: %d", task_ret);}
 }
 #endif
@@ -80,6 +84,7 @@ static void initNVS(){
 
 int app_main(void){
     initNVS();
+    sys_monitor_init();
 
 #ifdef TASK_DEBUG
     ESP_LOGI(TAG, "Creating Task Watcher");
@@ -87,12 +92,14 @@ int app_main(void){
 #endif
 
     // Setup bluetooth command queue
-    bt_cmd_queue = xQueueCreate(4, sizeof(bt_cmd_type_t));
+    bt_cmd_queue = SYS_QUEUE_CREATE("bt_cmd", 4, sizeof(bt_cmd_t));
     // Setup bluetooth "now playing" queue
-    bt_info_queue = xQueueCreate(2, sizeof(bt_now_playing_info_t));
+    bt_info_queue = SYS_QUEUE_CREATE("bt_info", 2, sizeof(bt_now_playing_info_t));
 
     // Setup kbus service; has side-effect of initializing and starting UART driver.
     init_kbus_service(bt_cmd_queue, bt_info_queue);
+    // After the UART driver is up; sleep wakeup is set on its port
+    sys_power_init();
 
 #ifdef R50_WIFI_ENABLED // Gating wifi and bt since there's still issues with them running concurrently.
     wifi_init_softap();
@@ -104,6 +111,7 @@ int app_main(void){
     // Running btstack_run_loop_execute() as it's own task or in a wrapper wasn't working;
     // however, does work as lowest priority loop after other tasks. Going with this.
     ESP_LOGI(TAG, "btstack run loop");
+    sys_topology_adopt(SYS_TASK_BT_RUNLOOP);
     btstack_run_loop_execute();
 #else
     while(1) {
@@ -0,0 +1,176 @@
+/**
+ ** Host side check of the CD changer state machine (cdc_state.h), built from the same source
+ ** as the firmware:
+ **
+ **   cc -O2 -Icomponents/cdc_emulator/include -Icomponents/common -Icomponents/meta_arena/include \
+ **       -Icomponents/kbus_service/include -o build/cdc_check tools/cdc_check.c components/cdc_emulator/cdc_state.c
+ **
+ **   cdc_check                 runs a radio session and the reply latency check
+ **   -n COUNT                  requests timed, default 200000
+ **   -b US                     p99 budget per reply in us, default 50
+ **
+ ** The session is what a radio sends while CD is its source: polls, play, held >> and <<,
+ ** track and disc changes, modes, stop. Every reply body and AVRCP command is compared with
+ ** what's expected. Latency is request in to reply bytes in a frame, polls mixed with
+ ** requests that re-encode the replies. The firmware's goal is well under a millisecond
+ ** from dispatch to tx queue; the default budget leaves a 20x margin for the host being
+ ** faster than a 240 MHz ESP32. Exits 1 if anything fails.
+ */
+
+// C stdlib includes
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// component includes
+#include "kbus_defines.h"
+#include "cdc_state.h"
+
+#define NONE BT_CMD_NOOP
+
+typedef struct {
+    uint8_t req;
+    uint8_t arg;
+    cdc_play_t play;
+    uint8_t function;
+    uint8_t disc;
+    uint8_t track;
+    bt_cmd_type_t commands[CDC_MAX_COMMANDS];
+} step_t;
+
+static const step_t session[] = {
+    {CDC_REQ_STATUS, 0x00, CDC_STOPPED,  CDC_FUNC_STOPPED, 1, 1,  {NONE}},
+    {CDC_REQ_PLAY,   0x00, CDC_PLAYING,  CDC_FUNC_PLAYING, 1, 1,  {AVRCP_PLAY}},
+    {CDC_REQ_PLAY,   0x00, CDC_PLAYING,  CDC_FUNC_PLAYING, 1, 1,  {NONE}},          // Repeated on source switch
+    {CDC_REQ_STATUS, 0x00, CDC_PLAYING,  CDC_FUNC_PLAYING, 1, 1,  {NONE}},
+    {CDC_REQ_SCAN,   0x00, CDC_SCAN_FWD, CDC_FUNC_PLAYING, 1, 1,  {AVRCP_FF_START}},
+    {CDC_REQ_SCAN,   0x00, CDC_SCAN_FWD, CDC_FUNC_PLAYING, 1, 1,  {NONE}},          // Still held
+    {CDC_REQ_PLAY,   0x00, CDC_PLAYING,  CDC_FUNC_PLAYING, 1, 1,  {AVRCP_FF_STOP}},  // Released
+    {CDC_REQ_SCAN,   0x01, CDC_SCAN_REV, CDC_FUNC_PLAYING, 1, 1,  {AVRCP_RWD_START}},
+    {CDC_REQ_SCAN,   0x00, CDC_SCAN_FWD, CDC_FUNC_PLAYING, 1, 1,  {AVRCP_RWD_STOP, AVRCP_FF_START}},
+    {CDC_REQ_PAUSE,  0x00, CDC_PAUSED,   CDC_FUNC_PAUSED,  1, 1,  {AVRCP_FF_STOP, AVRCP_PAUSE}},
+    {CDC_REQ_PLAY,   0x00, CDC_PLAYING,  CDC_FUNC_PLAYING, 1, 1,  {AVRCP_PLAY}},
+    {CDC_REQ_SEEK,   0x00, CDC_PLAYING,  CDC_FUNC_PLAYING, 1, 2,  {AVRCP_NEXT}},
+    {CDC_REQ_TRACK,  0x01, CDC_PLAYING,  CDC_FUNC_PLAYING, 1, 1,  {AVRCP_PREV}},
+    {CDC_REQ_TRACK,  0x01, CDC_PLAYING,  CDC_FUNC_PLAYING, 1, 99, {AVRCP_PREV}},    // Wraps
+    {CDC_REQ_TRACK,  0x00, CDC_PLAYING,  CDC_FUNC_PLAYING, 1, 1,  {AVRCP_NEXT}},
+    {CDC_REQ_DISC,   0x03, CDC_PLAYING,  CDC_FUNC_PLAYING, 3, 1,  {NONE}},
+    {CDC_REQ_DISC,   0x07, CDC_PLAYING,  CDC_FUNC_PLAYING, 3, 1,  {NONE}},          // No such disc
+    {CDC_REQ_RANDOM, 0x01, CDC_PLAYING,  CDC_FUNC_PLAYING | CDC_MODE_RANDOM, 3, 1, {NONE}},
+    {CDC_REQ_INTRO,  0x01, CDC_PLAYING,  CDC_FUNC_PLAYING | CDC_MODE_RANDOM | CDC_MODE_INTRO, 3, 1, {NONE}},
+    {CDC_REQ_RANDOM, 0x00, CDC_PLAYING,  CDC_FUNC_PLAYING | CDC_MODE_INTRO, 3, 1, {NONE}},
+    {CDC_REQ_INTRO,  0x00, CDC_PLAYING,  CDC_FUNC_PLAYING, 3, 1,  {NONE}},
+    {CDC_REQ_STOP,   0x00, CDC_STOPPED,  CDC_FUNC_STOPPED, 3, 1,  {AVRCP_PAUSE}},
+    {CDC_REQ_STOP,   0x00, CDC_STOPPED,  CDC_FUNC_STOPPED, 3, 1,  {NONE}},
+    {0x42,           0x00, CDC_STOPPED,  CDC_FUNC_STOPPED, 3, 1,  {NONE}},          // Unknown still gets a status
+};
+
+static int run_session() {
+    cdc_state_t state;
+    cdc_action_t action;
+    int failures = 0;
+
+    cdc_state_init(&state);
+    for(size_t i = 0; i < sizeof(session) / sizeof(session[0]); i++) {
+        const step_t* step = &session[i];
+        const uint8_t expect[CDC_STAT_BODY_LEN] = {
+            CD_STAT_RPLY, step->play, step->function, 0x00, CDC_DISCS_LOADED, 0x00, step->disc, step->track
+        };
+        uint8_t ncommands = 0;
+        bool ok;
+
+        while(ncommands < CDC_MAX_COMMANDS && step->commands[ncommands] != NONE) ncommands++;
+        action = cdc_state_feed(&state, step->req, step->arg);
+
+        ok = action.reply != NULL && memcmp(action.reply, expect, CDC_STAT_BODY_LEN) == 0 &&
+             action.ncommands == ncommands && memcmp(action.commands, step->commands, ncommands * sizeof(bt_cmd_type_t)) == 0;
+        if(!ok) {
+            failures++;
+            printf("FAIL step %zu: 38 %02X %02X ->", i, step->req, step->arg);
+            for(int b = 0; action.reply != NULL && b < CDC_STAT_BODY_LEN; b++) printf(" %02X", action.reply[b]);
+            printf(", %d commands", action.ncommands);
+            for(int c = 0; c < action.ncommands; c++) printf(" %d", action.commands[c]);
+            printf("\n");
+        }
+    }
+    printf("session: %zu steps, %d failed\n", sizeof(session) / sizeof(session[0]), failures);
+    return failures;
+}
+
+static inline uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int cmp_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+// One in eight requests changes track, so replies get re-encoded as they would while driving
+static int run_latency(uint32_t count, double budget_us) {
+    static const uint8_t mix[8][2] = {
+        {CDC_REQ_STATUS, 0}, {CDC_REQ_STATUS, 0}, {CDC_REQ_PLAY, 0}, {CDC_REQ_STATUS, 0},
+        {CDC_REQ_SEEK, 0},   {CDC_REQ_STATUS, 0}, {CDC_REQ_SCAN, 0}, {CDC_REQ_PLAY, 0},
+    };
+    uint8_t frame[CDC_STAT_BODY_LEN];
+    uint32_t* samples = malloc(count * sizeof(uint32_t));
+    cdc_state_t state;
+    cdc_action_t action;
+    uint64_t start, total = 0;
+    uint32_t checksum = 0;
+    double p50, p99, max;
+
+    if(samples == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    cdc_state_init(&state);
+    for(uint32_t i = 0; i < count; i++) {
+        start = now_ns();
+        action = cdc_state_feed(&state, mix[i % 8][0], mix[i % 8][1]);
+        memcpy(frame, action.reply, CDC_STAT_BODY_LEN);
+        samples[i] = (uint32_t)(now_ns() - start);
+        checksum += frame[7];   // Keeps the copy from being optimized out
+        total += samples[i];
+    }
+
+    qsort(samples, count, sizeof(samples[0]), cmp_u32);
+    p50 = samples[count / 2] / 1e3;
+    p99 = samples[(uint64_t)count * 99 / 100] / 1e3;
+    max = samples[count - 1] / 1e3;
+    printf("latency: n=%u mean=%.3f p50=%.3f p99=%.3f max=%.3f us, budget p99 %.1f us (checksum %u)\n",
+           count, total / 1e3 / count, p50, p99, max, budget_us, checksum);
+    free(samples);
+    return p99 > budget_us;
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [-n count] [-b p99_budget_us]\n", argv0);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    uint32_t count = 200000;
+    double budget_us = 50;
+    int failures, opt;
+
+    while((opt = getopt(argc, argv, "n:b:")) != -1) {
+        switch(opt) {
+            case 'n': count = (uint32_t)atol(optarg); break;
+            case 'b': budget_us = atof(optarg); break;
+            default: usage(argv[0]);
+        }
+    }
+    if(optind != argc || count == 0) usage(argv[0]);
+
+    failures = run_session();
+    failures += run_latency(count, budget_us);
+    printf("%s\n", failures ? "FAIL" : "PASS");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,83 @@
+// C stdlib includes
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// esp-idf includes
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+
+/**
+ ** esp_log, esp_random and heap_caps for the host build (tools/host). Log lines from several
+ ** tasks can interleave only at line granularity; stdout is locked per call.
+ */
+esp_log_level_t host_log_level = CONFIG_LOG_DEFAULT_LEVEL;
+
+void esp_log_level_set(const char* tag, esp_log_level_t level) {
+    (void)tag;
+    host_log_level = level;
+}
+
+uint32_t esp_log_timestamp() {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+void esp_log_write(esp_log_level_t level, const char* tag, const char* format, ...) {
+    va_list args;
+
+    (void)tag;
+    if(level > host_log_level) return;
+    va_start(args, format);
+    flockfile(stdout);
+    vprintf(format, args);
+    funlockfile(stdout);
+    va_end(args);
+}
+
+static void hex_lines(const char* tag, const void* buffer, uint16_t buff_len, esp_log_level_t level, bool ascii) {
+    const uint8_t* bytes = buffer;
+    char line[16 * 3 + 2 + 16 + 1];
+    int pos;
+
+    if(level > host_log_level) return;
+    for(uint16_t off = 0; off < buff_len; off += 16) {
+        pos = 0;
+        for(uint16_t i = off; i < off + 16 && i < buff_len; i++) pos += sprintf(&line[pos], "%02x ", bytes[i]);
+        if(ascii) {
+            pos += sprintf(&line[pos], " ");
+            for(uint16_t i = off; i < off + 16 && i < buff_len; i++) line[pos++] = (bytes[i] >= 0x20 && bytes[i] < 0x7F) ? bytes[i] : '.';
+            line[pos] = '\0';
+        }
+        esp_log_write(level, tag, "%c (%u) %s: %s\n", HOST_LOG_LETTER(level), esp_log_timestamp(), tag, line);
+    }
+}
+
+void esp_log_buffer_hexdump_internal(const char* tag, const void* buffer, uint16_t buff_len, esp_log_level_t level) {
+    hex_lines(tag, buffer, buff_len, level, true);
+}
+
+void esp_log_buffer_hex_internal(const char* tag, const void* buffer, uint16_t buff_len, esp_log_level_t level) {
+    hex_lines(tag, buffer, buff_len, level, false);
+}
+
+uint32_t esp_random() {
+    return ((uint32_t)random() << 16) ^ (uint32_t)random();
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+    (void)caps;
+    return 0;
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps) {
+    (void)caps;
+    return 0;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps) {
+    (void)caps;
+    return 0;
+}
@@ -0,0 +1,451 @@
+// C stdlib includes
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// FreeRTOS includes
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+// esp-idf includes
+#include "esp_task.h"
+#include "esp_timer.h"
+
+/**
+ ** Tasks, notifications and queues on pthreads, for the host build (tools/host). Every wait is
+ ** a condition variable on CLOCK_MONOTONIC, with ticks converted to an absolute deadline once,
+ ** so spurious wakeups don't stretch timeouts.
+ */
+#define HOST_TASK_NAME_LEN 16
+
+struct host_task {
+    pthread_t thread;
+    char name[HOST_TASK_NAME_LEN];
+    TaskFunction_t fn;
+    void* arg;
+    uint32_t stack_bytes;
+    UBaseType_t priority;
+
+    pthread_mutex_t lock;
+    pthread_cond_t notified;
+    uint32_t notify_value;
+    bool notify_pending;
+    pthread_cond_t resumed;
+    bool suspended;
+
+    struct host_task* next; // tasks list, for xTaskGetHandle()
+};
+
+struct host_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    uint8_t* storage;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t count;
+    UBaseType_t head;       // Oldest item
+};
+
+static pthread_mutex_t critical = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static pthread_mutex_t tasks_lock = PTHREAD_MUTEX_INITIALIZER;
+static __thread TaskHandle_t current_task = NULL;
+static UBaseType_t task_count = 0;
+static TaskHandle_t tasks = NULL;
+static struct timespec start_time;
+
+__attribute__((constructor)) static void host_clock_start() {
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+}
+
+static inline int64_t elapsed_us() {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)(now.tv_sec - start_time.tv_sec) * 1000000 + (now.tv_nsec - start_time.tv_nsec) / 1000;
+}
+
+// Absolute CLOCK_MONOTONIC time ticks from now
+static struct timespec deadline(TickType_t ticks) {
+    struct timespec ts;
+    uint64_t ms = (uint64_t)ticks * portTICK_PERIOD_MS;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += ms / 1000;
+    ts.tv_nsec += (ms % 1000) * 1000000;
+    if(ts.tv_nsec >= 1000000000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+    return ts;
+}
+
+// Waits on cond with lock held; false once the deadline has passed
+static bool wait_on(pthread_cond_t* cond, pthread_mutex_t* lock, TickType_t ticks, const struct timespec* until) {
+    if(ticks == 0) return false;
+    if(ticks == portMAX_DELAY) return pthread_cond_wait(cond, lock) == 0;
+    return pthread_cond_timedwait(cond, lock, until) != ETIMEDOUT;
+}
+
+static void init_cond(pthread_cond_t* cond) {
+    pthread_condattr_t attr;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+void host_critical_enter() {
+    pthread_mutex_lock(&critical);
+}
+
+void host_critical_exit() {
+    pthread_mutex_unlock(&critical);
+}
+
+int64_t esp_timer_get_time() {
+    return elapsed_us();
+}
+
+/* ---------------------------------------------------------------- tasks */
+
+static TaskHandle_t new_task(TaskFunction_t fn, const char* name, uint32_t stack_bytes, void* arg, UBaseType_t priority) {
+    TaskHandle_t task = calloc(1, sizeof(struct host_task));
+
+    if(task == NULL) return NULL;
+    snprintf(task->name, sizeof(task->name), "%s", name);
+    task->fn = fn;
+    task->arg = arg;
+    task->stack_bytes = stack_bytes;
+    task->priority = priority;
+    pthread_mutex_init(&task->lock, NULL);
+    init_cond(&task->notified);
+    init_cond(&task->resumed);
+
+    pthread_mutex_lock(&tasks_lock);
+    task_count++;
+    task->next = tasks;
+    tasks = task;
+    pthread_mutex_unlock(&tasks_lock);
+    return task;
+}
+
+static void* task_entry(void* arg) {
+    TaskHandle_t task = arg;
+
+    current_task = task;
+    pthread_setname_np(pthread_self(), task->name);
+    task->fn(task->arg);
+    vTaskDelete(NULL);  // Returning from a task is a bug on the target; end it quietly here
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack_bytes, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* handle_out, BaseType_t core) {
+    TaskHandle_t task = new_task(fn, name, stack_bytes, arg, priority);
+    pthread_attr_t attr;
+    int ret;
+
+    (void)core;
+    if(handle_out != NULL) *handle_out = task;
+    if(task == NULL) return errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;
+
+    // Handle is out before the thread runs, as tasks often look themselves up by it
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    ret = pthread_create(&task->thread, &attr, task_entry, task);
+    pthread_attr_destroy(&attr);
+    if(ret != 0) {
+        if(handle_out != NULL) *handle_out = NULL;
+        return errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;
+    }
+    return pdPASS;
+}
+
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack_bytes, void* arg,
+                                           UBaseType_t priority, StackType_t* stack, StaticTask_t* tcb, BaseType_t core) {
+    TaskHandle_t task = NULL;
+
+    (void)stack;
+    (void)tcb;
+    xTaskCreatePinnedToCore(fn, name, stack_bytes, arg, priority, &task, core);
+    return task;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if(task != NULL && task != current_task) {
+        fprintf(stderr, "host shim: vTaskDelete() of another task isn't supported\n");
+        abort();
+    }
+    pthread_mutex_lock(&tasks_lock);
+    task_count--;
+    for(TaskHandle_t* link = &tasks; *link != NULL; link = &(*link)->next) {
+        if(*link == current_task) {
+            *link = current_task->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&tasks_lock);
+    pthread_exit(NULL);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    struct timespec until = deadline(ticks);
+
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL) == EINTR);
+}
+
+void vTaskDelayUntil(TickType_t* previous_wake, TickType_t increment) {
+    TickType_t now = xTaskGetTickCount();
+
+    *previous_wake += increment;
+    if((int32_t)(*previous_wake - now) > 0) vTaskDelay(*previous_wake - now);
+}
+
+TickType_t xTaskGetTickCount() {
+    return (TickType_t)(elapsed_us() / 1000 / portTICK_PERIOD_MS);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    if(current_task == NULL) current_task = new_task(NULL, "main", ESP_TASK_MAIN_STACK, NULL, tskIDLE_PRIORITY + 1);
+    return current_task;
+}
+
+const char* pcTaskGetTaskName(TaskHandle_t task) {
+    return (task != NULL ? task : xTaskGetCurrentTaskHandle())->name;
+}
+
+void vTaskPrioritySet(TaskHandle_t task, UBaseType_t priority) {
+    (task != NULL ? task : xTaskGetCurrentTaskHandle())->priority = priority;
+}
+
+TaskHandle_t xTaskGetHandle(const char* name) {
+    TaskHandle_t task;
+
+    pthread_mutex_lock(&tasks_lock);
+    for(task = tasks; task != NULL && strncmp(task->name, name, sizeof(task->name) - 1) != 0; task = task->next);
+    pthread_mutex_unlock(&tasks_lock);
+    return task;
+}
+
+void vTaskSuspend(TaskHandle_t task) {
+    task = (task != NULL ? task : xTaskGetCurrentTaskHandle());
+    pthread_mutex_lock(&task->lock);
+    task->suspended = true;
+    pthread_mutex_unlock(&task->lock);
+}
+
+void vTaskResume(TaskHandle_t task) {
+    pthread_mutex_lock(&task->lock);
+    task->suspended = false;
+    pthread_cond_broadcast(&task->resumed);
+    pthread_mutex_unlock(&task->lock);
+}
+
+// Where a suspended task actually stops; threads can't be stopped from outside
+static void suspend_point() {
+    TaskHandle_t self = current_task;
+
+    if(self == NULL) return;
+    pthread_mutex_lock(&self->lock);
+    while(self->suspended) pthread_cond_wait(&self->resumed, &self->lock);
+    pthread_mutex_unlock(&self->lock);
+}
+
+UBaseType_t uxTaskGetNumberOfTasks() {
+    UBaseType_t count;
+
+    pthread_mutex_lock(&tasks_lock);
+    count = task_count;
+    pthread_mutex_unlock(&tasks_lock);
+    return count;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    return (task != NULL ? task : xTaskGetCurrentTaskHandle())->stack_bytes;
+}
+
+/* ---------------------------------------------------------------- notifications */
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action) {
+    BaseType_t ret = pdPASS;
+
+    pthread_mutex_lock(&task->lock);
+    switch(action) {
+        case eSetBits:                  task->notify_value |= value; break;
+        case eIncrement:                task->notify_value++; break;
+        case eSetValueWithOverwrite:    task->notify_value = value; break;
+        case eSetValueWithoutOverwrite:
+            if(task->notify_pending) ret = pdFAIL;
+            else task->notify_value = value;
+            break;
+        case eNoAction:
+        default:
+            break;
+    }
+    task->notify_pending = true;
+    pthread_cond_signal(&task->notified);
+    pthread_mutex_unlock(&task->lock);
+    return ret;
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t* value_out, TickType_t ticks_to_wait) {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    struct timespec until = deadline(ticks_to_wait);
+    BaseType_t ret = pdFALSE;
+
+    pthread_mutex_lock(&self->lock);
+    if(!self->notify_pending) self->notify_value &= ~clear_on_entry;
+    while(!self->notify_pending && wait_on(&self->notified, &self->lock, ticks_to_wait, &until));
+    if(value_out != NULL) *value_out = self->notify_value;
+    if(self->notify_pending) {
+        self->notify_value &= ~clear_on_exit;
+        self->notify_pending = false;
+        ret = pdTRUE;
+    }
+    pthread_mutex_unlock(&self->lock);
+    return ret;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait) {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    struct timespec until = deadline(ticks_to_wait);
+    uint32_t value;
+
+    pthread_mutex_lock(&self->lock);
+    while(self->notify_value == 0 && wait_on(&self->notified, &self->lock, ticks_to_wait, &until));
+    value = self->notify_value;
+    if(value != 0) self->notify_value = clear_on_exit ? 0 : value - 1;
+    self->notify_pending = false;
+    pthread_mutex_unlock(&self->lock);
+    return value;
+}
+
+/* ---------------------------------------------------------------- queues */
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    QueueHandle_t queue = calloc(1, sizeof(struct host_queue));
+
+    if(queue == NULL || length == 0) {
+        free(queue);
+        return NULL;
+    }
+    queue->storage = malloc(length * item_size + 1);
+    if(queue->storage == NULL) {
+        free(queue);
+        return NULL;
+    }
+    queue->length = length;
+    queue->item_size = item_size;
+    pthread_mutex_init(&queue->lock, NULL);
+    init_cond(&queue->not_empty);
+    init_cond(&queue->not_full);
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    pthread_mutex_destroy(&queue->lock);
+    pthread_cond_destroy(&queue->not_empty);
+    pthread_cond_destroy(&queue->not_full);
+    free(queue->storage);
+    free(queue);
+}
+
+static inline uint8_t* slot(QueueHandle_t queue, UBaseType_t index) {
+    return &queue->storage[(index % queue->length) * queue->item_size];
+}
+
+static BaseType_t send(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait, bool front, bool overwrite) {
+    struct timespec until = deadline(ticks_to_wait);
+
+    pthread_mutex_lock(&queue->lock);
+    if(overwrite && queue->count == queue->length) {
+        queue->count = 0;   // Overwrite is for length 1 queues; replaces the one item
+    }
+    while(queue->count == queue->length) {
+        if(!wait_on(&queue->not_full, &queue->lock, ticks_to_wait, &until)) {
+            pthread_mutex_unlock(&queue->lock);
+            return errQUEUE_FULL;
+        }
+    }
+    if(front) {
+        queue->head = (queue->head + queue->length - 1) % queue->length;
+        if(queue->item_size) memcpy(slot(queue, queue->head), item, queue->item_size);
+    } else if(queue->item_size) {
+        memcpy(slot(queue, queue->head + queue->count), item, queue->item_size);
+    }
+    queue->count++;
+    pthread_cond_signal(&queue->not_empty);
+    pthread_mutex_unlock(&queue->lock);
+    return pdPASS;
+}
+
+static BaseType_t receive(QueueHandle_t queue, void* item, TickType_t ticks_to_wait, bool peek) {
+    struct timespec until;
+
+    suspend_point();
+    until = deadline(ticks_to_wait);
+    pthread_mutex_lock(&queue->lock);
+    while(queue->count == 0) {
+        if(!wait_on(&queue->not_empty, &queue->lock, ticks_to_wait, &until)) {
+            pthread_mutex_unlock(&queue->lock);
+            return pdFALSE;
+        }
+    }
+    if(queue->item_size) memcpy(item, slot(queue, queue->head), queue->item_size);
+    if(!peek) {
+        queue->head = (queue->head + 1) % queue->length;
+        queue->count--;
+        pthread_cond_signal(&queue->not_full);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return pdTRUE;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait) {
+    return send(queue, item, ticks_to_wait, false, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait) {
+    return send(queue, item, ticks_to_wait, true, false);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void* item) {
+    return send(queue, item, 0, false, true);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks_to_wait) {
+    return receive(queue, item, ticks_to_wait, false);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void* item, TickType_t ticks_to_wait) {
+    return receive(queue, item, ticks_to_wait, true);
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+    pthread_mutex_lock(&queue->lock);
+    queue->count = 0;
+    queue->head = 0;
+    pthread_cond_broadcast(&queue->not_full);
+    pthread_mutex_unlock(&queue->lock);
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    UBaseType_t count;
+
+    pthread_mutex_lock(&queue->lock);
+    count = queue->count;
+    pthread_mutex_unlock(&queue->lock);
+    return count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue) {
+    return queue->length - uxQueueMessagesWaiting(queue);
+}
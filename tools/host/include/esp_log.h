@@ -0,0 +1,55 @@
+#ifndef ESP_LOG_H
+#define ESP_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+
+/**
+ ** ESP_LOG* on stdout in the ESP-IDF line format, "I (ms) tag: text". One runtime level for
+ ** every tag; esp_log_level_set() ignores the tag.
+ */
+typedef enum {
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE
+} esp_log_level_t;
+
+#ifndef LOG_LOCAL_LEVEL
+#define LOG_LOCAL_LEVEL CONFIG_LOG_DEFAULT_LEVEL
+#endif
+#define LOG_RESET_COLOR ""
+
+extern esp_log_level_t host_log_level;
+
+void esp_log_level_set(const char* tag, esp_log_level_t level);
+uint32_t esp_log_timestamp();
+void esp_log_write(esp_log_level_t level, const char* tag, const char* format, ...) __attribute__((format(printf, 3, 4)));
+void esp_log_buffer_hexdump_internal(const char* tag, const void* buffer, uint16_t buff_len, esp_log_level_t level);
+void esp_log_buffer_hex_internal(const char* tag, const void* buffer, uint16_t buff_len, esp_log_level_t level);
+
+#define HOST_LOG_LETTER(level) ("-EWIDV"[(level)])
+#define ESP_LOG_LEVEL(level, tag, format, ...) \
+    esp_log_write((level), (tag), "%c (%u) %s: " format "\n", HOST_LOG_LETTER(level), esp_log_timestamp(), (tag), ##__VA_ARGS__)
+#define ESP_LOG_LEVEL_LOCAL(level, tag, format, ...) do { \
+    if(LOG_LOCAL_LEVEL >= (level) && host_log_level >= (level)) ESP_LOG_LEVEL((level), (tag), format, ##__VA_ARGS__); \
+} while(0)
+
+#define ESP_LOGE(tag, format, ...) ESP_LOG_LEVEL_LOCAL(ESP_LOG_ERROR,   tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) ESP_LOG_LEVEL_LOCAL(ESP_LOG_WARN,    tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) ESP_LOG_LEVEL_LOCAL(ESP_LOG_INFO,    tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) ESP_LOG_LEVEL_LOCAL(ESP_LOG_DEBUG,   tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) ESP_LOG_LEVEL_LOCAL(ESP_LOG_VERBOSE, tag, format, ##__VA_ARGS__)
+
+#define ESP_LOG_BUFFER_HEXDUMP(tag, buffer, buff_len, level) do { \
+    if(LOG_LOCAL_LEVEL >= (level)) esp_log_buffer_hexdump_internal((tag), (buffer), (buff_len), (level)); \
+} while(0)
+#define ESP_LOG_BUFFER_HEX_LEVEL(tag, buffer, buff_len, level) do { \
+    if(LOG_LOCAL_LEVEL >= (level)) esp_log_buffer_hex_internal((tag), (buffer), (buff_len), (level)); \
+} while(0)
+#define ESP_LOG_BUFFER_HEX(tag, buffer, buff_len) ESP_LOG_BUFFER_HEX_LEVEL((tag), (buffer), (buff_len), ESP_LOG_INFO)
+
+#endif //ESP_LOG_H
@@ -0,0 +1,13 @@
+#ifndef ESP_SYSTEM_H
+#define ESP_SYSTEM_H
+
+#include <stdint.h>
+
+typedef int esp_err_t;
+
+#define ESP_OK      0
+#define ESP_FAIL    -1
+
+uint32_t esp_random();
+
+#endif //ESP_SYSTEM_H
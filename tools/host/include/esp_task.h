@@ -0,0 +1,10 @@
+#ifndef ESP_TASK_H
+#define ESP_TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+// ESP-IDF defaults for the main task
+#define ESP_TASK_MAIN_PRIO  (tskIDLE_PRIORITY + 1)
+#define ESP_TASK_MAIN_STACK 3584
+
+#endif //ESP_TASK_H
@@ -0,0 +1,61 @@
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+
+/**
+ ** Host shim for the slice of FreeRTOS the K-bus stack uses, on pthreads (freertos_shim.c).
+ ** Tasks are plain threads: no priorities, no core affinity, no preemption order. Timing and
+ ** blocking behave like the real thing, scheduling doesn't, so results are about code paths
+ ** and CPU cost, not about which task would have won on the ESP32.
+ **
+ ** Critical sections are one process wide recursive lock; portMUX_TYPE only has to exist.
+ */
+typedef uint32_t TickType_t;
+typedef TickType_t portTickType;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t StackType_t;
+
+typedef struct host_queue* QueueHandle_t;
+typedef struct host_task* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+// Static storage is accepted and ignored; the shim allocates its own
+typedef struct { uint8_t unused; } StaticQueue_t;
+typedef struct { uint8_t unused; } StaticTask_t;
+
+typedef struct { uint8_t unused; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED    {0}
+
+void host_critical_enter();
+void host_critical_exit();
+#define portENTER_CRITICAL(mux)         ((void)(mux), host_critical_enter())
+#define portEXIT_CRITICAL(mux)          ((void)(mux), host_critical_exit())
+#define portENTER_CRITICAL_ISR(mux)     portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux)      portEXIT_CRITICAL(mux)
+
+#define configTICK_RATE_HZ      CONFIG_FREERTOS_HZ
+#define configMAX_PRIORITIES    25
+#define portTICK_PERIOD_MS      (1000 / configTICK_RATE_HZ)
+#define portTICK_RATE_MS        portTICK_PERIOD_MS
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(((TickType_t)(ms) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000))
+#define portMAX_DELAY           ((TickType_t)0xffffffffUL)
+#define portNUM_PROCESSORS      2
+
+#define pdFALSE     ((BaseType_t)0)
+#define pdTRUE      ((BaseType_t)1)
+#define pdFAIL      pdFALSE
+#define pdPASS      pdTRUE
+#define errQUEUE_FULL   ((BaseType_t)0)
+#define errQUEUE_EMPTY  ((BaseType_t)0)
+#define errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY   (-1)
+
+#define tskIDLE_PRIORITY    ((UBaseType_t)0)
+#define tskNO_AFFINITY      0x7FFFFFFF
+#define xPortGetCoreID()    0
+
+#endif //FREERTOS_H
@@ -0,0 +1,48 @@
+#ifndef TASK_H
+#define TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef enum {
+    eNoAction = 0,
+    eSetBits,
+    eIncrement,
+    eSetValueWithOverwrite,
+    eSetValueWithoutOverwrite
+} eNotifyAction;
+
+// Stack sizes are in bytes, as on ESP-IDF; host threads get the platform default stack
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack_bytes, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* handle_out, BaseType_t core);
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack_bytes, void* arg,
+                                           UBaseType_t priority, StackType_t* stack, StaticTask_t* tcb, BaseType_t core);
+#define xTaskCreate(fn, name, stack_bytes, arg, priority, handle_out) \
+    xTaskCreatePinnedToCore((fn), (name), (stack_bytes), (arg), (priority), (handle_out), tskNO_AFFINITY)
+#define xTaskCreateStatic(fn, name, stack_bytes, arg, priority, stack, tcb) \
+    xTaskCreateStaticPinnedToCore((fn), (name), (stack_bytes), (arg), (priority), (stack), (tcb), tskNO_AFFINITY)
+
+// Only a task deleting itself (NULL) is supported
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t* previous_wake, TickType_t increment);
+TickType_t xTaskGetTickCount();
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action);
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t* value_out, TickType_t ticks_to_wait);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait);
+#define xTaskNotifyGive(task) xTaskNotify((task), 0, eIncrement)
+#define xTaskNotifyFromISR(task, value, action, woken) ((void)(woken), xTaskNotify((task), (value), (action)))
+
+// The main thread gets a handle too, the first time it asks
+TaskHandle_t xTaskGetCurrentTaskHandle();
+const char* pcTaskGetTaskName(TaskHandle_t task);
+void vTaskPrioritySet(TaskHandle_t task, UBaseType_t priority);
+TaskHandle_t xTaskGetHandle(const char* name);
+// A suspended task runs on until its next queue receive, and stops there until resumed
+void vTaskSuspend(TaskHandle_t task);
+void vTaskResume(TaskHandle_t task);
+UBaseType_t uxTaskGetNumberOfTasks();
+// No stack accounting on the host; reports the requested stack as untouched
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+
+#endif //TASK_H
@@ -0,0 +1,22 @@
+#ifndef KBUS_UART_DRIVER_H
+#define KBUS_UART_DRIVER_H
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+/**
+ ** Host stand-in for the kbus_uart_driver submodule's header: the message type the stack
+ ** passes around and the driver's entry point. The host build runs with CONFIG_KBUS_VIRTUAL_BUS,
+ ** so nothing calls into a driver.
+ */
+typedef struct {
+    uint8_t src;
+    uint8_t dst;
+    uint8_t body[32];
+    uint8_t body_len;
+} kbus_message_t;
+
+void init_kbus_uart_driver(QueueHandle_t rx_queue, QueueHandle_t tx_queue);
+
+#endif //KBUS_UART_DRIVER_H
@@ -0,0 +1,17 @@
+/*
+ * Host build configuration; stands in for the sdkconfig.h ESP-IDF generates from menuconfig.
+ * Kconfig defaults, except the virtual bus is on and runs without wire time, at full CPU speed.
+ */
+#pragma once
+#define CONFIG_FREERTOS_HZ 1000
+#define CONFIG_LOG_DEFAULT_LEVEL 3
+#define CONFIG_KBUS_VIRTUAL_BUS 1
+#define CONFIG_KBUS_VIRTUAL_BUS_ECHO 1
+#define CONFIG_KBUS_SCROLL_STEP_MS 15000
+#define CONFIG_KBUS_DISPLAY_MID 1
+#define CONFIG_KBUS_TX_DISPLAY_BUDGET 100
+#define CONFIG_KBUS_TX_DISPLAY_BURST 64
+#define CONFIG_KBUS_TX_PACE_UTIL_MAX 70
+#define CONFIG_CDC_EMULATOR 1
+#define CONFIG_SYS_TOPOLOGY_SPLIT 1
+#define CONFIG_SYS_MONITOR_REPORT_SEC 0
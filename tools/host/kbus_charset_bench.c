@@ -0,0 +1,178 @@
+/**
+ ** UTF-8 to display charset transcoding (kbus_charset.h) over a corpus of real track names, one
+ ** "title<>artist" per line, as bt_info_task sees them. Built by the host target
+ ** (tools/host/CMakeLists.txt):
+ **
+ **   kbus_charset_bench CORPUS every line at each display width, against a plain copy
+ **   -n PASSES                 passes over the corpus per run, default 20000
+ **   -r RUNS                   runs per width; the fastest counts, default 5
+ **
+ ** The copy is the original byte for byte copy display_tel_msg() and the SDRS replies made:
+ ** the UTF-8 bytes, cut at the width. Lines are split into pure ASCII and the rest, so the word
+ ** at a time fast path and the transliteration path show separately. Every output is also
+ ** checked: within the width, no control or (without CONFIG_KBUS_CHARSET_UMLAUTS) high bytes,
+ ** and each pure ASCII line passed through unchanged up to the width. Exits 1 on a bad output.
+ */
+
+// C stdlib includes
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// component includes
+#include "kbus_charset.h"
+#include "kbus_scroll.h"
+
+#define MAX_LINES 256
+
+typedef struct {
+    char* text;
+    size_t len;
+    bool ascii;
+} line_t;
+
+static line_t lines[MAX_LINES];
+static size_t line_count;
+
+// Display widths the transcoder cuts for
+static const struct {
+    const char* name;
+    size_t width;
+} widths[] = {
+    {"mid", KBUS_SCROLL_WIDTH_MID},
+    {"ike", KBUS_SCROLL_WIDTH_IKE},
+    {"scroll", KBUS_SCROLL_TEXT_MAX - 1},
+};
+
+static volatile size_t sink;
+
+static inline int64_t now_ns() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static bool load(const char* path) {
+    char buf[1024];
+    FILE* f = fopen(path, "r");
+
+    if(f == NULL) {
+        perror(path);
+        return false;
+    }
+    while(line_count < MAX_LINES && fgets(buf, sizeof(buf), f)) {
+        line_t* line = &lines[line_count];
+
+        buf[strcspn(buf, "\r\n")] = '\0';
+        if(buf[0] == '\0') continue;
+        line->text = strdup(buf);
+        line->len = strlen(buf);
+        line->ascii = true;
+        for(size_t i = 0; i < line->len; i++) line->ascii &= (uint8_t)buf[i] < 0x80;
+        line_count++;
+    }
+    fclose(f);
+    return line_count > 0;
+}
+
+static size_t copy_cut(const char* in, size_t in_len, char* out, size_t out_size) {
+    size_t len = in_len < out_size - 1 ? in_len : out_size - 1;
+
+    memcpy(out, in, len);
+    out[len] = '\0';
+    return len;
+}
+
+static int check(size_t width) {
+    char out[KBUS_SCROLL_TEXT_MAX];
+    size_t len;
+    int failures = 0;
+
+    for(size_t l = 0; l < line_count; l++) {
+        bool bad = false;
+
+        len = kbus_charset_from_utf8(lines[l].text, lines[l].len, out, width + 1);
+        bad |= len > width || strlen(out) != len;
+        for(size_t i = 0; i < len; i++) {
+            uint8_t c = (uint8_t)out[i];
+#ifdef CONFIG_KBUS_CHARSET_UMLAUTS
+            bad |= c < 0x20;
+#else
+            bad |= c < 0x20 || c >= 0x80;
+#endif
+        }
+        if(lines[l].ascii) bad |= strncmp(out, lines[l].text, width) != 0;
+        if(bad) {
+            printf("FAIL width %zu: \"%s\" -> \"%s\"\n", width, lines[l].text, out);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+// Fastest run's ns per input byte over the lines of one kind
+static double time_ns_per_byte(size_t (*fn)(const char*, size_t, char*, size_t), size_t width, bool ascii,
+                               uint32_t passes, uint32_t runs) {
+    char out[KBUS_SCROLL_TEXT_MAX];
+    size_t bytes = 0, total = 0;
+    int64_t best = INT64_MAX, start;
+
+    for(size_t l = 0; l < line_count; l++) {
+        if(lines[l].ascii == ascii) bytes += lines[l].len;
+    }
+    if(bytes == 0) return 0;
+
+    for(uint32_t r = 0; r < runs; r++) {
+        start = now_ns();
+        for(uint32_t p = 0; p < passes; p++) {
+            for(size_t l = 0; l < line_count; l++) {
+                if(lines[l].ascii == ascii) total += fn(lines[l].text, lines[l].len, out, width + 1);
+            }
+        }
+        if(now_ns() - start < best) best = now_ns() - start;
+    }
+    sink = total;
+    return (double)best / ((double)bytes * passes);
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [-n passes] [-r runs] corpus.txt\n", argv0);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    uint32_t passes = 20000, runs = 5;
+    size_t ascii_lines = 0;
+    int failures = 0, opt;
+
+    while((opt = getopt(argc, argv, "n:r:")) != -1) {
+        switch(opt) {
+            case 'n': passes = (uint32_t)atol(optarg); break;
+            case 'r': runs = (uint32_t)atol(optarg); break;
+            default: usage(argv[0]);
+        }
+    }
+    if(optind != argc - 1 || passes == 0 || runs == 0) usage(argv[0]);
+    if(!load(argv[optind])) return 2;
+
+    for(size_t l = 0; l < line_count; l++) ascii_lines += lines[l].ascii;
+    printf("%zu lines, %zu pure ASCII\n", line_count, ascii_lines);
+    printf("%-8s %22s %22s\n", "width", "ascii ns/B (copy)", "utf-8 ns/B (copy)");
+
+    for(size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); w++) {
+        failures += check(widths[w].width);
+        printf("%-8s %12.2f (%6.2f) %12.2f (%6.2f)\n", widths[w].name,
+               time_ns_per_byte(kbus_charset_from_utf8, widths[w].width, true, passes, runs),
+               time_ns_per_byte(copy_cut, widths[w].width, true, passes, runs),
+               time_ns_per_byte(kbus_charset_from_utf8, widths[w].width, false, passes, runs),
+               time_ns_per_byte(copy_cut, widths[w].width, false, passes, runs));
+    }
+
+    printf("%s\n", failures ? "FAIL" : "PASS");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,148 @@
+/**
+ ** Bytes copied per frame on the rx to dispatch path, from kbus_msg_pool's own counters, against
+ ** what the baseline copied for the same frame. Built by the host target (tools/host/CMakeLists.txt):
+ **
+ **   kbus_copy_check           every frame class, -n frames each
+ **   -n FRAMES                 frames per class, default 100
+ **   -v                        keep the stack's info logs
+ **
+ ** Frames go in one at a time through the virtual bus and each class has to come out at exactly
+ ** the expected count:
+ **
+ **   driver queue receive      sizeof(kbus_message_t), as before, straight into rx_ring
+ **   rx ring out               KBUS_RX_HDR_LEN + body_len, the body lands in the pooled buffer
+ **   queued subscriber         2 x sizeof(kbus_message_t*) each (send and receive of the reference)
+ **
+ ** The trace id is written into the ring, not copied, and a frame that had to be received
+ ** aside because the ring was full costs its way in too, which these one at a time frames
+ ** never hit. The baseline received every frame whole and copied SDRS frames whole twice more
+ ** through sdrs_enqueue_msg(); broadcasts the rx filter drops now cost nothing. Frames for
+ ** inline subscribers still cost the ring out on top of the baseline's one receive; that hop
+ ** is what keeps the driver from waiting on handlers. Exits 1 on any mismatch.
+ */
+
+// C stdlib includes
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// FreeRTOS includes
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+// esp-idf includes
+#include "esp_log.h"
+
+// component includes
+#include "kbus_uart_driver.h"
+#include "kbus_defines.h"
+#include "kbus_service.h"
+#include "kbus_msg_pool.h"
+#include "kbus_virtual_bus.h"
+#include "bt_common.h"
+#include "sdrs_emulator.h"
+#include "sys_monitor.h"
+
+#define KBUS_RX_HDR_LEN 4           // kbus_service.c: trace id, src, dst
+#define FRAME_TIMEOUT_MS 100
+#define SETTLE_MS 50                // Anything late, replies echoed back through the filter included
+
+static const char* TAG = "kbus_copy_check";
+static QueueHandle_t bt_cmd_queue, bt_info_queue;
+
+typedef struct {
+    const char* name;
+    kbus_message_t frame;
+    bool filtered;              // Dropped by the rx filter before the driver queue
+    uint8_t queued;             // Queued subscribers it reaches
+    uint8_t baseline_copies;    // Whole kbus_message_t copies the baseline made
+} copy_case_t;
+
+static const copy_case_t cases[] = {
+    {"sdrs poll",   {.src = RAD, .dst = SDRS, .body = {SDRS_CTRL_REQ, SDRS_HEARTBEAT, 0x00}, .body_len = 3}, false, 1, 3},
+    {"cdc poll",    {.src = RAD, .dst = CDC,  .body = {CD_CTRL_REQ, 0x00, 0x00}, .body_len = 3},            false, 0, 1},
+    {"tel status",  {.src = RAD, .dst = TEL,  .body = {DEV_STAT_REQ}, .body_len = 1},                       false, 0, 1},
+    {"ignition",    {.src = IKE, .dst = GLO,  .body = {IGN_STAT_RPLY, 0x01}, .body_len = 2},                false, 0, 1},
+    {"mfl release", {.src = MFL, .dst = RAD,  .body = {MFL_BUTTON, 0x21}, .body_len = 2},                   false, 0, 1},
+    {"broadcast",   {.src = IKE, .dst = GLO,  .body = {SPEED_RPM_REQ, 0x20, 0x1E}, .body_len = 3},          true,  0, 1},
+};
+#define CASES (sizeof(cases) / sizeof(cases[0]))
+
+static uint32_t expected_bytes(const copy_case_t* c) {
+    if(c->filtered) return 0;
+    return sizeof(kbus_message_t) + KBUS_RX_HDR_LEN + c->frame.body_len + c->queued * 2 * sizeof(kbus_message_t*);
+}
+
+static void bt_cmd_task() {
+    bt_cmd_t command;
+
+    while(1) xQueueReceive(bt_cmd_queue, &command, portMAX_DELAY);
+}
+
+static int run_case(const copy_case_t* c, uint32_t count) {
+    kbus_msg_pool_stats_t before, now;
+    uint32_t expect = expected_bytes(c), baseline = c->baseline_copies * sizeof(kbus_message_t);
+    uint32_t bytes, delivered;
+
+    kbus_msg_pool_get_stats(&before);
+    for(uint32_t i = 0; i < count; i++) {
+        kbus_virtual_bus_inject(&c->frame, portMAX_DELAY);
+        // One at a time, so the SDRS queue never overflows and drops a reference uncounted
+        for(int ms = 0; ms < FRAME_TIMEOUT_MS; ms++) {
+            kbus_msg_pool_get_stats(&now);
+            if(now.bytes_copied - before.bytes_copied >= (i + 1) * expect) break;
+            vTaskDelay(pdMS_TO_TICKS(1));
+        }
+    }
+    vTaskDelay(pdMS_TO_TICKS(SETTLE_MS));
+    kbus_msg_pool_get_stats(&now);
+
+    bytes = now.bytes_copied - before.bytes_copied;
+    delivered = now.frames_delivered - before.frames_delivered;
+    printf("%-12s %3"PRIu32" bytes/frame, baseline %3"PRIu32" (%+.0f%%)\n", c->name, bytes / count, baseline,
+           (bytes / (double)count - baseline) * 100 / baseline);
+    if(bytes != count * expect || delivered != (c->filtered ? 0 : count)) {
+        printf("FAIL %s: %"PRIu32" bytes over %"PRIu32" delivered frames, expected %"PRIu32" over %"PRIu32"\n",
+               c->name, bytes, delivered, count * expect, c->filtered ? 0 : count);
+        return 1;
+    }
+    return 0;
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [-n frames] [-v]\n", argv0);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    uint32_t count = 100;
+    bool verbose = false;
+    int failures = 0, opt;
+
+    while((opt = getopt(argc, argv, "n:v")) != -1) {
+        switch(opt) {
+            case 'n': count = (uint32_t)atol(optarg); break;
+            case 'v': verbose = true; break;
+            default: usage(argv[0]);
+        }
+    }
+    if(optind != argc || count == 0) usage(argv[0]);
+    if(!verbose) esp_log_level_set("*", ESP_LOG_WARN);
+
+    // As kbus_host starts it; the emulators' startup traffic is over before counting starts
+    sys_monitor_init();
+    bt_cmd_queue = SYS_QUEUE_CREATE("bt_cmd", 4, sizeof(bt_cmd_t));
+    bt_info_queue = SYS_QUEUE_CREATE("bt_info", 2, sizeof(bt_now_playing_info_t));
+    xTaskCreate(bt_cmd_task, "bt_cmd", 2048, NULL, 1, NULL);
+    init_kbus_service(bt_cmd_queue, bt_info_queue);
+    vTaskDelay(pdMS_TO_TICKS(2000));
+
+    for(size_t c = 0; c < CASES; c++) failures += run_case(&cases[c], count);
+    if(failures) ESP_LOGE(TAG, "%d frame classes off their expected copy count", failures);
+    printf("%s\n", failures ? "FAIL" : "PASS");
+    return failures ? 1 : 0;
+}
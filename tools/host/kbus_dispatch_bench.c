@@ -0,0 +1,275 @@
+/**
+ ** Dispatch cost per frame: kbus_pubsub's pattern tables, as kbus_service registers them,
+ ** against the baseline's switch(src) then switch(dst) in kbus_rx_task. Built by the host
+ ** target (tools/host/CMakeLists.txt):
+ **
+ **   kbus_dispatch_bench       every traffic mix, both dispatchers
+ **   -n FRAMES                 frames per mix and run, default 2000000
+ **   -r RUNS                   runs per mix; the fastest counts, default 5
+ **
+ ** Both sides call the same counting handlers, and per mix the counts have to agree, so the
+ ** table routes exactly what the switch did. The baseline's commented out CDC case is
+ ** enabled to match. Every subscriber is inline here; the SDRS queue handoff on top is in
+ ** kbus_host's round trips. The "+8 devices" rows add eight more emulated addresses to both,
+ ** as more modules get emulated. Exits 1 if routing differs.
+ **
+ ** The table keeps up with the switch, or beats it, except where nearly every frame is
+ ** delivered (the "sat" mix, about +25%): a switch's predicted branches lead straight to the
+ ** call, while the table needs the route load that depends on the match before it can call
+ ** the handler through a pointer. That's well under a nanosecond a frame here, and a frame
+ ** takes milliseconds on the wire, so it's the price of subscribing at runtime.
+ */
+
+// C stdlib includes
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// component includes
+#include "kbus_uart_driver.h"
+#include "kbus_defines.h"
+#include "kbus_filter.h"
+#include "kbus_pubsub.h"
+#include "kbus_service.h"
+#include "sdrs_emulator.h"
+
+typedef enum {
+    H_MFL = 0,
+    H_IGN,
+    H_TEL,
+    H_SDRS,
+    H_CDC,
+    H_EXTRA,
+    HANDLERS
+} handler_id_t;
+
+static const char* handler_names[HANDLERS] = {"mfl", "ignition", "tel", "sdrs", "cdc", "extra"};
+static uint32_t counts[HANDLERS];
+
+// Addresses a few more emulators would take; none of them see traffic in the mixes below but "busy"
+static const uint8_t extra_devs[] = {GT, BMBT, NAVE, CID, IRIS, ANZV, TV, DSP};
+
+static __attribute__((noinline)) void on_mfl(kbus_message_t* message)   { counts[H_MFL]++; }
+static __attribute__((noinline)) void on_ign(kbus_message_t* message)   { counts[H_IGN]++; }
+static __attribute__((noinline)) void on_tel(kbus_message_t* message)   { counts[H_TEL]++; }
+static __attribute__((noinline)) void on_sdrs(kbus_message_t* message)  { counts[H_SDRS]++; }
+static __attribute__((noinline)) void on_cdc(kbus_message_t* message)   { counts[H_CDC]++; }
+static __attribute__((noinline)) void on_extra(kbus_message_t* message) { counts[H_EXTRA]++; }
+
+// kbus_rx_task's switch routing as of 82da2d2, logging stripped, handlers in place of its calls
+static void baseline_dispatch(kbus_message_t* message) {
+    switch(message->src) {
+        case MFL:
+            on_mfl(message);
+            break;
+
+        default:
+            break;
+    }
+
+    switch(message->dst) {
+        case LOC:
+            break;
+
+        case GLO:
+            if(message->body_len && message->body[0] == IGN_STAT_RPLY) on_ign(message);
+            break;
+
+        case SDRS:
+            on_sdrs(message);
+            break;
+
+        case CDC:
+            if(message->body[0] == DEV_STAT_REQ || message->body[0] == CD_CTRL_REQ) on_cdc(message);
+            break;
+
+        case TEL:
+            on_tel(message);
+            break;
+
+        default:
+            break;
+    }
+}
+
+// Same, with a case per extra emulated device
+static void baseline_dispatch_wide(kbus_message_t* message) {
+    baseline_dispatch(message);
+    switch(message->dst) {
+        case GT:
+        case BMBT:
+        case NAVE:
+        case CID:
+        case IRIS:
+        case ANZV:
+        case TV:
+        case DSP:
+            on_extra(message);
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void table_dispatch(kbus_message_t* message) {
+    kbus_publish(message, 0);
+}
+
+#define FRAME(s, d, ...) {.src = (s), .dst = (d), .body = {__VA_ARGS__}, .body_len = sizeof((uint8_t[]){__VA_ARGS__})}
+
+// Radio with CD as source, the car's usual broadcasts around it
+static const kbus_message_t mix_cd[] = {
+    FRAME(RAD, CDC, CD_CTRL_REQ, 0x00, 0x00),
+    FRAME(IKE, GLO, IGN_STAT_RPLY, 0x03),
+    FRAME(IKE, GLO, SPEED_RPM_REQ, 0x20, 0x1E),
+    FRAME(IKE, GLO, TEMP, 0x14, 0x50),
+    FRAME(LCM, GLO, 0x5B, 0x00, 0x00, 0x00, 0x00),
+    FRAME(RAD, CDC, CD_CTRL_REQ, 0x00, 0x00),
+    FRAME(GM, GLO, 0x7A, 0x10, 0x00),
+    FRAME(RAD, LOC, DEV_STAT_RDY, 0x00),
+};
+
+// SAT as source: heartbeats, text requests, the radio's own display traffic
+static const kbus_message_t mix_sat[] = {
+    FRAME(RAD, SDRS, SDRS_CTRL_REQ, SDRS_HEARTBEAT, 0x00),
+    FRAME(RAD, SDRS, SDRS_CTRL_REQ, SDRS_REQ_SONG, 0x00),
+    FRAME(RAD, SDRS, SDRS_CTRL_REQ, SDRS_REQ_ARTIST, 0x00),
+    FRAME(IKE, GLO, SPEED_RPM_REQ, 0x20, 0x1E),
+    FRAME(RAD, GT, 0x23, 0x62, 0x30),
+    FRAME(RAD, SDRS, SDRS_CTRL_REQ, SDRS_HEARTBEAT, 0x00),
+    FRAME(IKE, GLO, IGN_STAT_RPLY, 0x03),
+};
+
+// Steering wheel buttons and the phone
+static const kbus_message_t mix_wheel[] = {
+    FRAME(MFL, RAD, MFL_BUTTON, 0x01),
+    FRAME(MFL, RAD, MFL_BUTTON, 0x21),
+    FRAME(MFL, TEL, 0x01),
+    FRAME(MFL, RAD, 0x32, 0x11),
+    FRAME(RAD, TEL, DEV_STAT_REQ),
+    FRAME(IKE, GLO, SPEED_RPM_REQ, 0x20, 0x1E),
+};
+
+// Navigation and the on-board monitor talking among themselves, the extra devices' addresses included
+static const kbus_message_t mix_busy[] = {
+    FRAME(BMBT, RAD, BMBT_BUTT_1, 0x05),
+    FRAME(GT, RAD, 0x37, 0x30),
+    FRAME(NAVE, GT, 0xA2, 0x01, 0x00),
+    FRAME(RAD, GT, 0x21, 0x60, 0x00),
+    FRAME(IKE, ANZV, 0x24, 0x01, 0x00),
+    FRAME(GT, GLO, 0x02, 0x30),
+    FRAME(LCM, GLO, 0x5B, 0x00, 0x00, 0x00, 0x00),
+    FRAME(DIA, IKE, 0x00),
+};
+
+typedef struct {
+    const char* name;
+    const kbus_message_t* frames;
+    size_t nframes;
+} mix_t;
+
+#define MIX(name, frames) {(name), (frames), sizeof(frames) / sizeof((frames)[0])}
+static const mix_t mixes[] = {
+    MIX("cd", mix_cd),
+    MIX("sat", mix_sat),
+    MIX("wheel", mix_wheel),
+    MIX("busy", mix_busy),
+};
+
+static inline uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Fastest of runs; counts are left from the last run
+static double time_mix(void (*dispatch)(kbus_message_t*), const mix_t* mix, uint32_t nframes, int runs) {
+    kbus_message_t frames[16];
+    double best = 0;
+    uint64_t start, elapsed;
+
+    memcpy(frames, mix->frames, mix->nframes * sizeof(kbus_message_t));
+    for(int r = 0; r < runs; r++) {
+        memset(counts, 0, sizeof(counts));
+        start = now_ns();
+        for(uint32_t i = 0, f = 0; i < nframes; i++) {
+            dispatch(&frames[f]);
+            if(++f == mix->nframes) f = 0;
+        }
+        elapsed = now_ns() - start;
+        if(r == 0 || elapsed < best) best = elapsed;
+    }
+    return best / nframes;
+}
+
+static int compare(const char* variant, void (*baseline)(kbus_message_t*), const mix_t* mix, uint32_t nframes, int runs) {
+    uint32_t expect[HANDLERS];
+    double base_ns, table_ns;
+    int failures = 0;
+
+    base_ns = time_mix(baseline, mix, nframes, runs);
+    memcpy(expect, counts, sizeof(counts));
+    table_ns = time_mix(table_dispatch, mix, nframes, runs);
+
+    printf("%-6s %-11s baseline %6.2f ns/frame, table %6.2f ns/frame (%+.0f%%)\n", mix->name, variant,
+           base_ns, table_ns, (table_ns - base_ns) * 100 / base_ns);
+    for(int h = 0; h < HANDLERS; h++) {
+        if(counts[h] == expect[h]) continue;
+        printf("FAIL %s %s: %s handler ran %u times, baseline %u\n", mix->name, variant, handler_names[h], counts[h], expect[h]);
+        failures++;
+    }
+    return failures;
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [-n frames] [-r runs]\n", argv0);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    static kbus_filter_t filter;
+    static const kbus_pattern_t cdc_patterns[] = {
+        {KBUS_ANY, CDC, DEV_STAT_REQ},
+        {KBUS_ANY, CDC, CD_CTRL_REQ},
+    };
+    uint32_t nframes = 2000000;
+    int runs = 5, failures = 0, opt;
+    uint64_t start;
+
+    while((opt = getopt(argc, argv, "n:r:")) != -1) {
+        switch(opt) {
+            case 'n': nframes = (uint32_t)atol(optarg); break;
+            case 'r': runs = atoi(optarg); break;
+            default: usage(argv[0]);
+        }
+    }
+    if(optind != argc || nframes == 0 || runs <= 0) usage(argv[0]);
+
+    // Registered as init_kbus_service(), sdrs_init_emulation() and cdc_init_emulation() do
+    kbus_filter_init(&filter, false);
+    kbus_pubsub_init(&filter);
+    start = now_ns();
+    kbus_register_src_handler(MFL, on_mfl);
+    kbus_register_dst_cmd_handler(GLO, (const uint8_t[]){IGN_STAT_RPLY}, 1, on_ign);
+    kbus_register_dst_handler(TEL, on_tel);
+    kbus_subscribe("sdrs", &KBUS_PATTERN(KBUS_ANY, SDRS, KBUS_ANY), 1, on_sdrs);
+    kbus_subscribe("cdc", cdc_patterns, sizeof(cdc_patterns) / sizeof(cdc_patterns[0]), on_cdc);
+    printf("registration: %d subscribers in %.1f us\n", kbus_pubsub_count(), (now_ns() - start) / 1e3);
+
+    for(size_t m = 0; m < sizeof(mixes) / sizeof(mixes[0]); m++) {
+        failures += compare("firmware", baseline_dispatch, &mixes[m], nframes, runs);
+    }
+
+    for(size_t d = 0; d < sizeof(extra_devs); d++) kbus_register_dst_handler(extra_devs[d], on_extra);
+    for(size_t m = 0; m < sizeof(mixes) / sizeof(mixes[0]); m++) {
+        failures += compare("+8 devices", baseline_dispatch_wide, &mixes[m], nframes, runs);
+    }
+
+    printf("%s\n", failures ? "FAIL" : "PASS");
+    return failures ? 1 : 0;
+}
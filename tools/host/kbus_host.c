@@ -0,0 +1,287 @@
+/**
+ ** The K-bus stack (kbus_service, the SDRS and CD changer emulators, MFL) on a workstation:
+ ** the same sources as the firmware, built against the FreeRTOS/ESP_LOG shim in this directory
+ ** with the virtual bus in place of kbus_uart_driver:
+ **
+ **   cmake -S tools/host -B build/host && cmake --build build/host
+ **
+ **   kbus_host                 request to reply round trips per emulated device, then throughput
+ **   kbus_host capture.kbc     same, with a capture (kbus_capture.py) as the throughput traffic
+ **   -n COUNT                  round trips per device, default 1000
+ **   -f FRAMES                 frames pushed through for throughput, default 100000
+ **   -v                        keep the stack's info logs
+ **
+ ** This is what bt_services would be on the device: bt_cmd_queue is drained here and each
+ ** command timestamped. There's no wire time, so numbers are CPU cost plus thread handoffs at
+ ** full workstation speed; shapes compare between builds, absolute values don't carry over to
+ ** a 240 MHz ESP32.
+ */
+
+// C stdlib includes
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// FreeRTOS includes
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+// esp-idf includes
+#include "esp_log.h"
+#include "esp_timer.h"
+
+// component includes
+#include "kbus_uart_driver.h"
+#include "kbus_defines.h"
+#include "kbus_service.h"
+#include "kbus_msg_pool.h"
+#include "kbus_tx_sched.h"
+#include "kbus_virtual_bus.h"
+#include "bt_common.h"
+#include "sdrs_emulator.h"
+#include "sys_monitor.h"
+
+#define KBC_MAGIC "KBC1"
+#define KBC_VERSION 1
+#define KBC_HDR_LEN 8
+#define KBC_REC_HDR_LEN 7
+#define STARTUP_TIMEOUT_MS 3000     // emus_init announces everything a little over a second in
+#define REPLY_TIMEOUT_MS 500        // KBUS_TX_REPLY_DEADLINE_MS; later than this is lost
+#define BT_CMD_NONE 0xFF
+
+static const char* TAG = "kbus_host";
+static QueueHandle_t bt_cmd_queue, bt_info_queue;
+static TaskHandle_t main_task;
+
+// What the round trip in progress waits for; a tx frame from expect_src with expect_cmd, or a BT command
+static volatile uint8_t expect_src = 0, expect_cmd = 0, expect_bt = BT_CMD_NONE;
+static volatile int64_t answered_us;
+static volatile bool cdc_announced = false;
+
+typedef struct {
+    const char* name;
+    kbus_message_t request;
+    uint8_t reply_src;          // 0 when the answer is a BT command
+    uint8_t reply_cmd;
+} round_trip_t;
+
+// Request to reply for each emulated device; held search up then released for MFL
+static const round_trip_t round_trips[] = {
+    {"sdrs poll",   {.src = RAD, .dst = SDRS, .body = {SDRS_CTRL_REQ, SDRS_HEARTBEAT, 0x00}, .body_len = 3}, SDRS, SDRS_STAT_RPLY},
+    {"cdc poll",    {.src = RAD, .dst = CDC,  .body = {CD_CTRL_REQ, 0x00, 0x00}, .body_len = 3},            CDC,  CD_STAT_RPLY},
+    {"tel status",  {.src = RAD, .dst = TEL,  .body = {DEV_STAT_REQ}, .body_len = 1},                       TEL,  DEV_STAT_RDY},
+    {"mfl hold",    {.src = MFL, .dst = RAD,  .body = {MFL_BUTTON, 0x11}, .body_len = 2},                   0,    AVRCP_FF_START},
+    {"mfl release", {.src = MFL, .dst = RAD,  .body = {MFL_BUTTON, 0x21}, .body_len = 2},                   0,    AVRCP_FF_STOP},
+};
+#define ROUND_TRIPS (sizeof(round_trips) / sizeof(round_trips[0]))
+
+// Throughput traffic without a capture: polls for every emulator, ignition, and broadcasts the filter drops
+static const kbus_message_t default_mix[] = {
+    {.src = RAD, .dst = SDRS, .body = {SDRS_CTRL_REQ, SDRS_HEARTBEAT, 0x00}, .body_len = 3},
+    {.src = RAD, .dst = CDC,  .body = {CD_CTRL_REQ, 0x00, 0x00}, .body_len = 3},
+    {.src = IKE, .dst = GLO,  .body = {IGN_STAT_RPLY, 0x01}, .body_len = 2},
+    {.src = IKE, .dst = GLO,  .body = {SPEED_RPM_REQ, 0x20, 0x1E}, .body_len = 3},
+    {.src = RAD, .dst = TEL,  .body = {DEV_STAT_REQ}, .body_len = 1},
+    {.src = IKE, .dst = GLO,  .body = {SPEED_RPM_REQ, 0x21, 0x1F}, .body_len = 3},
+};
+
+static void on_tx(const kbus_message_t* message) {
+    if(message->src == CDC && message->body[0] == DEV_STAT_RDY && message->body[1] == 0x01) cdc_announced = true;
+    if(message->src == expect_src && message->body[0] == expect_cmd) {
+        expect_src = 0;
+        answered_us = esp_timer_get_time();
+        xTaskNotifyGive(main_task);
+    }
+}
+
+// Stands in for bt_services' AVRCP sender
+static void bt_cmd_task() {
+    bt_cmd_t command;
+
+    while(1) {
+        if(xQueueReceive(bt_cmd_queue, &command, portMAX_DELAY) && command.type == expect_bt) {
+            expect_bt = BT_CMD_NONE;
+            answered_us = esp_timer_get_time();
+            xTaskNotifyGive(main_task);
+        }
+    }
+}
+
+static int cmp_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Request types take turns, so the MFL hold is always followed by its release
+static int run_round_trips(uint32_t count) {
+    uint32_t* samples = malloc(ROUND_TRIPS * count * sizeof(uint32_t));
+    uint32_t n[ROUND_TRIPS] = {0}, lost[ROUND_TRIPS] = {0};
+    int64_t start_us;
+    int failures = 0;
+
+    if(samples == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    for(uint32_t i = 0; i < count; i++) {
+        for(size_t t = 0; t < ROUND_TRIPS; t++) {
+            const round_trip_t* trip = &round_trips[t];
+
+            ulTaskNotifyTake(pdTRUE, 0);    // Anything late from a lost one
+            if(trip->reply_src) {
+                expect_cmd = trip->reply_cmd;
+                expect_src = trip->reply_src;
+            } else {
+                expect_bt = trip->reply_cmd;
+            }
+            start_us = esp_timer_get_time();
+            kbus_virtual_bus_inject(&trip->request, portMAX_DELAY);
+            if(ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(REPLY_TIMEOUT_MS)) == 0) {
+                expect_src = 0;
+                expect_bt = BT_CMD_NONE;
+                lost[t]++;
+                continue;
+            }
+            samples[t * count + n[t]++] = (uint32_t)(answered_us - start_us);
+        }
+    }
+
+    for(size_t t = 0; t < ROUND_TRIPS; t++) {
+        uint32_t* trip_samples = &samples[t * count];
+
+        failures += lost[t] != 0;
+        if(n[t] == 0) {
+            printf("%-12s n=0, %u lost\n", round_trips[t].name, lost[t]);
+            continue;
+        }
+        qsort(trip_samples, n[t], sizeof(uint32_t), cmp_u32);
+        printf("%-12s n=%u p50=%u p99=%u max=%u us, %u lost\n", round_trips[t].name, n[t], trip_samples[n[t] / 2],
+               trip_samples[(uint64_t)n[t] * 99 / 100], trip_samples[n[t] - 1], lost[t]);
+    }
+    free(samples);
+    return failures;
+}
+
+// Blocking injects, so the rate is what the stack drains, not what the producer can push
+static void run_throughput(const kbus_message_t* frames, size_t nframes, uint32_t total) {
+    kbus_msg_pool_stats_t pool_stats;
+    kbus_tx_stats_t tx_stats;
+    kbus_filter_stats_t filter_stats;
+    int64_t start_us, elapsed_us;
+
+    start_us = esp_timer_get_time();
+    for(uint32_t i = 0; i < total; i++) kbus_virtual_bus_inject(&frames[i % nframes], portMAX_DELAY);
+    elapsed_us = esp_timer_get_time() - start_us;
+    vTaskDelay(pdMS_TO_TICKS(100));     // Let replies drain before reading stats
+
+    kbus_msg_pool_get_stats(&pool_stats);
+    kbus_tx_get_stats(&tx_stats);
+    kbus_rx_filter_get_stats(&filter_stats);
+    printf("throughput   %u frames in %.1f ms, %.0f frames/s, %.2f us/frame\n", total, elapsed_us / 1e3,
+           total * 1e6 / elapsed_us, (double)elapsed_us / total);
+    printf("rx-filter    %"PRIu32" passed, %"PRIu32" dropped\n", filter_stats.passed, filter_stats.dropped);
+    printf("tx-sched     %"PRIu32" sent, %"PRIu32" superseded, %"PRIu32" expired, %"PRIu32" full\n",
+           tx_stats.sent, tx_stats.superseded, tx_stats.dropped_expired, tx_stats.dropped_full);
+    printf("msg-pool     max %d in use, %"PRIu32" alloc failures, %"PRIu32" bytes copied/frame\n", pool_stats.in_use_max,
+           pool_stats.alloc_failures, pool_stats.frames_delivered ? pool_stats.bytes_copied / pool_stats.frames_delivered : 0);
+}
+
+/**
+ ** [uint32 LE us since previous record][src][dst][body_len][body...], after an 8 byte header.
+ ** Timing is dropped; frames go in back to back.
+ */
+static kbus_message_t* load_capture(const char* path, size_t* nframes) {
+    FILE* f = fopen(path, "rb");
+    uint8_t hdr[KBC_HDR_LEN], rec[KBC_REC_HDR_LEN];
+    kbus_message_t* frames = NULL;
+    size_t cap = 0;
+
+    *nframes = 0;
+    if(f == NULL) {
+        perror(path);
+        return NULL;
+    }
+    if(fread(hdr, 1, KBC_HDR_LEN, f) != KBC_HDR_LEN || memcmp(hdr, KBC_MAGIC, 4) != 0 || hdr[4] != KBC_VERSION) {
+        fprintf(stderr, "%s: not a v%d K-bus capture\n", path, KBC_VERSION);
+        fclose(f);
+        return NULL;
+    }
+    while(fread(rec, 1, KBC_REC_HDR_LEN, f) == KBC_REC_HDR_LEN) {
+        if(*nframes == cap) {
+            cap = cap ? cap * 2 : 1024;
+            frames = realloc(frames, cap * sizeof(kbus_message_t));
+            if(frames == NULL) break;
+        }
+        kbus_message_t* frame = &frames[*nframes];
+        memset(frame, 0, sizeof(*frame));
+        frame->src = rec[4];
+        frame->dst = rec[5];
+        frame->body_len = rec[6] < sizeof(frame->body) ? rec[6] : sizeof(frame->body);
+        if(fread(frame->body, 1, frame->body_len, f) != frame->body_len ||
+           fseek(f, rec[6] - frame->body_len, SEEK_CUR) != 0) break;
+        (*nframes)++;
+    }
+    fclose(f);
+    if(*nframes == 0) {
+        fprintf(stderr, "%s: no frames\n", path);
+        free(frames);
+        return NULL;
+    }
+    return frames;
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [-n round_trips] [-f frames] [-v] [capture.kbc]\n", argv0);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    uint32_t count = 1000, total = 100000;
+    bool verbose = false;
+    const kbus_message_t* frames = default_mix;
+    kbus_message_t* capture = NULL;
+    size_t nframes = sizeof(default_mix) / sizeof(default_mix[0]);
+    int failures, opt;
+
+    while((opt = getopt(argc, argv, "n:f:v")) != -1) {
+        switch(opt) {
+            case 'n': count = (uint32_t)atol(optarg); break;
+            case 'f': total = (uint32_t)atol(optarg); break;
+            case 'v': verbose = true; break;
+            default: usage(argv[0]);
+        }
+    }
+    if(optind < argc - 1 || count == 0 || total == 0) usage(argv[0]);
+    if(optind == argc - 1) {
+        capture = load_capture(argv[optind], &nframes);
+        if(capture == NULL) return 1;
+        frames = capture;
+    }
+    if(!verbose) esp_log_level_set("*", ESP_LOG_WARN);
+
+    // As app_main does, minus NVS and Bluetooth
+    main_task = xTaskGetCurrentTaskHandle();
+    sys_monitor_init();
+    bt_cmd_queue = SYS_QUEUE_CREATE("bt_cmd", 4, sizeof(bt_cmd_t));
+    bt_info_queue = SYS_QUEUE_CREATE("bt_info", 2, sizeof(bt_now_playing_info_t));
+    xTaskCreate(bt_cmd_task, "bt_cmd", 2048, NULL, 1, NULL);
+    kbus_virtual_bus_set_tx_hook(on_tx);
+    init_kbus_service(bt_cmd_queue, bt_info_queue);
+
+    for(int ms = 0; !cdc_announced && ms < STARTUP_TIMEOUT_MS; ms += 10) vTaskDelay(pdMS_TO_TICKS(10));
+    if(!cdc_announced) {
+        ESP_LOGE(TAG, "Emulators didn't announce themselves in %d ms", STARTUP_TIMEOUT_MS);
+        return 1;
+    }
+
+    failures = run_round_trips(count);
+    run_throughput(frames, nframes, total);
+    free(capture);
+    printf("%s\n", failures ? "FAIL" : "PASS");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,148 @@
+/**
+ ** Torn read stress test for the now-playing snapshot (sdrs_display.h). Built by the host
+ ** target (tools/host/CMakeLists.txt):
+ **
+ **   sdrs_display_stress       one writer publishing back to back, readers copying back to back
+ **   -n PUBLISHES              default 200000
+ **   -r READERS                reader threads, default 3
+ **
+ ** Every publish fills all four fields, end to end, from its own number, so a snapshot with two
+ ** publishes in it has fields, or parts of one, that disagree. Each read has to be whole, carry
+ ** the version of the publish it came from, and not be older than sdrs_display_version() was
+ ** just before it nor than the reader's previous one. The slowest read is printed too; readers
+ ** never retry, so it stays a copy's worth apart from the host scheduling a reader out. Exits
+ ** 1 on any torn or out of order read.
+ */
+
+// C stdlib includes
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// component includes
+#include "sdrs_display.h"
+
+#define MAX_READERS 16
+
+typedef struct {
+    pthread_t thread;
+    uint64_t reads;
+    uint64_t torn;
+    uint64_t stale;
+    int64_t max_ns;
+} reader_t;
+
+static volatile bool done = false;
+
+static inline int64_t now_ns() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Field filled end to end with the publish number, as 8 hex digits over and over
+static void fill(char* field, size_t size, uint32_t n) {
+    char word[9];
+
+    snprintf(word, sizeof(word), "%08x", n);
+    for(size_t i = 0; i < size - 1; i++) field[i] = word[i % 8];
+    field[size - 1] = '\0';
+}
+
+static bool filled(const char* field, size_t size, uint32_t n) {
+    char expect[128];
+
+    fill(expect, size, n);
+    return memcmp(field, expect, size) == 0;
+}
+
+static void* writer(void* arg) {
+    uint32_t publishes = *(uint32_t*)arg;
+    sdrs_display_buf_t next;
+
+    for(uint32_t n = 1; n <= publishes; n++) {
+        fill(next.chan_disp, sizeof(next.chan_disp), n);
+        fill(next.song_disp, sizeof(next.song_disp), n);
+        fill(next.artist_disp, sizeof(next.artist_disp), n);
+        fill(next.esn_disp, sizeof(next.esn_disp), n);
+        sdrs_display_publish(&next);
+    }
+    done = true;
+    return NULL;
+}
+
+static void* reader(void* arg) {
+    reader_t* r = arg;
+    sdrs_display_buf_t snapshot;
+    uint32_t version, before, last = 0, n;
+    int64_t start;
+
+    while(!done) {
+        before = sdrs_display_version();
+        start = now_ns();
+        version = sdrs_display_read(&snapshot);
+        if(now_ns() - start > r->max_ns) r->max_ns = now_ns() - start;
+        r->reads++;
+
+        if(version < before || version < last) r->stale++;
+        last = version;
+        if(version == 1) continue;      // Initial text, before the first publish
+
+        // Publish n is version n + 1
+        n = version - 1;
+        if(!filled(snapshot.chan_disp, sizeof(snapshot.chan_disp), n) ||
+           !filled(snapshot.song_disp, sizeof(snapshot.song_disp), n) ||
+           !filled(snapshot.artist_disp, sizeof(snapshot.artist_disp), n) ||
+           !filled(snapshot.esn_disp, sizeof(snapshot.esn_disp), n)) {
+            if(r->torn++ == 0) printf("torn read at version %u: song \"%.24s...\"\n", version, snapshot.song_disp);
+        }
+    }
+    return NULL;
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [-n publishes] [-r readers]\n", argv0);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    static reader_t readers[MAX_READERS];
+    uint32_t publishes = 200000, reader_count = 3;
+    uint64_t reads = 0, torn = 0, stale = 0;
+    int64_t max_ns = 0;
+    pthread_t writer_thread;
+    int opt;
+
+    while((opt = getopt(argc, argv, "n:r:")) != -1) {
+        switch(opt) {
+            case 'n': publishes = (uint32_t)atol(optarg); break;
+            case 'r': reader_count = (uint32_t)atol(optarg); break;
+            default: usage(argv[0]);
+        }
+    }
+    if(optind != argc || publishes == 0 || reader_count == 0 || reader_count > MAX_READERS) usage(argv[0]);
+
+    for(uint32_t i = 0; i < reader_count; i++) pthread_create(&readers[i].thread, NULL, reader, &readers[i]);
+    pthread_create(&writer_thread, NULL, writer, &publishes);
+    pthread_join(writer_thread, NULL);
+
+    for(uint32_t i = 0; i < reader_count; i++) {
+        pthread_join(readers[i].thread, NULL);
+        reads += readers[i].reads;
+        torn += readers[i].torn;
+        stale += readers[i].stale;
+        if(readers[i].max_ns > max_ns) max_ns = readers[i].max_ns;
+    }
+
+    printf("%u publishes, %u readers, %llu reads: %llu torn, %llu out of order, slowest read %lld ns\n",
+           publishes, reader_count, (unsigned long long)reads, (unsigned long long)torn,
+           (unsigned long long)stale, (long long)max_ns);
+    printf("%s\n", torn || stale ? "FAIL" : "PASS");
+    return torn || stale ? 1 : 0;
+}
@@ -0,0 +1,171 @@
+/**
+ ** Now-playing publish to pushed track text, through the running SDRS emulator. Built by the
+ ** host target (tools/host/CMakeLists.txt):
+ **
+ **   sdrs_push_check           idle, then with rx_queue full of radio polls at each publish
+ **   -n SAMPLES                publishes per mode, default 20
+ **   -b BURST                  polls per burst, default 16; rx_queue holds 8
+ **   -v                        keep the stack's info logs
+ **
+ ** Each sample publishes a new song title and times until the song UPDATE_TXT push carrying it
+ ** leaves on the virtual bus. Samples are spaced past SDRS_PUSH_MIN_MS so the rate limit never
+ ** holds one back, and SAT is kept the radio's source by a poll before each. For a burst, emu_task
+ ** is suspended (the shim's vTaskSuspend) while the polls pile up, so the publish's wakeup
+ ** finds rx_queue full, as it can on the target when the radio polls in a burst; it's resumed
+ ** right after the publish. When that wakeup was the only record of the change, a full queue
+ ** dropped it and the push never went out. One that doesn't arrive within PUSH_TIMEOUT_MS is
+ ** missed. Exits 1 on any miss.
+ */
+
+// C stdlib includes
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// FreeRTOS includes
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+// esp-idf includes
+#include "esp_log.h"
+#include "esp_timer.h"
+
+// component includes
+#include "kbus_uart_driver.h"
+#include "kbus_defines.h"
+#include "kbus_service.h"
+#include "kbus_virtual_bus.h"
+#include "bt_common.h"
+#include "sdrs_emulator.h"
+#include "sdrs_sched.h"
+#include "sys_monitor.h"
+
+#define STARTUP_MS 2000
+#define PUSH_TIMEOUT_MS 1500
+#define SAMPLE_GAP_MS (SDRS_PUSH_MIN_MS + 100)
+#define BURST_SETTLE_MS 20          // For the dispatch task to queue the burst to emu_task
+
+static const char* TAG = "sdrs_push_check";
+static QueueHandle_t bt_cmd_queue, bt_info_queue, pushes;
+
+typedef struct {
+    int64_t at_us;
+    char song[sizeof(((sdrs_display_buf_t*)0)->song_disp)];
+} push_t;
+
+// Song pushes only; the replies to the polls below have other flags or come from RAD requests
+static void on_tx(const kbus_message_t* message) {
+    push_t push = {.at_us = esp_timer_get_time()};
+    uint8_t len;
+
+    if(message->src != SDRS || message->body[0] != SDRS_STAT_RPLY) return;
+    if(message->body[1] != SDRS_UPDATE_TXT || message->body[2] != 0x07) return;
+    len = message->body_len - 6;
+    if(len >= sizeof(push.song)) len = sizeof(push.song) - 1;
+    memcpy(push.song, &message->body[6], len);
+    xQueueSend(pushes, &push, 0);
+}
+
+static void bt_cmd_task() {
+    bt_cmd_t command;
+
+    while(1) xQueueReceive(bt_cmd_queue, &command, portMAX_DELAY);
+}
+
+static void poll(uint8_t req) {
+    kbus_message_t request = {.src = RAD, .dst = SDRS, .body = {SDRS_CTRL_REQ, req, 0}, .body_len = 3};
+
+    kbus_virtual_bus_inject(&request, portMAX_DELAY);
+}
+
+static int compare_us(const void* a, const void* b) {
+    int64_t x = *(const int64_t*)a, y = *(const int64_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Latency of each sample into lat_us; returns the number missed
+static uint32_t run(const char* mode, uint32_t samples, uint32_t burst, int64_t* lat_us) {
+    TaskHandle_t emu_tsk = xTaskGetHandle("sdrs_emu");
+    sdrs_display_buf_t display;
+    push_t push;
+    uint32_t missed = 0, got = 0;
+    int64_t start_us;
+    bool found;
+
+    sdrs_display_read(&display);
+    for(uint32_t i = 0; i < samples; i++) {
+        // SDRS_REQ_ESN is answered but starts no follow-up, so the poll only keeps SAT active
+        poll(SDRS_REQ_ESN);
+        vTaskDelay(pdMS_TO_TICKS(SAMPLE_GAP_MS));
+        xQueueReset(pushes);
+
+        snprintf(display.song_disp, sizeof(display.song_disp), "%s %u", mode, i);
+        if(burst) {
+            vTaskSuspend(emu_tsk);
+            for(uint32_t b = 0; b < burst; b++) poll(SDRS_REQ_ESN);
+            vTaskDelay(pdMS_TO_TICKS(BURST_SETTLE_MS));
+        }
+        start_us = esp_timer_get_time();
+        sdrs_display_publish(&display);
+        if(burst) vTaskResume(emu_tsk);
+
+        found = false;
+        while(!found && xQueueReceive(pushes, &push, pdMS_TO_TICKS(PUSH_TIMEOUT_MS))) {
+            found = strcmp(push.song, display.song_disp) == 0;
+        }
+        if(found) lat_us[got++] = push.at_us - start_us;
+        else missed++;
+    }
+
+    qsort(lat_us, got, sizeof(int64_t), compare_us);
+    printf("%-6s %3u samples  missed %3u", mode, samples, missed);
+    if(got) printf("  p50 %6lld us  p99 %6lld us  max %6lld us", (long long)lat_us[got / 2],
+                   (long long)lat_us[(got * 99) / 100], (long long)lat_us[got - 1]);
+    printf("\n");
+    return missed;
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [-n samples] [-b burst] [-v]\n", argv0);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    uint32_t samples = 20, burst = 16, missed;
+    bool verbose = false;
+    int64_t* lat_us;
+    int opt;
+
+    while((opt = getopt(argc, argv, "n:b:v")) != -1) {
+        switch(opt) {
+            case 'n': samples = (uint32_t)atol(optarg); break;
+            case 'b': burst = (uint32_t)atol(optarg); break;
+            case 'v': verbose = true; break;
+            default: usage(argv[0]);
+        }
+    }
+    if(optind != argc || samples == 0 || burst == 0) usage(argv[0]);
+    if(!verbose) esp_log_level_set("*", ESP_LOG_WARN);
+    lat_us = calloc(samples, sizeof(int64_t));
+
+    // As kbus_host starts it; bt_info_queue stays empty, so this is the display's only writer
+    sys_monitor_init();
+    bt_cmd_queue = SYS_QUEUE_CREATE("bt_cmd", 4, sizeof(bt_cmd_t));
+    bt_info_queue = SYS_QUEUE_CREATE("bt_info", 2, sizeof(bt_now_playing_info_t));
+    pushes = xQueueCreate(8, sizeof(push_t));
+    xTaskCreate(bt_cmd_task, "bt_cmd", 2048, NULL, 1, NULL);
+    kbus_virtual_bus_set_tx_hook(on_tx);
+    init_kbus_service(bt_cmd_queue, bt_info_queue);
+    vTaskDelay(pdMS_TO_TICKS(STARTUP_MS));
+
+    missed = run("idle", samples, 0, lat_us);
+    missed += run("burst", samples, burst, lat_us);
+    free(lat_us);
+    if(missed) ESP_LOGE(TAG, "%u track text pushes never went out", missed);
+    printf("%s\n", missed ? "FAIL" : "PASS");
+    return missed ? 1 : 0;
+}
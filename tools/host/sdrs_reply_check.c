@@ -0,0 +1,251 @@
+/**
+ ** The SDRS emulator's cached replies against the baseline's per-request build. Built by the
+ ** host target (tools/host/CMakeLists.txt):
+ **
+ **   sdrs_reply_check          a seeded random walk of radio requests and display publishes
+ **   -n STEPS                  steps, default 2000
+ **   -s SEED                   default 1
+ **   -v                        keep the stack's info logs
+ **
+ ** Each request goes through the virtual bus to the running emulator, and its reply has to match,
+ ** byte for byte, what the baseline's switch would have encoded from the same tuning and the
+ ** display text published last. Tuning requests (channel up/down, preset, bank) and publishes
+ ** are mixed in, so the cache is checked right after every kind of invalidation and on the
+ ** polls that reuse it in between. The heartbeat's channel text follow-up is checked once at the
+ ** end, as it comes a second later.
+ **
+ ** The baseline copied text of any length into the 32 byte body; texts here stay within what
+ ** fits, plus one that is clipped the way the cache clips it. Exits 1 on the first mismatch.
+ */
+
+// C stdlib includes
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// FreeRTOS includes
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+// esp-idf includes
+#include "esp_log.h"
+
+// component includes
+#include "kbus_uart_driver.h"
+#include "kbus_defines.h"
+#include "kbus_service.h"
+#include "kbus_virtual_bus.h"
+#include "bt_common.h"
+#include "sdrs_emulator.h"
+#include "sdrs_sched.h"
+#include "sys_monitor.h"
+
+#define STARTUP_MS 2000
+#define REPLY_TIMEOUT_MS 500
+#define TEXT_MAX 26                 // What fits in the body after the 6 byte reply header
+
+static const char* TAG = "sdrs_reply_check";
+static QueueHandle_t bt_cmd_queue, bt_info_queue, sdrs_tx;
+
+// What the baseline kept: tuning, and the display buffer it read text from per request
+static struct {
+    uint8_t channel, bank, preset;
+    sdrs_display_buf_t display;
+} model = {.channel = 0xaf};
+
+static const char* texts[] = {
+    "Spotify", "Radio 1", "", "Daft Punk", "Harder Better Faster", "Bohemian Rhapsody",
+    "Sigur Ros", "A", "Kings of Convenience", "Twenty six chars exactly!!",
+    "This one is far too long to fit in a single frame",
+};
+#define TEXTS (sizeof(texts) / sizeof(texts[0]))
+
+// SDRS_CTRL_REQ subcommands that get a reply
+static const uint8_t requests[] = {
+    SDRS_HEARTBEAT, SDRS_REQ_SLEEP, SDRS_REQ_CHAN_UP, SDRS_REQ_CHAN_DN, SDRS_REQ_PRESET,
+    SDRS_REQ_ESN, SDRS_REQ_BANK_UP, SDRS_REQ_ARTIST, SDRS_REQ_SONG,
+};
+
+static void on_tx(const kbus_message_t* message) {
+    if(message->src == SDRS && message->body[0] == SDRS_STAT_RPLY) xQueueSend(sdrs_tx, message, 0);
+}
+
+static void bt_cmd_task() {
+    bt_cmd_t command;
+
+    while(1) xQueueReceive(bt_cmd_queue, &command, portMAX_DELAY);
+}
+
+static void encode(uint8_t* body, uint8_t* len, uint8_t cmd, uint8_t flags, uint8_t channel, uint8_t presets,
+                   uint8_t magic, const char* text) {
+    size_t text_len = text ? strlen(text) : 0;
+
+    if(text_len > TEXT_MAX) text_len = TEXT_MAX;
+    body[0] = SDRS_STAT_RPLY;
+    body[1] = cmd;
+    body[2] = flags;
+    body[3] = channel;
+    body[4] = presets;
+    body[5] = magic;
+    memcpy(&body[6], text, text_len);
+    *len = 6 + text_len;
+}
+
+// emu_task's per-request encoding switch as of 82da2d2, on the model; false for requests it didn't answer
+static bool baseline_reply(uint8_t req, uint8_t arg, uint8_t* body, uint8_t* len) {
+    uint8_t presets;
+
+    switch(req) {
+        case SDRS_REQ_SLEEP:
+            encode(body, len, SDRS_POWER_MODE, 0x00, model.channel, (model.bank << 4) | model.preset, 0x04, NULL);
+            return true;
+        case SDRS_REQ_CHAN_UP:
+            model.channel++;
+            // Fall through
+        case SDRS_HEARTBEAT:
+            encode(body, len, SDRS_HEARTBEAT, 0x00, model.channel, (model.bank << 4) | model.preset, 0x04, NULL);
+            return true;
+        case SDRS_REQ_CHAN_DN:
+            model.channel--;
+            encode(body, len, SDRS_CHAN_DN_ACK, 0x00, model.channel, (model.bank << 4) | model.preset, 0x04, NULL);
+            return true;
+        case SDRS_REQ_PRESET:
+        case SDRS_REQ_BANK_UP:
+            if(req == SDRS_REQ_PRESET) model.preset = arg;
+            else model.bank++;
+            presets = (model.bank << 4) | model.preset;
+            encode(body, len, SDRS_HEARTBEAT, 0x00, model.channel, presets, 0x04, model.display.chan_disp);
+            return true;
+        case SDRS_REQ_ESN:
+            encode(body, len, SDRS_UPDATE_TXT, 0x0c, 0x30, 0x30, 0x30, model.display.esn_disp);
+            return true;
+        case SDRS_REQ_ARTIST:
+            encode(body, len, SDRS_UPDATE_TXT, 0x06, model.channel, 0x01, 0x01, model.display.artist_disp);
+            return true;
+        case SDRS_REQ_SONG:
+            encode(body, len, SDRS_UPDATE_TXT, 0x07, model.channel, 0x01, 0x01, model.display.song_disp);
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void print_body(const char* what, const uint8_t* body, uint8_t len) {
+    printf("  %-8s", what);
+    for(uint8_t i = 0; i < len; i++) printf(" %02X", body[i]);
+    printf("\n");
+}
+
+/**
+ ** Wait for a frame with the expected subcommand and flags that matches. Track text pushes and
+ ** channel text follow-ups share subcommand and flags with some replies; they're built from the
+ ** same cache, so one that matches counts, one that doesn't is skipped and shown if nothing does.
+ */
+static bool expect_frame(const uint8_t* body, uint8_t len, uint32_t timeout_ms) {
+    kbus_message_t frame, seen = {0};
+    TickType_t start = xTaskGetTickCount();
+
+    while(xTaskGetTickCount() - start < pdMS_TO_TICKS(timeout_ms)) {
+        if(!xQueueReceive(sdrs_tx, &frame, pdMS_TO_TICKS(10))) continue;
+        if(frame.body[1] != body[1] || frame.body[2] != body[2]) continue;
+        if(frame.body_len == len && memcmp(frame.body, body, len) == 0) return true;
+        seen = frame;
+    }
+    print_body("expected", body, len);
+    if(seen.body_len) print_body("cached", seen.body, seen.body_len);
+    return false;
+}
+
+static void publish(uint32_t* rng) {
+    sdrs_display_buf_t next = model.display;
+
+    // One to three fields at a time, like a track change with or without the channel
+    snprintf(next.song_disp, sizeof(next.song_disp), "%s", texts[rand_r(rng) % TEXTS]);
+    if(rand_r(rng) & 1) snprintf(next.artist_disp, sizeof(next.artist_disp), "%s", texts[rand_r(rng) % TEXTS]);
+    if(rand_r(rng) % 4 == 0) snprintf(next.chan_disp, sizeof(next.chan_disp), "%s", texts[rand_r(rng) % TEXTS]);
+    sdrs_display_publish(&next);
+    model.display = next;
+}
+
+static int run(uint32_t steps, uint32_t seed) {
+    kbus_message_t request = {.src = RAD, .dst = SDRS, .body = {SDRS_CTRL_REQ}, .body_len = 3};
+    uint8_t body[sizeof(request.body)], len;
+    uint32_t rng = seed, replies = 0, publishes = 0;
+
+    for(uint32_t i = 0; i < steps; i++) {
+        if(rand_r(&rng) % 4 == 0) {
+            publish(&rng);
+            publishes++;
+            continue;
+        }
+
+        request.body[1] = requests[rand_r(&rng) % sizeof(requests)];
+        request.body[2] = rand_r(&rng) % 7;     // Preset number; ignored by the rest
+        if(!baseline_reply(request.body[1], request.body[2], body, &len)) continue;
+
+        xQueueReset(sdrs_tx);
+        kbus_virtual_bus_inject(&request, portMAX_DELAY);
+        if(!expect_frame(body, len, REPLY_TIMEOUT_MS)) {
+            printf("FAIL step %u: 3D %02X %02X after %u publishes\n", i, request.body[1], request.body[2], publishes);
+            return 1;
+        }
+        replies++;
+    }
+
+    // Channel text a second after a heartbeat, from the cache as it is by then
+    request.body[1] = SDRS_HEARTBEAT;
+    baseline_reply(SDRS_HEARTBEAT, 0, body, &len);
+    xQueueReset(sdrs_tx);
+    kbus_virtual_bus_inject(&request, portMAX_DELAY);
+    encode(body, &len, SDRS_UPDATE_TXT, 0x00, model.channel, (model.bank << 4) | model.preset, 0x04, model.display.chan_disp);
+    if(!expect_frame(body, len, SDRS_TEXT_FOLLOWUP_MS + REPLY_TIMEOUT_MS)) {
+        printf("FAIL channel text follow-up\n");
+        return 1;
+    }
+
+    printf("%u replies matched the baseline encoding across %u publishes, channel 0x%02x bank %u preset %u\n",
+           replies, publishes, model.channel, model.bank, model.preset);
+    return 0;
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [-n steps] [-s seed] [-v]\n", argv0);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    uint32_t steps = 2000, seed = 1;
+    bool verbose = false;
+    int failures, opt;
+
+    while((opt = getopt(argc, argv, "n:s:v")) != -1) {
+        switch(opt) {
+            case 'n': steps = (uint32_t)atol(optarg); break;
+            case 's': seed = (uint32_t)atol(optarg); break;
+            case 'v': verbose = true; break;
+            default: usage(argv[0]);
+        }
+    }
+    if(optind != argc || steps == 0) usage(argv[0]);
+    if(!verbose) esp_log_level_set("*", ESP_LOG_WARN);
+
+    // As kbus_host starts it; bt_info_queue stays empty, so this is the display's only writer
+    sys_monitor_init();
+    bt_cmd_queue = SYS_QUEUE_CREATE("bt_cmd", 4, sizeof(bt_cmd_t));
+    bt_info_queue = SYS_QUEUE_CREATE("bt_info", 2, sizeof(bt_now_playing_info_t));
+    sdrs_tx = xQueueCreate(32, sizeof(kbus_message_t));
+    xTaskCreate(bt_cmd_task, "bt_cmd", 2048, NULL, 1, NULL);
+    kbus_virtual_bus_set_tx_hook(on_tx);
+    init_kbus_service(bt_cmd_queue, bt_info_queue);
+    sdrs_display_read(&model.display);
+    vTaskDelay(pdMS_TO_TICKS(STARTUP_MS));
+
+    failures = run(steps, seed);
+    if(failures) ESP_LOGE(TAG, "Cached reply differs from the baseline build");
+    printf("%s\n", failures ? "FAIL" : "PASS");
+    return failures ? 1 : 0;
+}
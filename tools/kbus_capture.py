@@ -0,0 +1,196 @@
+#!/usr/bin/env python3
+"""K-bus capture (.kbc) tool.
+
+Format matches components/kbus_service/include/kbus_capture.h:
+    header  b"KBC1" [version][3 reserved]
+    record  [uint32 LE us since previous record][src][dst][body_len][body...]
+
+Subcommands:
+    info      print the frames in a capture
+    from-dump pull a capture out of an `idf.py monitor` log (KBC-BEGIN/KBC-END block)
+    import    convert a text bus log (NavCoder session, blalor iPod_IBus_adapter logs) to a capture
+    to-c      emit a C header with the capture as a const array, for kbus_replay_start()
+"""
+import argparse
+import re
+import struct
+import sys
+
+import kbus_spec
+
+MAGIC = b"KBC1"
+VERSION = 1
+HDR_LEN = 8
+REC_HDR_LEN = 7
+
+# 9600 8E1; used to space frames from logs that carry no timestamps
+BITS_PER_BYTE = 11
+BAUD = 9600
+FRAME_OVERHEAD = 4
+
+
+def wire_us(body_len):
+    return (body_len + FRAME_OVERHEAD) * BITS_PER_BYTE * 1000000 // BAUD
+
+
+def write_capture(path, frames):
+    """frames: iterable of (t_us absolute, src, dst, body bytes)"""
+    out = bytearray(MAGIC + bytes([VERSION, 0, 0, 0]))
+    last = None
+    for t_us, src, dst, body in frames:
+        delta = 0 if last is None else max(0, t_us - last)
+        last = t_us
+        out += struct.pack("<IBBB", min(delta, 0xFFFFFFFF), src, dst, len(body)) + bytes(body)
+    with open(path, "wb") as f:
+        f.write(out)
+    return len(out)
+
+
+def read_capture(data):
+    if len(data) < HDR_LEN or data[:4] != MAGIC or data[4] != VERSION:
+        raise ValueError("not a v%d K-bus capture" % VERSION)
+    pos, t_us = HDR_LEN, 0
+    while pos + REC_HDR_LEN <= len(data):
+        delta, src, dst, body_len = struct.unpack_from("<IBBB", data, pos)
+        pos += REC_HDR_LEN
+        if pos + body_len > len(data):
+            raise ValueError("truncated record at offset %d" % (pos - REC_HDR_LEN))
+        t_us += delta
+        yield t_us, src, dst, data[pos:pos + body_len]
+        pos += body_len
+
+
+def parse_timestamp(token):
+    """HH:MM:SS(.fff), MM:SS(.fff), seconds with a fraction, or integer milliseconds."""
+    token = token.strip("[]()")
+    if ":" in token:
+        secs = 0.0
+        for part in token.split(":"):
+            secs = secs * 60 + float(part)
+        return int(secs * 1000000)
+    if re.fullmatch(r"\d+\.\d+", token):
+        return int(float(token) * 1000000)
+    if re.fullmatch(r"\d{3,}", token):
+        return int(token) * 1000
+    return None
+
+
+def scan_frames(octets):
+    """Find checksum-valid raw frames [src][len][dst][body...][chk] in a run of bytes."""
+    i = 0
+    while i + 4 <= len(octets):
+        length = octets[i + 1]
+        end = i + 2 + length
+        if length >= 2 and end <= len(octets):
+            chk = 0
+            for b in octets[i:end]:
+                chk ^= b
+            if chk == 0:
+                yield octets[i], octets[i + 2], bytes(octets[i + 3:end - 1])
+                i = end
+                continue
+        i += 1
+
+
+def import_log(lines):
+    hex_re = re.compile(r"^[0-9A-Fa-f]{2}$")
+    t_us = 0
+    for line in lines:
+        tokens = line.replace(",", " ").split()
+        stamp = None
+        octets = []
+        for tok in tokens:
+            if hex_re.match(tok):
+                octets.append(int(tok, 16))
+            elif stamp is None and not octets:
+                stamp = parse_timestamp(tok)
+        for src, dst, body in scan_frames(octets):
+            if stamp is not None:
+                t_us = max(t_us, stamp)
+                stamp = None    # Further frames on the same line follow back to back
+            yield t_us, src, dst, body
+            t_us += wire_us(len(body))
+
+
+def cmd_info(args):
+    with open(args.capture, "rb") as f:
+        frames = list(read_capture(f.read()))
+    spec = kbus_spec.load()
+    for t_us, src, dst, body in frames:
+        cmd = spec.cmd_name(body[0]) if body else ""
+        print("%12.6f  %-4s -> %-4s  %-16s %s" % (t_us / 1e6, spec.dev_name(src), spec.dev_name(dst), cmd,
+                                                body.hex(" ").upper()))
+    if frames:
+        span = frames[-1][0] - frames[0][0]
+        print("%d frames over %.3f s" % (len(frames), span / 1e6), file=sys.stderr)
+
+
+def cmd_from_dump(args):
+    data = bytearray()
+    inside = False
+    with open(args.log, errors="replace") as f:
+        for line in f:
+            line = line.strip()
+            if line.startswith("KBC-BEGIN"):
+                data, inside = bytearray(), True   # Last block in the log wins
+            elif line.startswith("KBC-END"):
+                inside = False
+            elif inside:
+                data += bytes.fromhex(line)
+    frames = list(read_capture(bytes(data)))
+    with open(args.output, "wb") as f:
+        f.write(data)
+    print("%d frames, %d bytes -> %s" % (len(frames), len(data), args.output))
+
+
+def cmd_import(args):
+    with open(args.log, errors="replace") as f:
+        frames = list(import_log(f))
+    size = write_capture(args.output, frames)
+    print("%d frames, %d bytes -> %s" % (len(frames), size, args.output))
+
+
+def cmd_to_c(args):
+    with open(args.capture, "rb") as f:
+        data = f.read()
+    count = sum(1 for _ in read_capture(data))
+    with open(args.output, "w") as f:
+        f.write("// Generated by tools/kbus_capture.py from %s, %d frames\n" % (args.capture, count))
+        f.write("#include <stdint.h>\n\n")
+        f.write("static const uint8_t %s[%d] = {\n" % (args.name, len(data)))
+        for i in range(0, len(data), 16):
+            f.write("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",\n")
+        f.write("};\n")
+    print("%d frames -> %s" % (count, args.output))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="cmd", required=True)
+
+    p = sub.add_parser("info")
+    p.add_argument("capture")
+    p.set_defaults(func=cmd_info)
+
+    p = sub.add_parser("from-dump")
+    p.add_argument("log")
+    p.add_argument("-o", "--output", required=True)
+    p.set_defaults(func=cmd_from_dump)
+
+    p = sub.add_parser("import")
+    p.add_argument("log")
+    p.add_argument("-o", "--output", required=True)
+    p.set_defaults(func=cmd_import)
+
+    p = sub.add_parser("to-c")
+    p.add_argument("capture")
+    p.add_argument("-o", "--output", required=True)
+    p.add_argument("--name", default="kbus_capture_data")
+    p.set_defaults(func=cmd_to_c)
+
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()
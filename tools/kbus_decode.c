@@ -0,0 +1,409 @@
+/**
+ ** Host side K-bus decoder. Builds against the generated kbus_tables.c, so device names,
+ ** command names, expected lengths and body layouts are the ones the firmware uses:
+ **
+ **   cc -O2 -Icomponents/kbus_service/include -o build/kbus_decode \
+ **       tools/kbus_decode.c components/kbus_service/kbus_tables.c
+ **
+ **   kbus_decode capture.kbc       .kbc capture (kbus_capture.py, CONFIG_KBUS_CAPTURE)
+ **   kbus_decode monitor.log       KBC-BEGIN/KBC-END blocks in an `idf.py monitor` log
+ **   kbus_decode -r /dev/ttyUSB0   raw bus bytes from a K-bus interface, "-" for stdin;
+ **                                 set the port up first: stty -F /dev/ttyUSB0 9600 cs8 parenb -parodd raw
+ **   -s                            counts per command and src -> dst pair instead of frames
+ **
+ ** Output is built by hand into one large buffer; printf per frame would be most of the cost.
+ */
+
+// C stdlib includes
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// component includes
+#include "kbus_defines.h"
+#include "kbus_tables.h"
+
+#define KBC_MAGIC "KBC1"
+#define KBC_VERSION 1
+#define KBC_HDR_LEN 8
+#define KBC_REC_HDR_LEN 7
+#define RAW_CHUNK (64 * 1024)
+#define OUT_FLUSH (1 << 20)
+#define LINE_MAX_LEN 2048   // Worst case line: 255 text bytes as \xHH plus names and fields
+
+typedef struct {
+    uint64_t frames;
+    uint64_t bad_len;       // Known command outside its spec'd length
+    uint64_t bad_chk;       // Raw input only, bytes skipped while resyncing
+    uint64_t cmd[256];
+    uint64_t cmd_bad_len[256];
+    uint32_t pair[256][256];
+} stats_t;
+
+static bool stats_only = false;
+static stats_t stats;
+static char out[OUT_FLUSH + LINE_MAX_LEN];
+static size_t out_len = 0;
+static const char hex_digits[] = "0123456789ABCDEF";
+
+static void out_flush() {
+    fwrite(out, 1, out_len, stdout);
+    out_len = 0;
+}
+
+static inline void put_str(const char* s) {
+    while(*s) out[out_len++] = *s++;
+}
+
+static inline void put_pad(const char* s, size_t width) {
+    size_t len = strlen(s);
+    memcpy(&out[out_len], s, len);
+    out_len += len;
+    while(len++ < width) out[out_len++] = ' ';
+}
+
+static inline void put_hex2(uint8_t b) {
+    out[out_len++] = hex_digits[b >> 4];
+    out[out_len++] = hex_digits[b & 0x0F];
+}
+
+static inline void put_dec(uint64_t v, int width, char pad) {
+    char tmp[20];
+    int n = 0;
+    do { tmp[n++] = '0' + v % 10; v /= 10; } while(v);
+    while(n < width--) out[out_len++] = pad;
+    while(n) out[out_len++] = tmp[--n];
+}
+
+static void put_dev(uint8_t addr) {
+    const char* name = kbus_dev_name(addr);
+    char hex[3] = {hex_digits[addr >> 4], hex_digits[addr & 0x0F], '\0'};
+    put_pad(name != NULL ? name : hex, 4);
+}
+
+static void put_fields(const kbus_cmd_info_t* info, const uint8_t* body, uint8_t len) {
+    uint8_t pos = 1;
+
+    for(uint8_t i = 0; i < info->n_fields; i++) {
+        const kbus_field_t* f = &info->fields[i];
+        if(pos >= len) break;
+        out[out_len++] = ' ';
+        put_str(f->name);
+        out[out_len++] = '=';
+
+        switch(f->type) {
+            case KBUS_FIELD_U8:
+                put_str("0x");
+                put_hex2(body[pos++]);
+                break;
+            case KBUS_FIELD_S8: {
+                int8_t v = (int8_t)body[pos++];
+                if(v < 0) out[out_len++] = '-';
+                put_dec(v < 0 ? -v : v, 0, ' ');
+                break;
+            }
+            case KBUS_FIELD_U16:
+                if(pos + 2 > len) { put_str("?"); pos = len; break; }
+                put_str("0x");
+                put_hex2(body[pos]);
+                put_hex2(body[pos + 1]);
+                pos += 2;
+                break;
+            case KBUS_FIELD_TEXT:
+                out[out_len++] = '"';
+                for(; pos < len; pos++) {
+                    uint8_t c = body[pos];
+                    if(c >= 0x20 && c < 0x7F && c != '"' && c != '\\') {
+                        out[out_len++] = c;
+                    } else {
+                        put_str("\\x");
+                        put_hex2(c);
+                    }
+                }
+                out[out_len++] = '"';
+                break;
+            case KBUS_FIELD_HEX:
+                for(; pos < len; pos++) put_hex2(body[pos]);
+                break;
+        }
+    }
+
+    if(pos < len) {
+        put_str(" +");
+        for(; pos < len; pos++) {
+            out[out_len++] = ' ';
+            put_hex2(body[pos]);
+        }
+    }
+}
+
+static void on_frame(uint64_t t_us, uint8_t src, uint8_t dst, const uint8_t* body, uint8_t len) {
+    bool len_ok = kbus_body_len_ok(body, len);
+
+    stats.frames++;
+    stats.pair[src][dst]++;
+    if(len) stats.cmd[body[0]]++;
+    if(!len_ok) {
+        stats.bad_len++;
+        if(len) stats.cmd_bad_len[body[0]]++;
+    }
+    if(stats_only) return;
+
+    put_dec(t_us / 1000000, 5, ' ');
+    out[out_len++] = '.';
+    put_dec(t_us % 1000000, 6, '0');
+    put_str("  ");
+    put_dev(src);
+    put_str(" -> ");
+    put_dev(dst);
+    put_str("  ");
+
+    if(len == 0) {
+        put_str("(empty)");
+    } else if(kbus_cmds[body[0]].name != NULL) {
+        put_pad(kbus_cmds[body[0]].name, 18);
+        put_fields(&kbus_cmds[body[0]], body, len);
+    } else {
+        for(uint8_t i = 0; i < len; i++) {
+            if(i) out[out_len++] = ' ';
+            put_hex2(body[i]);
+        }
+    }
+    if(!len_ok) put_str("  !len");
+    out[out_len++] = '\n';
+
+    if(out_len >= OUT_FLUSH) out_flush();
+}
+
+/**
+ ** [uint32 LE us since previous record][src][dst][body_len][body...], after an 8 byte header
+ */
+static int decode_capture(const uint8_t* data, size_t len) {
+    uint64_t t_us = 0;
+    size_t pos = KBC_HDR_LEN;
+
+    if(len < KBC_HDR_LEN || memcmp(data, KBC_MAGIC, 4) != 0 || data[4] != KBC_VERSION) {
+        fprintf(stderr, "not a v%d K-bus capture\n", KBC_VERSION);
+        return 1;
+    }
+    while(pos + KBC_REC_HDR_LEN <= len) {
+        const uint8_t* rec = &data[pos];
+        uint8_t body_len = rec[6];
+        if(pos + KBC_REC_HDR_LEN + body_len > len) {
+            fprintf(stderr, "truncated record at offset %zu\n", pos);
+            return 1;
+        }
+        t_us += rec[0] | rec[1] << 8 | rec[2] << 16 | (uint32_t)rec[3] << 24;
+        on_frame(t_us, rec[4], rec[5], &rec[KBC_REC_HDR_LEN], body_len);
+        pos += KBC_REC_HDR_LEN + body_len;
+    }
+    return 0;
+}
+
+static int hex_val(char c) {
+    if(c >= '0' && c <= '9') return c - '0';
+    if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/**
+ ** Pulls the last KBC-BEGIN/KBC-END block out of a monitor log, same as kbus_capture.py from-dump
+ */
+static int decode_dump(const uint8_t* text, size_t len) {
+    uint8_t* data = malloc(len / 2 + 1);
+    size_t data_len = 0;
+    bool inside = false, found = false;
+    const char* p = (const char*)text;
+    const char* end = p + len;
+    int ret;
+
+    while(p < end) {
+        const char* eol = memchr(p, '\n', end - p);
+        if(eol == NULL) eol = end;
+        while(p < eol && (*p == ' ' || *p == '\t')) p++;
+
+        if(eol - p >= 9 && memcmp(p, "KBC-BEGIN", 9) == 0) {
+            inside = found = true;
+            data_len = 0;   // Last block in the log wins
+        } else if(eol - p >= 7 && memcmp(p, "KBC-END", 7) == 0) {
+            inside = false;
+        } else if(inside) {
+            for(; p + 1 < eol; p += 2) {
+                int hi = hex_val(p[0]), lo = hex_val(p[1]);
+                if(hi < 0 || lo < 0) break;
+                data[data_len++] = hi << 4 | lo;
+            }
+        }
+        p = eol + 1;
+    }
+
+    if(!found) {
+        fprintf(stderr, "no KBC-BEGIN block; raw bus bytes need -r\n");
+        free(data);
+        return 1;
+    }
+    ret = decode_capture(data, data_len);
+    free(data);
+    return ret;
+}
+
+static uint64_t now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ ** [src][len][dst][body...][chk] with len counting dst through chk and an XOR checksum of
+ ** zero over the frame; resyncs a byte at a time. Frames from a live port are stamped with
+ ** the host clock, from a file by their time on the wire.
+ */
+static int decode_raw(int fd, bool live) {
+    static uint8_t buf[RAW_CHUNK + 260];
+    size_t have = 0;
+    bool eof = false;
+    uint64_t t_us = 0, start = now_us();
+
+    while(!eof) {
+        ssize_t n = read(fd, &buf[have], RAW_CHUNK);
+        size_t i = 0;
+
+        if(n > 0) have += n;
+        else eof = true;
+
+        while(i + 4 <= have) {
+            uint8_t frame_len = buf[i + 1];
+            size_t end = i + 2 + frame_len;
+            uint8_t chk = 0;
+
+            if(frame_len < 2) { i++; stats.bad_chk++; continue; }
+            if(end > have) {
+                if(!eof) break;     // Rest arrives with the next read
+                i++;                // Never will; it was noise
+                stats.bad_chk++;
+                continue;
+            }
+            for(size_t j = i; j < end; j++) chk ^= buf[j];
+            if(chk != 0) { i++; stats.bad_chk++; continue; }
+
+            if(live) t_us = now_us() - start;
+            on_frame(t_us, buf[i], buf[i + 2], &buf[i + 3], frame_len - 2);
+            if(!live) t_us += KBUS_WIRE_US(frame_len - 2);
+            i = end;
+        }
+
+        memmove(buf, &buf[i], have - i);
+        have -= i;
+        if(live) out_flush();
+    }
+    return 0;
+}
+
+static uint8_t* read_all(FILE* f, size_t* len) {
+    size_t cap = 1 << 20;
+    uint8_t* data = malloc(cap);
+    size_t n;
+
+    *len = 0;
+    while((n = fread(&data[*len], 1, cap - *len, f)) > 0) {
+        *len += n;
+        if(*len == cap) data = realloc(data, cap *= 2);
+    }
+    return data;
+}
+
+static int cmp_desc(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a >> 16, y = *(const uint64_t*)b >> 16;
+    return x < y ? 1 : (x > y ? -1 : 0);
+}
+
+static void print_stats(double secs) {
+    static uint64_t pairs[256 * 256];
+    size_t n_pairs = 0;
+
+    printf("%-20s %10s %8s\n", "command", "frames", "bad len");
+    for(int c = 0; c < 256; c++) {
+        if(stats.cmd[c] == 0) continue;
+        if(kbus_cmds[c].name != NULL) {
+            printf("%-20s %10llu %8llu\n", kbus_cmds[c].name,
+                   (unsigned long long)stats.cmd[c], (unsigned long long)stats.cmd_bad_len[c]);
+        } else {
+            printf("0x%02X %15s %10llu %8s\n", c, "", (unsigned long long)stats.cmd[c], "-");
+        }
+    }
+
+    // Count in the high bits, pair in the low 16, so one sort orders both
+    for(int s = 0; s < 256; s++) {
+        for(int d = 0; d < 256; d++) {
+            if(stats.pair[s][d]) pairs[n_pairs++] = (uint64_t)stats.pair[s][d] << 16 | s << 8 | d;
+        }
+    }
+    qsort(pairs, n_pairs, sizeof(pairs[0]), cmp_desc);
+    printf("\n%-14s %10s\n", "src -> dst", "frames");
+    for(size_t i = 0; i < n_pairs; i++) {
+        uint8_t s = pairs[i] >> 8, d = pairs[i];
+        char src[5], dst[5];
+        snprintf(src, sizeof(src), "%s", kbus_dev_name(s) ? kbus_dev_name(s) : "");
+        snprintf(dst, sizeof(dst), "%s", kbus_dev_name(d) ? kbus_dev_name(d) : "");
+        if(!src[0]) snprintf(src, sizeof(src), "%02X", s);
+        if(!dst[0]) snprintf(dst, sizeof(dst), "%02X", d);
+        printf("%-4s -> %-4s   %10llu\n", src, dst, (unsigned long long)(pairs[i] >> 16));
+    }
+
+    fprintf(stderr, "%llu frames, %llu outside spec'd length, %llu bytes skipped resyncing; %.2f M frames/s\n",
+            (unsigned long long)stats.frames, (unsigned long long)stats.bad_len,
+            (unsigned long long)stats.bad_chk, secs > 0 ? stats.frames / secs / 1e6 : 0.0);
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [-s] capture.kbc | monitor.log | -r raw_bytes|-\n", argv0);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    bool raw = false;
+    const char* path = NULL;
+    FILE* f;
+    struct stat st;
+    uint64_t start;
+    int ret, opt;
+
+    while((opt = getopt(argc, argv, "rs")) != -1) {
+        switch(opt) {
+            case 'r': raw = true; break;
+            case 's': stats_only = true; break;
+            default: usage(argv[0]);
+        }
+    }
+    if(optind != argc - 1) usage(argv[0]);
+    path = argv[optind];
+
+    f = strcmp(path, "-") == 0 ? stdin : fopen(path, "rb");
+    if(f == NULL) {
+        perror(path);
+        return 1;
+    }
+
+    start = now_us();
+    if(raw) {
+        bool live = fstat(fileno(f), &st) == 0 && S_ISCHR(st.st_mode);
+        ret = decode_raw(fileno(f), live);
+    } else {
+        size_t len;
+        uint8_t* data = read_all(f, &len);
+        bool capture = len >= 4 && memcmp(data, KBC_MAGIC, 4) == 0;
+        ret = capture ? decode_capture(data, len) : decode_dump(data, len);
+        free(data);
+    }
+    out_flush();
+
+    if(stats_only) print_stats((now_us() - start) / 1e6);
+    if(f != stdin) fclose(f);
+    return ret;
+}
@@ -0,0 +1,282 @@
+/**
+ ** Host side check of the steering wheel decoder (kbus_mfl.c): its transition table and
+ ** run_event() built from the same source as the firmware, against the FreeRTOS/ESP_LOG shim
+ ** headers from tools/host and a simulated tick:
+ **
+ **   cc -O2 -Itools/host/include -Icomponents/common -Icomponents/meta_arena/include \
+ **       -Icomponents/kbus_service/include -Icomponents/sys_monitor/include -o build/kbus_mfl_check \
+ **       tools/kbus_mfl_check.c components/kbus_service/kbus_mfl.c tools/host/esp_shim.c
+ **
+ **   add -DCONFIG_KBUS_MFL_TIMING -DCONFIG_KBUS_MFL_LONG_PRESS_MS=500 -DCONFIG_KBUS_MFL_DOUBLE_PRESS_MS=300
+ **   for the tick timed decoder (long presses from time, double presses)
+ **
+ **   kbus_mfl_check            runs the button scenarios and the latency check
+ **   -n COUNT                  presses timed, default 200000
+ **   -b US                     p99 budget per press in us, default 20
+ **
+ ** Scenarios are frames from the MFL at given ticks; between frames the clock advances the way
+ ** kbus_dispatch_task sleeps, waking when kbus_mfl_poll() says a timer is due. Every AVRCP
+ ** command and the tick it went out on is compared with what's expected. Latency is
+ ** kbus_mfl_feed() entry to the command callback, for taps and held search. malloc and friends
+ ** are counted (glibc) while the decoder runs and must stay at zero. Exits 1 if anything fails.
+ */
+
+// C stdlib includes
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// FreeRTOS includes
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// component includes
+#include "kbus_uart_driver.h"
+#include "kbus_defines.h"
+#include "kbus_mfl.h"
+
+#define MAX_FRAMES      6
+#define MAX_COMMANDS    4
+#define NONE            BT_CMD_NOOP
+
+typedef struct {
+    uint32_t at;            // ms since the scenario started
+    uint8_t cmd;            // MFL_BUTTON or VOLUME_CTRL
+    uint8_t code;
+} frame_t;
+
+typedef struct {
+    uint32_t at;
+    bt_cmd_type_t command;
+} command_t;
+
+typedef struct {
+    const char* name;
+    frame_t frames[MAX_FRAMES];
+    command_t expect[MAX_COMMANDS];
+} scenario_t;
+
+static const scenario_t scenarios[] = {
+    {"tap up",              {{0, MFL_BUTTON, 0x01}, {100, MFL_BUTTON, 0x21}},
+                            {{100, AVRCP_NEXT}}},
+    {"tap down",            {{0, MFL_BUTTON, 0x08}, {120, MFL_BUTTON, 0x28}},
+                            {{120, AVRCP_PREV}}},
+    {"hold up, MFL long",   {{0, MFL_BUTTON, 0x01}, {400, MFL_BUTTON, 0x11}, {700, MFL_BUTTON, 0x11}, {900, MFL_BUTTON, 0x21}},
+                            {{400, AVRCP_FF_START}, {900, AVRCP_FF_STOP}}},
+    {"hold down, MFL long", {{0, MFL_BUTTON, 0x08}, {400, MFL_BUTTON, 0x18}, {800, MFL_BUTTON, 0x28}},
+                            {{400, AVRCP_RWD_START}, {800, AVRCP_RWD_STOP}}},
+    {"long without press",  {{0, MFL_BUTTON, 0x11}, {300, MFL_BUTTON, 0x21}},
+                            {{0, AVRCP_FF_START}, {300, AVRCP_FF_STOP}}},
+    {"release only",        {{0, MFL_BUTTON, 0x21}},
+                            {{0, NONE}}},
+    {"r/t and volume",      {{0, MFL_BUTTON, 0x40}, {100, MFL_BUTTON, 0x60}, {200, VOLUME_CTRL, 0x11}, {300, VOLUME_CTRL, 0x10}},
+                            {{0, NONE}}},
+    {"unknown",             {{0, MFL_BUTTON, 0x02}, {100, MFL_BUTTON, 0x31}, {200, 0x01, 0x00}},
+                            {{0, NONE}}},
+#ifdef CONFIG_KBUS_MFL_TIMING
+    {"hold up, timed",      {{0, MFL_BUTTON, 0x01}, {600, MFL_BUTTON, 0x11}, {900, MFL_BUTTON, 0x21}},
+                            {{CONFIG_KBUS_MFL_LONG_PRESS_MS, AVRCP_FF_START}, {900, AVRCP_FF_STOP}}},
+    {"voice tap",           {{0, MFL_BUTTON, 0x80}, {100, MFL_BUTTON, 0xA0}},
+                            {{100 + CONFIG_KBUS_MFL_DOUBLE_PRESS_MS, AVRCP_STOP}}},
+    {"voice double",        {{0, MFL_BUTTON, 0x80}, {100, MFL_BUTTON, 0xA0}, {200, MFL_BUTTON, 0x80}, {300, MFL_BUTTON, 0xA0}},
+                            {{300, AVRCP_PAUSE}}},
+    {"voice tap then hold", {{0, MFL_BUTTON, 0x80}, {100, MFL_BUTTON, 0xA0}, {200, MFL_BUTTON, 0x80}, {1000, MFL_BUTTON, 0xA0}},
+                            {{200 + CONFIG_KBUS_MFL_LONG_PRESS_MS, AVRCP_PLAY}}},
+    {"voice hold",          {{0, MFL_BUTTON, 0x80}, {800, MFL_BUTTON, 0xA0}},
+                            {{CONFIG_KBUS_MFL_LONG_PRESS_MS, AVRCP_PLAY}}},
+#else
+    {"voice tap",           {{0, MFL_BUTTON, 0x80}, {100, MFL_BUTTON, 0xA0}},
+                            {{100, AVRCP_STOP}}},
+    {"voice hold",          {{0, MFL_BUTTON, 0x80}, {400, MFL_BUTTON, 0x90}, {800, MFL_BUTTON, 0xA0}},
+                            {{400, AVRCP_PLAY}}},
+#endif
+};
+
+// Simulated tick; the decoder's only clock
+static TickType_t now_ticks = 1;
+
+TickType_t xTaskGetTickCount() {
+    return now_ticks;
+}
+
+int64_t esp_timer_get_time() {
+    return (int64_t)now_ticks * portTICK_PERIOD_MS * 1000;
+}
+
+// Allocation counting; the decoder promises no heap
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t n, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+static bool counting = false;
+static uint32_t allocations = 0;
+
+void* malloc(size_t size) {
+    if(counting) allocations++;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) {
+    if(counting) allocations++;
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    if(counting) allocations++;
+    return __libc_realloc(ptr, size);
+}
+
+static command_t got[MAX_COMMANDS * 2];
+static size_t ngot;
+static uint64_t cmd_ns;
+
+static inline uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void on_command(bt_cmd_type_t command) {
+    cmd_ns = now_ns();
+    if(ngot < sizeof(got) / sizeof(got[0])) got[ngot++] = (command_t){now_ticks * portTICK_PERIOD_MS, command};
+}
+
+static void feed(uint8_t cmd, uint8_t code) {
+    kbus_message_t message = {.src = MFL, .dst = RAD, .body = {cmd, code}, .body_len = 2};
+
+    counting = true;
+    kbus_mfl_feed(&message);
+    counting = false;
+}
+
+// kbus_dispatch_task's sleep: wake on each timer the decoder asks for until the next frame is due
+static void advance_to(TickType_t target) {
+    TickType_t wait;
+
+    while(1) {
+        counting = true;
+        wait = kbus_mfl_poll();
+        counting = false;
+        if(wait == portMAX_DELAY || (int32_t)(now_ticks + wait - target) >= 0) break;
+        now_ticks += wait ? wait : 1;
+    }
+    now_ticks = target;
+}
+
+static int run_scenario(const scenario_t* scenario) {
+    TickType_t start;
+    size_t nexpect = 0;
+    bool ok;
+
+    kbus_mfl_init(on_command);
+    ngot = 0;
+    start = now_ticks;
+    for(size_t f = 0; f < MAX_FRAMES && scenario->frames[f].cmd != 0; f++) {
+        advance_to(start + pdMS_TO_TICKS(scenario->frames[f].at));
+        feed(scenario->frames[f].cmd, scenario->frames[f].code);
+    }
+    advance_to(now_ticks + pdMS_TO_TICKS(2000));    // Anything still timed
+
+    while(nexpect < MAX_COMMANDS && scenario->expect[nexpect].command != NONE) nexpect++;
+    ok = ngot == nexpect;
+    for(size_t c = 0; ok && c < ngot; c++) {
+        ok = got[c].command == scenario->expect[c].command && got[c].at - start * portTICK_PERIOD_MS == scenario->expect[c].at;
+    }
+    if(!ok) {
+        printf("FAIL %s:", scenario->name);
+        for(size_t c = 0; c < ngot; c++) printf(" %d@%u", got[c].command, (unsigned)(got[c].at - start * portTICK_PERIOD_MS));
+        printf(", expected");
+        for(size_t c = 0; c < nexpect; c++) printf(" %d@%u", scenario->expect[c].command, scenario->expect[c].at);
+        printf("\n");
+    }
+    now_ticks += pdMS_TO_TICKS(5000);   // Idle between scenarios
+    return ok ? 0 : 1;
+}
+
+static int cmp_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Alternates a tap of >> (command on release) and a held << (command on the MFL's long frame)
+static int run_latency(uint32_t count, double budget_us) {
+    static const uint8_t codes[5] = {0x01, 0x21, 0x08, 0x18, 0x28};
+    static const bool emits[5] = {false, true, false, true, true};
+    uint32_t* samples = malloc(count * sizeof(uint32_t));
+    uint32_t n = 0;
+    uint64_t start, total = 0;
+    double p50, p99, max;
+
+    if(samples == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    kbus_mfl_init(on_command);
+    for(uint32_t i = 0; n < count; i++) {
+        ngot = 0;
+        now_ticks++;
+        start = now_ns();
+        feed(MFL_BUTTON, codes[i % 5]);
+        if(!emits[i % 5]) continue;
+        if(ngot != 1) {
+            printf("FAIL latency: frame 0x%02x gave %u commands\n", codes[i % 5], (unsigned)ngot);
+            free(samples);
+            return 1;
+        }
+        samples[n] = (uint32_t)(cmd_ns - start);
+        total += samples[n++];
+    }
+
+    qsort(samples, count, sizeof(samples[0]), cmp_u32);
+    p50 = samples[count / 2] / 1e3;
+    p99 = samples[(uint64_t)count * 99 / 100] / 1e3;
+    max = samples[count - 1] / 1e3;
+    printf("latency: n=%u mean=%.3f p50=%.3f p99=%.3f max=%.3f us press to command, budget p99 %.1f us\n",
+           count, total / 1e3 / count, p50, p99, max, budget_us);
+    free(samples);
+    return p99 > budget_us;
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [-n count] [-b p99_budget_us]\n", argv0);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    uint32_t count = 200000;
+    double budget_us = 20;
+    kbus_mfl_stats_t stats;
+    int failures = 0, opt;
+
+    while((opt = getopt(argc, argv, "n:b:")) != -1) {
+        switch(opt) {
+            case 'n': count = (uint32_t)atol(optarg); break;
+            case 'b': budget_us = atof(optarg); break;
+            default: usage(argv[0]);
+        }
+    }
+    if(optind != argc || count == 0) usage(argv[0]);
+
+    for(size_t s = 0; s < sizeof(scenarios) / sizeof(scenarios[0]); s++) failures += run_scenario(&scenarios[s]);
+    printf("scenarios: %zu, %d failed (%s)\n", sizeof(scenarios) / sizeof(scenarios[0]), failures,
+#ifdef CONFIG_KBUS_MFL_TIMING
+           "tick timed"
+#else
+           "MFL long frames"
+#endif
+           );
+    failures += run_latency(count, budget_us);
+
+    kbus_mfl_get_stats(&stats);
+    printf("decoder: %u events, %u commands, %u ignored, %u synthesized long presses, %u allocations\n",
+           stats.events, stats.commands, stats.ignored, stats.synthesized, allocations);
+    if(allocations) {
+        printf("FAIL decoder allocated\n");
+        failures++;
+    }
+    printf("%s\n", failures ? "FAIL" : "PASS");
+    return failures ? 1 : 0;
+}
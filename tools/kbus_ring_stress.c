@@ -0,0 +1,156 @@
+/**
+ ** Two thread stress test of the rx ring (kbus_ring.h), built from the same source as the firmware:
+ **
+ **   cc -O2 -pthread -Icomponents/kbus_service/include -o build/kbus_ring_stress \
+ **       tools/kbus_ring_stress.c components/kbus_service/kbus_ring.c
+ **
+ **   kbus_ring_stress          one producer and one consumer thread, as kbus_rx_task and kbus_dispatch_task
+ **   -n FRAMES                 frames through the ring, default 2000000
+ **   -s BYTES                  ring size, power of two, default 128 so it wraps every few frames
+ **
+ ** The producer pushes a sequence number header and a 0-32 byte body derived from it, spinning
+ ** while the ring is full. It alternates gathering with kbus_ring_push2() and filling a
+ ** kbus_ring_reserve() of the largest frame in place, as kbus_rx_task does, so reservations
+ ** that don't fit before the end of the ring leave padding for the consumer to skip. The consumer
+ ** alternates kbus_ring_pop() and kbus_ring_pop2() and checks every frame arrives once, in
+ ** order, whole and with the right length; a torn or reordered frame shows up as a wrong
+ ** byte or sequence number. Exits 1 on the first bad frame.
+ */
+
+// C stdlib includes
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// component includes
+#include "kbus_ring.h"
+
+#define SEQ_LEN     4
+#define BODY_MAX    32
+
+static kbus_ring_t ring;
+static uint32_t nframes = 2000000;
+static uint32_t full_spins;
+
+static inline uint8_t body_len(uint32_t seq) {
+    return seq % (BODY_MAX + 1);
+}
+
+static inline uint8_t body_byte(uint32_t seq, uint8_t i) {
+    return (uint8_t)((seq + i) * 31 + (seq >> 8));
+}
+
+static void* producer(void* arg) {
+    uint8_t hdr[SEQ_LEN], body[BODY_MAX];
+    uint8_t* slot;
+    (void)arg;
+
+    for(uint32_t seq = 0; seq < nframes; seq++) {
+        hdr[0] = seq & 0xFF;
+        hdr[1] = (seq >> 8) & 0xFF;
+        hdr[2] = (seq >> 16) & 0xFF;
+        hdr[3] = seq >> 24;
+        for(uint8_t i = 0; i < body_len(seq); i++) body[i] = body_byte(seq, i);
+
+        if(seq & 2) {
+            while((slot = kbus_ring_reserve(&ring, SEQ_LEN + BODY_MAX)) == NULL) {
+                full_spins++;
+                sched_yield();
+            }
+            memcpy(slot, hdr, SEQ_LEN);
+            memcpy(&slot[SEQ_LEN], body, body_len(seq));
+            kbus_ring_commit(&ring, SEQ_LEN + body_len(seq));
+            continue;
+        }
+        while(!kbus_ring_push2(&ring, hdr, SEQ_LEN, body, body_len(seq))) {
+            full_spins++;
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+// Returns how many frames checked out before the first bad one, nframes if none was
+static uint32_t consume() {
+    uint8_t frame[SEQ_LEN + BODY_MAX], hdr[SEQ_LEN];
+    const uint8_t* body;
+    uint16_t len;
+    uint32_t got;
+
+    for(uint32_t seq = 0; seq < nframes; seq++) {
+        do {
+            if(seq & 1) {
+                len = kbus_ring_pop2(&ring, hdr, SEQ_LEN, &frame[SEQ_LEN], BODY_MAX);
+                if(len) memcpy(frame, hdr, SEQ_LEN);
+            } else {
+                len = kbus_ring_pop(&ring, frame, sizeof(frame));
+            }
+            if(len == 0) sched_yield();
+        } while(len == 0);
+
+        got = frame[0] | frame[1] << 8 | frame[2] << 16 | (uint32_t)frame[3] << 24;
+        if(got != seq || len != SEQ_LEN + body_len(seq)) {
+            printf("FAIL frame %u: got sequence %u, %u bytes, expected %u bytes\n", seq, got, len, SEQ_LEN + body_len(seq));
+            return seq;
+        }
+        body = &frame[SEQ_LEN];
+        for(uint8_t i = 0; i < body_len(seq); i++) {
+            if(body[i] == body_byte(seq, i)) continue;
+            printf("FAIL frame %u: byte %u is 0x%02x, expected 0x%02x\n", seq, i, body[i], body_byte(seq, i));
+            return seq;
+        }
+    }
+    return nframes;
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [-n frames] [-s ring_bytes]\n", argv0);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    uint8_t* storage;
+    uint32_t size = 128, checked;
+    struct timespec start, end;
+    pthread_t thread;
+    double elapsed;
+    int opt;
+
+    while((opt = getopt(argc, argv, "n:s:")) != -1) {
+        switch(opt) {
+            case 'n': nframes = (uint32_t)atol(optarg); break;
+            case 's': size = (uint32_t)atol(optarg); break;
+            default: usage(argv[0]);
+        }
+    }
+    if(optind != argc || nframes == 0) usage(argv[0]);
+
+    storage = malloc(size);
+    if(storage == NULL || !kbus_ring_init(&ring, storage, size) || size < 2 * (KBUS_RING_HDR_LEN + SEQ_LEN + BODY_MAX)) {
+        fprintf(stderr, "ring size must be a power of two of at least %d bytes\n", 2 * (KBUS_RING_HDR_LEN + SEQ_LEN + BODY_MAX));
+        return 2;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if(pthread_create(&thread, NULL, producer, NULL) != 0) {
+        perror("pthread_create");
+        return 1;
+    }
+    checked = consume();
+    if(checked != nframes) return 1;    // Producer is left spinning on a full ring
+    pthread_join(thread, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("%u frames through a %u byte ring in %.2f s, %.1f M frames/s, producer found it full %u times\n",
+           nframes, size, elapsed, nframes / elapsed / 1e6, full_spins);
+    printf("PASS\n");
+    free(storage);
+    return 0;
+}
@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+"""K-bus protocol spec (components/kbus_service/kbus_spec.json) tool.
+
+Subcommands:
+    gen     regenerate include/kbus_defines.h and kbus_tables.c from the spec; --check only
+            reports whether the checked in files are stale
+    dump    print the device and command tables
+
+Also imported by the other tools for names: load() returns a Spec with dev_name() and cmd_name().
+"""
+import argparse
+import json
+import os
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+COMPONENT = os.path.join(ROOT, "components", "kbus_service")
+SPEC_PATH = os.path.join(COMPONENT, "kbus_spec.json")
+DEFINES_PATH = os.path.join(COMPONENT, "include", "kbus_defines.h")
+TABLES_PATH = os.path.join(COMPONENT, "kbus_tables.c")
+
+FIELD_TYPES = {"u8": ("KBUS_FIELD_U8", 1), "s8": ("KBUS_FIELD_S8", 1), "u16": ("KBUS_FIELD_U16", 2),
+               "text": ("KBUS_FIELD_TEXT", None), "hex": ("KBUS_FIELD_HEX", None)}
+BANNER = "// Generated by tools/kbus_spec.py from kbus_spec.json; edit the spec, not this file\n"
+
+
+class Spec:
+    def __init__(self, raw):
+        self.bus = raw["bus"]
+        self.dev_groups = [[dict(d, addr=int(d["addr"], 16)) for d in group] for group in raw["devices"]]
+        self.devices = [d for group in self.dev_groups for d in group]
+        self.groups = []
+        for group in raw["command_groups"]:
+            cmds = [dict(c, id=int(c["id"], 16)) for c in group["commands"]]
+            self.groups.append((group["group"], cmds))
+        self.commands = [c for _, cmds in self.groups for c in cmds]
+        self.devs_by_addr = {d["addr"]: d for d in self.devices}
+        self.cmds_by_id = {c["id"]: c for c in self.commands}
+        self.validate()
+
+    def validate(self):
+        for kind, items, key in (("device", self.devices, "addr"), ("command", self.commands, "id")):
+            seen, names = {}, set()
+            for item in items:
+                if item[key] in seen:
+                    raise ValueError("%s 0x%02X is both %s and %s; make one an alias"
+                                     % (kind, item[key], seen[item[key]], item["name"]))
+                seen[item[key]] = item["name"]
+                for name in [item["name"]] + item.get("aliases", []):
+                    if name in names:
+                        raise ValueError("%s name %s used twice" % (kind, name))
+                    names.add(name)
+        for cmd in self.commands:
+            lo, hi = self.cmd_len(cmd)
+            if not 1 <= lo <= hi <= 0xFF:
+                raise ValueError("%s: bad len %r" % (cmd["name"], cmd.get("len")))
+            fixed = 1
+            for n, (fname, ftype) in enumerate(cmd.get("fields", [])):
+                if ftype not in FIELD_TYPES:
+                    raise ValueError("%s.%s: unknown field type %s" % (cmd["name"], fname, ftype))
+                width = FIELD_TYPES[ftype][1]
+                if width is None and n != len(cmd["fields"]) - 1:
+                    raise ValueError("%s.%s: %s must be the last field" % (cmd["name"], fname, ftype))
+                fixed += width or 0
+            if fixed > hi:
+                raise ValueError("%s: fields need %d bytes, len allows %d" % (cmd["name"], fixed, hi))
+
+    @staticmethod
+    def cmd_len(cmd):
+        spec = cmd.get("len", [1, None])
+        if isinstance(spec, int):
+            return spec, spec
+        return spec[0], 0xFF if spec[1] is None else spec[1]
+
+    def dev_name(self, addr):
+        dev = self.devs_by_addr.get(addr)
+        return dev["name"] if dev else "%02X" % addr
+
+    def cmd_name(self, cmd):
+        info = self.cmds_by_id.get(cmd)
+        return info["name"] if info else "%02X" % cmd
+
+
+def load(path=SPEC_PATH):
+    with open(path) as f:
+        return Spec(json.load(f))
+
+
+def comment(text):
+    return "    //%s" % text if text else ""
+
+
+def gen_defines(spec):
+    bus = spec.bus
+    out = ["#ifndef KBUS_DEFINES_H", "#define KBUS_DEFINES_H", BANNER.rstrip("\n"), "",
+           "/**",
+           " ** kbus bus timing; %d baud, 8 data bits, even parity, 1 stop bit" % bus["baud"],
+           " ** Frame on the wire is [src][len][dst][body...][chk], len counting dst through chk",
+           " */",
+           "#define KBUS_BAUD           %d" % bus["baud"],
+           "#define KBUS_BITS_PER_BYTE  %d" % bus["bits_per_byte"],
+           "#define KBUS_FRAME_OVERHEAD %d       // src, len, dst, checksum" % bus["frame_overhead"],
+           "#define KBUS_WIRE_US(body_len) ((((body_len) + KBUS_FRAME_OVERHEAD) * KBUS_BITS_PER_BYTE * 1000000UL) / KBUS_BAUD)",
+           "", "/**", " ** kbus device definitions from",
+           " ** http://web.archive.org/web/20110318185825/http://ibus.stuge.se/IBus_Devices", " */"]
+
+    for n, group in enumerate(spec.dev_groups):
+        if n:
+            out.append("")
+        for dev in group:
+            out.append(("#define %-7s 0x%02X" % (dev["name"], dev["addr"])) + comment(dev["desc"]))
+            for alias in dev.get("aliases", []):
+                out.append("#define %-7s %-4s    //Alias, same address" % (alias, dev["name"]))
+
+    out += ["", "/**", " ** kbus command definitions, first body byte, from",
+            " ** http://web.archive.org/web/20110318185808/http://ibus.stuge.se/IBus_Messages",
+            " ** AND", " ** Testing w/NavCoder", " */"]
+    for group, cmds in spec.groups:
+        out += ["", "// " + group]
+        for cmd in cmds:
+            out.append(("#define %-19s 0x%02X" % (cmd["name"], cmd["id"])) + comment(cmd["desc"]))
+            for alias in cmd.get("aliases", []):
+                out.append("#define %-19s %s    //Alias, same command" % (alias, cmd["name"]))
+
+    out += ["", "#endif //KBUS_DEFINES_H", ""]
+    return "\n".join(out)
+
+
+def gen_tables(spec):
+    out = [BANNER.rstrip("\n"), '#include <stddef.h>', '#include "kbus_tables.h"', ""]
+
+    for cmd in spec.commands:
+        if cmd.get("fields"):
+            fields = ", ".join('{"%s", %s}' % (n, FIELD_TYPES[t][0]) for n, t in cmd["fields"])
+            out.append("static const kbus_field_t %s_fields[] = {%s};" % (cmd["name"].lower(), fields))
+    out.append("")
+
+    out.append("const char* const kbus_dev_names[256] = {")
+    for dev in sorted(spec.devices, key=lambda d: d["addr"]):
+        out.append('    [0x%02X] = "%s",' % (dev["addr"], dev["name"]))
+    out += ["};", ""]
+
+    out.append("const kbus_cmd_info_t kbus_cmds[256] = {")
+    for cmd in sorted(spec.commands, key=lambda c: c["id"]):
+        lo, hi = spec.cmd_len(cmd)
+        fields = cmd.get("fields", [])
+        out.append('    [0x%02X] = {"%s", %d, %d, %d, %s},' % (
+            cmd["id"], cmd["name"], lo, hi, len(fields), "%s_fields" % cmd["name"].lower() if fields else "NULL"))
+    out += ["};", ""]
+    return "\n".join(out)
+
+
+def cmd_gen(args):
+    spec = load(args.spec)
+    stale = []
+    for path, text in ((DEFINES_PATH, gen_defines(spec)), (TABLES_PATH, gen_tables(spec))):
+        try:
+            with open(path, newline="") as f:
+                current = f.read()
+        except FileNotFoundError:
+            current = None
+        if current == text:
+            continue
+        stale.append(os.path.relpath(path, ROOT))
+        if not args.check:
+            with open(path, "w", newline="") as f:
+                f.write(text)
+    if args.check and stale:
+        sys.exit("stale, run tools/kbus_spec.py gen: " + ", ".join(stale))
+    print("updated " + ", ".join(stale) if stale else "up to date")
+
+
+def cmd_dump(args):
+    spec = load(args.spec)
+    for dev in spec.devices:
+        print("dev 0x%02X %-6s %s" % (dev["addr"], dev["name"], dev["desc"]))
+    for cmd in spec.commands:
+        lo, hi = spec.cmd_len(cmd)
+        size = str(lo) if lo == hi else "%d-%s" % (lo, "" if hi == 0xFF else hi)
+        layout = " ".join("%s:%s" % (n, t) for n, t in cmd.get("fields", []))
+        print("cmd 0x%02X %-20s len %-5s %s" % (cmd["id"], cmd["name"], size, layout))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--spec", default=SPEC_PATH)
+    sub = parser.add_subparsers(dest="cmd", required=True)
+
+    p = sub.add_parser("gen")
+    p.add_argument("--check", action="store_true", help="fail if the generated files are out of date")
+    p.set_defaults(func=cmd_gen)
+
+    p = sub.add_parser("dump")
+    p.set_defaults(func=cmd_dump)
+
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()
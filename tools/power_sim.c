@@ -0,0 +1,235 @@
+/**
+ ** Host side run of the ignition power state machine (sys_power_fsm.h) on a simulated clock,
+ ** with the same build of the FSM the firmware uses:
+ **
+ **   cc -O2 -Icomponents/sys_monitor/include -Icomponents/kbus_service/include -o build/power_sim \
+ **       tools/power_sim.c components/sys_monitor/sys_power_fsm.c
+ **
+ **   power_sim capture.kbc         replays a .kbc capture (kbus_capture.py, CONFIG_KBUS_CAPTURE)
+ **   power_sim script.txt          "<seconds> ign-on|ign-off|request|activity" per line, # comments;
+ **                                 "<seconds> expect on|linger|off" checks the state at that time
+ **   -s SEC, -l SEC                silence and linger timeouts (CONFIG_SYS_POWER_SILENCE_SEC/LINGER_SEC)
+ **   -t SEC                        quiet time to run on after the last event
+ **
+ ** Prints every transition at the simulated time it happens, timeouts included, and for a
+ ** capture the time from each wake to the first frame an emulated device (SDRS, TEL, CDC) sent,
+ ** if the capture has the bus echo of our own frames. A script with expect lines prints PASS
+ ** or FAIL and exits 1 if any state differed; tools/power_ignition.txt is ignition off, bus
+ ** silence, sleep and the wakes with the default timeouts.
+ */
+
+// C stdlib includes
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// component includes
+#include "kbus_defines.h"
+#include "sys_power_fsm.h"
+
+#define KBC_MAGIC "KBC1"
+#define KBC_VERSION 1
+#define KBC_HDR_LEN 8
+#define KBC_REC_HDR_LEN 7
+#define IGN_STAT_ON_MASK 0x07   // Same as kbus_service.c
+
+static sys_power_fsm_t fsm;
+static uint64_t sim_us = 0;         // Simulated clock; time of the last event or timeout
+static uint64_t woke_us = 0;
+static bool awaiting_reply = false;
+static uint32_t transitions = 0;
+static uint32_t expects = 0, expects_failed = 0;
+
+static void run_until(uint64_t t_us);
+static void feed(sys_power_event_t event, uint64_t t_us);
+
+static inline uint32_t to_ms(uint64_t us) {
+    return (uint32_t)(us / 1000);
+}
+
+// Fires every timeout due before t_us at its own time, as the power task would
+static void run_until(uint64_t t_us) {
+    uint32_t next_ms;
+
+    while(1) {
+        next_ms = sys_power_fsm_next_ms(&fsm, to_ms(sim_us));
+        if(next_ms == UINT32_MAX || sim_us + (uint64_t)next_ms * 1000 > t_us) return;
+        feed(SYS_POWER_EV_TICK, sim_us + (uint64_t)next_ms * 1000);
+    }
+}
+
+static void feed(sys_power_event_t event, uint64_t t_us) {
+    sys_power_state_t from = fsm.state;
+    sys_power_state_t to = sys_power_fsm_event(&fsm, event, to_ms(t_us));
+
+    sim_us = t_us;
+    if(to == from) return;
+    transitions++;
+    printf("%10.3f s  %-6s -> %-6s on %s\n", t_us / 1e6, sys_power_state_name(from), sys_power_state_name(to),
+           sys_power_event_name(event));
+    if(from == SYS_POWER_OFF) {
+        woke_us = t_us;
+        awaiting_reply = true;
+    } else if(to == SYS_POWER_OFF) {
+        awaiting_reply = false;
+    }
+}
+
+static void on_frame(uint64_t t_us, uint8_t src, uint8_t dst, const uint8_t* body, uint8_t body_len) {
+    run_until(t_us);
+
+    if(awaiting_reply && (src == SDRS || src == TEL || src == CDC)) {
+        printf("%10.3f s  wake to first reply %.1f ms (0x%02x -> 0x%02x)\n", t_us / 1e6, (t_us - woke_us) / 1e3, src, dst);
+        awaiting_reply = false;
+    }
+
+    if(dst == GLO && body_len == 2 && body[0] == IGN_STAT_RPLY) {
+        feed((body[1] & IGN_STAT_ON_MASK) ? SYS_POWER_EV_IGN_ON : SYS_POWER_EV_IGN_OFF, t_us);
+    } else if(dst == SDRS || dst == TEL || dst == CDC) {
+        feed(SYS_POWER_EV_REQUEST, t_us);
+    } else {
+        feed(SYS_POWER_EV_ACTIVITY, t_us);
+    }
+}
+
+/**
+ ** [uint32 LE us since previous record][src][dst][body_len][body...], after an 8 byte header
+ */
+static int run_capture(const uint8_t* data, size_t len, uint64_t* end_us) {
+    uint64_t t_us = 0;
+    size_t pos = KBC_HDR_LEN;
+
+    if(len < KBC_HDR_LEN || data[4] != KBC_VERSION) {
+        fprintf(stderr, "not a v%d K-bus capture\n", KBC_VERSION);
+        return 1;
+    }
+    while(pos + KBC_REC_HDR_LEN <= len) {
+        const uint8_t* rec = &data[pos];
+        uint8_t body_len = rec[6];
+        if(pos + KBC_REC_HDR_LEN + body_len > len) {
+            fprintf(stderr, "truncated record at offset %zu\n", pos);
+            return 1;
+        }
+        t_us += rec[0] | rec[1] << 8 | rec[2] << 16 | (uint32_t)rec[3] << 24;
+        on_frame(t_us, rec[4], rec[5], &rec[KBC_REC_HDR_LEN], body_len);
+        pos += KBC_REC_HDR_LEN + body_len;
+    }
+    *end_us = t_us;
+    return 0;
+}
+
+static int run_script(char* text, uint64_t* end_us) {
+    static const char* names[SYS_POWER_EV_TICK] = {"ign-on", "ign-off", "request", "activity"};
+    char* line, *save = NULL;
+    char name[16], arg[16];
+    double sec;
+    int line_no = 0, ev, fields;
+
+    for(line = strtok_r(text, "\n", &save); line != NULL; line = strtok_r(NULL, "\n", &save)) {
+        line_no++;
+        if(line[strspn(line, " \t\r")] == '#' || line[strspn(line, " \t\r")] == '\0') continue;
+        fields = sscanf(line, "%lf %15s %15s", &sec, name, arg);
+        if(fields < 2 || sec < 0) {
+            fprintf(stderr, "line %d: expected \"<seconds> <event>\"\n", line_no);
+            return 1;
+        }
+        if(strcmp(name, "expect") == 0) {
+            if(fields != 3 || (uint64_t)(sec * 1e6) < *end_us) {
+                fprintf(stderr, "line %d: expected \"<seconds> expect <state>\" in time order\n", line_no);
+                return 1;
+            }
+            *end_us = (uint64_t)(sec * 1e6);
+            run_until(*end_us);
+            expects++;
+            if(strcmp(arg, sys_power_state_name(fsm.state)) != 0) {
+                printf("%10.3f s  FAIL expected %s, is %s (line %d)\n", sec, arg, sys_power_state_name(fsm.state), line_no);
+                expects_failed++;
+            }
+            continue;
+        }
+        for(ev = 0; ev < SYS_POWER_EV_TICK && strcmp(name, names[ev]) != 0; ev++);
+        if(ev == SYS_POWER_EV_TICK || (uint64_t)(sec * 1e6) < *end_us) {
+            fprintf(stderr, "line %d: unknown event or time going backwards\n", line_no);
+            return 1;
+        }
+        *end_us = (uint64_t)(sec * 1e6);
+        run_until(*end_us);
+        feed((sys_power_event_t)ev, *end_us);
+    }
+    return 0;
+}
+
+static char* read_all(FILE* f, size_t* len) {
+    size_t cap = 64 * 1024;
+    char* data = malloc(cap + 1);
+
+    *len = 0;
+    while(data != NULL) {
+        *len += fread(&data[*len], 1, cap - *len, f);
+        if(*len < cap) break;
+        cap *= 2;
+        data = realloc(data, cap + 1);
+    }
+    if(data == NULL) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    data[*len] = '\0';
+    return data;
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [-s silence_sec] [-l linger_sec] [-t tail_sec] capture.kbc | script.txt | -\n", argv0);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    sys_power_cfg_t cfg = {.silence_ms = 60 * 1000, .linger_ms = 600 * 1000};
+    double tail_sec = 0;
+    uint64_t end_us = 0;
+    const char* path;
+    FILE* f;
+    char* data;
+    size_t len;
+    int ret, opt;
+
+    while((opt = getopt(argc, argv, "s:l:t:")) != -1) {
+        switch(opt) {
+            case 's': cfg.silence_ms = (uint32_t)(atof(optarg) * 1000); break;
+            case 'l': cfg.linger_ms = (uint32_t)(atof(optarg) * 1000); break;
+            case 't': tail_sec = atof(optarg); break;
+            default: usage(argv[0]);
+        }
+    }
+    if(optind != argc - 1) usage(argv[0]);
+    path = argv[optind];
+
+    f = strcmp(path, "-") == 0 ? stdin : fopen(path, "rb");
+    if(f == NULL) {
+        perror(path);
+        return 1;
+    }
+    data = read_all(f, &len);
+    if(f != stdin) fclose(f);
+
+    // Same start as the firmware: ON at boot, as if the bus had just been active
+    sys_power_fsm_init(&fsm, &cfg, 0);
+    if(len >= 4 && memcmp(data, KBC_MAGIC, 4) == 0) {
+        ret = run_capture((const uint8_t*)data, len, &end_us);
+    } else {
+        ret = run_script(data, &end_us);
+    }
+    free(data);
+    if(ret != 0) return ret;
+
+    end_us += (uint64_t)(tail_sec * 1e6);
+    run_until(end_us);
+    printf("%10.3f s  %s, %u transitions\n", end_us / 1e6, sys_power_state_name(fsm.state), transitions);
+    if(expects == 0) return 0;
+    printf("%u expectations, %u failed\n", expects, expects_failed);
+    printf("%s\n", expects_failed ? "FAIL" : "PASS");
+    return expects_failed ? 1 : 0;
+}
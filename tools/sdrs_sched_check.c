@@ -0,0 +1,168 @@
+/**
+ ** Host side check of the SDRS emulator's deadlines (sdrs_sched.h), built from the same source
+ ** as the firmware:
+ **
+ **   cc -O2 -Icomponents/sdrs_emulator/include -o build/sdrs_sched_check \
+ **       tools/sdrs_sched_check.c components/sdrs_emulator/sdrs_sched.c
+ **
+ **   sdrs_sched_check          every scenario, starting at tick 5000 and again just before the tick counter wraps
+ **   -v                        print every frame sent
+ **
+ ** Runs emu_task's loop on a simulated 1 ms tick: sleep for sdrs_sched_wait() or until the next
+ ** radio request, feed the request the way handle_request() does, send what sdrs_sched_service()
+ ** says is due. Every channel text and track text push has to come out at exactly its expected
+ ** tick. The baseline answered a heartbeat, then slept in vTaskDelay(SECONDS(1)) before sending
+ ** the channel text; the follow-up still goes out SDRS_TEXT_FOLLOWUP_MS after the reply, now
+ ** without holding up requests in between. Exits 1 if anything differs.
+ */
+
+// C stdlib includes
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// component includes
+#include "sdrs_sched.h"
+
+#define RAD 0x68
+#define MAX_STEPS 8
+
+typedef enum {
+    EV_END = 0,
+    EV_HEARTBEAT,       // Status poll; reply now, channel text follows
+    EV_CHAN_DN,         // Same follow-up as a heartbeat
+    EV_SONG_REQ,        // A poll without a follow-up
+    EV_SLEEP,           // Radio switched away from SAT
+    EV_CHANGE,          // Now-playing text changed
+    EV_NUDGE,           // Display publish with the text unchanged
+} event_t;
+
+typedef enum {
+    OUT_END = 0,
+    OUT_CHAN_TEXT,
+    OUT_TRACK_TEXT,
+} output_t;
+
+typedef struct {
+    uint32_t t;
+    event_t event;
+} step_t;
+
+typedef struct {
+    uint32_t t;
+    output_t output;
+} expect_t;
+
+typedef struct {
+    const char* name;
+    step_t steps[MAX_STEPS];
+    expect_t expect[MAX_STEPS];
+} scenario_t;
+
+static const char* output_names[] = {"", "chan text", "track text"};
+
+static const scenario_t scenarios[] = {
+    {"heartbeat follow-up", {{0, EV_HEARTBEAT}},
+                            {{1000, OUT_CHAN_TEXT}}},
+    {"repeated polls",      {{0, EV_HEARTBEAT}, {400, EV_HEARTBEAT}, {800, EV_HEARTBEAT}, {1500, EV_HEARTBEAT}},
+                            {{1000, OUT_CHAN_TEXT}, {2500, OUT_CHAN_TEXT}}},
+    {"channel down",        {{0, EV_CHAN_DN}, {200, EV_SONG_REQ}},
+                            {{1000, OUT_CHAN_TEXT}}},
+    {"push while SAT",      {{0, EV_SONG_REQ}, {2000, EV_CHANGE}, {2300, EV_CHANGE}, {3100, EV_CHANGE}, {3500, EV_CHANGE}},
+                            {{2000, OUT_TRACK_TEXT}, {3000, OUT_TRACK_TEXT}, {4000, OUT_TRACK_TEXT}}},
+    {"not SAT",             {{0, EV_SLEEP}, {500, EV_CHANGE}},
+                            {{0}}},
+    {"source timed out",    {{0, EV_HEARTBEAT}, {10500, EV_CHANGE}, {11000, EV_SONG_REQ}, {11200, EV_CHANGE}},
+                            {{1000, OUT_CHAN_TEXT}, {11200, OUT_TRACK_TEXT}}},
+    {"text unchanged",      {{0, EV_HEARTBEAT}, {100, EV_CHANGE}, {1500, EV_NUDGE}},
+                            {{100, OUT_TRACK_TEXT}, {1000, OUT_CHAN_TEXT}}},
+};
+
+static bool verbose = false;
+
+static int run(const scenario_t* scenario, uint32_t t0) {
+    sdrs_sched_t sched;
+    sdrs_due_t due;
+    uint32_t now = t0, wait, version = 1;
+    size_t step = 0, out = 0;
+    int failures = 0;
+
+    sdrs_sched_init(&sched, SDRS_TEXT_FOLLOWUP_MS, SDRS_ACTIVE_TIMEOUT_MS, SDRS_PUSH_MIN_MS, now);
+    while(1) {
+        const step_t* next = &scenario->steps[step];
+        bool have_step = step < MAX_STEPS && next->event != EV_END;
+
+        // What xQueueReceive(rx_queue, ..., deferred_wait()) would wake for first
+        wait = sdrs_sched_wait(&sched, now);
+        if(wait == SDRS_SCHED_FOREVER && !have_step) break;
+        if(have_step && (wait == SDRS_SCHED_FOREVER || t0 + next->t - now <= wait)) {
+            now = t0 + next->t;
+            switch(next->event) {
+                case EV_HEARTBEAT:
+                case EV_CHAN_DN:
+                    sdrs_sched_poll(&sched, RAD, true, now);
+                    sdrs_sched_chan_text(&sched, RAD, now);
+                    break;
+                case EV_SONG_REQ: sdrs_sched_poll(&sched, RAD, true, now); break;
+                case EV_SLEEP:    sdrs_sched_poll(&sched, RAD, false, now); break;
+                case EV_CHANGE:   version++;    // Fall through
+                case EV_NUDGE:    sdrs_sched_track_changed(&sched, now); break;
+                default: break;
+            }
+            step++;
+        } else {
+            now += wait;
+        }
+
+        due = sdrs_sched_service(&sched, version, now);
+        for(output_t o = OUT_CHAN_TEXT; o <= OUT_TRACK_TEXT; o++) {
+            const expect_t* expect = &scenario->expect[out];
+
+            if(o == OUT_CHAN_TEXT ? !due.chan_text : !due.track_text) continue;
+            if(o == OUT_TRACK_TEXT) sdrs_sched_pushed(&sched, version, now);
+            if(verbose) printf("  %6u ms %s\n", now - t0, output_names[o]);
+            if(out >= MAX_STEPS || expect->output != o || expect->t != now - t0) {
+                printf("FAIL %s from %u: %s at %u ms, expected %s at %u ms\n", scenario->name, t0, output_names[o],
+                       now - t0, out < MAX_STEPS ? output_names[expect->output] : "nothing", out < MAX_STEPS ? expect->t : 0);
+                failures++;
+            }
+            if(out < MAX_STEPS) out++;
+        }
+    }
+    if(out < MAX_STEPS && scenario->expect[out].output != OUT_END) {
+        printf("FAIL %s from %u: %s at %u ms never sent\n", scenario->name, t0, output_names[scenario->expect[out].output],
+               scenario->expect[out].t);
+        failures++;
+    }
+    return failures;
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [-v]\n", argv0);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    static const uint32_t starts[] = {5000, UINT32_MAX - 2500};
+    int failures = 0, opt;
+
+    while((opt = getopt(argc, argv, "v")) != -1) {
+        switch(opt) {
+            case 'v': verbose = true; break;
+            default: usage(argv[0]);
+        }
+    }
+    if(optind != argc) usage(argv[0]);
+
+    for(size_t s = 0; s < sizeof(scenarios) / sizeof(scenarios[0]); s++) {
+        for(size_t t = 0; t < sizeof(starts) / sizeof(starts[0]); t++) {
+            if(verbose) printf("%s from %u\n", scenarios[s].name, starts[t]);
+            failures += run(&scenarios[s], starts[t]);
+        }
+    }
+    printf("%zu scenarios, %d failed\n", sizeof(scenarios) / sizeof(scenarios[0]), failures);
+    printf("%s\n", failures ? "FAIL" : "PASS");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,51 @@
+#!/usr/bin/env python3
+"""MFL -> AVRCP latency benchmark (CONFIG_KBUS_BENCH) comparison.
+
+Collects the BENCH lines sys_bench_report() prints, one per run phase:
+    BENCH topology=split phase=loaded n=400 lost=0 mean=.. min=.. p50=.. p90=.. p99=.. max=..
+from any number of `idf.py monitor` logs, typically one per CONFIG_SYS_TOPOLOGY_* build,
+and prints them side by side in microseconds. A topology seen more than once keeps its
+last result.
+"""
+import argparse
+import re
+import sys
+
+LINE = re.compile(r"BENCH ((?:\w+=\S+ ?)+)")
+COLUMNS = ["n", "lost", "mean", "min", "p50", "p90", "p99", "max"]
+
+
+def read_results(paths):
+    results = {}
+    for path in paths:
+        with open(path, errors="replace") as f:
+            for line in f:
+                m = LINE.search(line)
+                if m is None:
+                    continue
+                fields = dict(kv.split("=", 1) for kv in m.group(1).split())
+                key = (fields.get("phase", "?"), fields.get("topology", "?"))
+                results[key] = fields
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("logs", nargs="+", help="monitor logs with BENCH lines")
+    parser.add_argument("--sort", default="p99", choices=COLUMNS, help="order topologies within a phase by this column")
+    args = parser.parse_args()
+
+    results = read_results(args.logs)
+    if not results:
+        sys.exit("no BENCH lines in %s" % ", ".join(args.logs))
+
+    print("%-8s %-12s" % ("phase", "topology") + "".join("%8s" % c for c in COLUMNS))
+    for phase in sorted({p for p, _ in results}):
+        rows = [(t, f) for (p, t), f in results.items() if p == phase]
+        rows.sort(key=lambda r: int(r[1].get(args.sort, 0)))
+        for topology, fields in rows:
+            print("%-8s %-12s" % (phase, topology) + "".join("%8s" % fields.get(c, "-") for c in COLUMNS))
+
+
+if __name__ == "__main__":
+    main()
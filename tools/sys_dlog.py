@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+"""Deferred binary log (CONFIG_SYS_DLOG) decoder.
+
+Call sites live in the ELF's .dlog_sites section as NUL terminated
+"<level>\\x1f<file>:<line>\\x1f<format>" strings; a site id is the string's offset.
+Records come out of the monitor as "DL <hex>" lines, all little-endian:
+    [uint32 us][uint16 site][uint8 buffer length][uint8 flags][uint32 arg x (flags & 7)][buffer]
+Bit 7 of flags is the core. Site 0xffff is a marker, its one arg is the number of records lost.
+
+Subcommands:
+    table   write the site table from an ELF to JSON (the build does this next to the .elf)
+    decode  pass a monitor log through, turning DL lines back into log text
+"""
+import argparse
+import json
+import os
+import re
+import struct
+import sys
+
+SECTION = ".dlog_sites"
+SITE_LOST = 0xFFFF
+BUF_MAX = 36    # SYS_DLOG_BUF_MAX
+REC_HDR = struct.Struct("<IHBB")
+SPEC = re.compile(r"%(?:%|[-+ #0]*(?:\d+|\*)?(?:\.(?:\d+|\*))?(?:hh|h|ll|l|z|j|t)?([diouxXcsp]))")
+
+
+def elf_section(path, wanted):
+    """Raw bytes of one section from a 32 bit little-endian ELF."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1:
+        raise ValueError("%s: not a 32 bit little-endian ELF" % path)
+    shoff, = struct.unpack_from("<I", data, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x2E)
+
+    def header(i):
+        # name, type, flags, addr, offset, size
+        return struct.unpack_from("<6I", data, shoff + i * shentsize)
+
+    strtab = header(shstrndx)
+    for i in range(shnum):
+        name_off, _, _, _, offset, size = header(i)
+        start = strtab[4] + name_off
+        if data[start:data.index(b"\0", start)].decode() == wanted:
+            return data[offset:offset + size]
+    return None
+
+
+def site_table(elf):
+    raw = elf_section(elf, SECTION)
+    if raw is None:
+        raise ValueError("%s has no %s section; built without CONFIG_SYS_DLOG?" % (elf, SECTION))
+    if len(raw) > SITE_LOST:
+        raise ValueError("%s is %d bytes, site ids are 16 bit" % (SECTION, len(raw)))
+
+    sites, pos = {}, 0
+    while pos < len(raw):
+        end = raw.index(b"\0", pos)
+        if end > pos:
+            level, where, fmt = raw[pos:end].decode(errors="replace").split("\x1f", 2)
+            sites[pos] = (level, where, fmt)
+        pos = end + 1
+    return sites
+
+
+def load_sites(path):
+    if path.endswith(".json"):
+        with open(path) as f:
+            return {int(k): tuple(v) for k, v in json.load(f).items()}
+    return site_table(path)
+
+
+def signed(value):
+    return value - (1 << 32) if value & 0x80000000 else value
+
+
+def render(fmt, args, buf, cut):
+    """printf for the integer args; a %.*s takes the buffer as text, otherwise it's appended as hex."""
+    args, used_buf = list(args), False
+
+    def sub(m):
+        nonlocal used_buf
+        conv = m.group(1)
+        if conv is None:
+            return "%"
+        spec = m.group(0)
+        if ".*s" in spec and not used_buf:
+            used_buf = True
+            return spec.replace(".*", "") % buf.decode(errors="replace")
+        value = args.pop(0) if args else 0
+        spec = re.sub(r"(hh|h|ll|l|z|j|t)(?=[diouxXcsp]$)", "", spec)
+        if conv in "di":
+            return spec % signed(value)
+        if conv == "c":
+            return spec % chr(value & 0xFF)
+        if conv in "sp":
+            return "0x%08x" % value
+        return spec % value
+
+    text = SPEC.sub(sub, fmt)
+    if buf and not used_buf:
+        text += "\n    " + " ".join("%02x" % b for b in buf)
+    if cut:
+        text += " (+%d cut)" % cut
+    return text
+
+
+def decode_line(sites, payload):
+    data = bytes.fromhex(payload)
+    us, site, buf_len, flags = REC_HDR.unpack_from(data)
+    nargs, core = flags & 0x07, flags >> 7
+    args = struct.unpack_from("<%dI" % nargs, data, REC_HDR.size)
+    buf = data[REC_HDR.size + 4 * nargs:]
+
+    stamp = "(%d.%06d) c%d" % (us // 1000000, us % 1000000, core)
+    if site == SITE_LOST:
+        return "W %s <%d records lost>" % (stamp, args[0] if args else 0)
+    if site not in sites:
+        return "? %s <unknown site 0x%04x, stale table?>" % (stamp, site)
+    level, where, fmt = sites[site]
+    cut = buf_len - len(buf) if buf_len > BUF_MAX else 0
+    return "%s %s %s: %s" % (level, stamp, os.path.basename(where), render(fmt, args, buf, cut))
+
+
+def cmd_table(args):
+    sites = site_table(args.elf)
+    with open(args.output, "w") as f:
+        json.dump({str(k): list(v) for k, v in sorted(sites.items())}, f, indent=1)
+    print("%d sites -> %s" % (len(sites), args.output))
+
+
+def cmd_decode(args):
+    sites = load_sites(args.sites)
+    src = open(args.log, errors="replace") if args.log != "-" else sys.stdin
+    with src:
+        for line in src:
+            pos = line.find("DL ")
+            if pos < 0:
+                sys.stdout.write(line)
+                continue
+            try:
+                print(line[:pos] + decode_line(sites, line[pos + 3:].strip()))
+            except (ValueError, struct.error):
+                sys.stdout.write(line)  # Mangled by the console, leave it as is
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="cmd", required=True)
+
+    p = sub.add_parser("table")
+    p.add_argument("elf")
+    p.add_argument("-o", "--output", required=True)
+    p.set_defaults(func=cmd_table)
+
+    p = sub.add_parser("decode")
+    p.add_argument("sites", help="firmware .elf, or the .json table written by `table`")
+    p.add_argument("log", nargs="?", default="-", help="`idf.py monitor` log, stdin if omitted")
+    p.set_defaults(func=cmd_decode)
+
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+"""Runtime telemetry (CONFIG_SYS_TELEMETRY) decoder.
+
+Format matches components/sys_monitor/include/sys_telemetry.h, all little-endian:
+    header  b"TLM1" [uint32 uptime ms][queues][timers][tasks][reserved]
+    queue   [name 12][uint32 sends][uint32 timeouts][uint32 drops][uint32 depth x8]
+    timer   [name 12][uint32 count][uint32 total us][uint32 log2 us histogram x12]
+    task    [name 16][uint16 CPU per mille of a core][2 reserved]
+
+Counters are totals since boot; with more than one TLM-BEGIN/TLM-END block in the log,
+--delta prints the change between the last two instead.
+"""
+import argparse
+import struct
+import sys
+
+MAGIC = b"TLM1"
+HDR_LEN = 12
+NAME_LEN = 12
+TASK_NAME_LEN = 16
+DEPTH_BUCKETS = 8
+TIME_BUCKETS = 12
+QUEUE_LEN = NAME_LEN + 12 + 4 * DEPTH_BUCKETS
+TIMER_LEN = NAME_LEN + 8 + 4 * TIME_BUCKETS
+TASK_LEN = TASK_NAME_LEN + 4
+
+
+def name(raw):
+    return raw.split(b"\0", 1)[0].decode(errors="replace")
+
+
+def parse(data):
+    if len(data) < HDR_LEN or data[:4] != MAGIC:
+        raise ValueError("not a telemetry snapshot")
+    uptime_ms, queues, timers, tasks = struct.unpack_from("<IBBB", data, 4)
+    if len(data) < HDR_LEN + queues * QUEUE_LEN + timers * TIMER_LEN + tasks * TASK_LEN:
+        raise ValueError("truncated snapshot")
+
+    snap = {"uptime_ms": uptime_ms, "queues": [], "timers": [], "tasks": []}
+    pos = HDR_LEN
+    for _ in range(queues):
+        fields = struct.unpack_from("<3I%dI" % DEPTH_BUCKETS, data, pos + NAME_LEN)
+        snap["queues"].append((name(data[pos:pos + NAME_LEN]), list(fields)))
+        pos += QUEUE_LEN
+    for _ in range(timers):
+        fields = struct.unpack_from("<2I%dI" % TIME_BUCKETS, data, pos + NAME_LEN)
+        snap["timers"].append((name(data[pos:pos + NAME_LEN]), list(fields)))
+        pos += TIMER_LEN
+    for _ in range(tasks):
+        (share,) = struct.unpack_from("<H", data, pos + TASK_NAME_LEN)
+        snap["tasks"].append((name(data[pos:pos + TASK_NAME_LEN]), share))
+        pos += TASK_LEN
+    return snap
+
+
+def delta(new, old):
+    """new - old for the cumulative counters; task shares are already per interval."""
+    out = dict(new, uptime_ms=new["uptime_ms"] - old["uptime_ms"])
+    for key in ("queues", "timers"):
+        before = dict(old[key])
+        out[key] = [(n, [a - b for a, b in zip(f, before.get(n, [0] * len(f)))]) for n, f in new[key]]
+    return out
+
+
+def percentile(hist, pct):
+    """Upper bound of the bucket holding the pct'th sample; None if no samples."""
+    total = sum(hist)
+    if total == 0:
+        return None
+    target, seen = (total * pct + 99) // 100, 0
+    for i, count in enumerate(hist):
+        seen += count
+        if seen >= target:
+            return (2 << i) - 1
+    return None
+
+
+def print_snapshot(snap):
+    print("uptime %.1f s" % (snap["uptime_ms"] / 1000))
+    if snap["queues"]:
+        print("\n%-12s %8s %8s %8s  depth 0..7+" % ("queue", "sends", "timeout", "drops"))
+        for n, f in snap["queues"]:
+            print("%-12s %8d %8d %8d  %s" % (n, f[0], f[1], f[2], " ".join("%d" % d for d in f[3:])))
+    if snap["timers"]:
+        print("\n%-12s %8s %8s %8s %8s" % ("timer", "count", "mean us", "p50 us", "p99 us"))
+        for n, f in snap["timers"]:
+            count, total, hist = f[0], f[1], f[2:]
+            p50, p99 = percentile(hist, 50), percentile(hist, 99)
+            print("%-12s %8d %8s %8s %8s" % (n, count, "%.1f" % (total / count) if count else "-",
+                                            "<%d" % (p50 + 1) if p50 is not None else "-",
+                                            "<%d" % (p99 + 1) if p99 is not None else "-"))
+    if snap["tasks"]:
+        print("\n%-16s %7s" % ("task", "cpu %"))
+        for n, share in sorted(snap["tasks"], key=lambda t: -t[1]):
+            print("%-16s %7.1f" % (n, share / 10))
+
+
+def read_dumps(lines):
+    data, inside = bytearray(), False
+    for line in lines:
+        line = line.strip()
+        if line.startswith("TLM-BEGIN"):
+            data, inside = bytearray(), True
+        elif line.startswith("TLM-END") and inside:
+            inside = False
+            yield bytes(data)
+        elif inside:
+            data += bytes.fromhex(line)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("log", help="`idf.py monitor` log with TLM-BEGIN/TLM-END blocks")
+    parser.add_argument("--delta", action="store_true", help="change between the last two blocks")
+    args = parser.parse_args()
+
+    with open(args.log, errors="replace") as f:
+        snaps = [parse(d) for d in read_dumps(f)]
+    if not snaps:
+        sys.exit("no telemetry blocks in %s" % args.log)
+    if args.delta:
+        if len(snaps) < 2:
+            sys.exit("--delta needs two blocks")
+        print_snapshot(delta(snaps[-1], snaps[-2]))
+    else:
+        print_snapshot(snaps[-1])
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+"""Per-frame latency trace (CONFIG_SYS_TRACE) tool.
+
+Format matches components/sys_monitor/include/sys_trace.h, all little-endian:
+    header  b"TRC1" [uint32 record count][uint32 now us]
+    record  [uint32 us][uint16 trace id][uint16 arg][stage][core][2 reserved]
+
+Subcommands:
+    stats   per stage latency percentiles, plus end to end per trace id
+    chrome  Chrome trace / Perfetto JSON; open in chrome://tracing or ui.perfetto.dev
+"""
+import argparse
+import json
+import struct
+import sys
+
+import kbus_spec
+
+MAGIC = b"TRC1"
+HDR_LEN = 12
+REC_LEN = 12
+
+# sys_trace_stage_t; (name, timeline lane)
+STAGES = {
+    1: ("rx_dequeue", "kbus_rx"),
+    2: ("dispatch", "kbus_disp"),
+    3: ("handler_begin", "handlers"),
+    4: ("handler_end", "handlers"),
+    5: ("bt_enqueue", "kbus_disp"),
+    6: ("bt_dequeue", "bt_cmd"),
+    7: ("avrcp_sent", "bt_cmd"),
+    8: ("tx_submit", "kbus_tx"),
+    9: ("tx_handoff", "kbus_tx"),
+}
+LANES = ["kbus_rx", "kbus_disp", "handlers", "bt_cmd", "kbus_tx"]
+SPEC = kbus_spec.load()
+BT_CMDS = ["noop", "connect", "disconnect", "play", "pause", "stop", "ff_start", "ff_stop",
+           "rwd_start", "rwd_stop", "next", "prev", "get_info"]
+
+
+def read_dumps(lines):
+    data, inside = bytearray(), False
+    for line in lines:
+        line = line.strip()
+        if line.startswith("TRC-BEGIN"):
+            data, inside = bytearray(), True    # Last block in the log wins
+        elif line.startswith("TRC-END"):
+            inside = False
+        elif inside:
+            data += bytes.fromhex(line)
+    return bytes(data)
+
+
+def read_trace(data):
+    """Yields (us, id, arg, stage, core) oldest first, with the 32 bit clock unwrapped."""
+    if len(data) < HDR_LEN or data[:4] != MAGIC:
+        raise ValueError("not a trace dump")
+    (count,) = struct.unpack_from("<I", data, 4)
+    last, wraps = None, 0
+    for i in range(count):
+        pos = HDR_LEN + i * REC_LEN
+        if pos + REC_LEN > len(data):
+            raise ValueError("truncated record %d" % i)
+        us, tid, arg, stage, core = struct.unpack_from("<IHHBB", data, pos)
+        if stage not in STAGES:
+            continue    # Lost while dumping
+        # Records from the two cores can be a little out of order; only a big step back is a wrap
+        if last is not None and us + wraps < last - (1 << 31):
+            wraps += 1 << 32
+        us += wraps
+        last = us
+        yield us, tid, arg, stage, core
+
+
+def describe(stage, arg):
+    if stage in (1, 2):
+        return "%s -> %s" % (SPEC.dev_name(arg >> 8), SPEC.dev_name(arg & 0xFF))
+    if stage in (3, 4):
+        return "sub %d" % arg     # Subscription order; the QUEUE_DEBUG watcher lists them by name
+    if stage in (5, 6, 7):
+        return BT_CMDS[arg] if arg < len(BT_CMDS) else "0x%02x" % arg
+    return "-> %s %s" % (SPEC.dev_name(arg >> 8), SPEC.cmd_name(arg & 0xFF))
+
+
+def by_id(records):
+    traces = {}
+    for rec in records:
+        traces.setdefault(rec[1], []).append(rec)
+    for recs in traces.values():
+        recs.sort(key=lambda r: r[0])
+    return traces
+
+
+def percentile(values, pct):
+    values = sorted(values)
+    return values[min(len(values) - 1, (len(values) * pct + 99) // 100 - 1)]
+
+
+def cmd_stats(args):
+    with open(args.log, errors="replace") as f:
+        traces = by_id(read_trace(read_dumps(f)))
+
+    hops, totals = {}, []
+    for recs in traces.values():
+        for prev, cur in zip(recs, recs[1:]):
+            key = "%s -> %s" % (STAGES[prev[3]][0], STAGES[cur[3]][0])
+            hops.setdefault(key, []).append(cur[0] - prev[0])
+        if len(recs) > 1:
+            totals.append(recs[-1][0] - recs[0][0])
+
+    print("%-30s %7s %8s %8s %8s %8s" % ("stage (us)", "count", "p50", "p90", "p99", "max"))
+    rows = sorted(hops.items(), key=lambda kv: -len(kv[1]))
+    if totals:
+        rows.append(("end to end", totals))
+    for key, vals in rows:
+        print("%-30s %7d %8d %8d %8d %8d" % (key, len(vals), percentile(vals, 50), percentile(vals, 90),
+                                            percentile(vals, 99), max(vals)))
+    print("%d traces" % len(traces), file=sys.stderr)
+
+
+def cmd_chrome(args):
+    with open(args.log, errors="replace") as f:
+        records = list(read_trace(read_dumps(f)))
+    if not records:
+        sys.exit("no trace records in %s" % args.log)
+    t0 = records[0][0]
+    events = [{"ph": "M", "pid": 1, "name": "process_name", "args": {"name": "r50-kbus"}}]
+    events += [{"ph": "M", "pid": 1, "tid": i, "name": "thread_name", "args": {"name": lane}}
+               for i, lane in enumerate(LANES)]
+
+    for tid, recs in by_id(records).items():
+        begins = {}
+        for n, (us, _, arg, stage, core) in enumerate(recs):
+            name, lane = STAGES[stage]
+            ts = us - t0
+            common = {"pid": 1, "tid": LANES.index(lane), "ts": ts}
+            info = {"id": tid, "core": core, "what": describe(stage, arg)}
+
+            if stage == 3:
+                begins[arg] = ts
+                continue
+            if stage == 4 and arg in begins:
+                start = begins.pop(arg)
+                events.append(dict(common, ph="X", name=describe(stage, arg), ts=start, dur=ts - start, args=info))
+            else:
+                events.append(dict(common, ph="i", s="t", name=name, args=info))
+
+            # Flow arrows tie one frame's stages together across lanes
+            phase = "s" if n == 0 else ("f" if n == len(recs) - 1 else "t")
+            if len(recs) > 1:
+                events.append(dict(common, ph=phase, bp="e", id=tid, cat="frame", name="frame"))
+
+    with open(args.output, "w") as f:
+        json.dump({"traceEvents": events, "displayTimeUnit": "ms"}, f)
+    print("%d records -> %s" % (len(records), args.output))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="cmd", required=True)
+
+    p = sub.add_parser("stats")
+    p.add_argument("log", help="`idf.py monitor` log with a TRC-BEGIN/TRC-END block")
+    p.set_defaults(func=cmd_stats)
+
+    p = sub.add_parser("chrome")
+    p.add_argument("log")
+    p.add_argument("-o", "--output", required=True)
+    p.set_defaults(func=cmd_chrome)
+
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()